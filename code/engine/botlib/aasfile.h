@@ -25,7 +25,11 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #define AASID					   ( ( 'S' << 24 ) + ( 'A' << 16 ) + ( 'A' << 8 ) + 'E' )
 #define AASVERSION_OLD			   4
-#define AASVERSION				   5
+#define AASVERSION_DDATA		   5
+#define AASVERSION				   6
+// version 6 files are little endian, have a plain header and every lump
+// starts at a multiple of AASLUMP_ALIGN so the file can be used in place
+#define AASLUMP_ALIGN			   16
 
 // presence types
 #define PRESENCE_NONE			   1
@@ -43,6 +43,8 @@ bsp_link_t* AAS_BSPLinkEntity( vec3_t absmins, vec3_t absmaxs, int entnum, int m
 qboolean	AAS_EntityCollision( int entnum, vec3_t start, vec3_t boxmins, vec3_t boxmaxs, vec3_t end, int contentmask, bsp_trace_t* trace );
 // for debugging
 void		AAS_PrintFreeBSPLinks( char* str );
+// makes AAS_Trace and AAS_PointContents hold the mutex while job threads may call them, NULL when done
+void		AAS_SetEngineMutex( void* mutex );
 //
 #endif // AASINTERN
 
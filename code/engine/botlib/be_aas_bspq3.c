@@ -86,6 +86,9 @@ typedef struct bsp_s
 // global bsp
 bsp_t bspworld;
 
+// held around the engine calls while job threads may make them
+static void* bspenginemutex;
+
 #ifdef BSP_DEBUG
 typedef struct cname_s
 {
@@ -143,6 +146,14 @@ void	PrintContents( int contents )
 bsp_trace_t AAS_Trace( vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, int passent, int contentmask )
 {
 	bsp_trace_t bsptrace;
+
+	if( bspenginemutex )
+	{
+		botimport.LockMutex( bspenginemutex );
+		botimport.Trace( &bsptrace, start, mins, maxs, end, passent, contentmask );
+		botimport.UnlockMutex( bspenginemutex );
+		return bsptrace;
+	} // end if
 	botimport.Trace( &bsptrace, start, mins, maxs, end, passent, contentmask );
 	return bsptrace;
 } // end of the function AAS_Trace
@@ -155,9 +166,30 @@ bsp_trace_t AAS_Trace( vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, int p
 //===========================================================================
 int AAS_PointContents( vec3_t point )
 {
+	int contents;
+
+	if( bspenginemutex )
+	{
+		botimport.LockMutex( bspenginemutex );
+		contents = botimport.PointContents( point );
+		botimport.UnlockMutex( bspenginemutex );
+		return contents;
+	} // end if
 	return botimport.PointContents( point );
 } // end of the function AAS_PointContents
 //===========================================================================
+// the engine traces and point contents go through shared scratch data,
+// while the mutex is set only one thread at a time makes them
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_SetEngineMutex( void* mutex )
+{
+	bspenginemutex = mutex;
+} // end of the function AAS_SetEngineMutex
+//===========================================================================
 //
 // Parameter:				-
 // Returns:					-
@@ -1734,6 +1734,10 @@ void AAS_InitClustering()
 		}
 #endif
 	} // end if
+#ifndef BSPC
+	// the clustering changes the data in place
+	AAS_UnmapAASFile();
+#endif
 	// set all view portals as cluster portals in case we re-calculate the reachabilities and clusters (with -reach)
 	AAS_SetViewPortalsAsClusterPortals();
 	// count the number of forced cluster portals
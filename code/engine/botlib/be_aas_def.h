@@ -139,6 +139,25 @@ typedef struct aas_routingcache_s
 	unsigned short int		   traveltimes[1]; // travel time for every area (variable sized)
 } aas_routingcache_t;
 
+// travel flag combinations a route table holds
+#define MAX_ROUTETABLEFLAGS 4
+
+// precomputed routing read from the .rcd file
+typedef struct aas_routetable_s
+{
+	void*				file; // mapped route table file, NULL when not available
+	int					numtravelflags;
+	int					travelflags[MAX_ROUTETABLEFLAGS];
+	int*				clusteroffset;	  // first area table element of every cluster
+	int*				portalrow;		  // portal table row of every area, -1 without reachabilities
+	unsigned char*		noreachabilities; // cleared, portal routing never stores reachabilities
+	unsigned char*		areadisabled;	  // AREA_DISABLED state of every area when the table was mapped
+	int					numchangedareas;  // areas not in that state, the table is bypassed while non-zero
+	unsigned short int* areatraveltimes[MAX_ROUTETABLEFLAGS];
+	unsigned char*		areareachabilities[MAX_ROUTETABLEFLAGS];
+	unsigned short int* portaltraveltimes[MAX_ROUTETABLEFLAGS];
+} aas_routetable_t;
+
 // fields for the routing algorithm
 typedef struct aas_routingupdate_s
 {
@@ -173,6 +192,16 @@ typedef struct aas_reachabilityareas_s
 	int firstarea, numareas;
 } aas_reachabilityareas_t;
 
+// bsp node with its plane, flattened for point and box sampling
+typedef struct aas_samplenode_s
+{
+	float normal[3];   // plane normal
+	float dist;		   // plane distance
+	int	  type;		   // axis if the normal points along a positive axis, 3 otherwise
+	int	  children[2]; // child nodes, negative for areas, zero for solid
+	int	  pad;
+} aas_samplenode_t;
+
 typedef struct aas_s
 {
 	int							loaded;		 // true when an AAS file is loaded
@@ -184,6 +213,9 @@ typedef struct aas_s
 	int							numframes;
 	// name of the aas file
 	char						filename[MAX_QPATH];
+	// the mapped file most lumps point into, NULL when they were read
+	void*						mappedfile;
+	long						mappedsize;
 	char						mapname[MAX_QPATH];
 	// bounding boxes
 	int							numbboxes;
@@ -218,6 +250,7 @@ typedef struct aas_s
 	// nodes of the bsp tree
 	int							numnodes;
 	aas_node_t*					nodes;
+	aas_samplenode_t*			samplenodes; // the nodes with their planes
 	// cluster portals
 	int							numportals;
 	aas_portal_t*				portals;
@@ -258,6 +291,8 @@ typedef struct aas_s
 	// cache list sorted on time
 	aas_routingcache_t*			oldestcache; // start of cache list sorted on time
 	aas_routingcache_t*			newestcache; // end of cache list sorted on time
+	// precomputed routing for the most used travel flags
+	aas_routetable_t			routetable;
 	// maximum travel time through portal areas
 	int*						portalmaxtraveltimes;
 	// areas the reachabilities go through
@@ -276,6 +311,7 @@ typedef struct aas_s
 	#include "be_aas_reach.h"
 	#include "be_aas_route.h"
 	#include "be_aas_routealt.h"
+	#include "be_aas_routewarm.h"
 	#include "be_aas_debug.h"
 	#include "be_aas_file.h"
 	#include "be_aas_optimize.h"
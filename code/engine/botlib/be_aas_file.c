@@ -54,6 +54,11 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 void AAS_SwapAASData()
 {
 	int i, j;
+
+#ifdef Q3_LITTLE_ENDIAN
+	// nothing to swap, and the lumps of a mapped file must not be written to
+	return;
+#endif
 	// bounding boxes
 	for( i = 0; i < aasworld.numbboxes; i++ )
 	{
@@ -178,6 +183,86 @@ void AAS_SwapAASData()
 	} // end for
 } // end of the function AAS_SwapAASData
 //===========================================================================
+// returns true if the lump points into the mapped AAS file
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static qboolean AAS_IsMappedAASLump( void* lump )
+{
+	if( !aasworld.mappedfile || !lump )
+	{
+		return qfalse;
+	}
+	return ( char* )lump >= ( char* )aasworld.mappedfile && ( char* )lump < ( char* )aasworld.mappedfile + aasworld.mappedsize;
+} // end of the function AAS_IsMappedAASLump
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_FreeAASLump( void* lump )
+{
+	if( lump && !AAS_IsMappedAASLump( lump ) )
+	{
+		FreeMemory( lump );
+	}
+} // end of the function AAS_FreeAASLump
+//===========================================================================
+// returns a copy of the lump in memory of its own if it is mapped
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void* AAS_CopyMappedAASLump( void* lump, int length )
+{
+	void* copy;
+
+	if( !AAS_IsMappedAASLump( lump ) )
+	{
+		return lump;
+	}
+	copy = GetClearedHunkMemory( length + 1 );
+	Com_Memcpy( copy, lump, length );
+	return copy;
+} // end of the function AAS_CopyMappedAASLump
+//===========================================================================
+// copies all mapped lumps to memory and releases the mapped file, this has
+// to be done before the data is changed in place or the file is rewritten
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_UnmapAASFile()
+{
+	if( !aasworld.mappedfile )
+	{
+		return;
+	}
+	aasworld.bboxes		  = ( aas_bbox_t* )AAS_CopyMappedAASLump( aasworld.bboxes, aasworld.numbboxes * sizeof( aas_bbox_t ) );
+	aasworld.vertexes	  = ( aas_vertex_t* )AAS_CopyMappedAASLump( aasworld.vertexes, aasworld.numvertexes * sizeof( aas_vertex_t ) );
+	aasworld.planes		  = ( aas_plane_t* )AAS_CopyMappedAASLump( aasworld.planes, aasworld.numplanes * sizeof( aas_plane_t ) );
+	aasworld.edges		  = ( aas_edge_t* )AAS_CopyMappedAASLump( aasworld.edges, aasworld.numedges * sizeof( aas_edge_t ) );
+	aasworld.edgeindex	  = ( aas_edgeindex_t* )AAS_CopyMappedAASLump( aasworld.edgeindex, aasworld.edgeindexsize * sizeof( aas_edgeindex_t ) );
+	aasworld.faces		  = ( aas_face_t* )AAS_CopyMappedAASLump( aasworld.faces, aasworld.numfaces * sizeof( aas_face_t ) );
+	aasworld.faceindex	  = ( aas_faceindex_t* )AAS_CopyMappedAASLump( aasworld.faceindex, aasworld.faceindexsize * sizeof( aas_faceindex_t ) );
+	aasworld.areas		  = ( aas_area_t* )AAS_CopyMappedAASLump( aasworld.areas, aasworld.numareas * sizeof( aas_area_t ) );
+	aasworld.areasettings = ( aas_areasettings_t* )AAS_CopyMappedAASLump( aasworld.areasettings, aasworld.numareasettings * sizeof( aas_areasettings_t ) );
+	aasworld.reachability = ( aas_reachability_t* )AAS_CopyMappedAASLump( aasworld.reachability, aasworld.reachabilitysize * sizeof( aas_reachability_t ) );
+	aasworld.nodes		  = ( aas_node_t* )AAS_CopyMappedAASLump( aasworld.nodes, aasworld.numnodes * sizeof( aas_node_t ) );
+	aasworld.portals	  = ( aas_portal_t* )AAS_CopyMappedAASLump( aasworld.portals, aasworld.numportals * sizeof( aas_portal_t ) );
+	aasworld.portalindex  = ( aas_portalindex_t* )AAS_CopyMappedAASLump( aasworld.portalindex, aasworld.portalindexsize * sizeof( aas_portalindex_t ) );
+	aasworld.clusters	  = ( aas_cluster_t* )AAS_CopyMappedAASLump( aasworld.clusters, aasworld.numclusters * sizeof( aas_cluster_t ) );
+	//
+	botimport.FS_UnmapFile( aasworld.mappedfile );
+	aasworld.mappedfile = NULL;
+	aasworld.mappedsize = 0;
+} // end of the function AAS_UnmapAASFile
+//===========================================================================
 // dump the current loaded aas file
 //
 // Parameter:				-
@@ -187,91 +272,56 @@ void AAS_SwapAASData()
 void AAS_DumpAASData()
 {
 	aasworld.numbboxes = 0;
-	if( aasworld.bboxes )
-	{
-		FreeMemory( aasworld.bboxes );
-	}
+	AAS_FreeAASLump( aasworld.bboxes );
 	aasworld.bboxes		 = NULL;
 	aasworld.numvertexes = 0;
-	if( aasworld.vertexes )
-	{
-		FreeMemory( aasworld.vertexes );
-	}
+	AAS_FreeAASLump( aasworld.vertexes );
 	aasworld.vertexes  = NULL;
 	aasworld.numplanes = 0;
-	if( aasworld.planes )
-	{
-		FreeMemory( aasworld.planes );
-	}
+	AAS_FreeAASLump( aasworld.planes );
 	aasworld.planes	  = NULL;
 	aasworld.numedges = 0;
-	if( aasworld.edges )
-	{
-		FreeMemory( aasworld.edges );
-	}
+	AAS_FreeAASLump( aasworld.edges );
 	aasworld.edges		   = NULL;
 	aasworld.edgeindexsize = 0;
-	if( aasworld.edgeindex )
-	{
-		FreeMemory( aasworld.edgeindex );
-	}
+	AAS_FreeAASLump( aasworld.edgeindex );
 	aasworld.edgeindex = NULL;
 	aasworld.numfaces  = 0;
-	if( aasworld.faces )
-	{
-		FreeMemory( aasworld.faces );
-	}
+	AAS_FreeAASLump( aasworld.faces );
 	aasworld.faces		   = NULL;
 	aasworld.faceindexsize = 0;
-	if( aasworld.faceindex )
-	{
-		FreeMemory( aasworld.faceindex );
-	}
+	AAS_FreeAASLump( aasworld.faceindex );
 	aasworld.faceindex = NULL;
 	aasworld.numareas  = 0;
-	if( aasworld.areas )
-	{
-		FreeMemory( aasworld.areas );
-	}
+	AAS_FreeAASLump( aasworld.areas );
 	aasworld.areas			 = NULL;
 	aasworld.numareasettings = 0;
-	if( aasworld.areasettings )
-	{
-		FreeMemory( aasworld.areasettings );
-	}
+	AAS_FreeAASLump( aasworld.areasettings );
 	aasworld.areasettings	  = NULL;
 	aasworld.reachabilitysize = 0;
-	if( aasworld.reachability )
-	{
-		FreeMemory( aasworld.reachability );
-	}
+	AAS_FreeAASLump( aasworld.reachability );
 	aasworld.reachability = NULL;
 	aasworld.numnodes	  = 0;
-	if( aasworld.nodes )
-	{
-		FreeMemory( aasworld.nodes );
-	}
+	AAS_FreeAASLump( aasworld.nodes );
 	aasworld.nodes		= NULL;
 	aasworld.numportals = 0;
-	if( aasworld.portals )
-	{
-		FreeMemory( aasworld.portals );
-	}
+	AAS_FreeAASLump( aasworld.portals );
 	aasworld.portals	= NULL;
 	aasworld.numportals = 0;
-	if( aasworld.portalindex )
-	{
-		FreeMemory( aasworld.portalindex );
-	}
+	AAS_FreeAASLump( aasworld.portalindex );
 	aasworld.portalindex	 = NULL;
 	aasworld.portalindexsize = 0;
-	if( aasworld.clusters )
-	{
-		FreeMemory( aasworld.clusters );
-	}
+	AAS_FreeAASLump( aasworld.clusters );
 	aasworld.clusters	 = NULL;
 	aasworld.numclusters = 0;
 	//
+	if( aasworld.mappedfile )
+	{
+		botimport.FS_UnmapFile( aasworld.mappedfile );
+	}
+	aasworld.mappedfile = NULL;
+	aasworld.mappedsize = 0;
+	//
 	aasworld.loaded		 = qfalse;
 	aasworld.initialized = qfalse;
 	aasworld.savefile	 = qfalse;
@@ -344,7 +394,11 @@ char* AAS_LoadAASLump( fileHandle_t fp, int offset, int length, int* lastoffset,
 	// seek to the data
 	if( offset != *lastoffset )
 	{
-		botimport.Print( PRT_WARNING, "AAS file not sequentially read\n" );
+		// version 6 lumps are padded to AASLUMP_ALIGN
+		if( offset < *lastoffset || offset - *lastoffset >= AASLUMP_ALIGN )
+		{
+			botimport.Print( PRT_WARNING, "AAS file not sequentially read\n" );
+		}
 		if( botimport.FS_Seek( fp, offset, FS_SEEK_SET ) )
 		{
 			AAS_Error( "can't seek to aas lump\n" );
@@ -352,6 +406,7 @@ char* AAS_LoadAASLump( fileHandle_t fp, int offset, int length, int* lastoffset,
 			botimport.FS_FCloseFile( fp );
 			return NULL;
 		} // end if
+		*lastoffset = offset;
 	} // end if
 	// allocate memory
 	buf = ( char* )GetClearedHunkMemory( length + 1 );
@@ -378,6 +433,94 @@ void AAS_DData( unsigned char* data, int size )
 		data[i] ^= ( unsigned char )i * 119;
 	} // end for
 } // end of the function AAS_DData
+#ifndef Q3_BIG_ENDIAN
+//===========================================================================
+// returns a pointer to the lump inside the mapped AAS file
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void* AAS_MappedLump( aas_header_t* header, int lumpnum, int size, int* count )
+{
+	*count = header->lumps[lumpnum].filelen / size;
+	if( !*count )
+	{
+		// just alloc a dummy
+		return GetClearedHunkMemory( size + 1 );
+	} // end if
+	return ( char* )header + header->lumps[lumpnum].fileofs;
+} // end of the function AAS_MappedLump
+//===========================================================================
+// maps a version 6 aas file and lets the lumps point into it, the file is
+// mapped read-only so all processes running the same map share the pages
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_LoadMappedAASFile( char* filename )
+{
+	aas_header_t* header;
+	void*		  file;
+	long		  length;
+	int			  i, offset, lumplength;
+
+	length = botimport.FS_MapFile( filename, &file );
+	if( !file )
+	{
+		AAS_Error( "can't open %s\n", filename );
+		return BLERR_CANNOTOPENAASFILE;
+	} // end if
+	header = ( aas_header_t* )file;
+	if( length < ( long )sizeof( aas_header_t ) || header->ident != AASID || header->version != AASVERSION )
+	{
+		AAS_Error( "%s is not a version %d AAS file\n", filename, AASVERSION );
+		botimport.FS_UnmapFile( file );
+		return BLERR_WRONGAASFILEID;
+	} // end if
+	// the lumps are used in place so they have to be inside the file and aligned
+	for( i = 0; i < AAS_LUMPS; i++ )
+	{
+		offset	   = header->lumps[i].fileofs;
+		lumplength = header->lumps[i].filelen;
+		if( offset < ( int )sizeof( aas_header_t ) || ( offset & ( AASLUMP_ALIGN - 1 ) ) || lumplength < 0 || offset + ( long )lumplength > length )
+		{
+			AAS_Error( "%s has a bad lump %d\n", filename, i );
+			botimport.FS_UnmapFile( file );
+			return BLERR_CANNOTREADAASLUMP;
+		} // end if
+	} // end for
+	aasworld.mappedfile = file;
+	aasworld.mappedsize = length;
+	//
+	aasworld.bboxes		  = ( aas_bbox_t* )AAS_MappedLump( header, AASLUMP_BBOXES, sizeof( aas_bbox_t ), &aasworld.numbboxes );
+	aasworld.vertexes	  = ( aas_vertex_t* )AAS_MappedLump( header, AASLUMP_VERTEXES, sizeof( aas_vertex_t ), &aasworld.numvertexes );
+	aasworld.planes		  = ( aas_plane_t* )AAS_MappedLump( header, AASLUMP_PLANES, sizeof( aas_plane_t ), &aasworld.numplanes );
+	aasworld.edges		  = ( aas_edge_t* )AAS_MappedLump( header, AASLUMP_EDGES, sizeof( aas_edge_t ), &aasworld.numedges );
+	aasworld.edgeindex	  = ( aas_edgeindex_t* )AAS_MappedLump( header, AASLUMP_EDGEINDEX, sizeof( aas_edgeindex_t ), &aasworld.edgeindexsize );
+	aasworld.faces		  = ( aas_face_t* )AAS_MappedLump( header, AASLUMP_FACES, sizeof( aas_face_t ), &aasworld.numfaces );
+	aasworld.faceindex	  = ( aas_faceindex_t* )AAS_MappedLump( header, AASLUMP_FACEINDEX, sizeof( aas_faceindex_t ), &aasworld.faceindexsize );
+	aasworld.areas		  = ( aas_area_t* )AAS_MappedLump( header, AASLUMP_AREAS, sizeof( aas_area_t ), &aasworld.numareas );
+	aasworld.areasettings = ( aas_areasettings_t* )AAS_MappedLump( header, AASLUMP_AREASETTINGS, sizeof( aas_areasettings_t ), &aasworld.numareasettings );
+	aasworld.reachability = ( aas_reachability_t* )AAS_MappedLump( header, AASLUMP_REACHABILITY, sizeof( aas_reachability_t ), &aasworld.reachabilitysize );
+	aasworld.nodes		  = ( aas_node_t* )AAS_MappedLump( header, AASLUMP_NODES, sizeof( aas_node_t ), &aasworld.numnodes );
+	aasworld.portals	  = ( aas_portal_t* )AAS_MappedLump( header, AASLUMP_PORTALS, sizeof( aas_portal_t ), &aasworld.numportals );
+	aasworld.portalindex  = ( aas_portalindex_t* )AAS_MappedLump( header, AASLUMP_PORTALINDEX, sizeof( aas_portalindex_t ), &aasworld.portalindexsize );
+	aasworld.clusters	  = ( aas_cluster_t* )AAS_MappedLump( header, AASLUMP_CLUSTERS, sizeof( aas_cluster_t ), &aasworld.numclusters );
+	// the area settings are changed at run time, when routing areas are disabled
+	aasworld.areasettings = ( aas_areasettings_t* )AAS_CopyMappedAASLump( aasworld.areasettings, aasworld.numareasettings * sizeof( aas_areasettings_t ) );
+	// aas file is loaded
+	aasworld.loaded = qtrue;
+	botimport.Print( PRT_MESSAGE, "mapped %s, %ld bytes\n", filename, length );
+	//
+#ifdef AASFILEDEBUG
+	AAS_FileInfo();
+#endif // AASFILEDEBUG
+	//
+	return BLERR_NOERROR;
+} // end of the function AAS_LoadMappedAASFile
+#endif // Q3_BIG_ENDIAN
 //===========================================================================
 // load an aas file
 //
@@ -415,14 +558,14 @@ int AAS_LoadAASFile( char* filename )
 	// check the version
 	header.version = LittleLong( header.version );
 	//
-	if( header.version != AASVERSION_OLD && header.version != AASVERSION )
+	if( header.version != AASVERSION_OLD && header.version != AASVERSION_DDATA && header.version != AASVERSION )
 	{
 		AAS_Error( "aas file %s is version %i, not %i\n", filename, header.version, AASVERSION );
 		botimport.FS_FCloseFile( fp );
 		return BLERR_WRONGAASFILEVERSION;
 	} // end if
 	//
-	if( header.version == AASVERSION )
+	if( header.version == AASVERSION_DDATA )
 	{
 		AAS_DData( ( unsigned char* )&header + 8, sizeof( aas_header_t ) - 8 );
 	} // end if
@@ -434,6 +577,14 @@ int AAS_LoadAASFile( char* filename )
 		botimport.FS_FCloseFile( fp );
 		return BLERR_WRONGAASFILEVERSION;
 	} // end if
+#ifndef Q3_BIG_ENDIAN
+	// version 6 files can be used without reading and swapping them
+	if( header.version == AASVERSION )
+	{
+		botimport.FS_FCloseFile( fp );
+		return AAS_LoadMappedAASFile( filename );
+	} // end if
+#endif
 	// load the lumps:
 	// bounding boxes
 	offset			   = LittleLong( header.lumps[AASLUMP_BBOXES].fileofs );
@@ -585,9 +736,18 @@ static int AAS_WriteAASLump_offset;
 int		   AAS_WriteAASLump( fileHandle_t fp, aas_header_t* h, int lumpnum, void* data, int length )
 {
 	aas_lump_t* lump;
+	char		padding[AASLUMP_ALIGN];
 
 	lump = &h->lumps[lumpnum];
 
+	// pad so the lump can be used in place when the file is mapped
+	Com_Memset( padding, 0, sizeof( padding ) );
+	if( AAS_WriteAASLump_offset & ( AASLUMP_ALIGN - 1 ) )
+	{
+		botimport.FS_Write( padding, AASLUMP_ALIGN - ( AAS_WriteAASLump_offset & ( AASLUMP_ALIGN - 1 ) ), fp );
+		AAS_WriteAASLump_offset = ( AAS_WriteAASLump_offset + AASLUMP_ALIGN - 1 ) & ~( AASLUMP_ALIGN - 1 );
+	} // end if
+
 	lump->fileofs = LittleLong( AAS_WriteAASLump_offset ); // LittleLong(ftell(fp));
 	lump->filelen = LittleLong( length );
 
@@ -613,6 +773,8 @@ qboolean AAS_WriteAASFile( char* filename )
 	fileHandle_t fp;
 
 	botimport.Print( PRT_MESSAGE, "writing %s\n", filename );
+	// the file being written may be the one that is mapped
+	AAS_UnmapAASFile();
 	// swap the aas data
 	AAS_SwapAASData();
 	// initialize the file header
@@ -689,7 +851,6 @@ qboolean AAS_WriteAASFile( char* filename )
 	}
 	// rewrite the header with the added lumps
 	botimport.FS_Seek( fp, 0, FS_SEEK_SET );
-	AAS_DData( ( unsigned char* )&header + 8, sizeof( aas_header_t ) - 8 );
 	botimport.FS_Write( &header, sizeof( aas_header_t ), fp );
 	// close the file
 	botimport.FS_FCloseFile( fp );
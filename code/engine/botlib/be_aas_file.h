@@ -36,6 +36,8 @@ int		 AAS_LoadAASFile( char* filename );
 qboolean AAS_WriteAASFile( char* filename );
 // dumps the loaded AAS data
 void	 AAS_DumpAASData();
+// copies the lumps of a mapped AAS file to memory before they are changed
+void	 AAS_UnmapAASFile();
 // print AAS file information
 void	 AAS_FileInfo();
 #endif // AASINTERN
@@ -38,6 +38,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 	#include "be_aas_reach.h"
 	#include "be_aas_route.h"
 	#include "be_aas_routealt.h"
+	#include "be_aas_routewarm.h"
 	#include "be_aas_debug.h"
 	#include "be_aas_file.h"
 	#include "be_aas_optimize.h"
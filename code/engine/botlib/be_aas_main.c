@@ -166,8 +166,12 @@ int AAS_StartFrame( float time )
 	AAS_InvalidateEntities();
 	// initialize AAS
 	AAS_ContinueInit( time );
+	// publish routing cache warmed in the background
+	AAS_ContinueRouteWarming();
 	//
 	aasworld.frameroutingupdates = 0;
+	// predictions only hold for one frame
+	AAS_ClearPredictionCache();
 	//
 	if( botDeveloper )
 	{
@@ -285,6 +289,8 @@ int AAS_LoadMap( const char* mapname )
 	} // end if
 	//
 	AAS_InitSettings();
+	// flatten the bsp nodes for sampling
+	AAS_InitSampleNodes();
 	// initialize the AAS link heap for the new map
 	AAS_InitAASLinkHeap();
 	// initialize the AAS linked entities for the new map
@@ -309,6 +315,8 @@ int AAS_Setup()
 	aasworld.maxentities = ( int )LibVarValue( "maxentities", "1024" );
 	// as soon as it's set to 1 the routing cache will be saved
 	saveroutingcache = LibVar( "saveroutingcache", "0" );
+	// movement predictions are cached within a frame
+	LibVar( "predictcache", "1" );
 	// allocate memory for the entities
 	if( aasworld.entities )
 	{
@@ -336,6 +344,8 @@ void AAS_Shutdown()
 	AAS_DumpBSPData();
 	// free routing caches
 	AAS_FreeRoutingCaches();
+	// free the flattened bsp nodes
+	AAS_FreeSampleNodes();
 	// free aas link heap
 	AAS_FreeAASLinkHeap();
 	// free aas linked entities
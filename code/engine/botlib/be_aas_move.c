@@ -47,6 +47,37 @@ aas_settings_t		   aassettings;
 
 // #define AAS_MOVE_DEBUG
 
+// the bot movement code predicts the same moves several times a frame, the
+// results are cached for the rest of the frame
+#define PREDICTCACHE_SIZE 256 // power of two
+
+typedef struct aas_predictkey_s
+{
+	vec3_t origin;
+	vec3_t velocity;
+	vec3_t cmdmove;
+	int	   entnum;
+	int	   presencetype;
+	int	   onground;
+	int	   cmdframes;
+	int	   maxframes;
+	float  frametime;
+	int	   stopevent;
+	int	   stopareanum;
+} aas_predictkey_t;
+
+typedef struct aas_predictcache_s
+{
+	int				 frame; // aasworld.numframes + 1 when valid
+	aas_predictkey_t key;
+	int				 result;
+	aas_clientmove_t move;
+} aas_predictcache_t;
+
+static aas_predictcache_t predictcache[PREDICTCACHE_SIZE];
+static qboolean			  predictcacheenabled;
+static int				  predictcalls, predicthits;
+
 //===========================================================================
 //
 // Parameter:			-
@@ -1086,10 +1117,83 @@ int AAS_PredictClientMovement( struct aas_clientmove_s* move,
 	int													stopareanum,
 	int													visualize )
 {
-	vec3_t mins, maxs;
-	return AAS_ClientMovementPrediction( move, entnum, origin, presencetype, onground, velocity, cmdmove, cmdframes, maxframes, frametime, stopevent, stopareanum, mins, maxs, visualize );
+	vec3_t				mins, maxs;
+	aas_predictkey_t	key;
+	aas_predictcache_t* cache;
+	unsigned int		hash;
+	int					i;
+
+	// the reachability calculation predicts on the job threads before the
+	// AAS is initialized, visualized predictions have to draw their lines
+	if( !predictcacheenabled || !aasworld.initialized || visualize )
+	{
+		return AAS_ClientMovementPrediction( move, entnum, origin, presencetype, onground, velocity, cmdmove, cmdframes, maxframes, frametime, stopevent, stopareanum, mins, maxs, visualize );
+	} // end if
+	//
+	Com_Memset( &key, 0, sizeof( key ) );
+	VectorCopy( origin, key.origin );
+	VectorCopy( velocity, key.velocity );
+	VectorCopy( cmdmove, key.cmdmove );
+	key.entnum		 = entnum;
+	key.presencetype = presencetype;
+	key.onground	 = onground;
+	key.cmdframes	 = cmdframes;
+	key.maxframes	 = maxframes;
+	key.frametime	 = frametime;
+	key.stopevent	 = stopevent;
+	key.stopareanum	 = stopareanum;
+	// FNV-1a over the key
+	hash = 2166136261u;
+	for( i = 0; i < ( int )sizeof( key ); i++ )
+	{
+		hash = ( hash ^ ( ( byte* )&key )[i] ) * 16777619u;
+	} // end for
+	cache = &predictcache[hash & ( PREDICTCACHE_SIZE - 1 )];
+	//
+	predictcalls++;
+	if( cache->frame == aasworld.numframes + 1 && !memcmp( &cache->key, &key, sizeof( key ) ) )
+	{
+		predicthits++;
+		Com_Memcpy( move, &cache->move, sizeof( aas_clientmove_t ) );
+		return cache->result;
+	} // end if
+	//
+	cache->result = AAS_ClientMovementPrediction( move, entnum, origin, presencetype, onground, velocity, cmdmove, cmdframes, maxframes, frametime, stopevent, stopareanum, mins, maxs, visualize );
+	cache->frame  = aasworld.numframes + 1;
+	cache->key	  = key;
+	Com_Memcpy( &cache->move, move, sizeof( aas_clientmove_t ) );
+	return cache->result;
 } // end of the function AAS_PredictClientMovement
 //===========================================================================
+// the entities and movers may have moved since the last frame
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_ClearPredictionCache()
+{
+	Com_Memset( predictcache, 0, sizeof( predictcache ) );
+	predictcacheenabled = LibVarGetValue( "predictcache" ) != 0;
+} // end of the function AAS_ClearPredictionCache
+//===========================================================================
+// returns the number of predictions and how many of them were cached
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_PredictionCacheStats( int* calls, int* hits, int reset )
+{
+	*calls = predictcalls;
+	*hits  = predicthits;
+	if( reset )
+	{
+		predictcalls = 0;
+		predicthits	 = 0;
+	} // end if
+} // end of the function AAS_PredictionCacheStats
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
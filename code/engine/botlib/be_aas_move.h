@@ -31,6 +31,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #ifdef AASINTERN
 extern aas_settings_t aassettings;
+// invalidates the predictions cached during the last frame
+void				  AAS_ClearPredictionCache();
 #endif // AASINTERN
 
 // movement prediction
@@ -61,6 +63,8 @@ int	  AAS_ClientMovementHitBBox( struct aas_clientmove_s* move,
 	  vec3_t											  mins,
 	  vec3_t											  maxs,
 	  int												  visualize );
+// returns the number of predictions and how many of them were cached
+void  AAS_PredictionCacheStats( int* calls, int* hits, int reset );
 // returns true if on the ground at the given origin
 int	  AAS_OnGround( vec3_t origin, int presencetype, int passent );
 // returns true if swimming at the given origin
@@ -336,6 +336,10 @@ void AAS_Optimize()
 	int			i, sign;
 	optimized_t optimized;
 
+#ifndef BSPC
+	// the optimized lumps replace the loaded ones
+	AAS_UnmapAASFile();
+#endif
 	AAS_OptimizeAlloc( &optimized );
 	for( i = 1; i < aasworld.numareas; i++ )
 	{
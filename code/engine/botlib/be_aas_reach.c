@@ -53,6 +53,10 @@ extern botlib_import_t botimport;
 #define AAS_MAX_REACHABILITYSIZE  65536
 // number of areas reachability is calculated for each frame
 #define REACHABILITYAREASPERCYCLE 15
+// number of areas handed to the job threads for each frame
+#define REACHABILITYAREASPERJOBS  256
+// maximum number of cells along each axis of the grid with area bounds
+#define REACHABILITYGRIDCELLS	  128
 // number of units reachability points are placed inside the areas
 #define INSIDEUNITS				  2
 #define INSIDEUNITS_WALKEND		  5
@@ -61,25 +65,38 @@ extern botlib_import_t botimport;
 // area flag used for weapon jumping
 #define AREA_WEAPONJUMP			  8192 // valid area to weapon jump to
 // number of reachabilities of each type
-int reach_swim;			// swim
-int reach_equalfloor;	// walk on floors with equal height
-int reach_step;			// step up
-int reach_walk;			// walk of step
-int reach_barrier;		// jump up to a barrier
-int reach_waterjump;	// jump out of water
-int reach_walkoffledge; // walk of a ledge
-int reach_jump;			// jump
-int reach_ladder;		// climb or descent a ladder
-int reach_teleport;		// teleport
-int reach_elevator;		// use an elevator
-int reach_funcbob;		// use a func bob
-int reach_grapple;		// grapple hook
-int reach_doublejump;	// double jump
-int reach_rampjump;		// ramp jump
-int reach_strafejump;	// strafe jump (just normal jump but further)
-int reach_rocketjump;	// rocket jump
-int reach_bfgjump;		// bfg jump
-int reach_jumppad;		// jump pads
+typedef struct aas_reachstats_s
+{
+	int swim;			// swim
+	int equalfloor;		// walk on floors with equal height
+	int step;			// step up
+	int walk;			// walk of step
+	int barrier;		// jump up to a barrier
+	int waterjump;		// jump out of water
+	int walkoffledge;	// walk of a ledge
+	int jump;			// jump
+	int ladder;			// climb or descent a ladder
+	int teleport;		// teleport
+	int elevator;		// use an elevator
+	int funcbob;		// use a func bob
+	int grapple;		// grapple hook
+	int doublejump;		// double jump
+	int rampjump;		// ramp jump
+	int strafejump;		// strafe jump (just normal jump but further)
+	int rocketjump;		// rocket jump
+	int bfgjump;		// bfg jump
+	int jumppad;		// jump pads
+} aas_reachstats_t;
+// all reachabilities calculated so far
+aas_reachstats_t reachstats;
+// the job threads count into their own stats, added to the totals afterwards
+#if defined( _MSC_VER )
+	#define AAS_THREAD_LOCAL __declspec( thread )
+#else
+	#define AAS_THREAD_LOCAL __thread
+#endif
+static AAS_THREAD_LOCAL aas_reachstats_t* jobreachstats; // only set while a job runs
+#define REACH_COUNT( type ) ( jobreachstats ? jobreachstats : &reachstats )->type++
 // if true grapple reachabilities are skipped
 int calcgrapplereach;
 // linked reachability
@@ -100,6 +117,29 @@ aas_lreachability_t*  reachabilityheap; // heap with reachabilities
 aas_lreachability_t*  nextreachability; // next free reachability from the heap
 aas_lreachability_t** areareachability; // reachability links for every area
 int					  numlreachabilities;
+// grid over the x-y bounds of the areas
+typedef struct aas_reachgrid_s
+{
+	float mins[2];
+	float cellsize;
+	int	  size[2];
+	int*  firstarea; // index of the first area in each cell
+	int*  areas;	 // areas overlapping each cell in increasing order
+} aas_reachgrid_t;
+// areas near enough to each area for a swim, walk, step, barrier,
+// waterjump, walk off ledge, ladder or jump reachability
+int*  firstreachcandidate; // index of the first candidate of each area
+int*  reachcandidates;	   // candidate areas in increasing order
+// held while job threads calculate reachabilities
+void* reachmutex;
+// a run of areas calculated on the job threads
+typedef struct aas_reachjobs_s
+{
+	int				 firstarea;
+	aas_reachstats_t stats[REACHABILITYAREASPERJOBS]; // counted by the job of every area
+} aas_reachjobs_t;
+
+static aas_reachjobs_t reachjobs;
 
 //===========================================================================
 // returns the surface area of the given face
@@ -523,19 +563,26 @@ aas_lreachability_t* AAS_AllocReachability()
 {
 	aas_lreachability_t* r;
 
-	if( !nextreachability )
+	if( reachmutex )
 	{
-		return NULL;
+		botimport.LockMutex( reachmutex );
 	}
-	// make sure the error message only shows up once
-	if( !nextreachability->next )
+	r = nextreachability;
+	if( r )
+	{
+		// make sure the error message only shows up once
+		if( !r->next )
+		{
+			AAS_Error( "AAS_MAX_REACHABILITYSIZE\n" );
+		}
+		//
+		nextreachability = r->next;
+		numlreachabilities++;
+	} // end if
+	if( reachmutex )
 	{
-		AAS_Error( "AAS_MAX_REACHABILITYSIZE\n" );
+		botimport.UnlockMutex( reachmutex );
 	}
-	//
-	r				 = nextreachability;
-	nextreachability = nextreachability->next;
-	numlreachabilities++;
 	return r;
 } // end of the function AAS_AllocReachability
 //===========================================================================
@@ -979,7 +1026,7 @@ int AAS_Reachability_Swim( int area1num, int area2num )
 					// link the reachability
 					lreach->next			   = areareachability[area1num];
 					areareachability[area1num] = lreach;
-					reach_swim++;
+					REACH_COUNT( swim );
 					return qtrue;
 				} // end if
 			} // end if
@@ -1147,7 +1194,7 @@ int AAS_Reachability_EqualFloorHeight( int area1num, int area2num )
 		// avoid rather small areas
 		// if (AAS_AreaGroundFaceArea(lreach->areanum) < 500) lreach->traveltime += 100;
 		//
-		reach_equalfloor++;
+		REACH_COUNT( equalfloor );
 		return qtrue;
 	} // end if
 	return qfalse;
@@ -1531,7 +1578,7 @@ int AAS_Reachability_Step_Barrier_WaterJump_WalkOffLedge( int area1num, int area
 			// avoid rather small areas
 			// if (AAS_AreaGroundFaceArea(lreach->areanum) < 500) lreach->traveltime += 100;
 			//
-			reach_step++;
+			REACH_COUNT( step );
 			return qtrue;
 		} // end if
 	} // end if
@@ -1586,7 +1633,7 @@ int AAS_Reachability_Step_Barrier_WaterJump_WalkOffLedge( int area1num, int area
 					lreach->next			   = areareachability[area1num];
 					areareachability[area1num] = lreach;
 					// we've got another waterjump reachability
-					reach_waterjump++;
+					REACH_COUNT( waterjump );
 					return qtrue;
 				} // end if
 			} // end if
@@ -1637,7 +1684,7 @@ int AAS_Reachability_Step_Barrier_WaterJump_WalkOffLedge( int area1num, int area
 					lreach->next			   = areareachability[area1num];
 					areareachability[area1num] = lreach;
 					// we've got another barrierjump reachability
-					reach_barrier++;
+					REACH_COUNT( barrier );
 					return qtrue;
 				} // end if
 			} // end if
@@ -1687,7 +1734,7 @@ int AAS_Reachability_Step_Barrier_WaterJump_WalkOffLedge( int area1num, int area
 				lreach->next			   = areareachability[area1num];
 				areareachability[area1num] = lreach;
 				// we've got another walk reachability
-				reach_walk++;
+				REACH_COUNT( walk );
 				return qtrue;
 			} // end if
 			// if no maximum fall height set or less than the max
@@ -1744,7 +1791,7 @@ int AAS_Reachability_Step_Barrier_WaterJump_WalkOffLedge( int area1num, int area
 							lreach->next			   = areareachability[area1num];
 							areareachability[area1num] = lreach;
 							//
-							reach_walkoffledge++;
+							REACH_COUNT( walkoffledge );
 							// NOTE: don't create a weapon (rl, bfg) jump reachability here
 							// because it interferes with other reachabilities
 							// like the ladder reachability
@@ -2626,11 +2673,11 @@ int AAS_Reachability_Jump( int area1num, int area2num )
 		//
 		if( ( traveltype & TRAVELTYPE_MASK ) == TRAVEL_JUMP )
 		{
-			reach_jump++;
+			REACH_COUNT( jump );
 		}
 		else
 		{
-			reach_walkoffledge++;
+			REACH_COUNT( walkoffledge );
 		}
 	} // end if
 	return qfalse;
@@ -2778,7 +2825,7 @@ int AAS_Reachability_Ladder( int area1num, int area2num )
 			lreach->next			   = areareachability[area1num];
 			areareachability[area1num] = lreach;
 			//
-			reach_ladder++;
+			REACH_COUNT( ladder );
 			// create a new reachability link
 			lreach = AAS_AllocReachability();
 			if( !lreach )
@@ -2796,7 +2843,7 @@ int AAS_Reachability_Ladder( int area1num, int area2num )
 			lreach->next			   = areareachability[area2num];
 			areareachability[area2num] = lreach;
 			//
-			reach_ladder++;
+			REACH_COUNT( ladder );
 			//
 			return qtrue;
 		} // end if
@@ -2823,7 +2870,7 @@ int AAS_Reachability_Ladder( int area1num, int area2num )
 			lreach->next			   = areareachability[area1num];
 			areareachability[area1num] = lreach;
 			//
-			reach_ladder++;
+			REACH_COUNT( ladder );
 			// create a new reachability link
 			lreach = AAS_AllocReachability();
 			if( !lreach )
@@ -2840,7 +2887,7 @@ int AAS_Reachability_Ladder( int area1num, int area2num )
 			lreach->next			   = areareachability[area2num];
 			areareachability[area2num] = lreach;
 			//
-			reach_walkoffledge++;
+			REACH_COUNT( walkoffledge );
 			//
 			return qtrue;
 		} // end if
@@ -2926,7 +2973,7 @@ int AAS_Reachability_Ladder( int area1num, int area2num )
 					lreach->next			   = areareachability[area1num];
 					areareachability[area1num] = lreach;
 					//
-					reach_ladder++;
+					REACH_COUNT( ladder );
 					// create a new reachability link
 					lreach = AAS_AllocReachability();
 					if( !lreach )
@@ -2946,7 +2993,7 @@ int AAS_Reachability_Ladder( int area1num, int area2num )
 					lreach->next			   = areareachability[area2num];
 					areareachability[area2num] = lreach;
 					//
-					reach_jump++;
+					REACH_COUNT( jump );
 					//
 					return qtrue;
 #ifdef REACH_DEBUG
@@ -2998,7 +3045,7 @@ int AAS_Reachability_Ladder( int area1num, int area2num )
 				  lreach->next = areareachability[area2num];
 				  areareachability[area2num] = lreach;
 				  //
-				  reach_jump++;
+				  REACH_COUNT( jump );
 				  //
 				  Log_Write("jump far to ladder reach between %d and %d\r\n", area2num, area1num);
 				  //
@@ -3256,7 +3303,7 @@ void AAS_Reachability_Teleport()
 			lreach->next			   = areareachability[area1num];
 			areareachability[area1num] = lreach;
 			//
-			reach_teleport++;
+			REACH_COUNT( teleport );
 		} // end for
 		// unlink the invalid entity
 		AAS_UnlinkFromAreas( areas );
@@ -3538,7 +3585,7 @@ void AAS_Reachability_Elevator()
 						Log_Write( "elevator reach from %d to %d\r\n", area1num, area2num );
 #endif //REACH_DEBUG \
 	//
-						reach_elevator++;
+						REACH_COUNT( elevator );
 					} // end for
 				} // end for
 			} // end for
@@ -3952,7 +3999,7 @@ void AAS_Reachability_FuncBobbing()
 					lreach->traveltype = TRAVEL_FUNCBOB;
 					lreach->traveltype |= AAS_TravelFlagsForTeam( ent );
 					lreach->traveltime = aassettings.rs_funcbob;
-					reach_funcbob++;
+					REACH_COUNT( funcbob );
 					lreach->next						  = areareachability[startreach->areanum];
 					areareachability[startreach->areanum] = lreach;
 					//
@@ -4191,7 +4238,7 @@ void AAS_Reachability_JumpPad()
 					lreach->next					= areareachability[link->areanum];
 					areareachability[link->areanum] = lreach;
 					//
-					reach_jumppad++;
+					REACH_COUNT( jumppad );
 				} // end for
 			} // end if
 		} // end if
@@ -4328,7 +4375,7 @@ void AAS_Reachability_JumpPad()
 									lreach->next					= areareachability[link->areanum];
 									areareachability[link->areanum] = lreach;
 									//
-									reach_jumppad++;
+									REACH_COUNT( jumppad );
 								} // end for
 							}
 						} // end if
@@ -4546,7 +4593,7 @@ int AAS_Reachability_Grapple( int area1num, int area2num )
 		lreach->next			   = areareachability[area1num];
 		areareachability[area1num] = lreach;
 		//
-		reach_grapple++;
+		REACH_COUNT( grapple );
 	} // end for
 	//
 	return qfalse;
@@ -4766,7 +4813,7 @@ int AAS_Reachability_WeaponJump( int area1num, int area2num )
 						lreach->next			   = areareachability[area1num];
 						areareachability[area1num] = lreach;
 						//
-						reach_rocketjump++;
+						REACH_COUNT( rocketjump );
 						return qtrue;
 					} // end if
 				} // end if
@@ -4983,7 +5030,7 @@ void AAS_Reachability_WalkOffLedge( int areanum )
 						lreach->next			  = areareachability[areanum];
 						areareachability[areanum] = lreach;
 						// we've got another walk off ledge reachability
-						reach_walkoffledge++;
+						REACH_COUNT( walkoffledge );
 					} // end if
 				} // end for
 			} // end for
@@ -5031,6 +5078,378 @@ void AAS_StoreReachability()
 	} // end for
 } // end of the function AAS_StoreReachability
 //===========================================================================
+// returns the distance in x and y within which an area can have a swim,
+// walk, step, barrier, waterjump, walk off ledge, ladder or jump
+// reachability towards another area, the jump distance is the largest
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+float AAS_ReachabilityCandidateDistance()
+{
+	float dist;
+
+	dist = 2 * AAS_MaxJumpDistance( aassettings.phys_jumpvel );
+	if( dist < 10 )
+	{
+		dist = 10;
+	}
+	// stay clear of rounding differences with the tests themselves
+	return dist + 1;
+} // end of the function AAS_ReachabilityCandidateDistance
+//===========================================================================
+// returns the range of grid cells overlapping the given x-y bounds
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_ReachabilityGridCells( aas_reachgrid_t* grid, vec3_t mins, vec3_t maxs, float dist, int* cellmins, int* cellmaxs )
+{
+	int i;
+
+	for( i = 0; i < 2; i++ )
+	{
+		cellmins[i] = ( int )( ( mins[i] - dist - grid->mins[i] ) / grid->cellsize );
+		cellmaxs[i] = ( int )( ( maxs[i] + dist - grid->mins[i] ) / grid->cellsize );
+		if( cellmins[i] < 0 )
+		{
+			cellmins[i] = 0;
+		}
+		if( cellmaxs[i] > grid->size[i] - 1 )
+		{
+			cellmaxs[i] = grid->size[i] - 1;
+		}
+	} // end for
+} // end of the function AAS_ReachabilityGridCells
+//===========================================================================
+// stores the areas near enough to the given area in the list, the list
+// is not sorted, returns the number of areas
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int AAS_FindReachabilityCandidates( aas_reachgrid_t* grid, int areanum, float dist, int* stamps, int* list )
+{
+	int			i, j, x, y, cell, numcandidates, cellmins[2], cellmaxs[2];
+	aas_area_t *area1, *area2;
+
+	area1 = &aasworld.areas[areanum];
+	AAS_ReachabilityGridCells( grid, area1->mins, area1->maxs, dist, cellmins, cellmaxs );
+	//
+	numcandidates = 0;
+	for( y = cellmins[1]; y <= cellmaxs[1]; y++ )
+	{
+		for( x = cellmins[0]; x <= cellmaxs[0]; x++ )
+		{
+			cell = y * grid->size[0] + x;
+			for( i = grid->firstarea[cell]; i < grid->firstarea[cell + 1]; i++ )
+			{
+				j = grid->areas[i];
+				// areas overlapping several cells are only tested once
+				if( j == areanum || stamps[j] == areanum )
+				{
+					continue;
+				}
+				stamps[j] = areanum;
+				// if the areas are not near enough in the x-y direction
+				area2 = &aasworld.areas[j];
+				if( area1->mins[0] > area2->maxs[0] + dist || area1->maxs[0] < area2->mins[0] - dist )
+				{
+					continue;
+				}
+				if( area1->mins[1] > area2->maxs[1] + dist || area1->maxs[1] < area2->mins[1] - dist )
+				{
+					continue;
+				}
+				if( list )
+				{
+					list[numcandidates] = j;
+				}
+				numcandidates++;
+			} // end for
+		} // end for
+	} // end for
+	return numcandidates;
+} // end of the function AAS_FindReachabilityCandidates
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int AAS_CompareAreaNums( const void* arg1, const void* arg2 )
+{
+	return *( const int* )arg1 - *( const int* )arg2;
+} // end of the function AAS_CompareAreaNums
+//===========================================================================
+// the swim, walk, step, barrier, waterjump, walk off ledge, ladder and jump
+// tests all start by rejecting areas too far apart in the x-y direction,
+// the areas that pass are found once through a grid over the area bounds
+// instead of testing all pairs of areas
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_InitReachabilityCandidates()
+{
+	int				i, x, y, cell, numcells, numcandidates, cellmins[2], cellmaxs[2];
+	int*			cellfill;
+	int*			stamps;
+	float			dist, extent;
+	aas_area_t*		area;
+	aas_reachgrid_t grid;
+
+	dist = AAS_ReachabilityCandidateDistance();
+	// bounds of all the areas
+	grid.mins[0] = grid.mins[1] = 999999;
+	extent							= 0;
+	for( i = 1; i < aasworld.numareas; i++ )
+	{
+		area = &aasworld.areas[i];
+		for( x = 0; x < 2; x++ )
+		{
+			if( area->mins[x] < grid.mins[x] )
+			{
+				grid.mins[x] = area->mins[x];
+			}
+		} // end for
+	} // end for
+	for( i = 1; i < aasworld.numareas; i++ )
+	{
+		area = &aasworld.areas[i];
+		for( x = 0; x < 2; x++ )
+		{
+			if( area->maxs[x] - grid.mins[x] > extent )
+			{
+				extent = area->maxs[x] - grid.mins[x];
+			}
+		} // end for
+	} // end for
+	// cells about the size of the candidate distance
+	grid.cellsize = dist;
+	if( extent / grid.cellsize > REACHABILITYGRIDCELLS - 1 )
+	{
+		grid.cellsize = extent / ( REACHABILITYGRIDCELLS - 1 );
+	}
+	grid.size[0] = grid.size[1] = ( int )( extent / grid.cellsize ) + 1;
+	numcells					= grid.size[0] * grid.size[1];
+	// count the areas in every cell
+	grid.firstarea = ( int* )GetClearedMemory( ( numcells + 1 ) * sizeof( int ) );
+	for( i = 1; i < aasworld.numareas; i++ )
+	{
+		area = &aasworld.areas[i];
+		AAS_ReachabilityGridCells( &grid, area->mins, area->maxs, 0, cellmins, cellmaxs );
+		for( y = cellmins[1]; y <= cellmaxs[1]; y++ )
+		{
+			for( x = cellmins[0]; x <= cellmaxs[0]; x++ )
+			{
+				grid.firstarea[y * grid.size[0] + x + 1]++;
+			} // end for
+		} // end for
+	} // end for
+	for( cell = 0; cell < numcells; cell++ )
+	{
+		grid.firstarea[cell + 1] += grid.firstarea[cell];
+	} // end for
+	// store the areas of every cell in increasing order
+	grid.areas = ( int* )GetMemory( ( grid.firstarea[numcells] + 1 ) * sizeof( int ) );
+	cellfill   = ( int* )GetMemory( numcells * sizeof( int ) );
+	Com_Memcpy( cellfill, grid.firstarea, numcells * sizeof( int ) );
+	for( i = 1; i < aasworld.numareas; i++ )
+	{
+		area = &aasworld.areas[i];
+		AAS_ReachabilityGridCells( &grid, area->mins, area->maxs, 0, cellmins, cellmaxs );
+		for( y = cellmins[1]; y <= cellmaxs[1]; y++ )
+		{
+			for( x = cellmins[0]; x <= cellmaxs[0]; x++ )
+			{
+				grid.areas[cellfill[y * grid.size[0] + x]++] = i;
+			} // end for
+		} // end for
+	} // end for
+	FreeMemory( cellfill );
+	// count the candidates of every area
+	stamps				= ( int* )GetClearedMemory( aasworld.numareas * sizeof( int ) );
+	firstreachcandidate = ( int* )GetClearedMemory( ( aasworld.numareas + 1 ) * sizeof( int ) );
+	for( i = 1; i < aasworld.numareas; i++ )
+	{
+		firstreachcandidate[i + 1] = firstreachcandidate[i] + AAS_FindReachabilityCandidates( &grid, i, dist, stamps, NULL );
+	} // end for
+	// store the candidates of every area in increasing order, the tests are
+	// made in the same order as when going over all the areas
+	numcandidates	= firstreachcandidate[aasworld.numareas];
+	reachcandidates = ( int* )GetMemory( ( numcandidates + 1 ) * sizeof( int ) );
+	Com_Memset( stamps, 0, aasworld.numareas * sizeof( int ) );
+	for( i = 1; i < aasworld.numareas; i++ )
+	{
+		AAS_FindReachabilityCandidates( &grid, i, dist, stamps, &reachcandidates[firstreachcandidate[i]] );
+		qsort( &reachcandidates[firstreachcandidate[i]], firstreachcandidate[i + 1] - firstreachcandidate[i], sizeof( int ), AAS_CompareAreaNums );
+	} // end for
+	FreeMemory( stamps );
+	FreeMemory( grid.firstarea );
+	FreeMemory( grid.areas );
+	//
+	botimport.Print( PRT_MESSAGE, "%d areas with %d candidate reachability areas\n", aasworld.numareas, numcandidates );
+} // end of the function AAS_InitReachabilityCandidates
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeReachabilityCandidates()
+{
+	if( firstreachcandidate )
+	{
+		FreeMemory( firstreachcandidate );
+		firstreachcandidate = NULL;
+	} // end if
+	if( reachcandidates )
+	{
+		FreeMemory( reachcandidates );
+		reachcandidates = NULL;
+	} // end if
+} // end of the function AAS_FreeReachabilityCandidates
+//===========================================================================
+// calculates the reachabilities from the given area to all other areas
+// except for the entity reachabilities
+//
+// reachabilities are only added to the list of the given area, except for
+// ladder reachabilities which are also added the other way around, the
+// areas other than ladder areas can therefore be calculated in any order
+// and in parallel, only calls into the engine and allocating links from
+// the heap have to be serialised
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_CalculateAreaReachability( int areanum )
+{
+	int i, j;
+
+	// only create jumppad reachabilities from jumppad areas
+	if( aasworld.areasettings[areanum].contents & AREACONTENTS_JUMPPAD )
+	{
+		return;
+	} // end if
+	// loop over the areas near enough
+	for( i = firstreachcandidate[areanum]; i < firstreachcandidate[areanum + 1]; i++ )
+	{
+		j = reachcandidates[i];
+		// never create reachabilities from teleporter or jumppad areas to regular areas
+		if( aasworld.areasettings[areanum].contents & ( AREACONTENTS_TELEPORTER | AREACONTENTS_JUMPPAD ) )
+		{
+			if( !( aasworld.areasettings[j].contents & ( AREACONTENTS_TELEPORTER | AREACONTENTS_JUMPPAD ) ) )
+			{
+				continue;
+			} // end if
+		} // end if
+		// if there already is a reachability link from area i to j
+		if( AAS_ReachabilityExists( areanum, j ) )
+		{
+			continue;
+		}
+		// check for a swim reachability
+		if( AAS_Reachability_Swim( areanum, j ) )
+		{
+			continue;
+		}
+		// check for a simple walk on equal floor height reachability
+		if( AAS_Reachability_EqualFloorHeight( areanum, j ) )
+		{
+			continue;
+		}
+		// check for step, barrier, waterjump and walk off ledge reachabilities
+		if( AAS_Reachability_Step_Barrier_WaterJump_WalkOffLedge( areanum, j ) )
+		{
+			continue;
+		}
+		// check for ladder reachabilities
+		if( AAS_Reachability_Ladder( areanum, j ) )
+		{
+			continue;
+		}
+		// check for a jump reachability
+		if( AAS_Reachability_Jump( areanum, j ) )
+		{
+			continue;
+		}
+	} // end for
+	// never create these reachabilities from teleporter or jumppad areas
+	if( aasworld.areasettings[areanum].contents & ( AREACONTENTS_TELEPORTER | AREACONTENTS_JUMPPAD ) )
+	{
+		return;
+	} // end if
+	// loop over the areas
+	for( j = 1; j < aasworld.numareas; j++ )
+	{
+		if( areanum == j )
+		{
+			continue;
+		}
+		//
+		if( AAS_ReachabilityExists( areanum, j ) )
+		{
+			continue;
+		}
+		// check for a grapple hook reachability
+		if( calcgrapplereach )
+		{
+			AAS_Reachability_Grapple( areanum, j );
+		}
+		// check for a weapon jump reachability
+		AAS_Reachability_WeaponJump( areanum, j );
+	} // end for
+} // end of the function AAS_CalculateAreaReachability
+//===========================================================================
+// job thread function, the areas of a run have no ladders so they only
+// add reachabilities to themselves
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_AreaReachabilityJob( void* data, int index )
+{
+	aas_reachjobs_t* jobs;
+
+	jobs		  = ( aas_reachjobs_t* )data;
+	jobreachstats = &jobs->stats[index];
+	AAS_CalculateAreaReachability( jobs->firstarea + index );
+	jobreachstats = NULL;
+} // end of the function AAS_AreaReachabilityJob
+//===========================================================================
+// calculates the reachabilities of the areas on the job threads and adds
+// their counts to the totals
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_RunReachabilityJobs( int firstarea, int numareas )
+{
+	int i, j, *src, *dst;
+
+	reachjobs.firstarea = firstarea;
+	Com_Memset( reachjobs.stats, 0, numareas * sizeof( aas_reachstats_t ) );
+	botimport.RunJobs( AAS_AreaReachabilityJob, &reachjobs, numareas );
+	//
+	dst = ( int* )&reachstats;
+	for( i = 0; i < numareas; i++ )
+	{
+		src = ( int* )&reachjobs.stats[i];
+		for( j = 0; j < ( int )( sizeof( aas_reachstats_t ) / sizeof( int ) ); j++ )
+		{
+			dst[j] += src[j];
+		} // end for
+	} // end for
+} // end of the function AAS_RunReachabilityJobs
+//===========================================================================
 //
 // TRAVEL_WALK					100%	equal floor height + steps
 // TRAVEL_CROUCH				100%
@@ -5057,9 +5476,8 @@ void AAS_StoreReachability()
 //===========================================================================
 int AAS_ContinueInitReachability( float time )
 {
-	int			 i, j, todo, start_time;
-	static float framereachability, reachability_delay;
-	static int	 lastpercentage;
+	int		   i, firstarea, numareas, run, parallel;
+	static int starttime;
 
 	if( !aasworld.loaded )
 	{
@@ -5074,104 +5492,52 @@ int AAS_ContinueInitReachability( float time )
 	if( aasworld.numreachabilityareas == 1 )
 	{
 		botimport.Print( PRT_MESSAGE, "calculating reachability...\n" );
-		lastpercentage	   = 0;
-		framereachability  = 2000;
-		reachability_delay = 1000;
+		starttime = Sys_MilliSeconds();
 	} // end if
-	// number of areas to calculate reachability for this cycle
-	todo	   = aasworld.numreachabilityareas + ( int )framereachability;
-	start_time = Sys_MilliSeconds();
-	// loop over the areas
-	for( i = aasworld.numreachabilityareas; i < aasworld.numareas && i < todo; i++ )
+	// calculate the reachabilities for the next areas
+	if( aasworld.numreachabilityareas < aasworld.numareas )
 	{
-		aasworld.numreachabilityareas++;
-		// only create jumppad reachabilities from jumppad areas
-		if( aasworld.areasettings[i].contents & AREACONTENTS_JUMPPAD )
-		{
-			continue;
-		} // end if
-		// loop over the areas
-		for( j = 1; j < aasworld.numareas; j++ )
+		firstarea = aasworld.numreachabilityareas;
+		numareas  = aasworld.numareas - firstarea;
+		if( numareas > REACHABILITYAREASPERJOBS )
 		{
-			if( i == j )
-			{
-				continue;
-			}
-			// never create reachabilities from teleporter or jumppad areas to regular areas
-			if( aasworld.areasettings[i].contents & ( AREACONTENTS_TELEPORTER | AREACONTENTS_JUMPPAD ) )
-			{
-				if( !( aasworld.areasettings[j].contents & ( AREACONTENTS_TELEPORTER | AREACONTENTS_JUMPPAD ) ) )
-				{
-					continue;
-				} // end if
-			} // end if
-			// if there already is a reachability link from area i to j
-			if( AAS_ReachabilityExists( i, j ) )
-			{
-				continue;
-			}
-			// check for a swim reachability
-			if( AAS_Reachability_Swim( i, j ) )
-			{
-				continue;
-			}
-			// check for a simple walk on equal floor height reachability
-			if( AAS_Reachability_EqualFloorHeight( i, j ) )
-			{
-				continue;
-			}
-			// check for step, barrier, waterjump and walk off ledge reachabilities
-			if( AAS_Reachability_Step_Barrier_WaterJump_WalkOffLedge( i, j ) )
-			{
-				continue;
-			}
-			// check for ladder reachabilities
-			if( AAS_Reachability_Ladder( i, j ) )
-			{
-				continue;
-			}
-			// check for a jump reachability
-			if( AAS_Reachability_Jump( i, j ) )
-			{
-				continue;
-			}
-		} // end for
-		// never create these reachabilities from teleporter or jumppad areas
-		if( aasworld.areasettings[i].contents & ( AREACONTENTS_TELEPORTER | AREACONTENTS_JUMPPAD ) )
+			numareas = REACHABILITYAREASPERJOBS;
+		}
+		// the mutex serialises the engine calls and the reachability heap
+		reachmutex = botimport.CreateMutex();
+		parallel   = reachmutex != NULL;
+		if( parallel )
 		{
-			continue;
+			AAS_SetEngineMutex( reachmutex );
 		} // end if
-		// loop over the areas
-		for( j = 1; j < aasworld.numareas; j++ )
+		// a ladder area also adds reachabilities to the areas below it, which
+		// then skip theirs, so every ladder area is calculated on its own
+		// between the runs of areas before and after it, in area order
+		run = firstarea;
+		for( i = firstarea; i <= firstarea + numareas; i++ )
 		{
-			if( i == j )
+			if( i < firstarea + numareas && parallel && !AAS_AreaLadder( i ) )
 			{
 				continue;
 			}
-			//
-			if( AAS_ReachabilityExists( i, j ) )
+			if( i > run )
 			{
-				continue;
+				AAS_RunReachabilityJobs( run, i - run );
 			}
-			// check for a grapple hook reachability
-			if( calcgrapplereach )
+			if( i < firstarea + numareas )
 			{
-				AAS_Reachability_Grapple( i, j );
+				AAS_CalculateAreaReachability( i );
 			}
-			// check for a weapon jump reachability
-			AAS_Reachability_WeaponJump( i, j );
+			run = i + 1;
 		} // end for
-		// if the calculation took more time than the max reachability delay
-		if( Sys_MilliSeconds() - start_time > ( int )reachability_delay )
+		if( parallel )
 		{
-			break;
-		}
-		//
-		if( aasworld.numreachabilityareas * 1000 / aasworld.numareas > lastpercentage )
-		{
-			break;
-		}
-	} // end for
+			AAS_SetEngineMutex( NULL );
+			botimport.DestroyMutex( reachmutex );
+			reachmutex = NULL;
+		} // end if
+		aasworld.numreachabilityareas += numareas;
+	} // end if
 	//
 	if( aasworld.numreachabilityareas == aasworld.numareas )
 	{
@@ -5202,21 +5568,21 @@ int AAS_ContinueInitReachability( float time )
 		AAS_Reachability_FuncBobbing();
 		//
 #ifdef DEBUG
-		botimport.Print( PRT_MESSAGE, "%6d reach swim\n", reach_swim );
-		botimport.Print( PRT_MESSAGE, "%6d reach equal floor\n", reach_equalfloor );
-		botimport.Print( PRT_MESSAGE, "%6d reach step\n", reach_step );
-		botimport.Print( PRT_MESSAGE, "%6d reach barrier\n", reach_barrier );
-		botimport.Print( PRT_MESSAGE, "%6d reach waterjump\n", reach_waterjump );
-		botimport.Print( PRT_MESSAGE, "%6d reach walkoffledge\n", reach_walkoffledge );
-		botimport.Print( PRT_MESSAGE, "%6d reach jump\n", reach_jump );
-		botimport.Print( PRT_MESSAGE, "%6d reach ladder\n", reach_ladder );
-		botimport.Print( PRT_MESSAGE, "%6d reach walk\n", reach_walk );
-		botimport.Print( PRT_MESSAGE, "%6d reach teleport\n", reach_teleport );
-		botimport.Print( PRT_MESSAGE, "%6d reach funcbob\n", reach_funcbob );
-		botimport.Print( PRT_MESSAGE, "%6d reach elevator\n", reach_elevator );
-		botimport.Print( PRT_MESSAGE, "%6d reach grapple\n", reach_grapple );
-		botimport.Print( PRT_MESSAGE, "%6d reach rocketjump\n", reach_rocketjump );
-		botimport.Print( PRT_MESSAGE, "%6d reach jumppad\n", reach_jumppad );
+		botimport.Print( PRT_MESSAGE, "%6d reach swim\n", reachstats.swim );
+		botimport.Print( PRT_MESSAGE, "%6d reach equal floor\n", reachstats.equalfloor );
+		botimport.Print( PRT_MESSAGE, "%6d reach step\n", reachstats.step );
+		botimport.Print( PRT_MESSAGE, "%6d reach barrier\n", reachstats.barrier );
+		botimport.Print( PRT_MESSAGE, "%6d reach waterjump\n", reachstats.waterjump );
+		botimport.Print( PRT_MESSAGE, "%6d reach walkoffledge\n", reachstats.walkoffledge );
+		botimport.Print( PRT_MESSAGE, "%6d reach jump\n", reachstats.jump );
+		botimport.Print( PRT_MESSAGE, "%6d reach ladder\n", reachstats.ladder );
+		botimport.Print( PRT_MESSAGE, "%6d reach walk\n", reachstats.walk );
+		botimport.Print( PRT_MESSAGE, "%6d reach teleport\n", reachstats.teleport );
+		botimport.Print( PRT_MESSAGE, "%6d reach funcbob\n", reachstats.funcbob );
+		botimport.Print( PRT_MESSAGE, "%6d reach elevator\n", reachstats.elevator );
+		botimport.Print( PRT_MESSAGE, "%6d reach grapple\n", reachstats.grapple );
+		botimport.Print( PRT_MESSAGE, "%6d reach rocketjump\n", reachstats.rocketjump );
+		botimport.Print( PRT_MESSAGE, "%6d reach jumppad\n", reachstats.jumppad );
 #endif
 		//*/
 		// store all the reachabilities
@@ -5225,15 +5591,17 @@ int AAS_ContinueInitReachability( float time )
 		AAS_ShutDownReachabilityHeap();
 		//
 		FreeMemory( areareachability );
+		AAS_FreeReachabilityCandidates();
 		//
 		aasworld.numreachabilityareas++;
 		//
+		botimport.Print( PRT_MESSAGE, "reachability calculated in %d msec\n", Sys_MilliSeconds() - starttime );
+		//
 		botimport.Print( PRT_MESSAGE, "calculating clusters...\n" );
 	} // end if
 	else
 	{
-		lastpercentage = aasworld.numreachabilityareas * 1000 / aasworld.numareas;
-		botimport.Print( PRT_MESSAGE, "\r%6.1f%%", ( float )lastpercentage / 10 );
+		botimport.Print( PRT_MESSAGE, "\r%6.1f%%", ( float )aasworld.numreachabilityareas * 100 / aasworld.numareas );
 	} // end else
 	// not yet finished
 	return qtrue;
@@ -5266,6 +5634,8 @@ void AAS_InitReachability()
 	} // end if
 #ifndef BSPC
 	calcgrapplereach = LibVarGetValue( "grapplereach" );
+	// the reachabilities are replaced
+	AAS_UnmapAASFile();
 #endif
 	aasworld.savefile = qtrue;
 	// start with area 1 because area zero is a dummy
@@ -5275,6 +5645,8 @@ void AAS_InitReachability()
 	AAS_SetupReachabilityHeap();
 	// allocate area reachability link array
 	areareachability = ( aas_lreachability_t** )GetClearedMemory( aasworld.numareas * sizeof( aas_lreachability_t* ) );
+	// find the areas near enough to each other for the pairwise tests
+	AAS_InitReachabilityCandidates();
 	//
 	AAS_SetWeaponJumpAreaFlags();
 } // end of the function AAS_InitReachable
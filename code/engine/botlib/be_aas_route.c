@@ -44,6 +44,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "be_aas_funcs.h"
 #include "be_interface.h"
 #include "be_aas_def.h"
+#include "be_ai_goal.h"
 
 #define ROUTING_DEBUG
 
@@ -58,6 +59,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 // maximum number of routing updates each frame
 #define MAX_FRAMEROUTINGUPDATES 10
 
+// shared routing lookup that would need a new routing cache
+#define ROUTE_UNCACHED			-1
+
 /*
 
   area routing cache:
@@ -73,6 +77,13 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
   for every area (aasworld.numareas) the portal cache stores
   aasworld.numportals travel times
 
+  route table:
+  the area and portal routing for the travel flags bots use most,
+  calculated in advance for every goal area and written to maps/<map>.rcd
+  by AAS_WriteRouteCache (bot_saveroutingcache 1), the file is mapped
+  when the map loads and looked up instead of the caches above, as long as
+  every area is enabled or disabled the way it was when the table got mapped
+
 */
 
 #ifdef ROUTING_DEBUG
@@ -80,8 +91,13 @@ int numareacacheupdates;
 int numportalcacheupdates;
 #endif // ROUTING_DEBUG
 
-int routingcachesize;
-int max_routingcachesize;
+int					routingcachesize;
+int					max_routingcachesize;
+
+aas_routingcache_t* AAS_GetAreaRoutingCache( int clusternum, int areanum, int travelflags );
+aas_routingcache_t* AAS_GetPortalRoutingCache( int clusternum, int areanum, int travelflags );
+void				AAS_FreeRouteTable();
+int					AAS_ReadRouteCache();
 
 //===========================================================================
 //
@@ -95,6 +111,8 @@ void AAS_RoutingInfo()
 	botimport.Print( PRT_MESSAGE, "%d area cache updates\n", numareacacheupdates );
 	botimport.Print( PRT_MESSAGE, "%d portal cache updates\n", numportalcacheupdates );
 	botimport.Print( PRT_MESSAGE, "%d bytes routing cache\n", routingcachesize );
+	botimport.Print( PRT_MESSAGE, "route table with %d travel flag combinations\n", aasworld.routetable.numtravelflags );
+	AAS_RouteWarmingInfo();
 } // end of the function AAS_RoutingInfo
 #endif // ROUTING_DEBUG
 //===========================================================================
@@ -357,6 +375,27 @@ int AAS_EnableRoutingArea( int areanum, int enable )
 	{
 		// remove all routing cache involving this area
 		AAS_RemoveRoutingCacheUsingArea( areanum );
+		// and the travel times prepared for the bots this frame
+		BotClearPreparedGoals();
+		// the route table holds the routing for the areas as they were when it
+		// got mapped, bypass it as long as any area is in a different state
+		if( aasworld.routetable.file )
+		{
+			if( ( aasworld.areasettings[areanum].areaflags & AREA_DISABLED ) != aasworld.routetable.areadisabled[areanum] )
+			{
+				aasworld.routetable.numchangedareas++;
+			}
+			else
+			{
+				aasworld.routetable.numchangedareas--;
+			}
+			if( botDeveloper )
+			{
+				botimport.Print( PRT_MESSAGE, "area %d changed state, %d areas differ from the route table\n", areanum, aasworld.routetable.numchangedareas );
+			} // end if
+		} // end if
+		// and start warming all over again
+		AAS_RouteWarmingAreaChanged();
 	} // end if
 	return !flags;
 } // end of the function AAS_EnableRoutingArea
@@ -1019,56 +1058,159 @@ void AAS_CreateAllRoutingCache()
 // Changes Globals:		-
 //===========================================================================
 
-// the route cache header
-// this header is followed by numportalcache + numareacache aas_routingcache_t
-// structures that store routing cache
+// the route table header
+// the header is followed by a block for every travel flag combination, each
+// block holds the travel times from all portals towards every area with
+// reachabilities, then the travel times and reachabilities from all the
+// reachability areas of a cluster towards every reachability area of that
+// cluster, the last exactly as the routing caches would calculate them
 typedef struct routecacheheader_s
 {
 	int ident;
 	int version;
 	int numareas;
 	int numclusters;
+	int numportals;
 	int areacrc;
 	int clustercrc;
-	int numportalcache;
-	int numareacache;
+	int reachabilitycrc;
+	int numtravelflags;
+	int travelflags[MAX_ROUTETABLEFLAGS];
 } routecacheheader_t;
 
 #define RCID	  ( ( 'C' << 24 ) + ( 'R' << 16 ) + ( 'E' << 8 ) + 'M' )
-#define RCVERSION 2
+#define RCVERSION 3
 
-// void AAS_DecompressVis(byte *in, int numareas, byte *decompressed);
-// int AAS_CompressVis(byte *vis, int numareas, byte *dest);
+// travel flag combinations written to the route table, the routing adds
+// TFL_DONOTENTER itself when starting or ending in a donotenter area
+static int routetableflags[MAX_ROUTETABLEFLAGS] = {
+	TFL_DEFAULT,
+	TFL_DEFAULT | TFL_DONOTENTER,
+	TFL_DEFAULT | TFL_ROCKETJUMP,
+	TFL_DEFAULT | TFL_ROCKETJUMP | TFL_DONOTENTER,
+};
 
-void AAS_WriteRouteCache()
+//===========================================================================
+// sets up the offsets of the clusters into the area tables and the rows of
+// the areas in the portal tables
+//
+// Parameter:			-
+// Returns:				size in bytes of a travel flag block
+// Changes Globals:		-
+//===========================================================================
+int AAS_RouteTableLayout( int* clusteroffset, int* portalrow, int* areatablesize, int* numportalrows )
 {
-	int					i, j, numportalcache, numareacache, totalsize;
-	aas_routingcache_t* cache;
-	aas_cluster_t*		cluster;
-	fileHandle_t		fp;
-	char				filename[MAX_QPATH];
-	routecacheheader_t	routecacheheader;
+	int i, size;
 
-	numportalcache = 0;
+	*areatablesize = 0;
+	for( i = 0; i < aasworld.numclusters; i++ )
+	{
+		clusteroffset[i] = *areatablesize;
+		*areatablesize += aasworld.clusters[i].numreachabilityareas * aasworld.clusters[i].numreachabilityareas;
+	} // end for
+	*numportalrows = 0;
 	for( i = 0; i < aasworld.numareas; i++ )
 	{
-		for( cache = aasworld.portalcache[i]; cache; cache = cache->next )
+		if( i > 0 && aasworld.areasettings[i].numreachableareas )
 		{
-			numportalcache++;
-		} // end for
+			portalrow[i] = ( *numportalrows )++;
+		}
+		else
+		{
+			portalrow[i] = -1;
+		}
 	} // end for
-	numareacache = 0;
-	for( i = 0; i < aasworld.numclusters; i++ )
+	size = *numportalrows * aasworld.numportals * sizeof( unsigned short int );
+	size += *areatablesize * ( sizeof( unsigned short int ) + sizeof( unsigned char ) );
+	// keep the next block aligned
+	return ( size + 3 ) & ~3;
+} // end of the function AAS_RouteTableLayout
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_RouteTableHeader( routecacheheader_t* header )
+{
+	header->ident			= RCID;
+	header->version			= RCVERSION;
+	header->numareas		= aasworld.numareas;
+	header->numclusters		= aasworld.numclusters;
+	header->numportals		= aasworld.numportals;
+	header->areacrc			= CRC_ProcessString( ( unsigned char* )aasworld.areas, sizeof( aas_area_t ) * aasworld.numareas );
+	header->clustercrc		= CRC_ProcessString( ( unsigned char* )aasworld.clusters, sizeof( aas_cluster_t ) * aasworld.numclusters );
+	header->reachabilitycrc = CRC_ProcessString( ( unsigned char* )aasworld.reachability, sizeof( aas_reachability_t ) * aasworld.reachabilitysize );
+} // end of the function AAS_RouteTableHeader
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeRoutingCacheList( aas_routingcache_t** list )
+{
+	aas_routingcache_t *cache, *nextcache;
+
+	for( cache = *list; cache; cache = nextcache )
 	{
-		cluster = &aasworld.clusters[i];
-		for( j = 0; j < cluster->numareas; j++ )
-		{
-			for( cache = aasworld.clusterareacache[i][j]; cache; cache = cache->next )
-			{
-				numareacache++;
-			} // end for
-		} // end for
+		nextcache = cache->next;
+		AAS_FreeRoutingCache( cache );
 	} // end for
+	*list = NULL;
+} // end of the function AAS_FreeRoutingCacheList
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeRouteTable()
+{
+	if( aasworld.routetable.file )
+	{
+		botimport.FS_UnmapFile( aasworld.routetable.file );
+	}
+	if( aasworld.routetable.clusteroffset )
+	{
+		FreeMemory( aasworld.routetable.clusteroffset );
+	}
+	Com_Memset( &aasworld.routetable, 0, sizeof( aas_routetable_t ) );
+} // end of the function AAS_FreeRouteTable
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int AAS_RouteTableValid()
+{
+	return aasworld.routetable.file && !aasworld.routetable.numchangedareas;
+} // end of the function AAS_RouteTableValid
+//===========================================================================
+// the table is filled from the routing caches, so it holds exactly what
+// the routing would calculate at run time for the current area states
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_WriteRouteCache()
+{
+	int					i, j, n, clusternum, clusters[2], numclusters, clusterareanum, numreachabilityareas;
+	int					blocksize, areatablesize, numportalrows, offset, totalsize;
+	int *				clusteroffset, *portalrow;
+	unsigned short int* areatraveltimes;
+	unsigned char*		areareachabilities;
+	aas_routingcache_t* cache;
+	aas_portal_t*		portal;
+	fileHandle_t		fp;
+	char				filename[MAX_QPATH];
+	routecacheheader_t	routecacheheader;
+	static byte			pad[4];
+
+	// the file can't be rewritten while it's mapped
+	AAS_FreeRouteTable();
 	// open the file for writing
 	Com_sprintf( filename, MAX_QPATH, "maps/%s.rcd", aasworld.mapname );
 	botimport.FS_FOpenFile( filename, &fp, FS_WRITE );
@@ -1077,79 +1219,101 @@ void AAS_WriteRouteCache()
 		AAS_Error( "Unable to open file: %s\n", filename );
 		return;
 	} // end if
+	botimport.Print( PRT_MESSAGE, "calculating route table...\n" );
+	//
+	clusteroffset = ( int* )GetMemory( ( aasworld.numclusters + aasworld.numareas ) * sizeof( int ) );
+	portalrow	  = clusteroffset + aasworld.numclusters;
+	blocksize	  = AAS_RouteTableLayout( clusteroffset, portalrow, &areatablesize, &numportalrows );
 	// create the header
-	routecacheheader.ident			= RCID;
-	routecacheheader.version		= RCVERSION;
-	routecacheheader.numareas		= aasworld.numareas;
-	routecacheheader.numclusters	= aasworld.numclusters;
-	routecacheheader.areacrc		= CRC_ProcessString( ( unsigned char* )aasworld.areas, sizeof( aas_area_t ) * aasworld.numareas );
-	routecacheheader.clustercrc		= CRC_ProcessString( ( unsigned char* )aasworld.clusters, sizeof( aas_cluster_t ) * aasworld.numclusters );
-	routecacheheader.numportalcache = numportalcache;
-	routecacheheader.numareacache	= numareacache;
+	AAS_RouteTableHeader( &routecacheheader );
+	routecacheheader.numtravelflags = MAX_ROUTETABLEFLAGS;
+	Com_Memcpy( routecacheheader.travelflags, routetableflags, sizeof( routetableflags ) );
 	// write the header
 	botimport.FS_Write( &routecacheheader, sizeof( routecacheheader_t ), fp );
 	//
-	totalsize = 0;
-	// write all the cache
-	for( i = 0; i < aasworld.numareas; i++ )
+	areatraveltimes	   = ( unsigned short int* )GetClearedMemory( areatablesize * sizeof( unsigned short int ) );
+	areareachabilities = ( unsigned char* )GetClearedMemory( areatablesize * sizeof( unsigned char ) );
+	//
+	for( n = 0; n < routecacheheader.numtravelflags; n++ )
 	{
-		for( cache = aasworld.portalcache[i]; cache; cache = cache->next )
+		// portal travel times towards every area, stored in row order
+		for( i = 1; i < aasworld.numareas; i++ )
 		{
-			botimport.FS_Write( cache, cache->size, fp );
-			totalsize += cache->size;
+			if( portalrow[i] < 0 )
+			{
+				continue;
+			}
+			// same cluster the routing asks for
+			clusternum = aasworld.areasettings[i].cluster;
+			if( clusternum < 0 )
+			{
+				clusternum = aasworld.portals[-clusternum].frontcluster;
+			} // end if
+			cache = AAS_GetPortalRoutingCache( clusternum, i, routetableflags[n] );
+			botimport.FS_Write( cache->traveltimes, aasworld.numportals * sizeof( unsigned short int ), fp );
+			// the area caches of the portal areas are reused for the next goal
+			AAS_FreeRoutingCacheList( &aasworld.portalcache[i] );
 		} // end for
-	} // end for
-	for( i = 0; i < aasworld.numclusters; i++ )
-	{
-		cluster = &aasworld.clusters[i];
-		for( j = 0; j < cluster->numareas; j++ )
+		// area travel times within the clusters
+		for( i = 1; i < aasworld.numareas; i++ )
 		{
-			for( cache = aasworld.clusterareacache[i][j]; cache; cache = cache->next )
+			clusternum = aasworld.areasettings[i].cluster;
+			if( !clusternum )
+			{
+				continue;
+			}
+			// portal areas are part of both their clusters
+			if( clusternum > 0 )
+			{
+				clusters[0]	= clusternum;
+				numclusters = 1;
+			} // end if
+			else
+			{
+				portal		= &aasworld.portals[-clusternum];
+				clusters[0] = portal->frontcluster;
+				clusters[1] = portal->backcluster;
+				numclusters = 2;
+			} // end else
+			for( j = 0; j < numclusters; j++ )
 			{
-				botimport.FS_Write( cache, cache->size, fp );
-				totalsize += cache->size;
+				numreachabilityareas = aasworld.clusters[clusters[j]].numreachabilityareas;
+				clusterareanum		 = AAS_ClusterAreaNum( clusters[j], i );
+				if( clusterareanum >= numreachabilityareas )
+				{
+					continue;
+				}
+				cache  = AAS_GetAreaRoutingCache( clusters[j], i, routetableflags[n] );
+				offset = clusteroffset[clusters[j]] + clusterareanum * numreachabilityareas;
+				Com_Memcpy( areatraveltimes + offset, cache->traveltimes, numreachabilityareas * sizeof( unsigned short int ) );
+				Com_Memcpy( areareachabilities + offset, cache->reachabilities, numreachabilityareas * sizeof( unsigned char ) );
+				AAS_FreeRoutingCacheList( &aasworld.clusterareacache[clusters[j]][clusterareanum] );
 			} // end for
 		} // end for
+		botimport.FS_Write( areatraveltimes, areatablesize * sizeof( unsigned short int ), fp );
+		botimport.FS_Write( areareachabilities, areatablesize * sizeof( unsigned char ), fp );
+		botimport.FS_Write( pad, blocksize - ( numportalrows * aasworld.numportals * sizeof( unsigned short int ) + areatablesize * 3 ), fp );
+		// start the next travel flags with a clean cache
+		for( i = 0; i < aasworld.numclusters; i++ )
+		{
+			AAS_RemoveRoutingCacheInCluster( i );
+		} // end for
 	} // end for
-	// write the visareas
-	/*
-	for (i = 0; i < aasworld.numareas; i++)
-	{
-		if (!aasworld.areavisibility[i]) {
-			size = 0;
-			botimport.FS_Write(&size, sizeof(int), fp);
-			continue;
-		}
-		AAS_DecompressVis( aasworld.areavisibility[i], aasworld.numareas, aasworld.decompressedvis );
-		size = AAS_CompressVis( aasworld.decompressedvis, aasworld.numareas, aasworld.decompressedvis );
-		botimport.FS_Write(&size, sizeof(int), fp);
-		botimport.FS_Write(aasworld.decompressedvis, size, fp);
-	}
-	*/
+	//
+	FreeMemory( areatraveltimes );
+	FreeMemory( areareachabilities );
+	FreeMemory( clusteroffset );
 	//
 	botimport.FS_FCloseFile( fp );
-	botimport.Print( PRT_MESSAGE, "\nroute cache written to %s\n", filename );
-	botimport.Print( PRT_MESSAGE, "written %d bytes of routing cache\n", totalsize );
+	totalsize = sizeof( routecacheheader_t ) + routecacheheader.numtravelflags * blocksize;
+	botimport.Print( PRT_MESSAGE, "\nroute table written to %s\n", filename );
+	botimport.Print( PRT_MESSAGE, "written %d bytes of routing for %d travel flag combinations\n", totalsize, routecacheheader.numtravelflags );
+	// and use it straight away
+	AAS_ReadRouteCache();
 } // end of the function AAS_WriteRouteCache
 //===========================================================================
-//
-// Parameter:			-
-// Returns:				-
-// Changes Globals:		-
-//===========================================================================
-aas_routingcache_t* AAS_ReadCache( fileHandle_t fp )
-{
-	int					size;
-	aas_routingcache_t* cache;
-
-	botimport.FS_Read( &size, sizeof( size ), fp );
-	cache		= ( aas_routingcache_t* )GetMemory( size );
-	cache->size = size;
-	botimport.FS_Read( ( unsigned char* )cache + sizeof( size ), size - sizeof( size ), fp );
-	cache->reachabilities = ( unsigned char* )cache + sizeof( aas_routingcache_t ) - sizeof( unsigned short ) + ( size - sizeof( aas_routingcache_t ) + sizeof( unsigned short ) ) / 3 * 2;
-	return cache;
-} // end of the function AAS_ReadCache
-//===========================================================================
+// maps the route table written by AAS_WriteRouteCache, the table is used
+// as is so loading costs neither time nor memory
 //
 // Parameter:			-
 // Returns:				-
@@ -1157,89 +1321,79 @@ aas_routingcache_t* AAS_ReadCache( fileHandle_t fp )
 //===========================================================================
 int AAS_ReadRouteCache()
 {
-	int					i, clusterareanum; //, size;
-	fileHandle_t		fp;
+	int					n, blocksize, areatablesize, numportalrows;
+	long				length;
+	void*				file;
+	byte*				block;
 	char				filename[MAX_QPATH];
+	routecacheheader_t* header;
 	routecacheheader_t	routecacheheader;
-	aas_routingcache_t* cache;
+	aas_routetable_t*	table;
 
+	AAS_FreeRouteTable();
+	//
 	Com_sprintf( filename, MAX_QPATH, "maps/%s.rcd", aasworld.mapname );
-	botimport.FS_FOpenFile( filename, &fp, FS_READ );
-	if( !fp )
-	{
-		return qfalse;
-	} // end if
-	botimport.FS_Read( &routecacheheader, sizeof( routecacheheader_t ), fp );
-	if( routecacheheader.ident != RCID )
-	{
-		AAS_Error( "%s is not a route cache dump\n", filename );
-		return qfalse;
-	} // end if
-	if( routecacheheader.version != RCVERSION )
+	length = botimport.FS_MapFile( filename, &file );
+	if( !file )
 	{
-		AAS_Error( "route cache dump has wrong version %d, should be %d\n", routecacheheader.version, RCVERSION );
 		return qfalse;
 	} // end if
-	if( routecacheheader.numareas != aasworld.numareas )
+	header = ( routecacheheader_t* )file;
+	if( length < ( long )sizeof( routecacheheader_t ) || header->ident != RCID )
 	{
-		// AAS_Error("route cache dump has wrong number of areas\n");
+		botimport.Print( PRT_WARNING, "%s is not a route table\n", filename );
+		botimport.FS_UnmapFile( file );
 		return qfalse;
 	} // end if
-	if( routecacheheader.numclusters != aasworld.numclusters )
+	if( header->version != RCVERSION )
 	{
-		// AAS_Error("route cache dump has wrong number of clusters\n");
+		botimport.Print( PRT_WARNING, "%s has wrong version %d, should be %d\n", filename, header->version, RCVERSION );
+		botimport.FS_UnmapFile( file );
 		return qfalse;
 	} // end if
-	if( routecacheheader.areacrc != CRC_ProcessString( ( unsigned char* )aasworld.areas, sizeof( aas_area_t ) * aasworld.numareas ) )
+	// the table must have been calculated for this very aas file
+	AAS_RouteTableHeader( &routecacheheader );
+	if( header->numareas != routecacheheader.numareas || header->numclusters != routecacheheader.numclusters || header->numportals != routecacheheader.numportals ||
+		header->areacrc != routecacheheader.areacrc || header->clustercrc != routecacheheader.clustercrc || header->reachabilitycrc != routecacheheader.reachabilitycrc ||
+		header->numtravelflags <= 0 || header->numtravelflags > MAX_ROUTETABLEFLAGS )
 	{
-		// AAS_Error("route cache dump area CRC incorrect\n");
+		if( botDeveloper )
+		{
+			botimport.Print( PRT_MESSAGE, "%s is out of date\n", filename );
+		} // end if
+		botimport.FS_UnmapFile( file );
 		return qfalse;
 	} // end if
-	if( routecacheheader.clustercrc != CRC_ProcessString( ( unsigned char* )aasworld.clusters, sizeof( aas_cluster_t ) * aasworld.numclusters ) )
-	{
-		// AAS_Error("route cache dump cluster CRC incorrect\n");
+	//
+	table				   = &aasworld.routetable;
+	table->clusteroffset   = ( int* )GetClearedMemory( ( aasworld.numclusters + aasworld.numareas ) * sizeof( int ) + aasworld.numportals + aasworld.numareas );
+	table->portalrow	   = table->clusteroffset + aasworld.numclusters;
+	table->noreachabilities = ( unsigned char* )( table->portalrow + aasworld.numareas );
+	table->areadisabled	   = table->noreachabilities + aasworld.numportals;
+	blocksize			   = AAS_RouteTableLayout( table->clusteroffset, table->portalrow, &areatablesize, &numportalrows );
+	if( length != ( long )sizeof( routecacheheader_t ) + header->numtravelflags * blocksize )
+	{
+		botimport.Print( PRT_WARNING, "%s has wrong size\n", filename );
+		FreeMemory( table->clusteroffset );
+		table->clusteroffset = NULL;
+		botimport.FS_UnmapFile( file );
 		return qfalse;
 	} // end if
-	// read all the portal cache
-	for( i = 0; i < routecacheheader.numportalcache; i++ )
+	//
+	table->file			  = file;
+	table->numtravelflags = header->numtravelflags;
+	for( n = 0; n < aasworld.numareas; n++ )
 	{
-		cache		= AAS_ReadCache( fp );
-		cache->next = aasworld.portalcache[cache->areanum];
-		cache->prev = NULL;
-		if( aasworld.portalcache[cache->areanum] )
-		{
-			aasworld.portalcache[cache->areanum]->prev = cache;
-		}
-		aasworld.portalcache[cache->areanum] = cache;
+		table->areadisabled[n] = aasworld.areasettings[n].areaflags & AREA_DISABLED;
 	} // end for
-	// read all the cluster area cache
-	for( i = 0; i < routecacheheader.numareacache; i++ )
+	for( n = 0; n < header->numtravelflags; n++ )
 	{
-		cache		   = AAS_ReadCache( fp );
-		clusterareanum = AAS_ClusterAreaNum( cache->cluster, cache->areanum );
-		cache->next	   = aasworld.clusterareacache[cache->cluster][clusterareanum];
-		cache->prev	   = NULL;
-		if( aasworld.clusterareacache[cache->cluster][clusterareanum] )
-		{
-			aasworld.clusterareacache[cache->cluster][clusterareanum]->prev = cache;
-		}
-		aasworld.clusterareacache[cache->cluster][clusterareanum] = cache;
+		block						  = ( byte* )file + sizeof( routecacheheader_t ) + n * blocksize;
+		table->travelflags[n]		  = header->travelflags[n];
+		table->portaltraveltimes[n]	  = ( unsigned short int* )block;
+		table->areatraveltimes[n]	  = table->portaltraveltimes[n] + numportalrows * aasworld.numportals;
+		table->areareachabilities[n] = ( unsigned char* )( table->areatraveltimes[n] + areatablesize );
 	} // end for
-	// read the visareas
-	/*
-	aasworld.areavisibility = (byte **) GetClearedMemory(aasworld.numareas * sizeof(byte *));
-	aasworld.decompressedvis = (byte *) GetClearedMemory(aasworld.numareas * sizeof(byte));
-	for (i = 0; i < aasworld.numareas; i++)
-	{
-		botimport.FS_Read(&size, sizeof(size), fp );
-		if (size) {
-			aasworld.areavisibility[i] = (byte *) GetMemory(size);
-			botimport.FS_Read(aasworld.areavisibility[i], size, fp );
-		}
-	}
-	*/
-	//
-	botimport.FS_FCloseFile( fp );
 	return qtrue;
 } // end of the function AAS_ReadRouteCache
 //===========================================================================
@@ -1365,6 +1519,8 @@ void AAS_InitRouting()
 	max_routingcachesize = 1024 * ( int )LibVarValue( "max_routingcache", "4096" );
 	// read any routing cache if available
 	AAS_ReadRouteCache();
+	// calculate the routing cache in the background if there's no route table
+	AAS_StartRouteWarming();
 } // end of the function AAS_InitRouting
 //===========================================================================
 //
@@ -1374,10 +1530,14 @@ void AAS_InitRouting()
 //===========================================================================
 void AAS_FreeRoutingCaches()
 {
+	// the warming thread reads the routing data
+	AAS_StopRouteWarming();
 	// free all the existing cluster area cache
 	AAS_FreeAllClusterAreaCache();
 	// free all the existing portal cache
 	AAS_FreeAllPortalCache();
+	// unmap the route table
+	AAS_FreeRouteTable();
 	// free cached travel times within areas
 	if( aasworld.areatraveltimes )
 	{
@@ -1427,13 +1587,18 @@ void AAS_FreeRoutingCaches()
 	aasworld.areacontentstravelflags = NULL;
 } // end of the function AAS_FreeRoutingCaches
 //===========================================================================
-// update the given routing cache
+// calculates the travel times and reachabilities within the cluster towards
+// the goal area, the update fields are scratch memory of the calling thread
+// and the travel times and reachabilities have to be cleared
 //
-// Parameter:			areacache		: routing cache to update
+// Parameter:			clusternum		: cluster of the goal area
+//						areanum			: goal area
+//						areaupdate		: numreachabilityareas update fields
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-void AAS_UpdateAreaRoutingCache( aas_routingcache_t* areacache )
+void AAS_CalculateAreaRouting( int clusternum, int areanum, int travelflags, unsigned short int starttraveltime, aas_routingupdate_t* areaupdate,
+	unsigned short int* traveltimes, unsigned char* reachabilities )
 {
 	int							i, nextareanum, cluster, badtravelflags, clusterareanum, linknum;
 	int							numreachabilityareas;
@@ -1443,19 +1608,14 @@ void AAS_UpdateAreaRoutingCache( aas_routingcache_t* areacache )
 	aas_reversedreachability_t* revreach;
 	aas_reversedlink_t*			revlink;
 
-#ifdef ROUTING_DEBUG
-	numareacacheupdates++;
-#endif // ROUTING_DEBUG
 	// number of reachability areas within this cluster
-	numreachabilityareas = aasworld.clusters[areacache->cluster].numreachabilityareas;
-	//
-	aasworld.frameroutingupdates++;
+	numreachabilityareas = aasworld.clusters[clusternum].numreachabilityareas;
 	// clear the routing update fields
 	//	Com_Memset(aasworld.areaupdate, 0, aasworld.numareas * sizeof(aas_routingupdate_t));
 	//
-	badtravelflags = ~areacache->travelflags;
+	badtravelflags = ~travelflags;
 	//
-	clusterareanum = AAS_ClusterAreaNum( areacache->cluster, areacache->areanum );
+	clusterareanum = AAS_ClusterAreaNum( clusternum, areanum );
 	if( clusterareanum >= numreachabilityareas )
 	{
 		return;
@@ -1463,13 +1623,13 @@ void AAS_UpdateAreaRoutingCache( aas_routingcache_t* areacache )
 	//
 	Com_Memset( startareatraveltimes, 0, sizeof( startareatraveltimes ) );
 	//
-	curupdate		   = &aasworld.areaupdate[clusterareanum];
-	curupdate->areanum = areacache->areanum;
-	// VectorCopy(areacache->origin, curupdate->start);
+	curupdate		   = &areaupdate[clusterareanum];
+	curupdate->areanum = areanum;
+	// VectorCopy(origin, curupdate->start);
 	curupdate->areatraveltimes = startareatraveltimes;
-	curupdate->tmptraveltime   = areacache->starttraveltime;
+	curupdate->tmptraveltime   = starttraveltime;
 	//
-	areacache->traveltimes[clusterareanum] = areacache->starttraveltime;
+	traveltimes[clusterareanum] = starttraveltime;
 	// put the area to start with in the current read list
 	curupdate->next = NULL;
 	curupdate->prev = NULL;
@@ -1518,12 +1678,12 @@ void AAS_UpdateAreaRoutingCache( aas_routingcache_t* areacache )
 			// get the cluster number of the area
 			cluster = aasworld.areasettings[nextareanum].cluster;
 			// don't leave the cluster
-			if( cluster > 0 && cluster != areacache->cluster )
+			if( cluster > 0 && cluster != clusternum )
 			{
 				continue;
 			}
 			// get the number of the area in the cluster
-			clusterareanum = AAS_ClusterAreaNum( areacache->cluster, nextareanum );
+			clusterareanum = AAS_ClusterAreaNum( clusternum, nextareanum );
 			if( clusterareanum >= numreachabilityareas )
 			{
 				continue;
@@ -1534,13 +1694,13 @@ void AAS_UpdateAreaRoutingCache( aas_routingcache_t* areacache )
 				// AAS_AreaTravelTime(curupdate->areanum, curupdate->start, reach->end) +
 				curupdate->areatraveltimes[i] + reach->traveltime;
 			//
-			if( !areacache->traveltimes[clusterareanum] || areacache->traveltimes[clusterareanum] > t )
+			if( !traveltimes[clusterareanum] || traveltimes[clusterareanum] > t )
 			{
-				areacache->traveltimes[clusterareanum]	  = t;
-				areacache->reachabilities[clusterareanum] = linknum - aasworld.areasettings[nextareanum].firstreachablearea;
-				nextupdate								  = &aasworld.areaupdate[clusterareanum];
-				nextupdate->areanum						  = nextareanum;
-				nextupdate->tmptraveltime				  = t;
+				traveltimes[clusterareanum]	   = t;
+				reachabilities[clusterareanum] = linknum - aasworld.areasettings[nextareanum].firstreachablearea;
+				nextupdate					   = &areaupdate[clusterareanum];
+				nextupdate->areanum			   = nextareanum;
+				nextupdate->tmptraveltime	   = t;
 				// VectorCopy(reach->start, nextupdate->start);
 				nextupdate->areatraveltimes = aasworld.areatraveltimes[nextareanum][linknum - aasworld.areasettings[nextareanum].firstreachablearea];
 				if( !nextupdate->inlist )
@@ -1564,24 +1724,38 @@ void AAS_UpdateAreaRoutingCache( aas_routingcache_t* areacache )
 			} // end if
 		} // end for
 	} // end while
+} // end of the function AAS_CalculateAreaRouting
+//===========================================================================
+// update the given routing cache
+//
+// Parameter:			areacache		: routing cache to update
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_UpdateAreaRoutingCache( aas_routingcache_t* areacache )
+{
+#ifdef ROUTING_DEBUG
+	numareacacheupdates++;
+#endif // ROUTING_DEBUG
+	//
+	aasworld.frameroutingupdates++;
+	//
+	AAS_CalculateAreaRouting( areacache->cluster, areacache->areanum, areacache->travelflags, areacache->starttraveltime, aasworld.areaupdate, areacache->traveltimes,
+		areacache->reachabilities );
 } // end of the function AAS_UpdateAreaRoutingCache
 //===========================================================================
+// returns the existing area routing cache without changing the cache lists
 //
 // Parameter:			-
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-aas_routingcache_t* AAS_GetAreaRoutingCache( int clusternum, int areanum, int travelflags )
+aas_routingcache_t* AAS_FindAreaRoutingCache( int clusternum, int areanum, int travelflags )
 {
-	int					clusterareanum;
-	aas_routingcache_t *cache, *clustercache;
+	aas_routingcache_t* cache;
 
-	// number of the area in the cluster
-	clusterareanum = AAS_ClusterAreaNum( clusternum, areanum );
-	// pointer to the cache for the area in the cluster
-	clustercache = aasworld.clusterareacache[clusternum][clusterareanum];
 	// find the cache without undesired travel flags
-	for( cache = clustercache; cache; cache = cache->next )
+	for( cache = aasworld.clusterareacache[clusternum][AAS_ClusterAreaNum( clusternum, areanum )]; cache; cache = cache->next )
 	{
 		// if there aren't used any undesired travel types for the cache
 		if( cache->travelflags == travelflags )
@@ -1589,22 +1763,120 @@ aas_routingcache_t* AAS_GetAreaRoutingCache( int clusternum, int areanum, int tr
 			break;
 		}
 	} // end for
+	return cache;
+} // end of the function AAS_FindAreaRoutingCache
+//===========================================================================
+// returns the existing portal routing cache without changing the cache lists
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+aas_routingcache_t* AAS_FindPortalRoutingCache( int areanum, int travelflags )
+{
+	aas_routingcache_t* cache;
+
+	for( cache = aasworld.portalcache[areanum]; cache; cache = cache->next )
+	{
+		if( cache->travelflags == travelflags )
+		{
+			break;
+		}
+	} // end for
+	return cache;
+} // end of the function AAS_FindPortalRoutingCache
+//===========================================================================
+// allocates a cleared routing cache and adds it to the area or portal cache
+// list of the goal area
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+aas_routingcache_t* AAS_NewRoutingCache( int type, int clusternum, int areanum, int travelflags )
+{
+	aas_routingcache_t *cache, **list;
+
+	if( type == CACHETYPE_AREA )
+	{
+		cache = AAS_AllocRoutingCache( aasworld.clusters[clusternum].numreachabilityareas );
+		list  = &aasworld.clusterareacache[clusternum][AAS_ClusterAreaNum( clusternum, areanum )];
+	} // end if
+	else
+	{
+		cache = AAS_AllocRoutingCache( aasworld.numportals );
+		list  = &aasworld.portalcache[areanum];
+	} // end else
+	cache->cluster = clusternum;
+	cache->areanum = areanum;
+	VectorCopy( aasworld.areas[areanum].center, cache->origin );
+	cache->starttraveltime = 1;
+	cache->travelflags	   = travelflags;
+	cache->type			   = type;
+	// add the cache to the cache list
+	cache->prev = NULL;
+	cache->next = *list;
+	if( *list )
+	{
+		( *list )->prev = cache;
+	}
+	*list = cache;
+	return cache;
+} // end of the function AAS_NewRoutingCache
+//===========================================================================
+// adds routing calculated elsewhere as new cache, the travel times and
+// reachabilities are copied
+//
+// Parameter:			-
+// Returns:				qfalse if the cache already exists
+// Changes Globals:		-
+//===========================================================================
+int AAS_AddRoutingCache( int type, int clusternum, int areanum, int travelflags, unsigned short int* traveltimes, unsigned char* reachabilities )
+{
+	int					numtraveltimes;
+	aas_routingcache_t* cache;
+
+	if( type == CACHETYPE_AREA )
+	{
+		if( AAS_FindAreaRoutingCache( clusternum, areanum, travelflags ) )
+		{
+			return qfalse;
+		}
+		numtraveltimes = aasworld.clusters[clusternum].numreachabilityareas;
+	} // end if
+	else
+	{
+		if( AAS_FindPortalRoutingCache( areanum, travelflags ) )
+		{
+			return qfalse;
+		}
+		numtraveltimes = aasworld.numportals;
+	} // end else
+	cache = AAS_NewRoutingCache( type, clusternum, areanum, travelflags );
+	Com_Memcpy( cache->traveltimes, traveltimes, numtraveltimes * sizeof( unsigned short int ) );
+	if( reachabilities )
+	{
+		Com_Memcpy( cache->reachabilities, reachabilities, numtraveltimes * sizeof( unsigned char ) );
+	}
+	cache->time = AAS_RoutingTime();
+	AAS_LinkCache( cache );
+	return qtrue;
+} // end of the function AAS_AddRoutingCache
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+aas_routingcache_t* AAS_GetAreaRoutingCache( int clusternum, int areanum, int travelflags )
+{
+	aas_routingcache_t* cache;
+
+	cache = AAS_FindAreaRoutingCache( clusternum, areanum, travelflags );
 	// if there was no cache
 	if( !cache )
 	{
-		cache		   = AAS_AllocRoutingCache( aasworld.clusters[clusternum].numreachabilityareas );
-		cache->cluster = clusternum;
-		cache->areanum = areanum;
-		VectorCopy( aasworld.areas[areanum].center, cache->origin );
-		cache->starttraveltime = 1;
-		cache->travelflags	   = travelflags;
-		cache->prev			   = NULL;
-		cache->next			   = clustercache;
-		if( clustercache )
-		{
-			clustercache->prev = cache;
-		}
-		aasworld.clusterareacache[clusternum][clusterareanum] = cache;
+		cache = AAS_NewRoutingCache( CACHETYPE_AREA, clusternum, areanum, travelflags );
 		AAS_UpdateAreaRoutingCache( cache );
 	} // end if
 	else
@@ -1613,40 +1885,42 @@ aas_routingcache_t* AAS_GetAreaRoutingCache( int clusternum, int areanum, int tr
 	} // end else
 	// the cache has been accessed
 	cache->time = AAS_RoutingTime();
-	cache->type = CACHETYPE_AREA;
 	AAS_LinkCache( cache );
 	return cache;
 } // end of the function AAS_GetAreaRoutingCache
 //===========================================================================
+// calculates the travel times of all the portals towards the goal area,
+// the area travel times within the clusters on the way are returned by
+// areatraveltimesfunc, the update fields are scratch memory of the calling
+// thread and the travel times have to be cleared
 //
-// Parameter:			-
+// Parameter:			clusternum		: cluster of the goal area
+//						areanum			: goal area
+//						portalupdate	: numportals + 1 update fields
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-void AAS_UpdatePortalRoutingCache( aas_routingcache_t* portalcache )
+void AAS_CalculatePortalRouting( int clusternum, int areanum, int travelflags, unsigned short int starttraveltime, aas_routingupdate_t* portalupdate,
+	unsigned short int* traveltimes, aas_areatraveltimesfunc_t areatraveltimesfunc, void* context )
 {
-	int					 i, portalnum, clusterareanum, clusternum;
+	int					 i, portalnum, clusterareanum;
 	unsigned short int	 t;
 	aas_portal_t*		 portal;
 	aas_cluster_t*		 cluster;
-	aas_routingcache_t*	 cache;
+	unsigned short int*	 areatraveltimes;
 	aas_routingupdate_t *updateliststart, *updatelistend, *curupdate, *nextupdate;
 
-#ifdef ROUTING_DEBUG
-	numportalcacheupdates++;
-#endif // ROUTING_DEBUG
 	// clear the routing update fields
 	//	Com_Memset(aasworld.portalupdate, 0, (aasworld.numportals+1) * sizeof(aas_routingupdate_t));
 	//
-	curupdate				 = &aasworld.portalupdate[aasworld.numportals];
-	curupdate->cluster		 = portalcache->cluster;
-	curupdate->areanum		 = portalcache->areanum;
-	curupdate->tmptraveltime = portalcache->starttraveltime;
+	curupdate				 = &portalupdate[aasworld.numportals];
+	curupdate->cluster		 = clusternum;
+	curupdate->areanum		 = areanum;
+	curupdate->tmptraveltime = starttraveltime;
 	// if the start area is a cluster portal, store the travel time for that portal
-	clusternum = aasworld.areasettings[portalcache->areanum].cluster;
-	if( clusternum < 0 )
+	if( aasworld.areasettings[areanum].cluster < 0 )
 	{
-		portalcache->traveltimes[-clusternum] = portalcache->starttraveltime;
+		traveltimes[-aasworld.areasettings[areanum].cluster] = starttraveltime;
 	} // end if
 	// put the area to start with in the current read list
 	curupdate->next = NULL;
@@ -1672,7 +1946,7 @@ void AAS_UpdatePortalRoutingCache( aas_routingcache_t* portalcache )
 		//
 		cluster = &aasworld.clusters[curupdate->cluster];
 		//
-		cache = AAS_GetAreaRoutingCache( curupdate->cluster, curupdate->areanum, portalcache->travelflags );
+		areatraveltimes = areatraveltimesfunc( curupdate->cluster, curupdate->areanum, travelflags, context );
 		// take all portals of the cluster
 		for( i = 0; i < cluster->numportals; i++ )
 		{
@@ -1690,17 +1964,17 @@ void AAS_UpdatePortalRoutingCache( aas_routingcache_t* portalcache )
 				continue;
 			}
 			//
-			t = cache->traveltimes[clusterareanum];
+			t = areatraveltimes[clusterareanum];
 			if( !t )
 			{
 				continue;
 			}
 			t += curupdate->tmptraveltime;
 			//
-			if( !portalcache->traveltimes[portalnum] || portalcache->traveltimes[portalnum] > t )
+			if( !traveltimes[portalnum] || traveltimes[portalnum] > t )
 			{
-				portalcache->traveltimes[portalnum] = t;
-				nextupdate							= &aasworld.portalupdate[portalnum];
+				traveltimes[portalnum] = t;
+				nextupdate			   = &portalupdate[portalnum];
 				if( portal->frontcluster == curupdate->cluster )
 				{
 					nextupdate->cluster = portal->backcluster;
@@ -1733,6 +2007,30 @@ void AAS_UpdatePortalRoutingCache( aas_routingcache_t* portalcache )
 			} // end if
 		} // end for
 	} // end while
+} // end of the function AAS_CalculatePortalRouting
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static unsigned short int* AAS_CachedAreaTravelTimes( int clusternum, int areanum, int travelflags, void* context UNUSED_VAR )
+{
+	return AAS_GetAreaRoutingCache( clusternum, areanum, travelflags )->traveltimes;
+} // end of the function AAS_CachedAreaTravelTimes
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_UpdatePortalRoutingCache( aas_routingcache_t* portalcache )
+{
+#ifdef ROUTING_DEBUG
+	numportalcacheupdates++;
+#endif // ROUTING_DEBUG
+	AAS_CalculatePortalRouting( portalcache->cluster, portalcache->areanum, portalcache->travelflags, portalcache->starttraveltime, aasworld.portalupdate,
+		portalcache->traveltimes, AAS_CachedAreaTravelTimes, NULL );
 } // end of the function AAS_UpdatePortalRoutingCache
 //===========================================================================
 //
@@ -1745,30 +2043,11 @@ aas_routingcache_t* AAS_GetPortalRoutingCache( int clusternum, int areanum, int
 	aas_routingcache_t* cache;
 
 	// find the cached portal routing if existing
-	for( cache = aasworld.portalcache[areanum]; cache; cache = cache->next )
-	{
-		if( cache->travelflags == travelflags )
-		{
-			break;
-		}
-	} // end for
+	cache = AAS_FindPortalRoutingCache( areanum, travelflags );
 	// if the portal routing isn't cached
 	if( !cache )
 	{
-		cache		   = AAS_AllocRoutingCache( aasworld.numportals );
-		cache->cluster = clusternum;
-		cache->areanum = areanum;
-		VectorCopy( aasworld.areas[areanum].center, cache->origin );
-		cache->starttraveltime = 1;
-		cache->travelflags	   = travelflags;
-		// add the cache to the cache list
-		cache->prev = NULL;
-		cache->next = aasworld.portalcache[areanum];
-		if( aasworld.portalcache[areanum] )
-		{
-			aasworld.portalcache[areanum]->prev = cache;
-		}
-		aasworld.portalcache[areanum] = cache;
+		cache = AAS_NewRoutingCache( CACHETYPE_PORTAL, clusternum, areanum, travelflags );
 		// update the cache
 		AAS_UpdatePortalRoutingCache( cache );
 	} // end if
@@ -1778,23 +2057,135 @@ aas_routingcache_t* AAS_GetPortalRoutingCache( int clusternum, int areanum, int
 	} // end else
 	// the cache has been accessed
 	cache->time = AAS_RoutingTime();
-	cache->type = CACHETYPE_PORTAL;
 	AAS_LinkCache( cache );
 	return cache;
 } // end of the function AAS_GetPortalRoutingCache
 //===========================================================================
+// returns the route table block with the given travel flags
 //
 // Parameter:			-
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int travelflags, int* traveltime, int* reachnum )
+static ID_INLINE int AAS_RouteTableIndex( int travelflags )
+{
+	int i;
+
+	if( aasworld.routetable.numchangedareas )
+	{
+		return -1;
+	}
+	for( i = 0; i < aasworld.routetable.numtravelflags; i++ )
+	{
+		if( aasworld.routetable.travelflags[i] == travelflags )
+		{
+			return i;
+		}
+	} // end for
+	return -1;
+} // end of the function AAS_RouteTableIndex
+//===========================================================================
+// travel times and reachabilities of the reachability areas in the cluster
+// towards the goal area, from the route table if possible
+// shared lookups never create or relink caches and fail when not cached
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int AAS_AreaRouting( int clusternum, int areanum, int travelflags, int shared, unsigned short int** traveltimes, unsigned char** reachabilities )
+{
+	int					n, clusterareanum, numreachabilityareas, offset;
+	aas_routingcache_t* cache;
+
+	clusterareanum = AAS_ClusterAreaNum( clusternum, areanum );
+	n			   = AAS_RouteTableIndex( travelflags );
+	if( n >= 0 )
+	{
+		numreachabilityareas = aasworld.clusters[clusternum].numreachabilityareas;
+		// areas without reachabilities have no rows, their cache is empty anyway
+		if( clusterareanum < numreachabilityareas )
+		{
+			offset			= aasworld.routetable.clusteroffset[clusternum] + clusterareanum * numreachabilityareas;
+			*traveltimes	= aasworld.routetable.areatraveltimes[n] + offset;
+			*reachabilities = aasworld.routetable.areareachabilities[n] + offset;
+			return qtrue;
+		} // end if
+	} // end if
+	if( shared )
+	{
+		// only existing caches can be read without changing the cache lists
+		cache = AAS_FindAreaRoutingCache( clusternum, areanum, travelflags );
+		if( !cache )
+		{
+			return qfalse;
+		}
+	} // end if
+	else
+	{
+		cache = AAS_GetAreaRoutingCache( clusternum, areanum, travelflags );
+	} // end else
+	*traveltimes	= cache->traveltimes;
+	*reachabilities = cache->reachabilities;
+	return qtrue;
+} // end of the function AAS_AreaRouting
+//===========================================================================
+// travel times of all the portals towards the goal area, from the route
+// table if possible
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int AAS_PortalRouting( int clusternum, int areanum, int travelflags, int shared, unsigned short int** traveltimes, unsigned char** reachabilities )
+{
+	int					n, row;
+	aas_routingcache_t* cache;
+
+	n = AAS_RouteTableIndex( travelflags );
+	if( n >= 0 )
+	{
+		row = aasworld.routetable.portalrow[areanum];
+		if( row >= 0 )
+		{
+			*traveltimes	= aasworld.routetable.portaltraveltimes[n] + row * aasworld.numportals;
+			*reachabilities = aasworld.routetable.noreachabilities;
+			return qtrue;
+		} // end if
+	} // end if
+	if( shared )
+	{
+		cache = AAS_FindPortalRoutingCache( areanum, travelflags );
+		if( !cache )
+		{
+			return qfalse;
+		}
+	} // end if
+	else
+	{
+		cache = AAS_GetPortalRoutingCache( clusternum, areanum, travelflags );
+	} // end else
+	*traveltimes	= cache->traveltimes;
+	*reachabilities = cache->reachabilities;
+	return qtrue;
+} // end of the function AAS_PortalRouting
+//===========================================================================
+// with shared set the routing is only read, so it can run on several
+// threads at once as long as nothing else changes the routing meanwhile
+//
+// Parameter:			-
+// Returns:				qtrue if a route was found, ROUTE_UNCACHED if a
+//						shared lookup needs routing cache that doesn't exist
+// Changes Globals:		-
+//===========================================================================
+int AAS_AreaRoute( int areanum, vec3_t origin, int goalareanum, int travelflags, int shared, int* traveltime, int* reachnum )
 {
 	int					clusternum, goalclusternum, portalnum, i, clusterareanum, bestreachnum;
 	unsigned short int	t, besttime;
 	aas_portal_t*		portal;
 	aas_cluster_t*		cluster;
-	aas_routingcache_t *areacache, *portalcache;
+	unsigned short int *areatraveltimes, *portaltraveltimes;
+	unsigned char *		areareachabilities, *portalreachabilities;
 	aas_reachability_t* reach;
 
 	if( !aasworld.initialized )
@@ -1811,7 +2202,7 @@ int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int tr
 	// check !AAS_AreaReachability(areanum) with custom developer-only debug message
 	if( areanum <= 0 || areanum >= aasworld.numareas )
 	{
-		if( botDeveloper )
+		if( botDeveloper && !shared )
 		{
 			botimport.Print( PRT_ERROR, "AAS_AreaTravelTimeToGoalArea: areanum %d out of range\n", areanum );
 		} // end if
@@ -1819,7 +2210,7 @@ int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int tr
 	} // end if
 	if( goalareanum <= 0 || goalareanum >= aasworld.numareas )
 	{
-		if( botDeveloper )
+		if( botDeveloper && !shared )
 		{
 			botimport.Print( PRT_ERROR, "AAS_AreaTravelTimeToGoalArea: goalareanum %d out of range\n", goalareanum );
 		} // end if
@@ -1830,7 +2221,7 @@ int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int tr
 		return qfalse;
 	} // end if
 	// make sure the routing cache doesn't grow to large
-	while( AvailableMemory() < 1 * 1024 * 1024 )
+	while( !shared && AvailableMemory() < 1 * 1024 * 1024 )
 	{
 		if( !AAS_FreeOldestCache() )
 		{
@@ -1878,7 +2269,10 @@ int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int tr
 	if( clusternum > 0 && goalclusternum > 0 && clusternum == goalclusternum )
 	{
 		//
-		areacache = AAS_GetAreaRoutingCache( clusternum, goalareanum, travelflags );
+		if( !AAS_AreaRouting( clusternum, goalareanum, travelflags, shared, &areatraveltimes, &areareachabilities ) )
+		{
+			return ROUTE_UNCACHED;
+		}
 		// the number of the area in the cluster
 		clusterareanum = AAS_ClusterAreaNum( clusternum, areanum );
 		// the cluster the area is in
@@ -1889,16 +2283,16 @@ int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int tr
 			return 0;
 		}
 		// if it is possible to travel to the goal area through this cluster
-		if( areacache->traveltimes[clusterareanum] != 0 )
+		if( areatraveltimes[clusterareanum] != 0 )
 		{
-			*reachnum = aasworld.areasettings[areanum].firstreachablearea + areacache->reachabilities[clusterareanum];
+			*reachnum = aasworld.areasettings[areanum].firstreachablearea + areareachabilities[clusterareanum];
 			if( !origin )
 			{
-				*traveltime = areacache->traveltimes[clusterareanum];
+				*traveltime = areatraveltimes[clusterareanum];
 				return qtrue;
 			}
 			reach		= &aasworld.reachability[*reachnum];
-			*traveltime = areacache->traveltimes[clusterareanum] + AAS_AreaTravelTime( areanum, origin, reach->start );
+			*traveltime = areatraveltimes[clusterareanum] + AAS_AreaTravelTime( areanum, origin, reach->start );
 			//
 			return qtrue;
 		} // end if
@@ -1913,13 +2307,16 @@ int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int tr
 		portal		   = &aasworld.portals[-goalclusternum];
 		goalclusternum = portal->frontcluster;
 	} // end if
-	// get the portal routing cache
-	portalcache = AAS_GetPortalRoutingCache( goalclusternum, goalareanum, travelflags );
+	// get the portal routing
+	if( !AAS_PortalRouting( goalclusternum, goalareanum, travelflags, shared, &portaltraveltimes, &portalreachabilities ) )
+	{
+		return ROUTE_UNCACHED;
+	}
 	// if the area is a cluster portal, read directly from the portal cache
 	if( clusternum < 0 )
 	{
-		*traveltime = portalcache->traveltimes[-clusternum];
-		*reachnum	= aasworld.areasettings[areanum].firstreachablearea + portalcache->reachabilities[-clusternum];
+		*traveltime = portaltraveltimes[-clusternum];
+		*reachnum	= aasworld.areasettings[areanum].firstreachablearea + portalreachabilities[-clusternum];
 		return qtrue;
 	} // end if
 	//
@@ -1932,14 +2329,17 @@ int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int tr
 	{
 		portalnum = aasworld.portalindex[cluster->firstportal + i];
 		// if the goal area isn't reachable from the portal
-		if( !portalcache->traveltimes[portalnum] )
+		if( !portaltraveltimes[portalnum] )
 		{
 			continue;
 		}
 		//
 		portal = &aasworld.portals[portalnum];
 		// get the cache of the portal area
-		areacache = AAS_GetAreaRoutingCache( clusternum, portal->areanum, travelflags );
+		if( !AAS_AreaRouting( clusternum, portal->areanum, travelflags, shared, &areatraveltimes, &areareachabilities ) )
+		{
+			return ROUTE_UNCACHED;
+		}
 		// current area inside the current cluster
 		clusterareanum = AAS_ClusterAreaNum( clusternum, areanum );
 		// if the area is NOT a reachability area
@@ -1948,13 +2348,13 @@ int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int tr
 			continue;
 		}
 		// if the portal is NOT reachable from this area
-		if( !areacache->traveltimes[clusterareanum] )
+		if( !areatraveltimes[clusterareanum] )
 		{
 			continue;
 		}
 		// total travel time is the travel time the portal area is from
 		// the goal area plus the travel time towards the portal area
-		t = portalcache->traveltimes[portalnum] + areacache->traveltimes[clusterareanum];
+		t = portaltraveltimes[portalnum] + areatraveltimes[clusterareanum];
 		// FIXME: add the exact travel time through the actual portal area
 		// NOTE: for now we just add the largest travel time through the portal area
 		//		because we can't directly calculate the exact travel time
@@ -1964,7 +2364,7 @@ int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int tr
 		//
 		if( origin )
 		{
-			*reachnum = aasworld.areasettings[areanum].firstreachablearea + areacache->reachabilities[clusterareanum];
+			*reachnum = aasworld.areasettings[areanum].firstreachablearea + areareachabilities[clusterareanum];
 			reach	  = aasworld.reachability + *reachnum;
 			t += AAS_AreaTravelTime( areanum, origin, reach->start );
 		} // end if
@@ -1982,6 +2382,16 @@ int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int tr
 	*reachnum	= bestreachnum;
 	*traveltime = besttime;
 	return qtrue;
+} // end of the function AAS_AreaRoute
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int AAS_AreaRouteToGoalArea( int areanum, vec3_t origin, int goalareanum, int travelflags, int* traveltime, int* reachnum )
+{
+	return AAS_AreaRoute( areanum, origin, goalareanum, travelflags, qfalse, traveltime, reachnum );
 } // end of the function AAS_AreaRouteToGoalArea
 //===========================================================================
 //
@@ -2000,6 +2410,29 @@ int AAS_AreaTravelTimeToGoalArea( int areanum, vec3_t origin, int goalareanum, i
 	return 0;
 } // end of the function AAS_AreaTravelTimeToGoalArea
 //===========================================================================
+// travel time lookup that may run on several threads at once, it only
+// uses the route table and routing cache that already exist
+//
+// Parameter:			-
+// Returns:				travel time, 0 without route or -1 when not cached
+// Changes Globals:		-
+//===========================================================================
+int AAS_AreaTravelTimeToGoalAreaShared( int areanum, vec3_t origin, int goalareanum, int travelflags )
+{
+	int traveltime, reachnum = 0, result;
+
+	result = AAS_AreaRoute( areanum, origin, goalareanum, travelflags, qtrue, &traveltime, &reachnum );
+	if( result == ROUTE_UNCACHED )
+	{
+		return -1;
+	}
+	if( result )
+	{
+		return traveltime;
+	}
+	return 0;
+} // end of the function AAS_AreaTravelTimeToGoalAreaShared
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
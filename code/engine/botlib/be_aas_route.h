@@ -39,8 +39,22 @@ unsigned short int AAS_AreaTravelTime( int areanum, vec3_t start, vec3_t end );
 //
 void			   AAS_CreateAllRoutingCache();
 void			   AAS_WriteRouteCache();
+// true when the route table is mapped and all areas are in the state it was calculated for
+int				   AAS_RouteTableValid();
 //
 void			   AAS_RoutingInfo();
+// returns the travel times within the cluster towards the area
+typedef unsigned short int* ( *aas_areatraveltimesfunc_t )( int clusternum, int areanum, int travelflags, void* context );
+// calculate routing into cleared travel times using the update fields of the calling thread
+void			   AAS_CalculateAreaRouting( int clusternum, int areanum, int travelflags, unsigned short int starttraveltime, struct aas_routingupdate_s* areaupdate,
+				 unsigned short int* traveltimes, unsigned char* reachabilities );
+void AAS_CalculatePortalRouting( int clusternum, int areanum, int travelflags, unsigned short int starttraveltime, struct aas_routingupdate_s* portalupdate,
+	unsigned short int* traveltimes, aas_areatraveltimesfunc_t areatraveltimesfunc, void* context );
+// returns the existing routing cache or NULL
+struct aas_routingcache_s* AAS_FindAreaRoutingCache( int clusternum, int areanum, int travelflags );
+struct aas_routingcache_s* AAS_FindPortalRoutingCache( int areanum, int travelflags );
+// adds a copy of the given routing as new cache, qfalse if already cached
+int						   AAS_AddRoutingCache( int type, int clusternum, int areanum, int travelflags, unsigned short int* traveltimes, unsigned char* reachabilities );
 #endif // AASINTERN
 
 // returns the travel flag for the given travel type
@@ -59,6 +73,8 @@ int				   AAS_EnableRoutingArea( int areanum, int enable );
 unsigned short int AAS_AreaTravelTime( int areanum, vec3_t start, vec3_t end );
 // returns the travel time from the area to the goal area using the given travel flags
 int				   AAS_AreaTravelTimeToGoalArea( int areanum, vec3_t origin, int goalareanum, int travelflags );
+// same but only reads existing routing so it can run on the job threads, -1 if not cached
+int				   AAS_AreaTravelTimeToGoalAreaShared( int areanum, vec3_t origin, int goalareanum, int travelflags );
 // predict a route up to a stop event
 int				   AAS_PredictRoute(
 				   struct aas_predictroute_s* route, int areanum, vec3_t origin, int goalareanum, int travelflags, int maxareas, int maxtime, int stopevent, int stopcontents, int stoptfl, int stopareanum );
@@ -0,0 +1,646 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+/*****************************************************************************
+ * name:		be_aas_routewarm.c
+ *
+ * desc:		AAS background routing cache warming
+ *
+ * $Archive: /source/code/botlib/be_aas_routewarm.c $
+ *
+ *****************************************************************************/
+
+#include "q_shared.h"
+#include "l_utils.h"
+#include "l_memory.h"
+#include "l_log.h"
+#include "l_libvar.h"
+#include "l_script.h"
+#include "l_precomp.h"
+#include "l_struct.h"
+#include "aasfile.h"
+#include "botlib.h"
+#include "be_aas.h"
+#include "be_aas_funcs.h"
+#include "be_interface.h"
+#include "be_aas_def.h"
+
+/*
+
+  without a route table the first routing towards every goal area has to
+  calculate the area and portal routing cache, which shows up as spikes
+  during the first minutes on a map
+
+  after the routing is initialized a thread calculates the caches for all
+  goal areas, the areas of the entities bots go for most come first, the
+  thread only reads the AAS data and calculates into memory of its own
+
+  the main thread hands out a batch of goal areas at a time from
+  AAS_ContinueRouteWarming and publishes the finished batch as regular
+  routing caches, so the cache lists are never touched by the thread
+
+  the travel times within the clusters towards the portal areas, which every
+  portal routing update needs, are kept by the thread for all the batches
+
+*/
+
+#define WARM_TRAVELFLAGS   TFL_DEFAULT
+#define WARM_BATCHGOALS	   32
+#define WARM_WAITTIME	   100 // msec the thread waits for a batch before checking for quit
+
+#define PORTALAREA_NONE	   0 // travel times not calculated
+#define PORTALAREA_NEW	   1 // calculated during the last batch
+#define PORTALAREA_CACHED  2 // published as routing cache
+
+typedef struct aas_warmclass_s
+{
+	char* prefix;
+	int	  weight;
+} aas_warmclass_t;
+
+typedef struct aas_warmgoal_s
+{
+	int					areanum;
+	int					cluster; // cluster of the portal routing, front cluster for portals
+	unsigned short int* areatraveltimes;
+	unsigned char*		areareachabilities;
+	unsigned short int* portaltraveltimes;
+} aas_warmgoal_t;
+
+typedef struct aas_routewarm_s
+{
+	void*				 thread;
+	void*				 wake;
+	volatile int		 quit;
+	volatile int		 busy; // set when a batch is handed out, cleared by the thread when done
+	// bumped whenever an area changes routing state
+	int					 generation;
+	int					 batchgeneration;
+	// goal areas in the order they are warmed
+	int*				 goals;
+	int					 numgoals;
+	int					 nextgoal;
+	// the current batch
+	aas_warmgoal_t		 batch[WARM_BATCHGOALS];
+	int					 numbatch;
+	// memory of the thread
+	aas_routingupdate_t* areaupdate;
+	aas_routingupdate_t* portalupdate;
+	// travel times towards the portal areas, two per portal, one for each cluster
+	int					 portalareageneration;
+	unsigned short int** portalareatraveltimes;
+	unsigned char**		 portalareareachabilities;
+	unsigned char*		 portalareastate;
+	// statistics
+	int					 numbatches;
+	int					 numdiscarded;
+	int					 numpublished;
+	int					 numrestarts;
+	int					 finished;
+} aas_routewarm_t;
+
+// how popular the entities are as goals
+aas_warmclass_t warmclasses[] = {
+	{ "team_CTF_redflag", 8 },
+	{ "team_CTF_blueflag", 8 },
+	{ "weapon_", 4 },
+	{ "item_", 3 },
+	{ "ammo_", 2 },
+	{ "holdable_", 2 },
+	{ "info_player_", 1 },
+	{ "team_CTF_", 1 },
+	{ NULL, 0 } };
+
+extern int		routingcachesize;
+extern int		max_routingcachesize;
+
+aas_routewarm_t routewarm;
+static int*		warmgoalweights; // only valid while sorting the goals
+
+//===========================================================================
+// returns the travel times within the cluster towards the portal area,
+// calculated the first time they're needed
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static unsigned short int* AAS_WarmPortalArea( int portalnum, int clusternum )
+{
+	int			  n, numreachabilityareas;
+	aas_portal_t* portal;
+
+	portal = &aasworld.portals[portalnum];
+	n	   = portalnum * 2 + ( portal->frontcluster == clusternum ? 0 : 1 );
+	if( routewarm.portalareastate[n] == PORTALAREA_NONE )
+	{
+		numreachabilityareas = aasworld.clusters[clusternum].numreachabilityareas;
+		Com_Memset( routewarm.portalareatraveltimes[n], 0, numreachabilityareas * sizeof( unsigned short int ) );
+		Com_Memset( routewarm.portalareareachabilities[n], 0, numreachabilityareas * sizeof( unsigned char ) );
+		AAS_CalculateAreaRouting( clusternum, portal->areanum, WARM_TRAVELFLAGS, 1, routewarm.areaupdate, routewarm.portalareatraveltimes[n],
+			routewarm.portalareareachabilities[n] );
+		routewarm.portalareastate[n] = PORTALAREA_NEW;
+	} // end if
+	return routewarm.portalareatraveltimes[n];
+} // end of the function AAS_WarmPortalArea
+//===========================================================================
+// the portal routing update only asks for the goal area and portal areas,
+// always with WARM_TRAVELFLAGS
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static unsigned short int* AAS_WarmAreaTravelTimes( int clusternum, int areanum, int travelflags UNUSED_VAR, void* context )
+{
+	aas_warmgoal_t* goal;
+	int				areacluster;
+
+	goal		= ( aas_warmgoal_t* )context;
+	areacluster = aasworld.areasettings[areanum].cluster;
+	if( areacluster < 0 )
+	{
+		return AAS_WarmPortalArea( -areacluster, clusternum );
+	}
+	return goal->areatraveltimes;
+} // end of the function AAS_WarmAreaTravelTimes
+//===========================================================================
+// runs on the warming thread
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_WarmBatch()
+{
+	int				i, clusternum;
+	aas_warmgoal_t* goal;
+
+	// the portal area travel times are of no use when areas changed state
+	if( routewarm.portalareageneration != routewarm.batchgeneration )
+	{
+		Com_Memset( routewarm.portalareastate, PORTALAREA_NONE, aasworld.numportals * 2 );
+		routewarm.portalareageneration = routewarm.batchgeneration;
+	} // end if
+	for( i = 0; i < routewarm.numbatch && !routewarm.quit; i++ )
+	{
+		goal	   = &routewarm.batch[i];
+		clusternum = aasworld.areasettings[goal->areanum].cluster;
+		if( clusternum < 0 )
+		{
+			// the area routing of portals is kept with the other portal areas
+			goal->cluster = aasworld.portals[-clusternum].frontcluster;
+			AAS_WarmPortalArea( -clusternum, aasworld.portals[-clusternum].frontcluster );
+			AAS_WarmPortalArea( -clusternum, aasworld.portals[-clusternum].backcluster );
+		} // end if
+		else
+		{
+			goal->cluster = clusternum;
+			Com_Memset( goal->areatraveltimes, 0, aasworld.clusters[clusternum].numreachabilityareas * sizeof( unsigned short int ) );
+			Com_Memset( goal->areareachabilities, 0, aasworld.clusters[clusternum].numreachabilityareas * sizeof( unsigned char ) );
+			AAS_CalculateAreaRouting( clusternum, goal->areanum, WARM_TRAVELFLAGS, 1, routewarm.areaupdate, goal->areatraveltimes, goal->areareachabilities );
+		} // end else
+		Com_Memset( goal->portaltraveltimes, 0, aasworld.numportals * sizeof( unsigned short int ) );
+		AAS_CalculatePortalRouting(
+			goal->cluster, goal->areanum, WARM_TRAVELFLAGS, 1, routewarm.portalupdate, goal->portaltraveltimes, AAS_WarmAreaTravelTimes, goal );
+	} // end for
+} // end of the function AAS_WarmBatch
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_RouteWarmThread( void* arg UNUSED_VAR )
+{
+	while( !routewarm.quit )
+	{
+		if( !botimport.WaitSignal( routewarm.wake, WARM_WAITTIME ) )
+		{
+			continue;
+		}
+		if( routewarm.quit || !routewarm.busy )
+		{
+			continue;
+		}
+		// see the batch as handed out by the main thread
+		botimport.MemoryBarrier();
+		AAS_WarmBatch();
+		// the results have to be visible before the batch is done
+		botimport.MemoryBarrier();
+		routewarm.busy = qfalse;
+	} // end while
+} // end of the function AAS_RouteWarmThread
+//===========================================================================
+// publishes the finished batch as routing caches
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_PublishWarmBatch()
+{
+	int				i, n, portalnum, clusternum;
+	aas_warmgoal_t* goal;
+
+	for( i = 0; i < routewarm.numbatch; i++ )
+	{
+		goal = &routewarm.batch[i];
+		if( aasworld.areasettings[goal->areanum].cluster > 0 )
+		{
+			routewarm.numpublished +=
+				AAS_AddRoutingCache( CACHETYPE_AREA, goal->cluster, goal->areanum, WARM_TRAVELFLAGS, goal->areatraveltimes, goal->areareachabilities );
+		} // end if
+		routewarm.numpublished += AAS_AddRoutingCache( CACHETYPE_PORTAL, goal->cluster, goal->areanum, WARM_TRAVELFLAGS, goal->portaltraveltimes, NULL );
+	} // end for
+	for( n = 0; n < aasworld.numportals * 2; n++ )
+	{
+		if( routewarm.portalareastate[n] != PORTALAREA_NEW )
+		{
+			continue;
+		}
+		portalnum  = n >> 1;
+		clusternum = ( n & 1 ) ? aasworld.portals[portalnum].backcluster : aasworld.portals[portalnum].frontcluster;
+		routewarm.numpublished += AAS_AddRoutingCache( CACHETYPE_AREA, clusternum, aasworld.portals[portalnum].areanum, WARM_TRAVELFLAGS,
+			routewarm.portalareatraveltimes[n], routewarm.portalareareachabilities[n] );
+		routewarm.portalareastate[n] = PORTALAREA_CACHED;
+	} // end for
+} // end of the function AAS_PublishWarmBatch
+//===========================================================================
+// returns true if all the routing cache of the goal area already exists
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_WarmGoalCached( int areanum )
+{
+	int clusternum;
+
+	clusternum = aasworld.areasettings[areanum].cluster;
+	if( clusternum > 0 && !AAS_FindAreaRoutingCache( clusternum, areanum, WARM_TRAVELFLAGS ) )
+	{
+		return qfalse;
+	}
+	return AAS_FindPortalRoutingCache( areanum, WARM_TRAVELFLAGS ) != NULL;
+} // end of the function AAS_WarmGoalCached
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_WarmGoalCompare( const void* a, const void* b )
+{
+	int areanum1, areanum2;
+
+	areanum1 = *( const int* )a;
+	areanum2 = *( const int* )b;
+	if( warmgoalweights[areanum1] != warmgoalweights[areanum2] )
+	{
+		return warmgoalweights[areanum2] - warmgoalweights[areanum1];
+	}
+	return areanum1 - areanum2;
+} // end of the function AAS_WarmGoalCompare
+//===========================================================================
+// sorts the goal areas on how popular the entities in them are as goals,
+// areas without entities follow in area order
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_WarmGoalOrder()
+{
+	int				 ent, areanum, i;
+	char			 classname[MAX_EPAIRKEY];
+	vec3_t			 origin, goalorigin;
+	vec3_t			 mins = { -15, -15, -15 }, maxs = { 15, 15, 15 };
+	aas_warmclass_t* wc;
+
+	warmgoalweights = ( int* )GetClearedMemory( aasworld.numareas * sizeof( int ) );
+	for( ent = AAS_NextBSPEntity( 0 ); ent; ent = AAS_NextBSPEntity( ent ) )
+	{
+		if( !AAS_ValueForBSPEpairKey( ent, "classname", classname, MAX_EPAIRKEY ) )
+		{
+			continue;
+		}
+		for( wc = warmclasses; wc->prefix; wc++ )
+		{
+			if( !Q_strncmp( classname, wc->prefix, strlen( wc->prefix ) ) )
+			{
+				break;
+			}
+		} // end for
+		if( !wc->prefix || !AAS_VectorForBSPEpairKey( ent, "origin", origin ) )
+		{
+			continue;
+		}
+		areanum = AAS_BestReachableArea( origin, mins, maxs, goalorigin );
+		if( areanum )
+		{
+			warmgoalweights[areanum] += wc->weight;
+		}
+	} // end for
+	routewarm.goals	   = ( int* )GetMemory( aasworld.numareas * sizeof( int ) );
+	routewarm.numgoals = 0;
+	for( i = 1; i < aasworld.numareas; i++ )
+	{
+		if( !aasworld.areasettings[i].numreachableareas || !aasworld.areasettings[i].cluster )
+		{
+			continue;
+		}
+		routewarm.goals[routewarm.numgoals++] = i;
+	} // end for
+	qsort( routewarm.goals, routewarm.numgoals, sizeof( int ), AAS_WarmGoalCompare );
+	FreeMemory( warmgoalweights );
+	warmgoalweights = NULL;
+} // end of the function AAS_WarmGoalOrder
+//===========================================================================
+// allocates everything the thread uses, before the thread is started
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_AllocRouteWarming()
+{
+	int	  i, n, size, maxreachabilityareas;
+	char* ptr;
+
+	maxreachabilityareas = 0;
+	for( i = 0; i < aasworld.numclusters; i++ )
+	{
+		if( aasworld.clusters[i].numreachabilityareas > maxreachabilityareas )
+		{
+			maxreachabilityareas = aasworld.clusters[i].numreachabilityareas;
+		} // end if
+	} // end for
+	routewarm.areaupdate   = ( aas_routingupdate_t* )GetClearedMemory( maxreachabilityareas * sizeof( aas_routingupdate_t ) );
+	routewarm.portalupdate = ( aas_routingupdate_t* )GetClearedMemory( ( aasworld.numportals + 1 ) * sizeof( aas_routingupdate_t ) );
+	// batch goals
+	size = WARM_BATCHGOALS * ( maxreachabilityareas * ( sizeof( unsigned short int ) + sizeof( unsigned char ) ) + aasworld.numportals * sizeof( unsigned short int ) );
+	ptr	 = ( char* )GetMemory( size );
+	for( i = 0; i < WARM_BATCHGOALS; i++ )
+	{
+		routewarm.batch[i].portaltraveltimes = ( unsigned short int* )ptr;
+		ptr += aasworld.numportals * sizeof( unsigned short int );
+		routewarm.batch[i].areatraveltimes = ( unsigned short int* )ptr;
+		ptr += maxreachabilityareas * sizeof( unsigned short int );
+		routewarm.batch[i].areareachabilities = ( unsigned char* )ptr;
+		ptr += maxreachabilityareas * sizeof( unsigned char );
+	} // end for
+	// portal area travel times
+	size = aasworld.numportals * 2 * ( sizeof( unsigned short int* ) + sizeof( unsigned char* ) + sizeof( unsigned char ) );
+	for( i = 0; i < aasworld.numportals; i++ )
+	{
+		size += aasworld.clusters[aasworld.portals[i].frontcluster].numreachabilityareas * ( sizeof( unsigned short int ) + sizeof( unsigned char ) );
+		size += aasworld.clusters[aasworld.portals[i].backcluster].numreachabilityareas * ( sizeof( unsigned short int ) + sizeof( unsigned char ) );
+	} // end for
+	ptr								   = ( char* )GetClearedMemory( size );
+	routewarm.portalareatraveltimes	   = ( unsigned short int** )ptr;
+	routewarm.portalareareachabilities = ( unsigned char** )( routewarm.portalareatraveltimes + aasworld.numportals * 2 );
+	ptr								   = ( char* )( routewarm.portalareareachabilities + aasworld.numportals * 2 );
+	for( n = 0; n < aasworld.numportals * 2; n++ )
+	{
+		i = ( n & 1 ) ? aasworld.portals[n >> 1].backcluster : aasworld.portals[n >> 1].frontcluster;
+		routewarm.portalareatraveltimes[n] = ( unsigned short int* )ptr;
+		ptr += aasworld.clusters[i].numreachabilityareas * sizeof( unsigned short int );
+	} // end for
+	for( n = 0; n < aasworld.numportals * 2; n++ )
+	{
+		i = ( n & 1 ) ? aasworld.portals[n >> 1].backcluster : aasworld.portals[n >> 1].frontcluster;
+		routewarm.portalareareachabilities[n] = ( unsigned char* )ptr;
+		ptr += aasworld.clusters[i].numreachabilityareas * sizeof( unsigned char );
+	} // end for
+	routewarm.portalareastate = ( unsigned char* )ptr;
+} // end of the function AAS_AllocRouteWarming
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_FreeRouteWarming()
+{
+	if( routewarm.areaupdate )
+	{
+		FreeMemory( routewarm.areaupdate );
+	}
+	if( routewarm.portalupdate )
+	{
+		FreeMemory( routewarm.portalupdate );
+	}
+	if( routewarm.batch[0].portaltraveltimes )
+	{
+		FreeMemory( routewarm.batch[0].portaltraveltimes );
+	}
+	if( routewarm.portalareatraveltimes )
+	{
+		FreeMemory( routewarm.portalareatraveltimes );
+	}
+	if( routewarm.goals )
+	{
+		FreeMemory( routewarm.goals );
+	}
+	// keep the statistics for AAS_RouteWarmingInfo
+	routewarm.thread				   = NULL;
+	routewarm.wake					   = NULL;
+	routewarm.areaupdate			   = NULL;
+	routewarm.portalupdate			   = NULL;
+	routewarm.portalareatraveltimes	   = NULL;
+	routewarm.portalareareachabilities = NULL;
+	routewarm.portalareastate		   = NULL;
+	routewarm.goals					   = NULL;
+	Com_Memset( routewarm.batch, 0, sizeof( routewarm.batch ) );
+	routewarm.numbatch = 0;
+} // end of the function AAS_FreeRouteWarming
+//===========================================================================
+// called once the routing is initialized
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_StartRouteWarming()
+{
+	AAS_StopRouteWarming();
+	Com_Memset( &routewarm, 0, sizeof( aas_routewarm_t ) );
+	if( !( int )LibVarValue( "routewarming", "1" ) )
+	{
+		return;
+	}
+	// all goals can be looked up in the route table
+	if( AAS_RouteTableValid() )
+	{
+		return;
+	}
+	if( !aasworld.numportals || !botimport.CreateThread )
+	{
+		return;
+	}
+	AAS_WarmGoalOrder();
+	AAS_AllocRouteWarming();
+	routewarm.wake	 = botimport.CreateSignal();
+	routewarm.thread = routewarm.wake ? botimport.CreateThread( AAS_RouteWarmThread, NULL ) : NULL;
+	if( !routewarm.thread )
+	{
+		botimport.Print( PRT_WARNING, "couldn't start the routing cache warming thread\n" );
+		if( routewarm.wake )
+		{
+			botimport.DestroySignal( routewarm.wake );
+		}
+		AAS_FreeRouteWarming();
+		return;
+	} // end if
+	if( botDeveloper )
+	{
+		botimport.Print( PRT_MESSAGE, "warming routing cache for %d goal areas\n", routewarm.numgoals );
+	} // end if
+} // end of the function AAS_StartRouteWarming
+//===========================================================================
+// stops and joins the thread and frees all the warming memory, the caches
+// already published stay
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_StopRouteWarming()
+{
+	if( !routewarm.thread )
+	{
+		return;
+	}
+	routewarm.quit = qtrue;
+	botimport.MemoryBarrier();
+	botimport.RaiseSignal( routewarm.wake );
+	botimport.JoinThread( routewarm.thread );
+	botimport.DestroySignal( routewarm.wake );
+	AAS_FreeRouteWarming();
+} // end of the function AAS_StopRouteWarming
+//===========================================================================
+// an area changed routing state, the routing cache involving the area is
+// gone and whatever the thread is calculating now is out of date
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_RouteWarmingAreaChanged()
+{
+	if( !routewarm.thread )
+	{
+		return;
+	}
+	routewarm.generation++;
+	routewarm.nextgoal = 0;
+	routewarm.numrestarts++;
+} // end of the function AAS_RouteWarmingAreaChanged
+//===========================================================================
+// called every frame on the main thread, publishes the last batch once the
+// thread finished it and hands out the next one
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_ContinueRouteWarming()
+{
+	if( !routewarm.thread || routewarm.busy )
+	{
+		return;
+	}
+	// see the results of the thread
+	botimport.MemoryBarrier();
+	if( routewarm.numbatch )
+	{
+		if( routewarm.batchgeneration == routewarm.generation )
+		{
+			AAS_PublishWarmBatch();
+		}
+		else
+		{
+			routewarm.numdiscarded++;
+		}
+		routewarm.numbatch = 0;
+	} // end if
+	// stop when the route table got loaded or the cache would grow too large
+	if( AAS_RouteTableValid() || routingcachesize > max_routingcachesize / 2 )
+	{
+		if( botDeveloper )
+		{
+			botimport.Print( PRT_MESSAGE, "routing cache warming stopped at goal area %d of %d\n", routewarm.nextgoal, routewarm.numgoals );
+		} // end if
+		AAS_StopRouteWarming();
+		routewarm.finished = 2;
+		return;
+	} // end if
+	// next batch of goal areas without cache
+	while( routewarm.numbatch < WARM_BATCHGOALS && routewarm.nextgoal < routewarm.numgoals )
+	{
+		if( !AAS_WarmGoalCached( routewarm.goals[routewarm.nextgoal] ) )
+		{
+			routewarm.batch[routewarm.numbatch++].areanum = routewarm.goals[routewarm.nextgoal];
+		}
+		routewarm.nextgoal++;
+	} // end while
+	if( !routewarm.numbatch )
+	{
+		if( botDeveloper )
+		{
+			botimport.Print( PRT_MESSAGE, "routing cache warmed for %d goal areas, %d caches\n", routewarm.numgoals, routewarm.numpublished );
+		} // end if
+		AAS_StopRouteWarming();
+		routewarm.finished = 1;
+		return;
+	} // end if
+	routewarm.batchgeneration = routewarm.generation;
+	routewarm.numbatches++;
+	// the batch has to be visible before the thread sees it's busy
+	botimport.MemoryBarrier();
+	routewarm.busy = qtrue;
+	botimport.RaiseSignal( routewarm.wake );
+} // end of the function AAS_ContinueRouteWarming
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_RouteWarmingInfo()
+{
+	if( routewarm.thread )
+	{
+		botimport.Print( PRT_MESSAGE, "routing cache warming at goal area %d of %d, %d batches, %d caches published, %d batches discarded, %d restarts\n",
+			routewarm.nextgoal, routewarm.numgoals, routewarm.numbatches, routewarm.numpublished, routewarm.numdiscarded, routewarm.numrestarts );
+	} // end if
+	else if( routewarm.finished )
+	{
+		botimport.Print( PRT_MESSAGE, "routing cache warming %s at goal area %d of %d, %d caches published\n", routewarm.finished == 1 ? "finished" : "stopped",
+			routewarm.nextgoal, routewarm.numgoals, routewarm.numpublished );
+	} // end else if
+	else
+	{
+		botimport.Print( PRT_MESSAGE, "no routing cache warming\n" );
+	} // end else
+} // end of the function AAS_RouteWarmingInfo
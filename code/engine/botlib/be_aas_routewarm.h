@@ -0,0 +1,43 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+/*****************************************************************************
+ * name:		be_aas_routewarm.h
+ *
+ * desc:		AAS
+ *
+ * $Archive: /source/code/botlib/be_aas_routewarm.h $
+ *
+ *****************************************************************************/
+
+#ifdef AASINTERN
+// starts warming the routing cache on a thread of its own
+void AAS_StartRouteWarming();
+// stops the thread, the routing cache warmed so far stays
+void AAS_StopRouteWarming();
+// publishes finished routing cache and hands out more goal areas
+void AAS_ContinueRouteWarming();
+// an area was enabled or disabled for routing
+void AAS_RouteWarmingAreaChanged();
+// prints the warming progress
+void AAS_RouteWarmingInfo();
+#endif // AASINTERN
@@ -231,6 +231,59 @@ void AAS_FreeAASLinkedEntities()
 	aasworld.arealinkedentities = NULL;
 } // end of the function AAS_InitAASLinkedEntities
 //===========================================================================
+// copies the planes into the bsp nodes so sampling the tree reads a
+// single 32 byte node per level
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_InitSampleNodes()
+{
+	int				  i, j;
+	aas_node_t*		  node;
+	aas_plane_t*	  plane;
+	aas_samplenode_t* samplenode;
+
+	AAS_FreeSampleNodes();
+	//
+	aasworld.samplenodes = ( aas_samplenode_t* )GetClearedMemory( aasworld.numnodes * sizeof( aas_samplenode_t ) );
+	// node zero is a dummy used for solid leafs, it keeps pointing at itself
+	for( i = 1; i < aasworld.numnodes; i++ )
+	{
+		node	   = &aasworld.nodes[i];
+		plane	   = &aasworld.planes[node->planenum];
+		samplenode = &aasworld.samplenodes[i];
+		VectorCopy( plane->normal, samplenode->normal );
+		samplenode->dist		= plane->dist;
+		samplenode->children[0] = node->children[0];
+		samplenode->children[1] = node->children[1];
+		// the dot product with an axis is exactly the coordinate
+		samplenode->type = 3;
+		for( j = 0; j < 3; j++ )
+		{
+			if( plane->normal[j] == 1 && plane->normal[( j + 1 ) % 3] == 0 && plane->normal[( j + 2 ) % 3] == 0 )
+			{
+				samplenode->type = j;
+			}
+		} // end for
+	} // end for
+} // end of the function AAS_InitSampleNodes
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeSampleNodes()
+{
+	if( aasworld.samplenodes )
+	{
+		FreeMemory( aasworld.samplenodes );
+	}
+	aasworld.samplenodes = NULL;
+} // end of the function AAS_FreeSampleNodes
+//===========================================================================
 // returns the AAS area the point is in
 //
 // Parameter:				-
@@ -239,10 +292,9 @@ void AAS_FreeAASLinkedEntities()
 //===========================================================================
 int AAS_PointAreaNum( vec3_t point )
 {
-	int			 nodenum;
-	vec_t		 dist;
-	aas_node_t*	 node;
-	aas_plane_t* plane;
+	int				  nodenum;
+	vec_t			  dist;
+	aas_samplenode_t* node;
 
 	if( !aasworld.loaded )
 	{
@@ -254,7 +306,6 @@ int AAS_PointAreaNum( vec3_t point )
 	nodenum = 1;
 	while( nodenum > 0 )
 	{
-//		botimport.Print(PRT_MESSAGE, "[%d]", nodenum);
 #ifdef AAS_SAMPLE_DEBUG
 		if( nodenum >= aasworld.numnodes )
 		{
@@ -262,16 +313,15 @@ int AAS_PointAreaNum( vec3_t point )
 			return 0;
 		} // end if
 #endif // AAS_SAMPLE_DEBUG
-		node = &aasworld.nodes[nodenum];
-#ifdef AAS_SAMPLE_DEBUG
-		if( node->planenum < 0 || node->planenum >= aasworld.numplanes )
+		node = &aasworld.samplenodes[nodenum];
+		if( node->type < 3 )
 		{
-			botimport.Print( PRT_ERROR, "node->planenum = %d >= aasworld.numplanes = %d\n", node->planenum, aasworld.numplanes );
-			return 0;
-		} // end if
-#endif // AAS_SAMPLE_DEBUG
-		plane = &aasworld.planes[node->planenum];
-		dist  = DotProduct( point, plane->normal ) - plane->dist;
+			dist = point[node->type] - node->dist;
+		}
+		else
+		{
+			dist = DotProduct( point, node->normal ) - node->dist;
+		}
 		if( dist > 0 )
 		{
 			nodenum = node->children[0];
@@ -291,6 +341,79 @@ int AAS_PointAreaNum( vec3_t point )
 	return -nodenum;
 } // end of the function AAS_PointAreaNum
 //===========================================================================
+// stores the area each point is in, same as calling AAS_PointAreaNum for
+// every point.  Groups of points descend the tree side by side without
+// branching on the plane sides, so the node loads of the group overlap and
+// there are no mispredicted branches.  A point that reached an area or
+// solid waits in the dummy node zero until the whole group is done
+//
+// Parameter:				-
+// Returns:					number of points not in solid
+// Changes Globals:		-
+//===========================================================================
+#define SAMPLE_LANES 8
+
+int AAS_PointAreaNums( vec3_t* points, int* areanums, int numpoints )
+{
+	int				  i, lane, numlanes, numinarea, child, nodes;
+	int				  lanenode[SAMPLE_LANES], lanearea[SAMPLE_LANES];
+	float*			  lanepoint[SAMPLE_LANES];
+	vec_t			  dist;
+	aas_samplenode_t* node;
+
+	if( !aasworld.loaded )
+	{
+		botimport.Print( PRT_ERROR, "AAS_PointAreaNums: aas not loaded\n" );
+		for( i = 0; i < numpoints; i++ )
+		{
+			areanums[i] = 0;
+		} // end for
+		return 0;
+	} // end if
+
+	numinarea = 0;
+	for( i = 0; i < numpoints; i += SAMPLE_LANES )
+	{
+		numlanes = numpoints - i;
+		if( numlanes > SAMPLE_LANES )
+		{
+			numlanes = SAMPLE_LANES;
+		}
+		for( lane = 0; lane < SAMPLE_LANES; lane++ )
+		{
+			// spare lanes of the last group repeat the first point
+			lanepoint[lane] = points[i + ( lane < numlanes ? lane : 0 )];
+			// start with node 1 because node zero is a dummy used for solid leafs
+			lanenode[lane] = 1;
+			lanearea[lane] = 0;
+		} // end for
+		do
+		{
+			nodes = 0;
+			for( lane = 0; lane < SAMPLE_LANES; lane++ )
+			{
+				node = &aasworld.samplenodes[lanenode[lane]];
+				// the plain dot product, it's exact for axial planes as well
+				dist  = DotProduct( lanepoint[lane], node->normal ) - node->dist;
+				child = node->children[!( dist > 0 )];
+				// remember the area, areas and solid continue in node zero
+				lanearea[lane] = child < 0 ? -child : lanearea[lane];
+				lanenode[lane] = child > 0 ? child : 0;
+				nodes |= lanenode[lane];
+			} // end for
+		} while( nodes );
+		for( lane = 0; lane < numlanes; lane++ )
+		{
+			areanums[i + lane] = lanearea[lane];
+			if( lanearea[lane] )
+			{
+				numinarea++;
+			}
+		} // end for
+	} // end for
+	return numinarea;
+} // end of the function AAS_PointAreaNums
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -1293,6 +1416,55 @@ int AAS_BoxOnPlaneSide2( vec3_t absmins, vec3_t absmaxs, aas_plane_t* p )
 	return sides;
 } // end of the function AAS_BoxOnPlaneSide2
 //===========================================================================
+// same as AAS_BoxOnPlaneSide2 for the plane of the node, only the
+// coordinate along the axis is needed for axial planes
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int AAS_BoxOnSampleNodeSide( vec3_t absmins, vec3_t absmaxs, aas_samplenode_t* node )
+{
+	int	   i, sides;
+	float  dist1, dist2;
+	vec3_t corners[2];
+
+	if( node->type < 3 )
+	{
+		dist1 = absmaxs[node->type] - node->dist;
+		dist2 = absmins[node->type] - node->dist;
+	} // end if
+	else
+	{
+		for( i = 0; i < 3; i++ )
+		{
+			if( node->normal[i] < 0 )
+			{
+				corners[0][i] = absmins[i];
+				corners[1][i] = absmaxs[i];
+			} // end if
+			else
+			{
+				corners[1][i] = absmins[i];
+				corners[0][i] = absmaxs[i];
+			} // end else
+		} // end for
+		dist1 = DotProduct( node->normal, corners[0] ) - node->dist;
+		dist2 = DotProduct( node->normal, corners[1] ) - node->dist;
+	} // end else
+	sides = 0;
+	if( dist1 >= 0 )
+	{
+		sides = 1;
+	}
+	if( dist2 < 0 )
+	{
+		sides |= 2;
+	}
+
+	return sides;
+} // end of the function AAS_BoxOnSampleNodeSide
+//===========================================================================
 //
 // Parameter:				-
 // Returns:					-
@@ -1354,8 +1526,7 @@ aas_link_t* AAS_AASLinkEntity( vec3_t absmins, vec3_t absmaxs, int entnum )
 	int				 side, nodenum;
 	aas_linkstack_t	 linkstack[128];
 	aas_linkstack_t* lstack_p;
-	aas_node_t*		 aasnode;
-	aas_plane_t*	 plane;
+	aas_samplenode_t* aasnode;
 	aas_link_t *	 link, *areas;
 
 	if( !aasworld.loaded )
@@ -1433,11 +1604,9 @@ aas_link_t* AAS_AASLinkEntity( vec3_t absmins, vec3_t absmaxs, int entnum )
 			continue;
 		}
 		// the node to test against
-		aasnode = &aasworld.nodes[nodenum];
-		// the current node plane
-		plane = &aasworld.planes[aasnode->planenum];
-		// get the side(s) the box is situated relative to the plane
-		side = AAS_BoxOnPlaneSide2( absmins, absmaxs, plane );
+		aasnode = &aasworld.samplenodes[nodenum];
+		// get the side(s) the box is situated relative to the node plane
+		side = AAS_BoxOnSampleNodeSide( absmins, absmaxs, aasnode );
 		// if on the front side of the node
 		if( side & 1 )
 		{
@@ -30,6 +30,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *****************************************************************************/
 
 #ifdef AASINTERN
+void		 AAS_InitSampleNodes();
+void		 AAS_FreeSampleNodes();
 void		 AAS_InitAASLinkHeap();
 void		 AAS_InitAASLinkedEntities();
 void		 AAS_FreeAASLinkHeap();
@@ -62,6 +64,8 @@ int			AAS_BBoxAreas( vec3_t absmins, vec3_t absmaxs, int* areas, int maxareas );
 int			AAS_AreaInfo( int areanum, aas_areainfo_t* info );
 // returns the area the point is in
 int			AAS_PointAreaNum( vec3_t point );
+// stores the area each point is in and returns the number of points not in solid
+int			AAS_PointAreaNums( vec3_t* points, int* areanums, int numpoints );
 //
 int			AAS_PointReachabilityAreaIndex( vec3_t point );
 // returns the plane the given face is in
@@ -110,6 +110,7 @@ typedef struct bot_synonym_s
 {
 	char*				  string;
 	float				  weight;
+	int					  pattern; // pattern number in the chat automaton
 	struct bot_synonym_s* next;
 } bot_synonym_t;
 // list with synonyms
@@ -125,6 +126,7 @@ typedef struct bot_synonymlist_s
 typedef struct bot_matchstring_s
 {
 	char*					  string;
+	int						  pattern; // pattern number in the chat automaton
 	struct bot_matchstring_s* next;
 } bot_matchstring_t;
 
@@ -171,6 +173,33 @@ typedef struct bot_stringlist_s
 	struct bot_stringlist_s* next;
 } bot_stringlist_t;
 
+// Aho-Corasick automaton over all the match and synonym strings
+typedef struct bot_chatautomaton_s
+{
+	int			  numstates;
+	int			  numclasses;
+	int			  numpatterns;
+	int			  maxoutputs;			// most patterns ending at the same character
+	unsigned char charclass[256];		// upper case character to input class, 0 if in no pattern
+	int*		  transitions;			// numstates * numclasses next states
+	int*		  pattern;				// pattern ending in the state or -1
+	int*		  output;				// longest suffix state a pattern ends in, 0 if none
+	int*		  patternlength;
+} bot_chatautomaton_t;
+
+// the pattern occurrences in a message
+typedef struct bot_chatscan_s
+{
+	int	  valid;
+	char  string[MAX_MESSAGE_SIZE];
+	int*  first; // first occurrence of every pattern or -1
+	int*  last;
+	int	  numoccurrences;
+	int*  start; // offset in the message
+	int*  next;	 // next occurrence of the same pattern or -1
+	int*  occurrencepattern;
+} bot_chatscan_t;
+
 // chat state of a bot
 typedef struct bot_chatstate_s
 {
@@ -209,6 +238,10 @@ bot_synonymlist_t*	  synonyms = NULL;
 bot_randomlist_t*	  randomstrings = NULL;
 // reply chats
 bot_replychat_t*	  replychats = NULL;
+// automaton for matching all the strings above at once
+bot_chatautomaton_t*  chatautomaton = NULL;
+bot_chatscan_t		  chatscan;
+int					  chatpatternchars;
 
 //========================================================================
 //
@@ -618,10 +651,12 @@ char* StringContainsWord( char* str1, char* str2, int casesensitive )
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-void StringReplaceWords( char* string, char* synonym, char* replacement )
+int StringReplaceWords( char* string, char* synonym, char* replacement )
 {
 	char *str, *str2;
+	int	  numreplaced;
 
+	numreplaced = 0;
 	// find the synonym in the string
 	str = StringContainsWord( string, synonym, qfalse );
 	// if the synonym occurred in the string
@@ -643,12 +678,321 @@ void StringReplaceWords( char* string, char* synonym, char* replacement )
 			memmove( str + strlen( replacement ), str + strlen( synonym ), strlen( str + strlen( synonym ) ) + 1 );
 			// append the synonum replacement
 			Com_Memcpy( str, replacement, strlen( replacement ) );
+			numreplaced++;
 		} // end if
 		// find the next synonym in the string
 		str = StringContainsWord( str + strlen( replacement ), synonym, qfalse );
 	} // end if
+	return numreplaced;
 } // end of the function StringReplaceWords
 //===========================================================================
+// adds the string to the chat automaton, with pass 0 only the characters
+// are collected
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void BotAddChatPattern( char* string, int* pattern, int pass )
+{
+	int					 i, c, state, *next;
+	bot_chatautomaton_t* ca;
+
+	ca = chatautomaton;
+	// empty strings match anywhere and are never looked up
+	if( !*string )
+	{
+		return;
+	}
+	if( !pass )
+	{
+		for( i = 0; string[i]; i++ )
+		{
+			c = toupper( ( unsigned char )string[i] );
+			if( !ca->charclass[c] )
+			{
+				ca->charclass[c] = ca->numclasses++;
+			}
+		} // end for
+		chatpatternchars += i;
+		return;
+	} // end if
+	state = 0;
+	for( i = 0; string[i]; i++ )
+	{
+		next = &ca->transitions[state * ca->numclasses + ca->charclass[toupper( ( unsigned char )string[i] )]];
+		if( !*next )
+		{
+			*next = ca->numstates++;
+		}
+		state = *next;
+	} // end for
+	// the same string may be used several times
+	if( ca->pattern[state] < 0 )
+	{
+		ca->pattern[state]					 = ca->numpatterns;
+		ca->patternlength[ca->numpatterns++] = i;
+	} // end if
+	*pattern = ca->pattern[state];
+} // end of the function BotAddChatPattern
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void BotAddMatchPiecePatterns( bot_matchpiece_t* pieces, int pass )
+{
+	bot_matchpiece_t*  mp;
+	bot_matchstring_t* ms;
+
+	for( mp = pieces; mp; mp = mp->next )
+	{
+		if( mp->type != MT_STRING )
+		{
+			continue;
+		}
+		for( ms = mp->firststring; ms; ms = ms->next )
+		{
+			BotAddChatPattern( ms->string, &ms->pattern, pass );
+		} // end for
+	} // end for
+} // end of the function BotAddMatchPiecePatterns
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void BotAddChatPatterns( int pass )
+{
+	bot_matchtemplate_t* mt;
+	bot_replychat_t*	 rchat;
+	bot_replychatkey_t*	 key;
+	bot_synonymlist_t*	 syn;
+	bot_synonym_t*		 synonym;
+
+	for( mt = matchtemplates; mt; mt = mt->next )
+	{
+		BotAddMatchPiecePatterns( mt->first, pass );
+	} // end for
+	for( rchat = replychats; rchat; rchat = rchat->next )
+	{
+		for( key = rchat->keys; key; key = key->next )
+		{
+			if( key->flags & RCKFL_VARIABLES )
+			{
+				BotAddMatchPiecePatterns( key->match, pass );
+			} // end if
+		} // end for
+	} // end for
+	for( syn = synonyms; syn; syn = syn->next )
+	{
+		for( synonym = syn->firstsynonym; synonym; synonym = synonym->next )
+		{
+			BotAddChatPattern( synonym->string, &synonym->pattern, pass );
+		} // end for
+	} // end for
+} // end of the function BotAddChatPatterns
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void BotFreeChatAutomaton()
+{
+	if( !chatautomaton )
+	{
+		return;
+	}
+	FreeMemory( chatautomaton->transitions );
+	FreeMemory( chatautomaton->pattern );
+	FreeMemory( chatautomaton->patternlength );
+	FreeMemory( chatautomaton );
+	chatautomaton = NULL;
+	if( chatscan.first )
+	{
+		FreeMemory( chatscan.first );
+	}
+	Com_Memset( &chatscan, 0, sizeof( bot_chatscan_t ) );
+} // end of the function BotFreeChatAutomaton
+//===========================================================================
+// compiles all the match template, reply chat key and synonym strings into
+// one automaton so a message is scanned for all of them in a single pass
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void BotBuildChatAutomaton()
+{
+	int					 i, c, state, failstate, maxstates, head, tail;
+	int *				 fail, *queue, *numoutputs, *next;
+	bot_chatautomaton_t* ca;
+
+	BotFreeChatAutomaton();
+	//
+	ca				 = ( bot_chatautomaton_t* )GetClearedMemory( sizeof( bot_chatautomaton_t ) );
+	ca->numclasses	 = 1;
+	chatautomaton	 = ca;
+	chatpatternchars = 0;
+	BotAddChatPatterns( 0 );
+	if( !chatpatternchars )
+	{
+		FreeMemory( ca );
+		chatautomaton = NULL;
+		return;
+	} // end if
+	// a trie with a state for every character at most
+	maxstates		  = chatpatternchars + 1;
+	ca->transitions	  = ( int* )GetClearedMemory( maxstates * ca->numclasses * sizeof( int ) );
+	ca->pattern		  = ( int* )GetMemory( maxstates * 2 * sizeof( int ) );
+	ca->output		  = ca->pattern + maxstates;
+	ca->patternlength = ( int* )GetMemory( chatpatternchars * sizeof( int ) );
+	for( i = 0; i < maxstates; i++ )
+	{
+		ca->pattern[i] = -1;
+		ca->output[i]  = 0;
+	} // end for
+	ca->numstates = 1;
+	BotAddChatPatterns( 1 );
+	// breadth first set the failure states and turn the trie into a DFA
+	fail	   = ( int* )GetClearedMemory( ca->numstates * 3 * sizeof( int ) );
+	queue	   = fail + ca->numstates;
+	numoutputs = queue + ca->numstates;
+	head = tail = 0;
+	for( c = 0; c < ca->numclasses; c++ )
+	{
+		if( ca->transitions[c] )
+		{
+			queue[tail++] = ca->transitions[c];
+		}
+	} // end for
+	while( head < tail )
+	{
+		state			  = queue[head++];
+		numoutputs[state] = ( ca->pattern[state] >= 0 ) + numoutputs[ca->output[state]];
+		if( numoutputs[state] > ca->maxoutputs )
+		{
+			ca->maxoutputs = numoutputs[state];
+		}
+		for( c = 0; c < ca->numclasses; c++ )
+		{
+			next	  = &ca->transitions[state * ca->numclasses + c];
+			failstate = ca->transitions[fail[state] * ca->numclasses + c];
+			if( *next )
+			{
+				fail[*next]		  = failstate;
+				ca->output[*next] = ( ca->pattern[failstate] >= 0 ) ? failstate : ca->output[failstate];
+				queue[tail++]	  = *next;
+			} // end if
+			else
+			{
+				*next = failstate;
+			} // end else
+		} // end for
+	} // end while
+	FreeMemory( fail );
+	// memory to scan messages with
+	chatscan.first			   = ( int* )GetMemory( ( ca->numpatterns * 2 + MAX_MESSAGE_SIZE * ca->maxoutputs * 3 ) * sizeof( int ) );
+	chatscan.last			   = chatscan.first + ca->numpatterns;
+	chatscan.start			   = chatscan.last + ca->numpatterns;
+	chatscan.next			   = chatscan.start + MAX_MESSAGE_SIZE * ca->maxoutputs;
+	chatscan.occurrencepattern = chatscan.next + MAX_MESSAGE_SIZE * ca->maxoutputs;
+	for( i = 0; i < ca->numpatterns; i++ )
+	{
+		chatscan.first[i] = -1;
+	} // end for
+	chatscan.valid			= qfalse;
+	chatscan.numoccurrences = 0;
+	//
+	if( botDeveloper )
+	{
+		botimport.Print( PRT_MESSAGE, "chat automaton with %d strings, %d states, %d character classes\n", ca->numpatterns, ca->numstates, ca->numclasses );
+	} // end if
+} // end of the function BotBuildChatAutomaton
+//===========================================================================
+// finds all the pattern occurrences in the message, the last message is
+// remembered so every bot that looks at the same message shares the scan
+//
+// Parameter:			-
+// Returns:				NULL without automaton or if the message is too long
+// Changes Globals:		-
+//===========================================================================
+bot_chatscan_t* BotScanChatMessage( char* string )
+{
+	int					 i, n, len, state, p;
+	bot_chatautomaton_t* ca;
+
+	ca = chatautomaton;
+	if( !ca )
+	{
+		return NULL;
+	}
+	if( chatscan.valid && !strcmp( chatscan.string, string ) )
+	{
+		return &chatscan;
+	}
+	len = strlen( string );
+	if( len >= MAX_MESSAGE_SIZE )
+	{
+		return NULL;
+	}
+	// forget the occurrences in the last message
+	for( i = 0; i < chatscan.numoccurrences; i++ )
+	{
+		chatscan.first[chatscan.occurrencepattern[i]] = -1;
+	} // end for
+	chatscan.numoccurrences = 0;
+	strcpy( chatscan.string, string );
+	chatscan.valid = qtrue;
+	//
+	state = 0;
+	for( i = 0; i < len; i++ )
+	{
+		state = ca->transitions[state * ca->numclasses + ca->charclass[toupper( ( unsigned char )string[i] )]];
+		// all the patterns ending here
+		for( p = ( ca->pattern[state] >= 0 ) ? state : ca->output[state]; p; p = ca->output[p] )
+		{
+			n							  = chatscan.numoccurrences++;
+			chatscan.start[n]			  = i + 1 - ca->patternlength[ca->pattern[p]];
+			chatscan.next[n]			  = -1;
+			chatscan.occurrencepattern[n] = ca->pattern[p];
+			if( chatscan.first[ca->pattern[p]] < 0 )
+			{
+				chatscan.first[ca->pattern[p]] = n;
+			}
+			else
+			{
+				chatscan.next[chatscan.last[ca->pattern[p]]] = n;
+			}
+			chatscan.last[ca->pattern[p]] = n;
+		} // end for
+	} // end for
+	return &chatscan;
+} // end of the function BotScanChatMessage
+//===========================================================================
+// same as StringContains on the scanned message from the offset on
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int BotScanStringContains( bot_chatscan_t* scan, int pattern, int offset )
+{
+	int n;
+
+	for( n = scan->first[pattern]; n >= 0; n = scan->next[n] )
+	{
+		if( scan->start[n] >= offset )
+		{
+			return scan->start[n] - offset;
+		}
+	} // end for
+	return -1;
+} // end of the function BotScanStringContains
+//===========================================================================
 //
 // Parameter:				-
 // Returns:					-
@@ -800,6 +1144,7 @@ bot_synonymlist_t* BotLoadSynonyms( char* filename )
 							synonym->string = ptr;
 							ptr += len;
 							strcpy( synonym->string, token.string );
+							synonym->pattern = -1;
 							//
 							if( lastsynonym )
 							{
@@ -873,7 +1218,9 @@ void BotReplaceSynonyms( char* string, unsigned long int context )
 {
 	bot_synonymlist_t* syn;
 	bot_synonym_t*	   synonym;
+	bot_chatscan_t*	   scan;
 
+	scan = BotScanChatMessage( string );
 	for( syn = synonyms; syn; syn = syn->next )
 	{
 		if( !( syn->context & context ) )
@@ -882,7 +1229,20 @@ void BotReplaceSynonyms( char* string, unsigned long int context )
 		}
 		for( synonym = syn->firstsynonym->next; synonym; synonym = synonym->next )
 		{
-			StringReplaceWords( string, synonym->string, syn->firstsynonym->string );
+			// empty synonyms have no pattern and nothing to replace
+			if( !*synonym->string )
+			{
+				continue;
+			}
+			// a synonym not in the string can't be replaced
+			if( scan && synonym->pattern >= 0 && scan->first[synonym->pattern] < 0 )
+			{
+				continue;
+			}
+			if( StringReplaceWords( string, synonym->string, syn->firstsynonym->string ) && scan )
+			{
+				scan = BotScanChatMessage( string );
+			}
 		} // end for
 	} // end for
 } // end of the function BotReplaceSynonyms
@@ -897,7 +1257,9 @@ void BotReplaceWeightedSynonyms( char* string, unsigned long int context )
 	bot_synonymlist_t* syn;
 	bot_synonym_t *	   synonym, *replacement;
 	float			   weight, curweight;
+	bot_chatscan_t*	   scan;
 
+	scan = BotScanChatMessage( string );
 	for( syn = synonyms; syn; syn = syn->next )
 	{
 		if( !( syn->context & context ) )
@@ -926,11 +1288,18 @@ void BotReplaceWeightedSynonyms( char* string, unsigned long int context )
 		// replace all synonyms with the replacement
 		for( synonym = syn->firstsynonym; synonym; synonym = synonym->next )
 		{
-			if( synonym == replacement )
+			if( synonym == replacement || !*synonym->string )
 			{
 				continue;
 			}
-			StringReplaceWords( string, synonym->string, replacement->string );
+			if( scan && synonym->pattern >= 0 && scan->first[synonym->pattern] < 0 )
+			{
+				continue;
+			}
+			if( StringReplaceWords( string, synonym->string, replacement->string ) && scan )
+			{
+				scan = BotScanChatMessage( string );
+			}
 		} // end for
 	} // end for
 } // end of the function BotReplaceWeightedSynonyms
@@ -1412,6 +1781,7 @@ bot_matchpiece_t* BotLoadMatchPieces( source_t* source, char* endtoken )
 				matchstring			= ( bot_matchstring_t* )GetClearedHunkMemory( sizeof( bot_matchstring_t ) + strlen( token.string ) + 1 );
 				matchstring->string = ( char* )matchstring + sizeof( bot_matchstring_t );
 				strcpy( matchstring->string, token.string );
+				matchstring->pattern = -1;
 				if( !strlen( token.string ) )
 				{
 					emptystring = qtrue;
@@ -1581,7 +1951,7 @@ bot_matchtemplate_t* BotLoadMatchTemplates( char* matchfile )
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
-int StringsMatch( bot_matchpiece_t* pieces, bot_match_t* match )
+int StringsMatch( bot_matchpiece_t* pieces, bot_match_t* match, bot_chatscan_t* scan )
 {
 	int				   lastvariable, index;
 	char *			   strptr, *newstrptr;
@@ -1608,7 +1978,14 @@ int StringsMatch( bot_matchpiece_t* pieces, bot_match_t* match )
 					break;
 				} // end if
 				// Log_Write("MT_STRING: %s", mp->string);
-				index = StringContains( strptr, ms->string, qfalse );
+				if( scan && ms->pattern >= 0 )
+				{
+					index = BotScanStringContains( scan, ms->pattern, strptr - match->string );
+				}
+				else
+				{
+					index = StringContains( strptr, ms->string, qfalse );
+				}
 				if( index >= 0 )
 				{
 					newstrptr = strptr + index;
@@ -1663,6 +2040,7 @@ int BotFindMatch( char* str, bot_match_t* match, unsigned long int context )
 {
 	int					 i;
 	bot_matchtemplate_t* ms;
+	bot_chatscan_t*		 scan;
 
 	Q_strncpyz( match->string, str, MAX_MESSAGE_SIZE );
 	// remove any trailing enters
@@ -1670,6 +2048,8 @@ int BotFindMatch( char* str, bot_match_t* match, unsigned long int context )
 	{
 		match->string[strlen( match->string ) - 1] = '\0';
 	} // end while
+	// find all the match strings in one go
+	scan = BotScanChatMessage( match->string );
 	// compare the string with all the match strings
 	for( ms = matchtemplates; ms; ms = ms->next )
 	{
@@ -1683,7 +2063,7 @@ int BotFindMatch( char* str, bot_match_t* match, unsigned long int context )
 			match->variables[i].offset = -1;
 		}
 		//
-		if( StringsMatch( ms->first, match ) )
+		if( StringsMatch( ms->first, match, scan ) )
 		{
 			match->type	   = ms->type;
 			match->subtype = ms->subtype;
@@ -3049,6 +3429,7 @@ int BotReplyChat( int chatstate, char* message, int mcontext, int vcontext, char
 	bot_match_t			match, bestmatch;
 	int					bestpriority, num, found, res, numchatmessages, index;
 	bot_chatstate_t*	cs;
+	bot_chatscan_t*		scan;
 
 	cs = BotChatStateFromHandle( chatstate );
 	if( !cs )
@@ -3057,6 +3438,7 @@ int BotReplyChat( int chatstate, char* message, int mcontext, int vcontext, char
 	}
 	Com_Memset( &match, 0, sizeof( bot_match_t ) );
 	strcpy( match.string, message );
+	scan			= BotScanChatMessage( match.string );
 	bestpriority	= -1;
 	bestchatmessage = NULL;
 	bestrchat		= NULL;
@@ -3090,7 +3472,7 @@ int BotReplyChat( int chatstate, char* message, int mcontext, int vcontext, char
 			}
 			else if( key->flags & RCKFL_VARIABLES )
 			{
-				res = StringsMatch( key->match, &match );
+				res = StringsMatch( key->match, &match, scan );
 			}
 			else if( key->flags & RCKFL_STRING )
 			{
@@ -3460,6 +3842,8 @@ int BotSetupChatAI()
 		file	   = LibVarString( "rchatfile", "rchat.c" );
 		replychats = BotLoadReplyChat( file );
 	} // end if
+	// compile all the strings to match
+	BotBuildChatAutomaton();
 
 	InitConsoleMessageHeap();
 
@@ -3486,6 +3870,7 @@ void BotShutdownChatAI()
 			BotFreeChatState( i );
 		} // end if
 	} // end for
+	BotFreeChatAutomaton();
 	// free all cached chats
 	for( i = 0; i < MAX_CLIENTS; i++ )
 	{
@@ -169,6 +169,14 @@ typedef struct bot_goalstate_s
 	//
 	int					   avoidgoals[MAX_AVOIDGOALS];	   // goals to avoid
 	float				   avoidgoaltimes[MAX_AVOIDGOALS]; // times to avoid the goals
+	// level item travel times calculated by BotPrepareGoals
+	int					   prepareframe;		// value of goalprepareframe they are valid for
+	int					   preparedareanum;		// area they were calculated from
+	vec3_t				   preparedorigin;		// origin they were calculated from
+	int					   preparedtravelflags; // travel flags they were calculated with
+	int*				   itemtraveltimes;		// per level item heap slot, -1 if not known
+	int*				   itemgoalareas;		// goal area of the item at the time
+	int					   numitemtraveltimes;	// size of the above arrays
 } bot_goalstate_t;
 
 bot_goalstate_t* botgoalstates[MAX_CLIENTS + 1]; // FIXME: init?
@@ -179,6 +187,9 @@ levelitem_t*	 levelitemheap	= NULL;
 levelitem_t*	 freelevelitems = NULL;
 levelitem_t*	 levelitems		= NULL;
 int				 numlevelitems	= 0;
+int				 maxlevelitems	= 0;
+// incremented by every BotPrepareGoals
+int				 goalprepareframe = 0;
 // map locations
 maplocation_t*	 maplocations = NULL;
 // camp spots
@@ -384,6 +395,9 @@ void InitLevelItemHeap()
 
 	max_levelitems = ( int )LibVarValue( "max_levelitems", "256" );
 	levelitemheap  = ( levelitem_t* )GetClearedMemory( max_levelitems * sizeof( levelitem_t ) );
+	maxlevelitems  = max_levelitems;
+	// travel times prepared for the old heap are useless now
+	goalprepareframe++;
 
 	for( i = 0; i < max_levelitems - 1; i++ )
 	{
@@ -1435,6 +1449,146 @@ int BotGetSecondGoal( int goalstate, bot_goal_t* goal )
 	return qtrue;
 } // end of the function BotGetSecondGoal
 //===========================================================================
+// the area the bot chooses goals from
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int BotGoalArea( bot_goalstate_t* gs, vec3_t origin )
+{
+	int areanum;
+
+	areanum = BotReachabilityArea( origin, gs->client );
+	// if the bot is in solid or if the area the bot is in has no reachability links
+	if( !areanum || !AAS_AreaReachability( areanum ) )
+	{
+		// use the last valid area the bot was in
+		areanum = gs->lastreachabilityarea;
+	} // end if
+	return areanum;
+} // end of the function BotGoalArea
+//===========================================================================
+// travel time towards the level item, prepared by BotPrepareGoals if possible
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int BotItemTravelTime( bot_goalstate_t* gs, levelitem_t* li, int areanum, vec3_t origin, int travelflags )
+{
+	int n;
+
+	if( gs->prepareframe == goalprepareframe && gs->preparedareanum == areanum && gs->preparedtravelflags == travelflags && VectorCompare( gs->preparedorigin, origin ) )
+	{
+		n = li - levelitemheap;
+		if( gs->itemgoalareas[n] == li->goalareanum && gs->itemtraveltimes[n] >= 0 )
+		{
+			return gs->itemtraveltimes[n];
+		}
+	} // end if
+	return AAS_AreaTravelTimeToGoalArea( areanum, origin, li->goalareanum, travelflags );
+} // end of the function BotItemTravelTime
+//===========================================================================
+// runs on the job threads, it may only read the level items and the
+// routing and write the arrays of its own goal state
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void BotPrepareGoalJob( void* data, int index )
+{
+	bot_goalstate_t* gs;
+	levelitem_t*	 li;
+	int				 n;
+
+	gs = ( ( bot_goalstate_t** )data )[index];
+	for( li = levelitems; li; li = li->next )
+	{
+		n					 = li - levelitemheap;
+		gs->itemgoalareas[n] = li->goalareanum;
+		if( li->goalareanum <= 0 )
+		{
+			continue;
+		}
+		gs->itemtraveltimes[n] = AAS_AreaTravelTimeToGoalAreaShared( gs->preparedareanum, gs->preparedorigin, li->goalareanum, gs->preparedtravelflags );
+	} // end for
+} // end of the function BotPrepareGoalJob
+//===========================================================================
+// the bot areas are found on the calling thread because that traces, the
+// routing for all bots then runs on the job threads, routing that isn't
+// cached yet is left to the serial lookup when the bot chooses its goal
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotPrepareGoals( bot_goalprepare_t* prepare, int numprepare )
+{
+	int				 i, n, numgoalstates;
+	bot_goalstate_t* gs;
+	bot_goalstate_t* goalstates[MAX_CLIENTS];
+
+	// invalidates everything prepared before
+	goalprepareframe++;
+	//
+	if( !AAS_Loaded() || !levelitemheap )
+	{
+		return;
+	}
+	numgoalstates = 0;
+	for( i = 0; i < numprepare && numgoalstates < MAX_CLIENTS; i++ )
+	{
+		gs = BotGoalStateFromHandle( prepare[i].goalstate );
+		if( !gs || !gs->itemweightconfig )
+		{
+			continue;
+		}
+		gs->preparedareanum = BotGoalArea( gs, prepare[i].origin );
+		if( !gs->preparedareanum )
+		{
+			continue;
+		}
+		VectorCopy( prepare[i].origin, gs->preparedorigin );
+		gs->preparedtravelflags = prepare[i].travelflags;
+		if( gs->numitemtraveltimes != maxlevelitems )
+		{
+			if( gs->itemtraveltimes )
+			{
+				FreeMemory( gs->itemtraveltimes );
+			}
+			gs->itemtraveltimes	   = ( int* )GetMemory( maxlevelitems * 2 * sizeof( int ) );
+			gs->itemgoalareas	   = gs->itemtraveltimes + maxlevelitems;
+			gs->numitemtraveltimes = maxlevelitems;
+		} // end if
+		for( n = 0; n < maxlevelitems; n++ )
+		{
+			gs->itemtraveltimes[n] = -1;
+		} // end for
+		gs->prepareframe			= goalprepareframe;
+		goalstates[numgoalstates++] = gs;
+	} // end for
+	// most frames none of the bots choose a goal
+	if( !numgoalstates )
+	{
+		return;
+	}
+	botimport.RunJobs( BotPrepareGoalJob, goalstates, numgoalstates );
+} // end of the function BotPrepareGoals
+//===========================================================================
+// called when the routing changed, the prepared travel times may go
+// through areas that can't be used anymore
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotClearPreparedGoals()
+{
+	goalprepareframe++;
+} // end of the function BotClearPreparedGoals
+//===========================================================================
 // pops a new long term goal on the goal stack in the goalstate
 //
 // Parameter:				-
@@ -1461,13 +1615,7 @@ int BotChooseLTGItem( int goalstate, vec3_t origin, int* inventory, int travelfl
 		return qfalse;
 	}
 	// get the area the bot is in
-	areanum = BotReachabilityArea( origin, gs->client );
-	// if the bot is in solid or if the area the bot is in has no reachability links
-	if( !areanum || !AAS_AreaReachability( areanum ) )
-	{
-		// use the last valid area the bot was in
-		areanum = gs->lastreachabilityarea;
-	} // end if
+	areanum = BotGoalArea( gs, origin );
 	// remember the last area with reachabilities the bot was in
 	gs->lastreachabilityarea = areanum;
 	// if still in solid
@@ -1552,7 +1700,7 @@ int BotChooseLTGItem( int goalstate, vec3_t origin, int* inventory, int travelfl
 		if( weight > 0 )
 		{
 			// get the travel time towards the goal area
-			t = AAS_AreaTravelTimeToGoalArea( areanum, origin, li->goalareanum, travelflags );
+			t = BotItemTravelTime( gs, li, areanum, origin, travelflags );
 			// if the goal is reachable
 			if( t > 0 )
 			{
@@ -1668,13 +1816,7 @@ int BotChooseNBGItem( int goalstate, vec3_t origin, int* inventory, int travelfl
 		return qfalse;
 	}
 	// get the area the bot is in
-	areanum = BotReachabilityArea( origin, gs->client );
-	// if the bot is in solid or if the area the bot is in has no reachability links
-	if( !areanum || !AAS_AreaReachability( areanum ) )
-	{
-		// use the last valid area the bot was in
-		areanum = gs->lastreachabilityarea;
-	} // end if
+	areanum = BotGoalArea( gs, origin );
 	// remember the last area with reachabilities the bot was in
 	gs->lastreachabilityarea = areanum;
 	// if still in solid
@@ -1768,7 +1910,7 @@ int BotChooseNBGItem( int goalstate, vec3_t origin, int* inventory, int travelfl
 		if( weight > 0 )
 		{
 			// get the travel time towards the goal area
-			t = AAS_AreaTravelTimeToGoalArea( areanum, origin, li->goalareanum, travelflags );
+			t = BotItemTravelTime( gs, li, areanum, origin, travelflags );
 			// if the goal is reachable
 			if( t > 0 && t < maxtime )
 			{
@@ -2037,6 +2179,10 @@ void BotFreeGoalState( int handle )
 		return;
 	} // end if
 	BotFreeItemWeights( handle );
+	if( botgoalstates[handle]->itemtraveltimes )
+	{
+		FreeMemory( botgoalstates[handle]->itemtraveltimes );
+	}
 	FreeMemory( botgoalstates[handle] );
 	botgoalstates[handle] = NULL;
 } // end of the function BotFreeGoalState
@@ -216,6 +216,8 @@ int Export_BotLibShutdown()
 	LibVarDeAllocAll();
 	// remove all global defines from the pre compiler
 	PC_RemoveAllGlobalDefines();
+	// free the preprocessed script tokens
+	PC_ShutdownTokenCache();
 
 	// dump all allocated memory
 //	DumpMemory();
@@ -721,6 +723,7 @@ static void Init_AAS_Export( aas_export_t* aas )
 	// be_aas_sample.c
 	//--------------------------------------------
 	aas->AAS_PointAreaNum				= AAS_PointAreaNum;
+	aas->AAS_PointAreaNums				= AAS_PointAreaNums;
 	aas->AAS_PointReachabilityAreaIndex = AAS_PointReachabilityAreaIndex;
 	aas->AAS_TraceAreas					= AAS_TraceAreas;
 	aas->AAS_BBoxAreas					= AAS_BBoxAreas;
@@ -753,6 +756,7 @@ static void Init_AAS_Export( aas_export_t* aas )
 	//--------------------------------------------
 	aas->AAS_Swimming			   = AAS_Swimming;
 	aas->AAS_PredictClientMovement = AAS_PredictClientMovement;
+	aas->AAS_PredictionCacheStats  = AAS_PredictionCacheStats;
 }
 
 /*
@@ -847,6 +851,7 @@ static void Init_AI_Export( ai_export_t* ai )
 	ai->BotGetSecondGoal			  = BotGetSecondGoal;
 	ai->BotChooseLTGItem			  = BotChooseLTGItem;
 	ai->BotChooseNBGItem			  = BotChooseNBGItem;
+	ai->BotPrepareGoals				  = BotPrepareGoals;
 	ai->BotTouchingGoal				  = BotTouchingGoal;
 	ai->BotItemGoalInVisButNotVisible = BotItemGoalInVisButNotVisible;
 	ai->BotGetLevelItemGoal			  = BotGetLevelItemGoal;
@@ -64,6 +64,8 @@ typedef enum
 	#include "l_script.h"
 	#include "l_precomp.h"
 	#include "l_log.h"
+	#include "l_libvar.h"
+	#include "l_crc.h"
 #endif // BOTLIB
 
 #ifdef MEQCC
@@ -123,6 +125,123 @@ token_t *freetokens;					//free tokens from the heap
 // list with global defines added to every source loaded
 define_t*  globaldefines;
 
+#ifdef BOTLIB
+	#define TOKENCACHE_IDENT	 ( ( 'C' << 24 ) + ( 'T' << 16 ) + ( 'C' << 8 ) + 'P' ) // little endian "PCTC"
+	#define TOKENCACHE_VERSION	 1
+	#define TOKENCACHE_FOLDER	 "botcache"
+	#define TOKENCACHE_MAXFILES	 32
+
+// preprocessed token
+typedef struct pc_cachedtoken_s
+{
+	int			 string;	   // offset in the string pool
+	int			 type;		   // token type
+	int			 subtype;	   // token sub type
+	unsigned int intvalue;	   // integer value
+	float		 floatvalue;   // floating point value
+	int			 line;		   // line the token was on
+	short		 file;		   // file the token was read from
+	short		 linescrossed; // lines crossed in white space
+} pc_cachedtoken_t;
+
+// file that was read while preprocessing a source
+typedef struct pc_cachedfile_s
+{
+	char name[MAX_QPATH];
+	int	 length;
+	int	 crc;
+} pc_cachedfile_t;
+
+// header of the token cache block, the block is written to disk as is
+typedef struct pc_cacheheader_s
+{
+	int ident;
+	int version;
+	int definescrc; // checksum of the global defines
+	int numfiles;	// the source file itself and the files it includes
+	int numtokens;
+	int stringsize;
+} pc_cacheheader_t;
+
+// the preprocessed tokens of a source file
+typedef struct pc_tokencache_s
+{
+	char					path[MAX_QPATH]; // base folder and file name
+	int						users;			 // number of sources replaying the tokens
+	int						stored;			 // true when in the token store
+	int						size;			 // size of the block
+	pc_cacheheader_t*		header;			 // block with header, files, tokens and strings
+	pc_cachedfile_t*		files;
+	pc_cachedtoken_t*		tokens;
+	char*					strings;
+	struct pc_tokencache_s* next;
+} pc_tokencache_t;
+
+// the token store
+pc_tokencache_t* tokencaches;
+
+// state while preprocessing a source for the token cache
+int				 pc_recording;
+int				 pc_recordfailed;
+int				 pc_recordmessages;
+int				 pc_recordnumfiles;
+pc_cachedfile_t	 pc_recordfiles[TOKENCACHE_MAXFILES];
+script_t*		 pc_recordscripts[TOKENCACHE_MAXFILES];
+
+extern char		 basefolder[MAX_QPATH]; // l_script.c
+
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+void PC_SourcePosition( source_t* source, char** filename, int* line )
+{
+	pc_cachedtoken_t* token;
+
+	if( source->scriptstack )
+	{
+		*filename = source->scriptstack->filename;
+		*line	  = source->scriptstack->line;
+	} // end if
+	else if( source->cache && source->cachetoken > 0 )
+	{
+		token	  = &source->cache->tokens[source->cachetoken - 1];
+		*filename = source->cache->files[token->file].name;
+		*line	  = token->line;
+	} // end else if
+	else
+	{
+		*filename = source->filename;
+		*line	  = 0;
+	} // end else
+} // end of the function PC_SourcePosition
+//============================================================================
+// remembers a file read while preprocessing a source for the token cache
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+void PC_RecordScript( script_t* script )
+{
+	pc_cachedfile_t* file;
+
+	if( pc_recordnumfiles >= TOKENCACHE_MAXFILES || strlen( script->filename ) >= MAX_QPATH )
+	{
+		pc_recordfailed = qtrue;
+		return;
+	} // end if
+	file = &pc_recordfiles[pc_recordnumfiles];
+	Q_strncpyz( file->name, script->filename, sizeof( file->name ) );
+	file->length = script->length;
+	file->crc	 = CRC_ProcessString( ( unsigned char* )script->buffer, script->length );
+	pc_recordscripts[pc_recordnumfiles] = script;
+	pc_recordnumfiles++;
+} // end of the function PC_RecordScript
+#endif // BOTLIB
+
 //============================================================================
 //
 // Parameter:				-
@@ -133,12 +252,18 @@ void QDECL SourceError( source_t* source, char* str, ... )
 {
 	char	text[1024];
 	va_list ap;
+#ifdef BOTLIB
+	char*	filename;
+	int		line;
+#endif // BOTLIB
 
 	va_start( ap, str );
 	Q_vsnprintf( text, sizeof( text ), str, ap );
 	va_end( ap );
 #ifdef BOTLIB
-	botimport.Print( PRT_ERROR, "file %s, line %d: %s\n", source->scriptstack->filename, source->scriptstack->line, text );
+	PC_SourcePosition( source, &filename, &line );
+	botimport.Print( PRT_ERROR, "file %s, line %d: %s\n", filename, line, text );
+	pc_recordmessages++;
 #endif // BOTLIB
 #ifdef MEQCC
 	printf( "error: file %s, line %d: %s\n", source->scriptstack->filename, source->scriptstack->line, text );
@@ -157,12 +282,18 @@ void QDECL SourceWarning( source_t* source, char* str, ... )
 {
 	char	text[1024];
 	va_list ap;
+#ifdef BOTLIB
+	char*	filename;
+	int		line;
+#endif // BOTLIB
 
 	va_start( ap, str );
 	Q_vsnprintf( text, sizeof( text ), str, ap );
 	va_end( ap );
 #ifdef BOTLIB
-	botimport.Print( PRT_WARNING, "file %s, line %d: %s\n", source->scriptstack->filename, source->scriptstack->line, text );
+	PC_SourcePosition( source, &filename, &line );
+	botimport.Print( PRT_WARNING, "file %s, line %d: %s\n", filename, line, text );
+	pc_recordmessages++;
 #endif // BOTLIB
 #ifdef MEQCC
 	printf( "warning: file %s, line %d: %s\n", source->scriptstack->filename, source->scriptstack->line, text );
@@ -241,6 +372,12 @@ void PC_PushScript( source_t* source, script_t* script )
 	// push the script on the script stack
 	script->next		= source->scriptstack;
 	source->scriptstack = script;
+#ifdef BOTLIB
+	if( pc_recording )
+	{
+		PC_RecordScript( script );
+	}
+#endif // BOTLIB
 } // end of the function PC_PushScript
 //============================================================================
 //
@@ -3090,6 +3227,52 @@ int QuakeCMacro( source_t* source )
 	return qtrue;
 } // end of the function QuakeCMacro
 #endif // QUAKEC
+#ifdef BOTLIB
+//============================================================================
+// reads the next token of a source replayed from the token cache,
+// the tokens are already preprocessed
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+int PC_ReadCachedToken( source_t* source, token_t* token )
+{
+	pc_tokencache_t*  cache = source->cache;
+	pc_cachedtoken_t* t;
+	token_t*		  unread;
+
+	if( source->tokens )
+	{
+		// copy the unread token
+		Com_Memcpy( token, source->tokens, sizeof( token_t ) );
+		unread		   = source->tokens;
+		source->tokens = source->tokens->next;
+		PC_FreeToken( unread );
+	} // end if
+	else
+	{
+		if( source->cachetoken >= cache->header->numtokens )
+		{
+			return qfalse;
+		}
+		t = &cache->tokens[source->cachetoken++];
+		strcpy( token->string, cache->strings + t->string );
+		token->type			   = t->type;
+		token->subtype		   = t->subtype;
+		token->intvalue		   = t->intvalue;
+		token->floatvalue	   = t->floatvalue;
+		token->whitespace_p	   = NULL;
+		token->endwhitespace_p = NULL;
+		token->line			   = t->line;
+		token->linescrossed	   = t->linescrossed;
+		token->next			   = NULL;
+	} // end else
+	// copy token for unreading
+	Com_Memcpy( &source->token, token, sizeof( token_t ) );
+	return qtrue;
+} // end of the function PC_ReadCachedToken
+#endif // BOTLIB
 //============================================================================
 //
 // Parameter:				-
@@ -3100,6 +3283,13 @@ int PC_ReadToken( source_t* source, token_t* token )
 {
 	define_t* define;
 
+#ifdef BOTLIB
+	if( source->cache )
+	{
+		return PC_ReadCachedToken( source, token );
+	}
+#endif // BOTLIB
+
 	while( 1 )
 	{
 		if( !PC_ReadSourceToken( source, token ) )
@@ -3437,6 +3627,456 @@ void PC_SetPunctuations( source_t* source, punctuation_t* p )
 {
 	source->punctuations = p;
 } // end of the function PC_SetPunctuations
+#ifdef BOTLIB
+//============================================================================
+//
+// token cache
+//
+// The first time a source file is loaded it is preprocessed completely and
+// the resulting tokens are kept in the token store and written to
+// botcache/<path>.tok.  Later loads of the file, in this or a next session,
+// replay the tokens without lexing, directives or macro expansion.  The
+// cached tokens are only used while the checksums of the file, the files it
+// includes and the global defines still match.
+//
+//============================================================================
+
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+int PC_GlobalDefinesCRC()
+{
+	unsigned short crc;
+	define_t*	   define;
+	token_t*	   token;
+	char*		   ptr;
+
+	CRC_Init( &crc );
+	for( define = globaldefines; define; define = define->next )
+	{
+		for( ptr = define->name; *ptr; ptr++ )
+		{
+			CRC_ProcessByte( &crc, *ptr );
+		}
+		CRC_ProcessByte( &crc, '(' );
+		for( token = define->parms; token; token = token->next )
+		{
+			for( ptr = token->string; *ptr; ptr++ )
+			{
+				CRC_ProcessByte( &crc, *ptr );
+			}
+			CRC_ProcessByte( &crc, ',' );
+		} // end for
+		CRC_ProcessByte( &crc, ')' );
+		for( token = define->tokens; token; token = token->next )
+		{
+			for( ptr = token->string; *ptr; ptr++ )
+			{
+				CRC_ProcessByte( &crc, *ptr );
+			}
+			CRC_ProcessByte( &crc, ' ' );
+		} // end for
+		CRC_ProcessByte( &crc, '\n' );
+	} // end for
+	return CRC_Value( crc );
+} // end of the function PC_GlobalDefinesCRC
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+pc_tokencache_t* PC_AllocTokenCache( const char* path, int numfiles, int numtokens, int stringsize )
+{
+	pc_tokencache_t* cache;
+	int				 size;
+
+	size  = sizeof( pc_cacheheader_t ) + numfiles * sizeof( pc_cachedfile_t ) + numtokens * sizeof( pc_cachedtoken_t ) + stringsize;
+	cache = ( pc_tokencache_t* )GetClearedMemory( sizeof( pc_tokencache_t ) + size );
+	Q_strncpyz( cache->path, path, sizeof( cache->path ) );
+	cache->size	   = size;
+	cache->header  = ( pc_cacheheader_t* )( cache + 1 );
+	cache->files   = ( pc_cachedfile_t* )( cache->header + 1 );
+	cache->tokens  = ( pc_cachedtoken_t* )( cache->files + numfiles );
+	cache->strings = ( char* )( cache->tokens + numtokens );
+	//
+	cache->header->ident	  = TOKENCACHE_IDENT;
+	cache->header->version	  = TOKENCACHE_VERSION;
+	cache->header->numfiles	  = numfiles;
+	cache->header->numtokens  = numtokens;
+	cache->header->stringsize = stringsize;
+	return cache;
+} // end of the function PC_AllocTokenCache
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+void PC_ReleaseTokenCache( pc_tokencache_t* cache )
+{
+	if( cache->users <= 0 && !cache->stored )
+	{
+		FreeMemory( cache );
+	}
+} // end of the function PC_ReleaseTokenCache
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+void PC_UnlinkTokenCache( pc_tokencache_t* cache )
+{
+	pc_tokencache_t **prev, *c;
+
+	for( prev = &tokencaches, c = tokencaches; c; prev = &c->next, c = c->next )
+	{
+		if( c == cache )
+		{
+			*prev		  = c->next;
+			cache->stored = qfalse;
+			PC_ReleaseTokenCache( cache );
+			return;
+		} // end if
+	} // end for
+} // end of the function PC_UnlinkTokenCache
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+void PC_StoreTokenCache( pc_tokencache_t* cache )
+{
+	cache->stored = qtrue;
+	cache->next	  = tokencaches;
+	tokencaches	  = cache;
+} // end of the function PC_StoreTokenCache
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+pc_tokencache_t* PC_FindTokenCache( const char* path )
+{
+	pc_tokencache_t* cache;
+
+	for( cache = tokencaches; cache; cache = cache->next )
+	{
+		if( !Q_stricmp( cache->path, path ) )
+		{
+			return cache;
+		}
+	} // end for
+	return NULL;
+} // end of the function PC_FindTokenCache
+//============================================================================
+// returns true if the cached tokens were preprocessed from the current
+// versions of the files with the current global defines
+//
+// Parameter:				script: the source file itself
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+int PC_TokenCacheValid( pc_tokencache_t* cache, script_t* script )
+{
+	pc_cachedfile_t* file;
+	script_t*		 include;
+	int				 i, valid;
+
+	if( cache->header->definescrc != PC_GlobalDefinesCRC() )
+	{
+		return qfalse;
+	}
+	file = &cache->files[0];
+	if( file->length != script->length || file->crc != CRC_ProcessString( ( unsigned char* )script->buffer, script->length ) )
+	{
+		return qfalse;
+	}
+	for( i = 1; i < cache->header->numfiles; i++ )
+	{
+		file	= &cache->files[i];
+		include = LoadScriptFile( file->name );
+		if( !include )
+		{
+			return qfalse;
+		}
+		valid = ( file->length == include->length && file->crc == CRC_ProcessString( ( unsigned char* )include->buffer, include->length ) );
+		FreeScript( include );
+		if( !valid )
+		{
+			return qfalse;
+		}
+	} // end for
+	return qtrue;
+} // end of the function PC_TokenCacheValid
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+void PC_TokenCacheFileName( const char* path, char* filename, int size )
+{
+	Com_sprintf( filename, size, "%s/%s.tok", TOKENCACHE_FOLDER, path );
+} // end of the function PC_TokenCacheFileName
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+pc_tokencache_t* PC_ReadTokenCacheFile( const char* path )
+{
+	char			 filename[MAX_QPATH * 2];
+	fileHandle_t	 fp;
+	pc_cacheheader_t header;
+	pc_tokencache_t* cache;
+	pc_cachedtoken_t* token;
+	int				 length, i;
+
+	PC_TokenCacheFileName( path, filename, sizeof( filename ) );
+	length = botimport.FS_FOpenFile( filename, &fp, FS_READ );
+	if( !fp )
+	{
+		return NULL;
+	}
+	if( length < ( int )sizeof( pc_cacheheader_t ) )
+	{
+		botimport.FS_FCloseFile( fp );
+		return NULL;
+	} // end if
+	botimport.FS_Read( &header, sizeof( pc_cacheheader_t ), fp );
+	if( header.ident != TOKENCACHE_IDENT || header.version != TOKENCACHE_VERSION || header.numfiles < 1 || header.numfiles > TOKENCACHE_MAXFILES || header.numtokens < 0 ||
+		header.numtokens > length || header.stringsize < 1 || header.stringsize > length || ( size_t )length != sizeof( pc_cacheheader_t ) + header.numfiles * sizeof( pc_cachedfile_t ) + header.numtokens * sizeof( pc_cachedtoken_t ) + header.stringsize )
+	{
+		botimport.FS_FCloseFile( fp );
+		return NULL;
+	} // end if
+	cache = PC_AllocTokenCache( path, header.numfiles, header.numtokens, header.stringsize );
+	Com_Memcpy( cache->header, &header, sizeof( pc_cacheheader_t ) );
+	botimport.FS_Read( cache->files, length - sizeof( pc_cacheheader_t ), fp );
+	botimport.FS_FCloseFile( fp );
+	// don't trust the file
+	cache->strings[header.stringsize - 1] = '\0';
+	for( i = 0; i < header.numfiles; i++ )
+	{
+		cache->files[i].name[MAX_QPATH - 1] = '\0';
+	} // end for
+	for( i = 0; i < header.numtokens; i++ )
+	{
+		token = &cache->tokens[i];
+		if( token->string < 0 || token->string >= header.stringsize || strlen( cache->strings + token->string ) >= MAX_TOKEN || token->file < 0 || token->file >= header.numfiles )
+		{
+			FreeMemory( cache );
+			return NULL;
+		} // end if
+	} // end for
+	return cache;
+} // end of the function PC_ReadTokenCacheFile
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+void PC_WriteTokenCacheFile( pc_tokencache_t* cache )
+{
+	char		 filename[MAX_QPATH * 2];
+	fileHandle_t fp;
+
+	PC_TokenCacheFileName( cache->path, filename, sizeof( filename ) );
+	botimport.FS_FOpenFile( filename, &fp, FS_WRITE );
+	if( !fp )
+	{
+		return;
+	}
+	botimport.FS_Write( cache->header, cache->size, fp );
+	botimport.FS_FCloseFile( fp );
+} // end of the function PC_WriteTokenCacheFile
+//============================================================================
+// preprocesses the whole source and returns the tokens, complete is set
+// to false when the tokens can't be reused because of an error or warning
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+pc_tokencache_t* PC_RecordSource( source_t* source, const char* path, int* complete )
+{
+	pc_tokencache_t*  cache;
+	pc_cachedtoken_t *tokens, *t;
+	char*			  strings;
+	void*			  ptr;
+	token_t			  token;
+	int				   numtokens, maxtokens, stringsize, maxstrings, length, i;
+
+	pc_recording	  = qtrue;
+	pc_recordfailed	  = qfalse;
+	pc_recordmessages = 0;
+	pc_recordnumfiles = 0;
+	PC_RecordScript( source->scriptstack );
+	//
+	numtokens  = 0;
+	maxtokens  = 256;
+	tokens	   = ( pc_cachedtoken_t* )GetMemory( maxtokens * sizeof( pc_cachedtoken_t ) );
+	stringsize = 0;
+	maxstrings = 4096;
+	strings	   = ( char* )GetMemory( maxstrings );
+	//
+	while( PC_ReadToken( source, &token ) )
+	{
+		if( numtokens >= maxtokens )
+		{
+			ptr = GetMemory( maxtokens * 2 * sizeof( pc_cachedtoken_t ) );
+			Com_Memcpy( ptr, tokens, numtokens * sizeof( pc_cachedtoken_t ) );
+			FreeMemory( tokens );
+			tokens = ( pc_cachedtoken_t* )ptr;
+			maxtokens *= 2;
+		} // end if
+		length = strlen( token.string ) + 1;
+		while( stringsize + length > maxstrings )
+		{
+			ptr = GetMemory( maxstrings * 2 );
+			Com_Memcpy( ptr, strings, stringsize );
+			FreeMemory( strings );
+			strings = ( char* )ptr;
+			maxstrings *= 2;
+		} // end while
+		Com_Memcpy( strings + stringsize, token.string, length );
+		//
+		t				= &tokens[numtokens++];
+		t->string		= stringsize;
+		t->type			= token.type;
+		t->subtype		= token.subtype;
+		t->intvalue		= token.intvalue;
+		t->floatvalue	= token.floatvalue;
+		t->line			= token.line;
+		t->linescrossed = token.linescrossed > 0x7fff ? 0x7fff : token.linescrossed;
+		t->file			= 0;
+		for( i = pc_recordnumfiles - 1; i > 0; i-- )
+		{
+			if( pc_recordscripts[i] == source->scriptstack )
+			{
+				t->file = i;
+				break;
+			} // end if
+		} // end for
+		stringsize += length;
+		// values that don't fit the cache, unsigned long is 64 bits on some platforms
+		if( t->intvalue != token.intvalue )
+		{
+			pc_recordfailed = qtrue;
+		}
+	} // end while
+	// the whole file must have been read without complaints
+	*complete = !pc_recordfailed && !pc_recordmessages && !source->tokens && !source->indentstack && !source->scriptstack->next && EndOfScript( source->scriptstack );
+	pc_recording = qfalse;
+	//
+	cache = PC_AllocTokenCache( path, pc_recordnumfiles, numtokens, stringsize + 1 );
+	cache->header->definescrc = PC_GlobalDefinesCRC();
+	Com_Memcpy( cache->files, pc_recordfiles, pc_recordnumfiles * sizeof( pc_cachedfile_t ) );
+	Com_Memcpy( cache->tokens, tokens, numtokens * sizeof( pc_cachedtoken_t ) );
+	Com_Memcpy( cache->strings, strings, stringsize );
+	FreeMemory( tokens );
+	FreeMemory( strings );
+	return cache;
+} // end of the function PC_RecordSource
+//============================================================================
+// loads a source file through the token cache
+//
+// Parameter:				script: the loaded source file
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+source_t* PC_LoadCachedSource( const char* filename, script_t* script )
+{
+	char			 path[MAX_QPATH];
+	pc_tokencache_t* cache;
+	source_t*		 source;
+	int				 complete;
+
+	if( strlen( basefolder ) )
+	{
+		Com_sprintf( path, sizeof( path ), "%s/%s", basefolder, filename );
+	}
+	else
+	{
+		Com_sprintf( path, sizeof( path ), "%s", filename );
+	}
+	// try the token store
+	cache = PC_FindTokenCache( path );
+	if( cache && !PC_TokenCacheValid( cache, script ) )
+	{
+		PC_UnlinkTokenCache( cache );
+		cache = NULL;
+	} // end if
+	// try the cache file
+	if( !cache )
+	{
+		cache = PC_ReadTokenCacheFile( path );
+		if( cache )
+		{
+			if( PC_TokenCacheValid( cache, script ) )
+			{
+				PC_StoreTokenCache( cache );
+			}
+			else
+			{
+				FreeMemory( cache );
+				cache = NULL;
+			} // end else
+		} // end if
+	} // end if
+	if( cache )
+	{
+		FreeScript( script );
+	}
+	else
+	{
+		source = ( source_t* )GetClearedMemory( sizeof( source_t ) );
+		Q_strncpyz( source->filename, filename, sizeof( source->filename ) );
+		source->scriptstack = script;
+#if DEFINEHASHING
+		source->definehash = GetClearedMemory( DEFINEHASHSIZE * sizeof( define_t* ) );
+#endif // DEFINEHASHING
+		PC_AddGlobalDefinesToSource( source );
+		// preprocess the whole file once, errors and warnings are printed now
+		// and the replay ends where the source would have failed to read
+		cache = PC_RecordSource( source, path, &complete );
+		FreeSource( source );
+		if( complete )
+		{
+			PC_StoreTokenCache( cache );
+			PC_WriteTokenCacheFile( cache );
+		} // end if
+	} // end else
+	// replay the cached tokens, a replayed source has no scripts or defines
+	source = ( source_t* )GetClearedMemory( sizeof( source_t ) );
+	Q_strncpyz( source->filename, filename, sizeof( source->filename ) );
+	source->cache = cache;
+	cache->users++;
+	return source;
+} // end of the function PC_LoadCachedSource
+//============================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+void PC_ShutdownTokenCache()
+{
+	while( tokencaches )
+	{
+		PC_UnlinkTokenCache( tokencaches );
+	}
+} // end of the function PC_ShutdownTokenCache
+#endif // BOTLIB
 //============================================================================
 //
 // Parameter:			-
@@ -3458,6 +4098,13 @@ source_t* LoadSourceFile( const char* filename )
 
 	script->next = NULL;
 
+#ifdef BOTLIB
+	if( botlibglobals.botlibsetup && LibVarValue( "bot_tokencache", "1" ) )
+	{
+		return PC_LoadCachedSource( filename, script );
+	}
+#endif // BOTLIB
+
 	source = ( source_t* )GetMemory( sizeof( source_t ) );
 	Com_Memset( source, 0, sizeof( source_t ) );
 
@@ -3540,7 +4187,7 @@ void FreeSource( source_t* source )
 		PC_FreeToken( token );
 	} // end for
 #if DEFINEHASHING
-	for( i = 0; i < DEFINEHASHSIZE; i++ )
+	for( i = 0; source->definehash && i < DEFINEHASHSIZE; i++ )
 	{
 		while( source->definehash[i] )
 		{
@@ -3572,6 +4219,14 @@ void FreeSource( source_t* source )
 		FreeMemory( source->definehash );
 	}
 #endif // DEFINEHASHING
+#ifdef BOTLIB
+	// release the replayed tokens
+	if( source->cache )
+	{
+		source->cache->users--;
+		PC_ReleaseTokenCache( source->cache );
+	} // end if
+#endif // BOTLIB
 	// free the source itself
 	FreeMemory( source );
 } // end of the function FreeSource
@@ -3672,6 +4327,10 @@ int PC_ReadTokenHandle( int handle, pc_token_t* pc_token )
 //============================================================================
 int PC_SourceFileAndLine( int handle, char* filename, int* line )
 {
+#ifdef BOTLIB
+	char* name;
+#endif // BOTLIB
+
 	if( handle < 1 || handle >= MAX_SOURCEFILES )
 	{
 		return qfalse;
@@ -3682,6 +4341,13 @@ int PC_SourceFileAndLine( int handle, char* filename, int* line )
 	}
 
 	strcpy( filename, sourceFiles[handle]->filename );
+#ifdef BOTLIB
+	if( sourceFiles[handle]->cache )
+	{
+		PC_SourcePosition( sourceFiles[handle], &name, line );
+		return qtrue;
+	} // end if
+#endif // BOTLIB
 	if( sourceFiles[handle]->scriptstack )
 	{
 		*line = sourceFiles[handle]->scriptstack->line;
@@ -3717,7 +4383,7 @@ void PC_CheckOpenSourceHandles()
 		if( sourceFiles[i] )
 		{
 #ifdef BOTLIB
-			botimport.Print( PRT_ERROR, "file %s still open in precompiler\n", sourceFiles[i]->scriptstack->filename );
+			botimport.Print( PRT_ERROR, "file %s still open in precompiler\n", sourceFiles[i]->filename );
 #endif // BOTLIB
 		} // end if
 	} // end for
@@ -99,6 +99,8 @@ typedef struct source_s
 	indent_t*	   indentstack;		  // stack with indents
 	int			   skip;			  // > 0 if skipping conditional code
 	token_t		   token;			  // last read token
+	struct pc_tokencache_s* cache;	  // preprocessed tokens replayed instead of the scripts
+	int			   cachetoken;		  // next token to replay from the cache
 } source_t;
 
 // read a token from the source
@@ -172,3 +174,5 @@ int	 PC_FreeSourceHandle( int handle );
 int	 PC_ReadTokenHandle( int handle, pc_token_t* pc_token );
 int	 PC_SourceFileAndLine( int handle, char* filename, int* line );
 void PC_CheckOpenSourceHandles();
+// free the preprocessed tokens kept for source files
+void PC_ShutdownTokenCache();
@@ -75,6 +75,7 @@ cvar_t*			   cl_showSend;
 cvar_t*			   cl_timedemo;
 cvar_t*			   cl_timedemoLog;
 cvar_t*			   cl_autoRecordDemo;
+cvar_t*			   cl_deltaDictionary;
 cvar_t*			   cl_aviFrameRate;
 cvar_t*			   cl_aviMotionJpeg;
 cvar_t*			   cl_forceavidemo;
@@ -889,6 +890,14 @@ void		CL_Record_f()
 	MSG_WriteByte( &buf, svc_gamestate );
 	MSG_WriteLong( &buf, clc.serverCommandSequence );
 
+	// the recorded snapshots use the dictionary of the server
+	if( cl.useDeltaDictionary )
+	{
+		MSG_WriteByte( &buf, svc_deltaDictionary );
+		MSG_WriteDeltaDictionary( &buf, &cl.deltaDictionary );
+		buf.deltaDictionary = &cl.deltaDictionary;
+	}
+
 	// configstrings
 	for( i = 0; i < MAX_CONFIGSTRINGS; i++ )
 	{
@@ -2682,6 +2691,11 @@ void CL_CheckForResend()
 #endif
 				Info_SetValueForKey( info, "protocol", va( "%i", com_protocol->integer ) );
 			Info_SetValueForKey( info, "qport", va( "%i", port ) );
+			if( cl_deltaDictionary->integer )
+			{
+				// servers that don't know the key simply ignore it
+				Info_SetValueForKey( info, "deltaEncoding", va( "%i", DELTA_ENCODING_VERSION ) );
+			}
 			Info_SetValueForKey( info, "challenge", va( "%i", clc.challenge ) );
 
 			Com_sprintf( data, sizeof( data ), "connect \"%s\"", info );
@@ -3927,6 +3941,7 @@ void CL_Init()
 	cl_timedemo		  = Cvar_Get( "timedemo", "0", 0 );
 	cl_timedemoLog	  = Cvar_Get( "cl_timedemoLog", "", CVAR_ARCHIVE );
 	cl_autoRecordDemo = Cvar_Get( "cl_autoRecordDemo", "0", CVAR_ARCHIVE );
+	cl_deltaDictionary = Cvar_Get( "cl_deltaDictionary", "1", CVAR_ARCHIVE );
 	cl_aviFrameRate	  = Cvar_Get( "cl_aviFrameRate", "25", CVAR_ARCHIVE );
 	cl_aviMotionJpeg  = Cvar_Get( "cl_aviMotionJpeg", "1", CVAR_ARCHIVE );
 	cl_forceavidemo	  = Cvar_Get( "cl_forceavidemo", "0", 0 );
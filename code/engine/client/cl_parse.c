@@ -36,6 +36,7 @@ char* svc_strings[256] = {
 	"svc_EOF",
 	"svc_voipSpeex",
 	"svc_voipOpus",
+	"svc_deltaDictionary",
 };
 
 void SHOWNET( msg_t* msg, char* s )
@@ -528,6 +529,9 @@ void CL_ParseGamestate( msg_t* msg )
 	// wipe local client state
 	CL_ClearState();
 
+	// baselines are only dictionary coded if this gamestate sends a dictionary
+	msg->deltaDictionary = NULL;
+
 	// a gamestate always marks a server command sequence
 	clc.serverCommandSequence = MSG_ReadLong( msg );
 
@@ -564,6 +568,12 @@ void CL_ParseGamestate( msg_t* msg )
 			Com_Memcpy( cl.gameState.stringData + cl.gameState.dataCount, s, len + 1 );
 			cl.gameState.dataCount += len + 1;
 		}
+		else if( cmd == svc_deltaDictionary )
+		{
+			MSG_ReadDeltaDictionary( msg, &cl.deltaDictionary );
+			cl.useDeltaDictionary = qtrue;
+			msg->deltaDictionary  = &cl.deltaDictionary;
+		}
 		else if( cmd == svc_baseline )
 		{
 			newnum = MSG_ReadBits( msg, GENTITYNUM_BITS );
@@ -990,6 +1000,9 @@ void CL_ParseServerMessage( msg_t* msg )
 
 	MSG_Bitstream( msg );
 
+	// a gamestate in this message may still switch to the dictionary
+	msg->deltaDictionary = cl.useDeltaDictionary ? &cl.deltaDictionary : NULL;
+
 	// get the reliable sequence acknowledge number
 	clc.reliableAcknowledge = MSG_ReadLong( msg );
 	//
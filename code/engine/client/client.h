@@ -142,6 +142,9 @@ typedef struct
 
 	entityState_t entityBaselines[MAX_GENTITIES]; // for delta compression when not in previous frame
 
+	qboolean		  useDeltaDictionary; // the gamestate announced a delta dictionary
+	deltaDictionary_t deltaDictionary;
+
 	entityState_t parseEntities[MAX_PARSE_ENTITIES];
 } clientActive_t;
 
@@ -433,6 +436,7 @@ extern cvar_t*		  cl_inGameVideo;
 
 extern cvar_t*		  cl_lanForcePackets;
 extern cvar_t*		  cl_autoRecordDemo;
+extern cvar_t*		  cl_deltaDictionary;
 
 extern cvar_t*		  cl_consoleKeys;
 
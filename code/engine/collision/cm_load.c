@@ -228,7 +228,7 @@ void CMod_LoadBrushes( lump_t* l )
 {
 	dbrush_t* in;
 	cbrush_t* out;
-	int		  i, count;
+	int		  i, j, count;
 
 	in = ( void* )( cmod_base + l->fileofs );
 	if( l->filelen % sizeof( *in ) )
@@ -255,6 +255,15 @@ void CMod_LoadBrushes( lump_t* l )
 		out->contents = cm.shaders[out->shaderNum].contentFlags;
 
 		CM_BoundBrush( out );
+
+		if( out->numsides )
+		{
+			out->planes = CM_AllocPlaneBlocks( out->numsides );
+			for( j = 0; j < out->numsides; j++ )
+			{
+				CM_SetPlaneBlock( out->planes, j, out->sides[j].plane->normal, out->sides[j].plane->dist );
+			}
+		}
 	}
 }
 
@@ -783,6 +792,8 @@ void CMod_LoadSurfaces( lump_t* surfs, lump_t* verts, lump_t* indexesLump )
 
 			// create the internal facet structure
 			surface->sc = CM_GeneratePatchCollide( width, height, vertexes );
+			cm.maxSurfacePlanes = MAX( cm.maxSurfacePlanes, surface->sc->numPlanes );
+			CM_BuildFacetPlanes( surface->sc );
 		}
 		else if( LittleLong( in->surfaceType ) == MST_TRIANGLE_SOUP && ( cm.perPolyCollision || cm_forceTriangles->integer ) )
 		{
@@ -829,6 +840,8 @@ void CMod_LoadSurfaces( lump_t* surfs, lump_t* verts, lump_t* indexesLump )
 
 			// create the internal facet structure
 			surface->sc = CM_GenerateTriangleSoupCollide( numVertexes, vertexes, numIndexes, indexes );
+			cm.maxSurfacePlanes = MAX( cm.maxSurfacePlanes, surface->sc->numPlanes );
+			CM_BuildFacetPlanes( surface->sc );
 		}
 	}
 }
@@ -885,6 +898,8 @@ void CM_LoadMap( const char* name, qboolean clientload, int* checksum )
 	cm_showCurves	  = Cvar_Get( "cm_showCurves", "0", CVAR_CHEAT );
 	cm_showTriangles  = Cvar_Get( "cm_showTriangles", "0", CVAR_CHEAT );
 
+	CM_InitKernels();
+
 	Com_DPrintf( "CM_LoadMap( %s, %i )\n", name, clientload );
 
 	if( !strcmp( cm.name, name ) && clientload )
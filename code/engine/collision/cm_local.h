@@ -78,6 +78,7 @@ typedef struct
 	qboolean	  collided;	  // marker for optimisation
 	cbrushedge_t* edges;
 	int			  numEdges;
+	float*		  planes; // side planes in CM_PLANE_BLOCK SoA blocks, NULL for the box brush
 } cbrush_t;
 
 typedef struct cPlane_s
@@ -110,6 +111,7 @@ typedef struct cSurfaceCollide_s
 
 	int		  numFacets;
 	cFacet_t* facets;
+	float*	  facetPlanes; // facet surface planes in CM_PLANE_BLOCK SoA blocks
 } cSurfaceCollide_t;
 
 typedef struct
@@ -179,6 +181,8 @@ typedef struct
 	int			  checkcount; // incremented on each trace
 
 	qboolean	  perPolyCollision;
+
+	int			  maxSurfacePlanes; // most planes of any surface collide
 } clipMap_t;
 
 // keep 1/8 unit away to keep the position valid before network snapping
@@ -208,6 +212,20 @@ typedef struct
 	vec3_t offset;
 } sphere_t;
 
+// per thread state for traces that run off the main thread, where the brush
+// and surface checkcounts can't be used to skip items seen in an earlier leaf
+#define MAX_TRACE_CHECKS 512 // must be a power of two
+
+typedef struct
+{
+	int			checkcount;
+	int			checkStamps[MAX_TRACE_CHECKS];
+	const void* checks[MAX_TRACE_CHECKS];
+
+	qboolean*	frontFacing; // [cm.maxSurfacePlanes]
+	float*		intersection;
+} traceThread_t;
+
 typedef struct
 {
 	traceType_t type;
@@ -225,8 +243,51 @@ typedef struct
 	sphere_t	sphere;		 // sphere for oriented capsule collision
 	biSphere_t	biSphere;
 	qboolean	testLateralCollision; // whether or not to test for lateral collision
+	traceThread_t* thread;			  // NULL on the main thread
 } traceWork_t;
 
+// SIMD collision kernels, see cm_simd.c
+//
+// brush side planes and facet surface planes are also kept as blocks of
+// CM_PLANE_BLOCK normals and distances, { nx[8], ny[8], nz[8], dist[8] },
+// so they can be tested several at a time.  Unused lanes of the last block
+// face nowhere and lie far behind everything.
+#define CM_PLANE_BLOCK		  8
+#define CM_PLANE_BLOCK_FLOATS ( CM_PLANE_BLOCK * 4 )
+
+typedef struct
+{
+	float	 enterFrac;
+	float	 leaveFrac;
+	int		 leadSide; // brush side with the latest entry, -1 if none
+	qboolean startout;
+	qboolean getout;
+} brushClip_t;
+
+typedef struct
+{
+	const char* name;
+
+	// returns qfalse if the trace is completely in front of one of the
+	// planes, else fills in clip like the scalar loop in CM_TraceThroughBrush
+	qboolean ( *clipBrush )( const traceWork_t* tw, const cbrush_t* brush, brushClip_t* clip );
+
+	// returns qtrue if tw->start is behind all non axial planes of the brush
+	qboolean ( *startInBrush )( const traceWork_t* tw, const cbrush_t* brush );
+
+	// returns a bit for each facet of the block that is not completely in
+	// front of its surface plane
+	int ( *facetMask )( const traceWork_t* tw, const float* block );
+} cmKernels_t;
+
+extern const cmKernels_t* cm_kernels; // NULL for the plain C code
+extern cvar_t*			  cm_simd;
+
+void					  CM_InitKernels();
+float*					  CM_AllocPlaneBlocks( int numPlanes );
+void					  CM_SetPlaneBlock( float* blocks, int index, const vec3_t normal, float dist );
+void					  CM_BuildFacetPlanes( cSurfaceCollide_t* sc );
+
 typedef struct leafList_s
 {
 	int		 count;
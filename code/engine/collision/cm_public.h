@@ -40,6 +40,7 @@ int			 CM_TransformedPointContents( const vec3_t p, clipHandle_t model, const ve
 void		 CM_BoxTrace( trace_t* results, const vec3_t start, const vec3_t end, vec3_t mins, vec3_t maxs, clipHandle_t model, int brushmask, traceType_t type );
 void		 CM_TransformedBoxTrace(
 			trace_t* results, const vec3_t start, const vec3_t end, vec3_t mins, vec3_t maxs, clipHandle_t model, int brushmask, const vec3_t origin, const vec3_t angles, traceType_t type );
+void		 CM_BoxTraceBatch( trace_t* results, const traceRequest_t* requests, int count );
 void	 CM_BiSphereTrace( trace_t* results, const vec3_t start, const vec3_t end, float startRad, float endRad, clipHandle_t model, int mask );
 void	 CM_TransformedBiSphereTrace( trace_t* results, const vec3_t start, const vec3_t end, float startRad, float endRad, clipHandle_t model, int mask, const vec3_t origin );
 
@@ -65,6 +66,9 @@ int		 CM_MarkFragments( int numPoints, const vec3_t* points, const vec3_t projec
 
 void	 CM_DrawDebugSurface( void ( *drawPoly )( int color, int numPoints, float* points ) );
 
+// cm_simd.c
+void	 CM_KernelTest_f();
+
 #if defined( USE_BULLET )
 	#include <Bullet-C-Api.h>
 
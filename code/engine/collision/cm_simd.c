@@ -0,0 +1,866 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// cm_simd.c -- SSE and AVX2 versions of the inner plane loops of cm_trace.c
+
+#include "cm_local.h"
+
+#if( defined( __x86_64__ ) || defined( _M_X64 ) || id386_sse ) && !defined( C_ONLY )
+	#define CM_SIMD 1
+	#include <immintrin.h>
+	#if defined( _MSC_VER )
+		#include <intrin.h>
+	#endif
+#else
+	#define CM_SIMD 0
+#endif
+
+#if defined( __GNUC__ ) || defined( __clang__ )
+	#define CM_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#else
+	#define CM_TARGET_AVX2
+#endif
+
+// distance of the unused lanes, far enough behind any trace to never
+// be crossed, small enough to never overflow
+#define PLANE_BLOCK_FILL 1.0e30f
+
+const cmKernels_t* cm_kernels;
+cvar_t*			   cm_simd;
+
+/*
+===============================================================================
+
+PLANE BLOCKS
+
+===============================================================================
+*/
+
+/*
+==================
+CM_AllocPlaneBlocks
+
+Returns enough blocks for numPlanes, with every lane facing nowhere
+==================
+*/
+float* CM_AllocPlaneBlocks( int numPlanes )
+{
+	float* blocks;
+	int	   numBlocks;
+	int	   i;
+
+	numBlocks = ( numPlanes + CM_PLANE_BLOCK - 1 ) / CM_PLANE_BLOCK;
+	blocks	  = Hunk_Alloc( numBlocks * CM_PLANE_BLOCK_FLOATS * sizeof( float ), h_high );
+
+	// normals are zeroed by the hunk
+	for( i = 0; i < numBlocks; i++ )
+	{
+		blocks[i * CM_PLANE_BLOCK_FLOATS + 24] = PLANE_BLOCK_FILL;
+		blocks[i * CM_PLANE_BLOCK_FLOATS + 25] = PLANE_BLOCK_FILL;
+		blocks[i * CM_PLANE_BLOCK_FLOATS + 26] = PLANE_BLOCK_FILL;
+		blocks[i * CM_PLANE_BLOCK_FLOATS + 27] = PLANE_BLOCK_FILL;
+		blocks[i * CM_PLANE_BLOCK_FLOATS + 28] = PLANE_BLOCK_FILL;
+		blocks[i * CM_PLANE_BLOCK_FLOATS + 29] = PLANE_BLOCK_FILL;
+		blocks[i * CM_PLANE_BLOCK_FLOATS + 30] = PLANE_BLOCK_FILL;
+		blocks[i * CM_PLANE_BLOCK_FLOATS + 31] = PLANE_BLOCK_FILL;
+	}
+
+	return blocks;
+}
+
+/*
+==================
+CM_SetPlaneBlock
+==================
+*/
+void CM_SetPlaneBlock( float* blocks, int index, const vec3_t normal, float dist )
+{
+	float* block = blocks + ( index / CM_PLANE_BLOCK ) * CM_PLANE_BLOCK_FLOATS;
+	int	   lane	 = index % CM_PLANE_BLOCK;
+
+	block[lane]						 = normal[0];
+	block[lane + CM_PLANE_BLOCK]	 = normal[1];
+	block[lane + CM_PLANE_BLOCK * 2] = normal[2];
+	block[lane + CM_PLANE_BLOCK * 3] = dist;
+}
+
+/*
+==================
+CM_BuildFacetPlanes
+==================
+*/
+void CM_BuildFacetPlanes( cSurfaceCollide_t* sc )
+{
+	const cPlane_t* p;
+	int				i;
+
+	if( !sc->numFacets )
+	{
+		return;
+	}
+
+	sc->facetPlanes = CM_AllocPlaneBlocks( sc->numFacets );
+	for( i = 0; i < sc->numFacets; i++ )
+	{
+		p = &sc->planes[sc->facets[i].surfacePlane];
+		CM_SetPlaneBlock( sc->facetPlanes, i, p->plane, p->plane[3] );
+	}
+}
+
+/*
+===============================================================================
+
+KERNELS
+
+Every lane repeats the scalar arithmetic of cm_trace.c in the same order,
+so the plane distances come out bit identical.  The box and capsule cases
+share one formula:
+
+  dist = ( plane.dist - DotProduct( corner, normal ) ) + radius
+  d    = DotProduct( point, normal ) - dist
+
+where for a box the corner is picked by the normal signs and radius is 0,
+and for a capsule the corner is 0 and the point is the capsule end nearer
+to the plane.  Only the fractions differ slightly, the scalar code divides
+in double because SURFACE_CLIP_EPSILON is a double.
+
+===============================================================================
+*/
+
+typedef struct
+{
+	vec3_t cornerPos; // box corner for normal components >= 0
+	vec3_t cornerNeg; // box corner for normal components < 0
+	vec3_t capsuleOffset;
+	float  radius;
+	vec3_t startFront; // capsule points for DotProduct( normal, capsuleOffset ) > 0
+	vec3_t startBack;
+	vec3_t endFront;
+	vec3_t endBack;
+} kernelTrace_t;
+
+/*
+==================
+CM_SetupKernelTrace
+==================
+*/
+static void CM_SetupKernelTrace( const traceWork_t* tw, kernelTrace_t* kt )
+{
+	if( tw->type == TT_CAPSULE )
+	{
+		VectorClear( kt->cornerPos );
+		VectorClear( kt->cornerNeg );
+		VectorCopy( tw->sphere.offset, kt->capsuleOffset );
+		kt->radius = tw->sphere.radius;
+		VectorSubtract( tw->start, tw->sphere.offset, kt->startFront );
+		VectorAdd( tw->start, tw->sphere.offset, kt->startBack );
+		VectorSubtract( tw->end, tw->sphere.offset, kt->endFront );
+		VectorAdd( tw->end, tw->sphere.offset, kt->endBack );
+	}
+	else
+	{
+		VectorCopy( tw->offsets[0], kt->cornerPos );
+		VectorCopy( tw->offsets[7], kt->cornerNeg );
+		VectorClear( kt->capsuleOffset );
+		kt->radius = 0;
+		VectorCopy( tw->start, kt->startFront );
+		VectorCopy( tw->start, kt->startBack );
+		VectorCopy( tw->end, kt->endFront );
+		VectorCopy( tw->end, kt->endBack );
+	}
+}
+
+#if CM_SIMD
+
+/*
+===============================================================================
+
+SSE
+
+===============================================================================
+*/
+
+typedef struct
+{
+	__m128 cornerPos[3], cornerNeg[3];
+	__m128 capsuleOffset[3];
+	__m128 radius;
+	__m128 startFront[3], startBack[3];
+	__m128 endFront[3], endBack[3];
+} kernelTrace4_t;
+
+#define SSE_SELECT( mask, a, b ) _mm_or_ps( _mm_and_ps( mask, b ), _mm_andnot_ps( mask, a ) )
+
+static void CM_LoadKernelTrace4( const kernelTrace_t* kt, kernelTrace4_t* k )
+{
+	int i;
+
+	for( i = 0; i < 3; i++ )
+	{
+		k->cornerPos[i]		= _mm_set1_ps( kt->cornerPos[i] );
+		k->cornerNeg[i]		= _mm_set1_ps( kt->cornerNeg[i] );
+		k->capsuleOffset[i] = _mm_set1_ps( kt->capsuleOffset[i] );
+		k->startFront[i]	= _mm_set1_ps( kt->startFront[i] );
+		k->startBack[i]		= _mm_set1_ps( kt->startBack[i] );
+		k->endFront[i]		= _mm_set1_ps( kt->endFront[i] );
+		k->endBack[i]		= _mm_set1_ps( kt->endBack[i] );
+	}
+	k->radius = _mm_set1_ps( kt->radius );
+}
+
+/*
+==================
+CM_PlaneDistances4
+
+Distances of the start and end point to four planes of a block
+==================
+*/
+static ID_INLINE void CM_PlaneDistances4( const kernelTrace4_t* k, const float* p, __m128* d1, __m128* d2 )
+{
+	__m128 nx, ny, nz, zero;
+	__m128 front, dist, t, px, py, pz;
+
+	nx	 = _mm_loadu_ps( p );
+	ny	 = _mm_loadu_ps( p + CM_PLANE_BLOCK );
+	nz	 = _mm_loadu_ps( p + CM_PLANE_BLOCK * 2 );
+	zero = _mm_setzero_ps();
+
+	// plane distance pushed out by the box corner or the capsule radius
+	px	 = SSE_SELECT( _mm_cmplt_ps( nx, zero ), k->cornerPos[0], k->cornerNeg[0] );
+	py	 = SSE_SELECT( _mm_cmplt_ps( ny, zero ), k->cornerPos[1], k->cornerNeg[1] );
+	pz	 = SSE_SELECT( _mm_cmplt_ps( nz, zero ), k->cornerPos[2], k->cornerNeg[2] );
+	t	 = _mm_add_ps( _mm_add_ps( _mm_mul_ps( px, nx ), _mm_mul_ps( py, ny ) ), _mm_mul_ps( pz, nz ) );
+	dist = _mm_add_ps( _mm_sub_ps( _mm_loadu_ps( p + CM_PLANE_BLOCK * 3 ), t ), k->radius );
+
+	// capsule end closest to the plane
+	t	  = _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx, k->capsuleOffset[0] ), _mm_mul_ps( ny, k->capsuleOffset[1] ) ), _mm_mul_ps( nz, k->capsuleOffset[2] ) );
+	front = _mm_cmpgt_ps( t, zero );
+
+	px	= SSE_SELECT( front, k->startBack[0], k->startFront[0] );
+	py	= SSE_SELECT( front, k->startBack[1], k->startFront[1] );
+	pz	= SSE_SELECT( front, k->startBack[2], k->startFront[2] );
+	*d1 = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( px, nx ), _mm_mul_ps( py, ny ) ), _mm_mul_ps( pz, nz ) ), dist );
+
+	if( d2 )
+	{
+		px	= SSE_SELECT( front, k->endBack[0], k->endFront[0] );
+		py	= SSE_SELECT( front, k->endBack[1], k->endFront[1] );
+		pz	= SSE_SELECT( front, k->endBack[2], k->endFront[2] );
+		*d2 = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( px, nx ), _mm_mul_ps( py, ny ) ), _mm_mul_ps( pz, nz ) ), dist );
+	}
+}
+
+/*
+==================
+CM_ClipBrush_SSE
+==================
+*/
+static qboolean CM_ClipBrush_SSE( const traceWork_t* tw, const cbrush_t* brush, brushClip_t* clip )
+{
+	kernelTrace_t  kt;
+	kernelTrace4_t k;
+	__m128		   zero, one, eps, d1, d2, denom, f, cross, enter, better;
+	__m128		   startout, getout, bestEnter, bestSide, leave, side;
+	float		   enters[4];
+	float		   sides[4];
+	int			   i, j;
+
+	CM_SetupKernelTrace( tw, &kt );
+	CM_LoadKernelTrace4( &kt, &k );
+
+	zero	  = _mm_setzero_ps();
+	one		  = _mm_set1_ps( 1.0f );
+	eps		  = _mm_set1_ps( SURFACE_CLIP_EPSILON );
+	startout  = zero;
+	getout	  = zero;
+	bestEnter = _mm_set1_ps( -1.0f );
+	bestSide  = _mm_set1_ps( -1.0f );
+	leave	  = one;
+	side	  = _mm_setr_ps( 0, 1, 2, 3 );
+
+	for( i = 0; i < brush->numsides; i += 4, side = _mm_add_ps( side, _mm_set1_ps( 4.0f ) ) )
+	{
+		CM_PlaneDistances4( &k, brush->planes + ( i / CM_PLANE_BLOCK ) * CM_PLANE_BLOCK_FLOATS + ( i % CM_PLANE_BLOCK ), &d1, &d2 );
+
+		// if completely in front of face, no intersection with the entire brush
+		if( _mm_movemask_ps( _mm_and_ps( _mm_cmpgt_ps( d1, zero ), _mm_or_ps( _mm_cmpge_ps( d2, eps ), _mm_cmpge_ps( d2, d1 ) ) ) ) )
+		{
+			return qfalse;
+		}
+
+		startout = _mm_or_ps( startout, _mm_cmpgt_ps( d1, zero ) );
+		getout	 = _mm_or_ps( getout, _mm_cmpgt_ps( d2, zero ) );
+
+		// planes that aren't crossed get a harmless divisor
+		cross = _mm_or_ps( _mm_cmpgt_ps( d1, zero ), _mm_cmpgt_ps( d2, zero ) );
+		enter = _mm_and_ps( cross, _mm_cmpgt_ps( d1, d2 ) );
+		denom = SSE_SELECT( cross, one, _mm_sub_ps( d1, d2 ) );
+
+		f		  = _mm_max_ps( _mm_div_ps( _mm_sub_ps( d1, eps ), denom ), zero );
+		better	  = _mm_and_ps( enter, _mm_cmpgt_ps( f, bestEnter ) );
+		bestEnter = SSE_SELECT( better, bestEnter, f );
+		bestSide  = SSE_SELECT( better, bestSide, side );
+
+		f	  = _mm_min_ps( _mm_div_ps( _mm_add_ps( d1, eps ), denom ), one );
+		leave = _mm_min_ps( leave, SSE_SELECT( _mm_andnot_ps( enter, cross ), one, f ) );
+	}
+
+	_mm_storeu_ps( enters, bestEnter );
+	_mm_storeu_ps( sides, bestSide );
+
+	// the earliest side wins ties, like in the scalar loop
+	clip->enterFrac = -1.0f;
+	clip->leadSide	= -1;
+	for( j = 0; j < 4; j++ )
+	{
+		if( enters[j] > clip->enterFrac || ( enters[j] == clip->enterFrac && ( int )sides[j] < clip->leadSide ) )
+		{
+			clip->enterFrac = enters[j];
+			clip->leadSide	= ( int )sides[j];
+		}
+	}
+
+	leave			= _mm_min_ps( leave, _mm_shuffle_ps( leave, leave, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+	leave			= _mm_min_ps( leave, _mm_shuffle_ps( leave, leave, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+	clip->leaveFrac = _mm_cvtss_f32( leave );
+	clip->startout	= _mm_movemask_ps( startout ) ? qtrue : qfalse;
+	clip->getout	= _mm_movemask_ps( getout ) ? qtrue : qfalse;
+
+	return qtrue;
+}
+
+/*
+==================
+CM_StartInBrush_SSE
+==================
+*/
+static qboolean CM_StartInBrush_SSE( const traceWork_t* tw, const cbrush_t* brush )
+{
+	kernelTrace_t  kt;
+	kernelTrace4_t k;
+	__m128		   d1, axial;
+	int			   i;
+
+	CM_SetupKernelTrace( tw, &kt );
+	CM_LoadKernelTrace4( &kt, &k );
+
+	// the first six planes are the axial planes, which were already
+	// tested against the bounds
+	for( i = 4; i < brush->numsides; i += 4 )
+	{
+		CM_PlaneDistances4( &k, brush->planes + ( i / CM_PLANE_BLOCK ) * CM_PLANE_BLOCK_FLOATS + ( i % CM_PLANE_BLOCK ), &d1, NULL );
+
+		axial = ( i == 4 ) ? _mm_castsi128_ps( _mm_setr_epi32( -1, -1, 0, 0 ) ) : _mm_setzero_ps();
+		if( _mm_movemask_ps( _mm_andnot_ps( axial, _mm_cmpgt_ps( d1, _mm_setzero_ps() ) ) ) )
+		{
+			return qfalse;
+		}
+	}
+
+	return qtrue;
+}
+
+/*
+==================
+CM_FacetMask_SSE
+==================
+*/
+static int CM_FacetMask_SSE( const traceWork_t* tw, const float* block )
+{
+	kernelTrace_t  kt;
+	kernelTrace4_t k;
+	__m128		   d1, d2, eps, outside;
+	int			   i, mask;
+
+	CM_SetupKernelTrace( tw, &kt );
+	CM_LoadKernelTrace4( &kt, &k );
+
+	eps	 = _mm_set1_ps( SURFACE_CLIP_EPSILON );
+	mask = 0;
+	for( i = 0; i < CM_PLANE_BLOCK; i += 4 )
+	{
+		CM_PlaneDistances4( &k, block + i, &d1, &d2 );
+
+		outside = _mm_and_ps( _mm_cmpgt_ps( d1, _mm_setzero_ps() ), _mm_or_ps( _mm_cmpge_ps( d2, eps ), _mm_cmpge_ps( d2, d1 ) ) );
+		mask |= ( ~_mm_movemask_ps( outside ) & 15 ) << i;
+	}
+
+	return mask;
+}
+
+static const cmKernels_t cm_kernelsSSE = { "SSE", CM_ClipBrush_SSE, CM_StartInBrush_SSE, CM_FacetMask_SSE };
+
+/*
+===============================================================================
+
+AVX2
+
+===============================================================================
+*/
+
+typedef struct
+{
+	__m256 cornerPos[3], cornerNeg[3];
+	__m256 capsuleOffset[3];
+	__m256 radius;
+	__m256 startFront[3], startBack[3];
+	__m256 endFront[3], endBack[3];
+} kernelTrace8_t;
+
+CM_TARGET_AVX2 static void CM_LoadKernelTrace8( const kernelTrace_t* kt, kernelTrace8_t* k )
+{
+	int i;
+
+	for( i = 0; i < 3; i++ )
+	{
+		k->cornerPos[i]		= _mm256_set1_ps( kt->cornerPos[i] );
+		k->cornerNeg[i]		= _mm256_set1_ps( kt->cornerNeg[i] );
+		k->capsuleOffset[i] = _mm256_set1_ps( kt->capsuleOffset[i] );
+		k->startFront[i]	= _mm256_set1_ps( kt->startFront[i] );
+		k->startBack[i]		= _mm256_set1_ps( kt->startBack[i] );
+		k->endFront[i]		= _mm256_set1_ps( kt->endFront[i] );
+		k->endBack[i]		= _mm256_set1_ps( kt->endBack[i] );
+	}
+	k->radius = _mm256_set1_ps( kt->radius );
+}
+
+/*
+==================
+CM_PlaneDistances8
+
+Same as CM_PlaneDistances4 for a whole block
+==================
+*/
+CM_TARGET_AVX2 static ID_INLINE void CM_PlaneDistances8( const kernelTrace8_t* k, const float* p, __m256* d1, __m256* d2 )
+{
+	__m256 nx, ny, nz, zero;
+	__m256 front, dist, t, px, py, pz;
+
+	nx	 = _mm256_loadu_ps( p );
+	ny	 = _mm256_loadu_ps( p + CM_PLANE_BLOCK );
+	nz	 = _mm256_loadu_ps( p + CM_PLANE_BLOCK * 2 );
+	zero = _mm256_setzero_ps();
+
+	px	 = _mm256_blendv_ps( k->cornerPos[0], k->cornerNeg[0], _mm256_cmp_ps( nx, zero, _CMP_LT_OQ ) );
+	py	 = _mm256_blendv_ps( k->cornerPos[1], k->cornerNeg[1], _mm256_cmp_ps( ny, zero, _CMP_LT_OQ ) );
+	pz	 = _mm256_blendv_ps( k->cornerPos[2], k->cornerNeg[2], _mm256_cmp_ps( nz, zero, _CMP_LT_OQ ) );
+	t	 = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( px, nx ), _mm256_mul_ps( py, ny ) ), _mm256_mul_ps( pz, nz ) );
+	dist = _mm256_add_ps( _mm256_sub_ps( _mm256_loadu_ps( p + CM_PLANE_BLOCK * 3 ), t ), k->radius );
+
+	t	  = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( nx, k->capsuleOffset[0] ), _mm256_mul_ps( ny, k->capsuleOffset[1] ) ), _mm256_mul_ps( nz, k->capsuleOffset[2] ) );
+	front = _mm256_cmp_ps( t, zero, _CMP_GT_OQ );
+
+	px	= _mm256_blendv_ps( k->startBack[0], k->startFront[0], front );
+	py	= _mm256_blendv_ps( k->startBack[1], k->startFront[1], front );
+	pz	= _mm256_blendv_ps( k->startBack[2], k->startFront[2], front );
+	*d1 = _mm256_sub_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( px, nx ), _mm256_mul_ps( py, ny ) ), _mm256_mul_ps( pz, nz ) ), dist );
+
+	if( d2 )
+	{
+		px	= _mm256_blendv_ps( k->endBack[0], k->endFront[0], front );
+		py	= _mm256_blendv_ps( k->endBack[1], k->endFront[1], front );
+		pz	= _mm256_blendv_ps( k->endBack[2], k->endFront[2], front );
+		*d2 = _mm256_sub_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( px, nx ), _mm256_mul_ps( py, ny ) ), _mm256_mul_ps( pz, nz ) ), dist );
+	}
+}
+
+/*
+==================
+CM_ClipBrush_AVX2
+==================
+*/
+CM_TARGET_AVX2 static qboolean CM_ClipBrush_AVX2( const traceWork_t* tw, const cbrush_t* brush, brushClip_t* clip )
+{
+	kernelTrace_t  kt;
+	kernelTrace8_t k;
+	__m256		   zero, one, eps, d1, d2, denom, f, cross, enter, better;
+	__m256		   startout, getout, bestEnter, bestSide, leave, side;
+	__m128		   leave4;
+	float		   enters[8];
+	float		   sides[8];
+	int			   i, j;
+
+	CM_SetupKernelTrace( tw, &kt );
+	CM_LoadKernelTrace8( &kt, &k );
+
+	zero	  = _mm256_setzero_ps();
+	one		  = _mm256_set1_ps( 1.0f );
+	eps		  = _mm256_set1_ps( SURFACE_CLIP_EPSILON );
+	startout  = zero;
+	getout	  = zero;
+	bestEnter = _mm256_set1_ps( -1.0f );
+	bestSide  = _mm256_set1_ps( -1.0f );
+	leave	  = one;
+	side	  = _mm256_setr_ps( 0, 1, 2, 3, 4, 5, 6, 7 );
+
+	for( i = 0; i < brush->numsides; i += CM_PLANE_BLOCK, side = _mm256_add_ps( side, _mm256_set1_ps( CM_PLANE_BLOCK ) ) )
+	{
+		CM_PlaneDistances8( &k, brush->planes + ( i / CM_PLANE_BLOCK ) * CM_PLANE_BLOCK_FLOATS, &d1, &d2 );
+
+		if( _mm256_movemask_ps( _mm256_and_ps( _mm256_cmp_ps( d1, zero, _CMP_GT_OQ ),
+				_mm256_or_ps( _mm256_cmp_ps( d2, eps, _CMP_GE_OQ ), _mm256_cmp_ps( d2, d1, _CMP_GE_OQ ) ) ) ) )
+		{
+			_mm256_zeroupper();
+			return qfalse;
+		}
+
+		startout = _mm256_or_ps( startout, _mm256_cmp_ps( d1, zero, _CMP_GT_OQ ) );
+		getout	 = _mm256_or_ps( getout, _mm256_cmp_ps( d2, zero, _CMP_GT_OQ ) );
+
+		cross = _mm256_or_ps( _mm256_cmp_ps( d1, zero, _CMP_GT_OQ ), _mm256_cmp_ps( d2, zero, _CMP_GT_OQ ) );
+		enter = _mm256_and_ps( cross, _mm256_cmp_ps( d1, d2, _CMP_GT_OQ ) );
+		denom = _mm256_blendv_ps( one, _mm256_sub_ps( d1, d2 ), cross );
+
+		f		  = _mm256_max_ps( _mm256_div_ps( _mm256_sub_ps( d1, eps ), denom ), zero );
+		better	  = _mm256_and_ps( enter, _mm256_cmp_ps( f, bestEnter, _CMP_GT_OQ ) );
+		bestEnter = _mm256_blendv_ps( bestEnter, f, better );
+		bestSide  = _mm256_blendv_ps( bestSide, side, better );
+
+		f	  = _mm256_min_ps( _mm256_div_ps( _mm256_add_ps( d1, eps ), denom ), one );
+		leave = _mm256_min_ps( leave, _mm256_blendv_ps( one, f, _mm256_andnot_ps( enter, cross ) ) );
+	}
+
+	_mm256_storeu_ps( enters, bestEnter );
+	_mm256_storeu_ps( sides, bestSide );
+
+	clip->enterFrac = -1.0f;
+	clip->leadSide	= -1;
+	for( j = 0; j < 8; j++ )
+	{
+		if( enters[j] > clip->enterFrac || ( enters[j] == clip->enterFrac && ( int )sides[j] < clip->leadSide ) )
+		{
+			clip->enterFrac = enters[j];
+			clip->leadSide	= ( int )sides[j];
+		}
+	}
+
+	leave4			= _mm_min_ps( _mm256_castps256_ps128( leave ), _mm256_extractf128_ps( leave, 1 ) );
+	leave4			= _mm_min_ps( leave4, _mm_shuffle_ps( leave4, leave4, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+	leave4			= _mm_min_ps( leave4, _mm_shuffle_ps( leave4, leave4, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+	clip->leaveFrac = _mm_cvtss_f32( leave4 );
+	clip->startout	= _mm256_movemask_ps( startout ) ? qtrue : qfalse;
+	clip->getout	= _mm256_movemask_ps( getout ) ? qtrue : qfalse;
+
+	_mm256_zeroupper();
+
+	return qtrue;
+}
+
+/*
+==================
+CM_StartInBrush_AVX2
+==================
+*/
+CM_TARGET_AVX2 static qboolean CM_StartInBrush_AVX2( const traceWork_t* tw, const cbrush_t* brush )
+{
+	kernelTrace_t  kt;
+	kernelTrace8_t k;
+	__m256		   d1, axial;
+	int			   i;
+
+	CM_SetupKernelTrace( tw, &kt );
+	CM_LoadKernelTrace8( &kt, &k );
+
+	for( i = 0; i < brush->numsides; i += CM_PLANE_BLOCK )
+	{
+		CM_PlaneDistances8( &k, brush->planes + ( i / CM_PLANE_BLOCK ) * CM_PLANE_BLOCK_FLOATS, &d1, NULL );
+
+		// the first six planes are the axial planes
+		axial = ( i == 0 ) ? _mm256_castsi256_ps( _mm256_setr_epi32( -1, -1, -1, -1, -1, -1, 0, 0 ) ) : _mm256_setzero_ps();
+		if( _mm256_movemask_ps( _mm256_andnot_ps( axial, _mm256_cmp_ps( d1, _mm256_setzero_ps(), _CMP_GT_OQ ) ) ) )
+		{
+			_mm256_zeroupper();
+			return qfalse;
+		}
+	}
+
+	_mm256_zeroupper();
+	return qtrue;
+}
+
+/*
+==================
+CM_FacetMask_AVX2
+==================
+*/
+CM_TARGET_AVX2 static int CM_FacetMask_AVX2( const traceWork_t* tw, const float* block )
+{
+	kernelTrace_t  kt;
+	kernelTrace8_t k;
+	__m256		   d1, d2, eps, outside;
+	int			   mask;
+
+	CM_SetupKernelTrace( tw, &kt );
+	CM_LoadKernelTrace8( &kt, &k );
+
+	eps = _mm256_set1_ps( SURFACE_CLIP_EPSILON );
+	CM_PlaneDistances8( &k, block, &d1, &d2 );
+
+	outside = _mm256_and_ps( _mm256_cmp_ps( d1, _mm256_setzero_ps(), _CMP_GT_OQ ), _mm256_or_ps( _mm256_cmp_ps( d2, eps, _CMP_GE_OQ ), _mm256_cmp_ps( d2, d1, _CMP_GE_OQ ) ) );
+	mask	= ~_mm256_movemask_ps( outside ) & 255;
+
+	_mm256_zeroupper();
+	return mask;
+}
+
+static const cmKernels_t cm_kernelsAVX2 = { "AVX2", CM_ClipBrush_AVX2, CM_StartInBrush_AVX2, CM_FacetMask_AVX2 };
+
+/*
+==================
+CM_CpuHasAVX2
+
+AVX2 needs both the instructions and an OS that saves the ymm registers
+==================
+*/
+static qboolean CM_CpuHasAVX2()
+{
+	#if defined( _MSC_VER )
+	int regs[4];
+
+	__cpuid( regs, 0 );
+	if( regs[0] < 7 )
+	{
+		return qfalse;
+	}
+
+	// OSXSAVE and AVX
+	__cpuid( regs, 1 );
+	if( ( regs[2] & ( ( 1 << 27 ) | ( 1 << 28 ) ) ) != ( ( 1 << 27 ) | ( 1 << 28 ) ) )
+	{
+		return qfalse;
+	}
+	if( ( _xgetbv( 0 ) & 6 ) != 6 )
+	{
+		return qfalse;
+	}
+
+	__cpuidex( regs, 7, 0 );
+	return ( regs[1] & ( 1 << 5 ) ) ? qtrue : qfalse;
+	#elif defined( __GNUC__ ) || defined( __clang__ )
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "avx2" ) ? qtrue : qfalse;
+	#else
+	return qfalse;
+	#endif
+}
+
+#endif // CM_SIMD
+
+/*
+==================
+CM_InitKernels
+
+cm_simd 0 runs the plain C loops, 1 the SSE kernels and 2 or more the
+best ones the CPU supports
+==================
+*/
+void CM_InitKernels()
+{
+	cm_simd	   = Cvar_Get( "cm_simd", "2", 0 );
+	cm_kernels = NULL;
+
+#if CM_SIMD
+	if( cm_simd->integer >= 2 && CM_CpuHasAVX2() )
+	{
+		cm_kernels = &cm_kernelsAVX2;
+	}
+	else if( cm_simd->integer >= 1 )
+	{
+		cm_kernels = &cm_kernelsSSE;
+	}
+#endif
+
+	Com_DPrintf( "collision kernels: %s\n", cm_kernels ? cm_kernels->name : "C" );
+}
+
+/*
+===============================================================================
+
+KERNEL TEST
+
+===============================================================================
+*/
+
+#define KERNEL_TEST_TRACES 20000
+
+typedef struct
+{
+	vec3_t		start, end;
+	vec3_t		mins, maxs;
+	traceType_t type;
+} kernelTestTrace_t;
+
+/*
+==================
+CM_RunKernelTest
+
+Runs all test traces with the given kernels and returns the time it took
+==================
+*/
+static int64_t CM_RunKernelTest( const cmKernels_t* kernels, const kernelTestTrace_t* traces, int count, trace_t* results )
+{
+	const cmKernels_t* saved = cm_kernels;
+	int64_t			   start;
+	int				   i;
+
+	cm_kernels = kernels;
+	start	   = Sys_Microseconds();
+	for( i = 0; i < count; i++ )
+	{
+		CM_BoxTrace( &results[i], traces[i].start, traces[i].end, ( float* )traces[i].mins, ( float* )traces[i].maxs, 0, CONTENTS_SOLID | CONTENTS_PLAYERCLIP, traces[i].type );
+	}
+	start	   = Sys_Microseconds() - start;
+	cm_kernels = saved;
+
+	return start;
+}
+
+/*
+==================
+CM_CompareKernelTraces
+
+Traces may end on a different plane when two planes are hit at the same
+fraction, those are counted but not reported as errors
+==================
+*/
+static int CM_CompareKernelTraces( const trace_t* a, const trace_t* b, int count, int* planeTies )
+{
+	int i, errors;
+
+	errors	   = 0;
+	*planeTies = 0;
+	for( i = 0; i < count; i++, a++, b++ )
+	{
+		if( a->allsolid != b->allsolid || a->startsolid != b->startsolid || fabs( a->fraction - b->fraction ) > 1.0e-4f || a->contents != b->contents )
+		{
+			if( errors < 8 )
+			{
+				Com_Printf( "  trace %i: fraction %f / %f, startsolid %i / %i, allsolid %i / %i\n", i, a->fraction, b->fraction, a->startsolid, b->startsolid, a->allsolid,
+					b->allsolid );
+			}
+			errors++;
+		}
+		else if( a->fraction < 1 && ( !VectorCompare( a->plane.normal, b->plane.normal ) || a->plane.dist != b->plane.dist ) )
+		{
+			( *planeTies )++;
+		}
+	}
+
+	return errors;
+}
+
+/*
+==================
+CM_KernelTest_f
+
+cmkerneltest [traces] [seed]
+
+Compares random box, capsule and point traces through the loaded map
+between the C code and every SIMD kernel the CPU can run
+==================
+*/
+void CM_KernelTest_f()
+{
+	const cmKernels_t* kernels[2];
+	int				   numKernels;
+	kernelTestTrace_t* traces;
+	trace_t *		   reference, *results;
+	vec3_t			   mins, maxs, size;
+	int64_t			   baseTime, time;
+	int				   count, seed, i, j, errors, ties;
+
+	if( !cm.numBrushes )
+	{
+		Com_Printf( "cmkerneltest: no map loaded\n" );
+		return;
+	}
+
+	count = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : KERNEL_TEST_TRACES;
+	seed  = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : Sys_Milliseconds();
+	if( count <= 0 )
+	{
+		count = KERNEL_TEST_TRACES;
+	}
+
+	numKernels = 0;
+#if CM_SIMD
+	kernels[numKernels++] = &cm_kernelsSSE;
+	if( CM_CpuHasAVX2() )
+	{
+		kernels[numKernels++] = &cm_kernelsAVX2;
+	}
+#endif
+	if( !numKernels )
+	{
+		Com_Printf( "cmkerneltest: no SIMD kernels on this platform\n" );
+		return;
+	}
+
+	traces	  = Z_Malloc( count * sizeof( *traces ) );
+	reference = Z_Malloc( count * sizeof( *reference ) );
+	results	  = Z_Malloc( count * sizeof( *results ) );
+
+	// short random moves all over the world, a third each with points,
+	// boxes and capsules
+	CM_ModelBounds( 0, mins, maxs );
+	VectorSubtract( maxs, mins, size );
+	for( i = 0; i < count; i++ )
+	{
+		kernelTestTrace_t* t = &traces[i];
+
+		for( j = 0; j < 3; j++ )
+		{
+			t->start[j] = mins[j] + Q_random( &seed ) * size[j];
+			t->end[j]	= t->start[j] + Q_crandom( &seed ) * 256;
+		}
+
+		if( i % 3 == 0 )
+		{
+			VectorClear( t->mins );
+			VectorClear( t->maxs );
+			t->type = TT_AABB;
+		}
+		else
+		{
+			t->maxs[0] = t->maxs[1] = 8 + Q_random( &seed ) * 24;
+			t->maxs[2]				= 16 + Q_random( &seed ) * 32;
+			VectorNegate( t->maxs, t->mins );
+			t->mins[2] = -24;
+			t->type	   = ( i % 3 == 1 ) ? TT_AABB : TT_CAPSULE;
+		}
+	}
+
+	Com_Printf( "%i traces, seed %i\n", count, seed );
+
+	baseTime = CM_RunKernelTest( NULL, traces, count, reference );
+	Com_Printf( "%-6s %8.2f msec\n", "C", baseTime / 1000.0f );
+
+	for( i = 0; i < numKernels; i++ )
+	{
+		time   = CM_RunKernelTest( kernels[i], traces, count, results );
+		errors = CM_CompareKernelTraces( reference, results, count, &ties );
+		Com_Printf( "%-6s %8.2f msec, %i mismatches, %i plane ties\n", kernels[i]->name, time / 1000.0f, errors, ties );
+	}
+
+	Z_Free( results );
+	Z_Free( reference );
+	Z_Free( traces );
+}
@@ -158,6 +158,52 @@ float SquareRootFloat( float number )
 	return number * y;
 }
 
+/*
+================
+CM_CheckedBefore
+
+Multi-check avoidance for brushes and surfaces that span several leafs.
+On the main thread the item is stamped with cm.checkcount, other threads
+keep a small per trace hash of what they have seen instead.  When that
+hash is crowded the item is reported as new, which only costs the time
+of testing it again.
+================
+*/
+static qboolean CM_CheckedBefore( traceWork_t* tw, int* checkcount, const void* item )
+{
+	traceThread_t* thread = tw->thread;
+	unsigned	   hash;
+	int			   i, slot;
+
+	if( !thread )
+	{
+		if( *checkcount == cm.checkcount )
+		{
+			return qtrue;
+		}
+		*checkcount = cm.checkcount;
+		return qfalse;
+	}
+
+	hash = ( unsigned )( ( size_t )item >> 4 ) * 2654435761u;
+	for( i = 0; i < 8; i++ )
+	{
+		slot = ( hash + i ) & ( MAX_TRACE_CHECKS - 1 );
+		if( thread->checkStamps[slot] != thread->checkcount )
+		{
+			thread->checkStamps[slot] = thread->checkcount;
+			thread->checks[slot]	  = item;
+			return qfalse;
+		}
+		if( thread->checks[slot] == item )
+		{
+			return qtrue;
+		}
+	}
+
+	return qfalse;
+}
+
 /*
 ===============================================================================
 
@@ -193,7 +239,14 @@ static void CM_TestBoxInBrush( traceWork_t* tw, cbrush_t* brush )
 		return;
 	}
 
-	if( tw->type == TT_CAPSULE )
+	if( cm_kernels && brush->planes )
+	{
+		if( !cm_kernels->startInBrush( tw, brush ) )
+		{
+			return;
+		}
+	}
+	else if( tw->type == TT_CAPSULE )
 	{
 		// the first six planes are the axial planes, so we only
 		// need to test the remainder
@@ -375,11 +428,10 @@ void CM_TestInLeaf( traceWork_t* tw, cLeaf_t* leaf )
 	{
 		brushnum = cm.leafbrushes[leaf->firstLeafBrush + k];
 		b		 = &cm.brushes[brushnum];
-		if( b->checkcount == cm.checkcount )
+		if( CM_CheckedBefore( tw, &b->checkcount, b ) )
 		{
 			continue; // already checked this brush in another leaf
 		}
-		b->checkcount = cm.checkcount;
 
 		if( !( b->contents & tw->contents ) )
 		{
@@ -403,13 +455,11 @@ void CM_TestInLeaf( traceWork_t* tw, cLeaf_t* leaf )
 			continue;
 		}
 
-		if( surface->checkcount == cm.checkcount )
+		if( CM_CheckedBefore( tw, &surface->checkcount, surface ) )
 		{
 			continue; // already checked this surface in another leaf
 		}
 
-		surface->checkcount = cm.checkcount;
-
 		if( !( surface->contents & tw->contents ) )
 		{
 			continue;
@@ -584,11 +634,17 @@ void CM_PositionTest( traceWork_t* tw )
 	ll.lastLeaf	  = 0;
 	ll.overflowed = qfalse;
 
-	cm.checkcount++;
+	if( !tw->thread )
+	{
+		cm.checkcount++;
+	}
 
 	CM_BoxLeafnums_r( &ll, 0 );
 
-	cm.checkcount++;
+	if( !tw->thread )
+	{
+		cm.checkcount++;
+	}
 
 	// test the contents of the leafs
 	for( i = 0; i < ll.count; i++ )
@@ -618,8 +674,10 @@ CM_TracePointThroughSurfaceCollide
 */
 void CM_TracePointThroughSurfaceCollide( traceWork_t* tw, const cSurfaceCollide_t* sc )
 {
-	static qboolean frontFacing[SHADER_MAX_TRIANGLES];
-	static float	intersection[SHADER_MAX_TRIANGLES];
+	static qboolean mainFrontFacing[SHADER_MAX_TRIANGLES];
+	static float	mainIntersection[SHADER_MAX_TRIANGLES];
+	qboolean*		frontFacing;
+	float*			intersection;
 	float			intersect;
 	const cPlane_t* planes;
 	const cFacet_t* facet;
@@ -633,6 +691,17 @@ void CM_TracePointThroughSurfaceCollide( traceWork_t* tw, const cSurfaceCollide_
 		return;
 	}
 
+	if( tw->thread )
+	{
+		frontFacing	 = tw->thread->frontFacing;
+		intersection = tw->thread->intersection;
+	}
+	else
+	{
+		frontFacing	 = mainFrontFacing;
+		intersection = mainIntersection;
+	}
+
 	// determine the trace's relationship to all planes
 	planes = sc->planes;
 	for( i = 0; i < sc->numPlanes; i++, planes++ )
@@ -699,12 +768,12 @@ void CM_TracePointThroughSurfaceCollide( traceWork_t* tw, const cSurfaceCollide_
 		if( j == facet->numBorders )
 		{
 			// we hit this facet
-			if( !cv )
+			if( !cv && !tw->thread )
 			{
 				cv = Cvar_Get( "r_debugSurfaceUpdate", "1", 0 );
 			}
 
-			if( cv->integer )
+			if( cv && cv->integer && !tw->thread )
 			{
 				debugSurfaceCollide = sc;
 				debugFacet			= facet;
@@ -802,6 +871,7 @@ void CM_TraceThroughSurfaceCollide( traceWork_t* tw, const cSurfaceCollide_t* sc
 	float		   plane[4]		= { 0, 0, 0, 0 };
 	float		   bestplane[4] = { 0, 0, 0, 0 };
 	vec3_t		   startp, endp;
+	int			   facetMask;
 	static cvar_t* cv;
 
 	if( !CM_BoundsIntersect( tw->bounds[0], tw->bounds[1], sc->bounds[0], sc->bounds[1] ) )
@@ -815,8 +885,23 @@ void CM_TraceThroughSurfaceCollide( traceWork_t* tw, const cSurfaceCollide_t* sc
 		return;
 	}
 
+	facetMask = -1;
 	for( i = 0, facet = sc->facets; i < sc->numFacets; i++, facet++ )
 	{
+		// most facets are culled by their surface plane, test those
+		// a block at a time first
+		if( cm_kernels && sc->facetPlanes )
+		{
+			if( !( i % CM_PLANE_BLOCK ) )
+			{
+				facetMask = cm_kernels->facetMask( tw, sc->facetPlanes + ( i / CM_PLANE_BLOCK ) * CM_PLANE_BLOCK_FLOATS );
+			}
+			if( !( facetMask & ( 1 << ( i % CM_PLANE_BLOCK ) ) ) )
+			{
+				continue;
+			}
+		}
+
 		enterFrac = -1.0;
 		leaveFrac = 1.0;
 		hitnum	  = -1;
@@ -935,11 +1020,11 @@ void CM_TraceThroughSurfaceCollide( traceWork_t* tw, const cSurfaceCollide_t* sc
 					enterFrac = 0;
 				}
 
-				if( !cv )
+				if( !cv && !tw->thread )
 				{
 					cv = Cvar_Get( "r_debugSurfaceUpdate", "1", 0 );
 				}
-				if( cv && cv->integer )
+				if( cv && cv->integer && !tw->thread )
 				{
 					debugSurfaceCollide = sc;
 					debugFacet			= facet;
@@ -1001,6 +1086,7 @@ void CM_TraceThroughBrush( traceWork_t* tw, cbrush_t* brush )
 	float		  t;
 	vec3_t		  startp;
 	vec3_t		  endp;
+	brushClip_t	  clip;
 
 	enterFrac = -1.0;
 	leaveFrac = 1.0;
@@ -1018,7 +1104,26 @@ void CM_TraceThroughBrush( traceWork_t* tw, cbrush_t* brush )
 
 	leadside = NULL;
 
-	if( tw->type == TT_BISPHERE )
+	if( cm_kernels && brush->planes && tw->type != TT_BISPHERE && !tw->testLateralCollision )
+	{
+		// test several planes at a time, this gives the same results
+		// as the loops below except for the lateral collision flags
+		if( !cm_kernels->clipBrush( tw, brush, &clip ) )
+		{
+			return;
+		}
+
+		enterFrac = clip.enterFrac;
+		leaveFrac = clip.leaveFrac;
+		startout  = clip.startout;
+		getout	  = clip.getout;
+		if( clip.leadSide >= 0 )
+		{
+			leadside  = brush->sides + clip.leadSide;
+			clipplane = leadside->plane;
+		}
+	}
+	else if( tw->type == TT_BISPHERE )
 	{
 		//
 		// compare the trace against all planes of the brush
@@ -1055,7 +1160,10 @@ void CM_TraceThroughBrush( traceWork_t* tw, cbrush_t* brush )
 				continue;
 			}
 
-			brush->collided = qtrue;
+			if( tw->testLateralCollision )
+			{
+				brush->collided = qtrue;
+			}
 
 			// crosses face
 			if( d1 > d2 )
@@ -1140,7 +1248,10 @@ void CM_TraceThroughBrush( traceWork_t* tw, cbrush_t* brush )
 				continue;
 			}
 
-			brush->collided = qtrue;
+			if( tw->testLateralCollision )
+			{
+				brush->collided = qtrue;
+			}
 
 			// crosses face
 			if( d1 > d2 ) // enter
@@ -1210,7 +1321,10 @@ void CM_TraceThroughBrush( traceWork_t* tw, cbrush_t* brush )
 				continue;
 			}
 
-			brush->collided = qtrue;
+			if( tw->testLateralCollision )
+			{
+				brush->collided = qtrue;
+			}
 
 			// crosses face
 			if( d1 > d2 ) // enter
@@ -1391,18 +1505,20 @@ void CM_TraceThroughLeaf( traceWork_t* tw, cLeaf_t* leaf )
 		brushnum = cm.leafbrushes[leaf->firstLeafBrush + k];
 
 		b = &cm.brushes[brushnum];
-		if( b->checkcount == cm.checkcount )
+		if( CM_CheckedBefore( tw, &b->checkcount, b ) )
 		{
 			continue; // already checked this brush in another leaf
 		}
-		b->checkcount = cm.checkcount;
 
 		if( !( b->contents & tw->contents ) )
 		{
 			continue;
 		}
 
-		b->collided = qfalse;
+		if( tw->testLateralCollision )
+		{
+			b->collided = qfalse;
+		}
 
 		if( !CM_BoundsIntersect( tw->bounds[0], tw->bounds[1], b->bounds[0], b->bounds[1] ) )
 		{
@@ -1427,13 +1543,11 @@ void CM_TraceThroughLeaf( traceWork_t* tw, cLeaf_t* leaf )
 			continue;
 		}
 
-		if( surface->checkcount == cm.checkcount )
+		if( CM_CheckedBefore( tw, &surface->checkcount, surface ) )
 		{
 			continue; // already checked this surface in another leaf
 		}
 
-		surface->checkcount = cm.checkcount;
-
 		if( !( surface->contents & tw->contents ) )
 		{
 			continue;
@@ -1963,7 +2077,7 @@ static void CM_TraceThroughTree( traceWork_t* tw, int num, float p1f, float p2f,
 CM_Trace
 ==================
 */
-static void CM_Trace( trace_t* results, const vec3_t start, const vec3_t end, vec3_t mins, vec3_t maxs, clipHandle_t model, const vec3_t origin, int brushmask, traceType_t type, sphere_t* sphere )
+static void CM_Trace( trace_t* results, const vec3_t start, const vec3_t end, vec3_t mins, vec3_t maxs, clipHandle_t model, const vec3_t origin, int brushmask, traceType_t type, sphere_t* sphere, traceThread_t* thread )
 {
 	int			i;
 	traceWork_t tw;
@@ -1972,7 +2086,14 @@ static void CM_Trace( trace_t* results, const vec3_t start, const vec3_t end, ve
 
 	cmod = CM_ClipHandleToModel( model );
 
-	cm.checkcount++; // for multi-check avoidance
+	if( thread )
+	{
+		thread->checkcount++;
+	}
+	else
+	{
+		cm.checkcount++; // for multi-check avoidance
+	}
 
 	c_traces++; // for statistics, may be zeroed
 
@@ -1980,7 +2101,8 @@ static void CM_Trace( trace_t* results, const vec3_t start, const vec3_t end, ve
 	Com_Memset( &tw, 0, sizeof( tw ) );
 	tw.trace.fraction = 1; // assume it goes the entire distance until shown otherwise
 	VectorCopy( origin, tw.modelOrigin );
-	tw.type = type;
+	tw.type	  = type;
+	tw.thread = thread;
 
 	if( !cm.numNodes )
 	{
@@ -2227,7 +2349,7 @@ CM_BoxTrace
 */
 void CM_BoxTrace( trace_t* results, const vec3_t start, const vec3_t end, vec3_t mins, vec3_t maxs, clipHandle_t model, int brushmask, traceType_t type )
 {
-	CM_Trace( results, start, end, mins, maxs, model, vec3_origin, brushmask, type, NULL );
+	CM_Trace( results, start, end, mins, maxs, model, vec3_origin, brushmask, type, NULL, NULL );
 }
 
 /*
@@ -2318,7 +2440,7 @@ void CM_TransformedBoxTrace(
 	}
 	
 	// sweep the box through the model
-	CM_Trace( &trace, start_l, end_l, symetricSize[0], symetricSize[1], model, origin, brushmask, type, &sphere );
+	CM_Trace( &trace, start_l, end_l, symetricSize[0], symetricSize[1], model, origin, brushmask, type, &sphere, NULL );
 	
 	// if the bmodel was rotated and there was a collision
 	if( rotated && trace.fraction != 1.0 )
@@ -2432,7 +2554,7 @@ void CM_TransformedBoxTrace(
 	}
 
 	// sweep the box through the model
-	CM_Trace( &trace, startRotated, endRotated, symetricSize[0], symetricSize[1], model, origin, brushmask, type, &sphere );
+	CM_Trace( &trace, startRotated, endRotated, symetricSize[0], symetricSize[1], model, origin, brushmask, type, &sphere, NULL );
 
 	// if the bmodel was rotated and there was a collision
 	if( rotated && trace.fraction != 1.0 )
@@ -2450,6 +2572,169 @@ void CM_TransformedBoxTrace(
 #endif
 }
 
+/*
+===============================================================================
+
+BATCHED TRACES
+
+Many independent world traces are sorted by where they start, so that
+neighbouring traces walk the same part of the tree, and spread over the
+worker threads in small chunks.
+
+===============================================================================
+*/
+
+#define TRACE_BATCH_CHUNK 8
+
+typedef struct
+{
+	trace_t*			  results;
+	const traceRequest_t* requests;
+	const int*			  order;
+	int					  count;
+	volatile int		  nextChunk;
+} traceBatch_t;
+
+static traceThread_t traceThreads[MAX_JOB_THREADS + 1];
+static int			 traceThreadPlanes; // size of the scratch arrays in traceThreads
+
+static int*			 traceOrder;
+static int			 traceOrderSize;
+
+/*
+==================
+CM_TraceSortKey
+
+Morton code of the start point on a 64 unit grid
+==================
+*/
+static unsigned CM_TraceSortKey( const vec3_t p )
+{
+	unsigned key = 0;
+	unsigned c[3];
+	int		 i, bit;
+
+	for( i = 0; i < 3; i++ )
+	{
+		c[i] = ( ( unsigned )Com_Clamp( 0, 65535, ( int )p[i] + 32768 ) ) >> 6;
+	}
+
+	for( bit = 0; bit < 10; bit++ )
+	{
+		for( i = 0; i < 3; i++ )
+		{
+			key |= ( ( c[i] >> bit ) & 1 ) << ( bit * 3 + i );
+		}
+	}
+
+	return key;
+}
+
+static int CM_CompareTraceKeys( const void* a, const void* b )
+{
+	unsigned ka = ( ( const unsigned* )a )[0];
+	unsigned kb = ( ( const unsigned* )b )[0];
+
+	return ka < kb ? -1 : ka > kb;
+}
+
+/*
+==================
+CM_TraceBatchJob
+==================
+*/
+static void CM_TraceBatchJob( void* data, int index )
+{
+	traceBatch_t*		  batch	 = ( traceBatch_t* )data;
+	traceThread_t*		  thread = &traceThreads[index];
+	const traceRequest_t* r;
+	int					  i, n, first, last;
+
+	while( ( first = Sys_AtomicIncrement( &batch->nextChunk ) * TRACE_BATCH_CHUNK ) < batch->count )
+	{
+		last = MIN( first + TRACE_BATCH_CHUNK, batch->count );
+		for( i = first; i < last; i++ )
+		{
+			n = batch->order[i];
+			r = &batch->requests[n];
+			CM_Trace( &batch->results[n], r->start, r->end, ( float* )r->mins, ( float* )r->maxs, 0, vec3_origin, r->contentmask, r->type, NULL, thread );
+		}
+	}
+}
+
+/*
+==================
+CM_BoxTraceBatch
+
+Traces every request against the world, the results are in the order of
+the requests
+==================
+*/
+void CM_BoxTraceBatch( trace_t* results, const traceRequest_t* requests, int count )
+{
+	traceBatch_t batch;
+	unsigned*	 keys;
+	int			 i, numThreads;
+
+	numThreads = Sys_NumJobThreads();
+
+	if( numThreads == 1 || count < 2 * TRACE_BATCH_CHUNK )
+	{
+		for( i = 0; i < count; i++ )
+		{
+			CM_Trace( &results[i], requests[i].start, requests[i].end, ( float* )requests[i].mins, ( float* )requests[i].maxs, 0, vec3_origin, requests[i].contentmask, requests[i].type, NULL, NULL );
+		}
+		return;
+	}
+
+	// scratch for point traces through surfaces
+	if( traceThreadPlanes < cm.maxSurfacePlanes )
+	{
+		for( i = 0; i < numThreads; i++ )
+		{
+			if( traceThreads[i].frontFacing )
+			{
+				Z_Free( traceThreads[i].frontFacing );
+				Z_Free( traceThreads[i].intersection );
+			}
+			traceThreads[i].frontFacing	 = Z_Malloc( cm.maxSurfacePlanes * sizeof( qboolean ) );
+			traceThreads[i].intersection = Z_Malloc( cm.maxSurfacePlanes * sizeof( float ) );
+		}
+		traceThreadPlanes = cm.maxSurfacePlanes;
+	}
+
+	// sort by start point, each entry is a key followed by the request number
+	if( traceOrderSize < count )
+	{
+		if( traceOrder )
+		{
+			Z_Free( traceOrder );
+		}
+		traceOrderSize = count;
+		traceOrder	   = Z_Malloc( traceOrderSize * 2 * sizeof( int ) );
+	}
+
+	keys = ( unsigned* )traceOrder;
+	for( i = 0; i < count; i++ )
+	{
+		keys[i * 2 + 0] = CM_TraceSortKey( requests[i].start );
+		keys[i * 2 + 1] = i;
+	}
+	qsort( keys, count, 2 * sizeof( int ), CM_CompareTraceKeys );
+	for( i = 0; i < count; i++ )
+	{
+		traceOrder[i] = keys[i * 2 + 1];
+	}
+
+	batch.results	= results;
+	batch.requests	= requests;
+	batch.order		= traceOrder;
+	batch.count		= count;
+	batch.nextChunk = 0;
+
+	Sys_RunJobs( CM_TraceBatchJob, &batch, numThreads );
+}
+
 /*
 ==================
 CM_BiSphereTrace
@@ -329,6 +329,10 @@ void QDECL Com_Error( int code, const char* fmt, ... )
 	com_gameRestarting		 = qfalse;
 	com_gameClientRestarting = qfalse;
 
+	// the error may have left SV_SendClientMessages in the middle of a packet
+	// batch, the disconnect messages and everything after them must go out
+	Sys_FlushPacketBatch();
+
 	if( code == ERR_DISCONNECT || code == ERR_SERVERDISCONNECT )
 	{
 		VM_Forced_Unload_Start();
@@ -2421,7 +2425,9 @@ void Com_RunAndTimeServerPacket( netadr_t* evFrom, msg_t* buf )
 		t1 = Sys_Milliseconds();
 	}
 
+	PROF_BEGIN( "SV_PacketEvent" );
 	SV_PacketEvent( *evFrom, buf );
+	PROF_END();
 
 	if( com_speeds->integer )
 	{
@@ -2472,6 +2478,19 @@ int Com_EventLoop()
 				}
 			}
 
+			// everything that is waiting on the sockets
+			while( Sys_GetPacket( &evFrom, &buf ) )
+			{
+				if( com_sv_running->integer )
+				{
+					Com_RunAndTimeServerPacket( &evFrom, &buf );
+				}
+				else
+				{
+					CL_PacketEvent( evFrom, &buf );
+				}
+			}
+
 			return ev.evTime;
 		}
 
@@ -3703,6 +3722,8 @@ void Com_Init( char* commandLine )
 	}
 	Cmd_AddCommand( "quit", Com_Quit_f );
 	Cmd_AddCommand( "changeVectors", MSG_ReportChangeVectors_f );
+	Cmd_AddCommand( "huffbench", MSG_HuffmanBenchmark_f );
+	Cmd_AddCommand( "cmkerneltest", CM_KernelTest_f );
 	Cmd_AddCommand( "writeconfig", Com_WriteConfig_f );
 	Cmd_SetCommandCompletionFunc( "writeconfig", Cmd_CompleteCfgName );
 	Cmd_AddCommand( "game_restart", Com_GameRestart_f );
@@ -3790,6 +3811,10 @@ void Com_Init( char* commandLine )
 
 	Sys_Init();
 
+	Sys_InitJobs();
+
+	Prof_Init();
+
 	Sys_InitPIDFile( FS_GetCurrentGameDir() );
 
 	// Pick a random port value
@@ -4117,6 +4142,8 @@ void Com_Frame()
 	timeBeforeClient	  = 0;
 	timeAfter			  = 0;
 
+	Prof_Frame();
+
 	// write config file if anything changed
 	Com_WriteConfiguration();
 
@@ -4200,10 +4227,15 @@ void Com_Frame()
 		}
 	} while( Com_TimeVal( minMsec ) );
 
+	// everything up to NET_FlushPacketQueue, the sleep above is not part of it
+	PROF_BEGIN( "Com_Frame" );
+
 	IN_Frame();
 
 	lastTime	  = com_frameTime;
+	PROF_BEGIN( "Com_EventLoop" );
 	com_frameTime = Com_EventLoop();
+	PROF_END();
 
 	msec = com_frameTime - lastTime;
 
@@ -4226,7 +4258,9 @@ void Com_Frame()
 		timeBeforeServer = Sys_Milliseconds();
 	}
 
+	PROF_BEGIN( "SV_Frame" );
 	SV_Frame( msec );
+	PROF_END();
 
 	// if "dedicated" has been modified, start up
 	// or shut down the client system.
@@ -4256,7 +4290,9 @@ void Com_Frame()
 	{
 		timeBeforeEvents = Sys_Milliseconds();
 	}
+	PROF_BEGIN( "Com_EventLoop" );
 	Com_EventLoop();
+	PROF_END();
 	Cbuf_Execute();
 
 	//
@@ -4267,7 +4303,9 @@ void Com_Frame()
 		timeBeforeClient = Sys_Milliseconds();
 	}
 
+	PROF_BEGIN( "CL_Frame" );
 	CL_Frame( msec );
+	PROF_END();
 
 	if( com_speeds->integer )
 	{
@@ -4284,6 +4322,8 @@ void Com_Frame()
 
 	NET_FlushPacketQueue();
 
+	PROF_END();
+
 	//
 	// report timing information
 	//
@@ -4329,6 +4369,8 @@ Com_Shutdown
 */
 void Com_Shutdown()
 {
+	Sys_ShutdownJobs();
+
 	if( logfile )
 	{
 		FS_FCloseFile( logfile );
@@ -231,6 +231,15 @@ typedef struct searchpath_s
 	directory_t*		 dir;
 } searchpath_t;
 
+#define MAX_MAPPED_FILES 16
+
+typedef struct
+{
+	void*	 data;
+	long	 length;
+	qboolean mapped; // qfalse when read into the zone
+} mappedFile_t;
+
 static char	   fs_gamedir[MAX_OSPATH]; // this will be a single file name with no separators
 static cvar_t* fs_debug;
 static cvar_t* fs_homepath;
@@ -249,6 +258,7 @@ static searchpath_t* fs_searchpaths;
 static int			 fs_readCount;	   // total bytes read
 static int			 fs_loadCount;	   // total files read
 static int			 fs_loadStack;	   // total files in memory
+static mappedFile_t	 fs_mappedFiles[MAX_MAPPED_FILES];
 static int			 fs_packFiles = 0; // total number of files in packs
 
 static int			 fs_checksumFeed;
@@ -2163,6 +2173,128 @@ void FS_FreeFile( void* buffer )
 	}
 }
 
+/*
+=============
+FS_MapFile
+
+Loose files are mapped straight from the disk, so large read-only data
+costs neither a copy nor zone memory until its pages are touched
+=============
+*/
+long FS_MapFile( const char* qpath, void** buffer )
+{
+	searchpath_t* search;
+	mappedFile_t* mf;
+	fileHandle_t  f;
+	long		  len;
+	int			  i;
+
+	if( !fs_searchpaths )
+	{
+		Com_Error( ERR_FATAL, "Filesystem call made without initialization" );
+	}
+
+	if( !qpath || !qpath[0] || !buffer )
+	{
+		Com_Error( ERR_FATAL, "FS_MapFile: bad parameters" );
+	}
+
+	*buffer = NULL;
+
+	for( i = 0; i < MAX_MAPPED_FILES; i++ )
+	{
+		if( !fs_mappedFiles[i].data )
+		{
+			break;
+		}
+	}
+	if( i == MAX_MAPPED_FILES )
+	{
+		Com_Printf( S_COLOR_YELLOW "WARNING: FS_MapFile: too many mapped files for %s\n", qpath );
+		return -1;
+	}
+	mf = &fs_mappedFiles[i];
+
+	// only the first search path that has the file counts
+	for( search = fs_searchpaths; search; search = search->next )
+	{
+		if( FS_FOpenFileReadDir( qpath, search, NULL, qfalse, qfalse ) <= 0 )
+		{
+			continue;
+		}
+
+		if( search->dir )
+		{
+			mf->data   = Sys_MapFile( FS_BuildOSPath( search->dir->path, search->dir->gamedir, qpath ), &mf->length );
+			mf->mapped = qtrue;
+		}
+		break;
+	}
+
+	if( !mf->data )
+	{
+		// packed, or the platform couldn't map it
+		len = FS_FOpenFileRead( qpath, &f, qtrue );
+		if( !f )
+		{
+			return -1;
+		}
+
+		mf->data = Z_Malloc( len + 1 );
+		FS_Read( mf->data, len, f );
+		FS_FCloseFile( f );
+
+		mf->length = len;
+		mf->mapped = qfalse;
+	}
+
+	if( fs_debug->integer )
+	{
+		Com_Printf( "FS_MapFile: %s %s\n", qpath, mf->mapped ? "mapped" : "read" );
+	}
+
+	fs_loadCount++;
+	*buffer = mf->data;
+	return mf->length;
+}
+
+/*
+=============
+FS_UnmapFile
+=============
+*/
+void FS_UnmapFile( void* buffer )
+{
+	int i;
+
+	if( !buffer )
+	{
+		Com_Error( ERR_FATAL, "FS_UnmapFile( NULL )" );
+	}
+
+	for( i = 0; i < MAX_MAPPED_FILES; i++ )
+	{
+		if( fs_mappedFiles[i].data == buffer )
+		{
+			break;
+		}
+	}
+	if( i == MAX_MAPPED_FILES )
+	{
+		Com_Error( ERR_FATAL, "FS_UnmapFile: buffer wasn't returned by FS_MapFile" );
+	}
+
+	if( fs_mappedFiles[i].mapped )
+	{
+		Sys_UnmapFile( buffer, fs_mappedFiles[i].length );
+	}
+	else
+	{
+		Z_Free( buffer );
+	}
+	Com_Memset( &fs_mappedFiles[i], 0, sizeof( fs_mappedFiles[i] ) );
+}
+
 /*
 ============
 FS_WriteFile
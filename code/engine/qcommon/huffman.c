@@ -29,16 +29,17 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 static int bloc = 0;
 
+// the offset variants of the writers don't touch the global bloc so
+// messages can be built on several threads at the same time
 void	   Huff_putBit( int bit, byte* fout, int* offset )
 {
-	bloc = *offset;
-	if( ( bloc & 7 ) == 0 )
+	int ofs = *offset;
+	if( ( ofs & 7 ) == 0 )
 	{
-		fout[( bloc >> 3 )] = 0;
+		fout[( ofs >> 3 )] = 0;
 	}
-	fout[( bloc >> 3 )] |= bit << ( bloc & 7 );
-	bloc++;
-	*offset = bloc;
+	fout[( ofs >> 3 )] |= bit << ( ofs & 7 );
+	*offset = ofs + 1;
 }
 
 int Huff_getBloc()
@@ -425,11 +426,27 @@ void Huff_transmit( huff_t* huff, int ch, byte* fout, int maxoffset )
 	}
 }
 
+/* Send the prefix code for this node without using the global bloc */
+static void offsetSend( node_t* node, node_t* child, byte* fout, int* offset, int maxoffset )
+{
+	if( node->parent )
+	{
+		offsetSend( node->parent, node, fout, offset, maxoffset );
+	}
+	if( child )
+	{
+		if( *offset >= maxoffset )
+		{
+			*offset = maxoffset + 1;
+			return;
+		}
+		Huff_putBit( node->right == child, fout, offset );
+	}
+}
+
 void Huff_offsetTransmit( huff_t* huff, int ch, byte* fout, int* offset, int maxoffset )
 {
-	bloc = *offset;
-	send( huff->loc[ch], NULL, fout, maxoffset );
-	*offset = bloc;
+	offsetSend( huff->loc[ch], NULL, fout, offset, maxoffset );
 }
 
 void Huff_Decompress( msg_t* mbuf, int offset )
@@ -553,3 +570,178 @@ void Huff_Init( huffman_t* huff )
 	huff->compressor.lhead->next = huff->compressor.lhead->prev = NULL;
 	huff->compressor.tree->parent = huff->compressor.tree->left = huff->compressor.tree->right = NULL;
 }
+
+/*
+=============================================================================
+
+STATIC TREE TABLES
+
+Once a tree stops adapting, like the one msg.c builds from msg_hData, its
+codes can be looked up instead of walking the tree one bit per node.  The
+output is bit for bit the same as Huff_offsetTransmit / Huff_offsetReceive,
+including the behaviour at maxoffset.
+
+=============================================================================
+*/
+
+/*
+=================
+Huff_BuildTable
+
+Both directions use the same tree, it must not be changed afterwards
+=================
+*/
+void Huff_BuildTable( huffTable_t* table, huff_t* huff )
+{
+	int			  ch, i, bits;
+	unsigned int  code;
+	node_t*		  node;
+	huffLookup_t* entry;
+
+	Com_Memset( table, 0, sizeof( *table ) );
+	table->huff = huff;
+
+	// prefix codes, the first transmitted bit in bit 0
+	for( ch = 0; ch < HMAX; ch++ )
+	{
+		if( !huff->loc[ch] )
+		{
+			continue;
+		}
+
+		bits = 0;
+		for( node = huff->loc[ch]; node->parent; node = node->parent )
+		{
+			bits++;
+		}
+		if( bits > 32 )
+		{
+			// leave it to offsetSend
+			continue;
+		}
+
+		code = 0;
+		for( node = huff->loc[ch]; node->parent; node = node->parent )
+		{
+			code = ( code << 1 ) | ( node->parent->right == node );
+		}
+		table->code[ch]		= code;
+		table->codeBits[ch] = bits;
+	}
+
+	// decode HUFF_LOOKUP_BITS at once, longer codes continue from the node
+	for( i = 0, entry = table->lookup; i < ( 1 << HUFF_LOOKUP_BITS ); i++, entry++ )
+	{
+		node = huff->tree;
+		for( bits = 0; bits < HUFF_LOOKUP_BITS && node && node->symbol == INTERNAL_NODE; bits++ )
+		{
+			node = ( i >> bits ) & 1 ? node->right : node->left;
+		}
+
+		if( node && node->symbol != INTERNAL_NODE )
+		{
+			entry->symbol = node->symbol;
+			entry->bits	  = bits;
+		}
+		else
+		{
+			entry->node = node;
+		}
+	}
+}
+
+/*
+=================
+Huff_tableTransmit
+=================
+*/
+void Huff_tableTransmit( const huffTable_t* table, int ch, byte* fout, int* offset, int maxoffset )
+{
+	int		 ofs, bits, shift, i;
+	uint64_t value;
+	byte*	 out;
+
+	ofs	 = *offset;
+	bits = table->codeBits[ch];
+
+	if( !bits || ofs + bits > maxoffset )
+	{
+		// let the tree walk handle the overflow
+		offsetSend( table->huff->loc[ch], NULL, fout, offset, maxoffset );
+		return;
+	}
+
+	// Huff_putBit clears every byte it enters, so only the first one is merged
+	shift = ofs & 7;
+	value = ( uint64_t )table->code[ch] << shift;
+	out	  = fout + ( ofs >> 3 );
+
+	out[0] = shift ? out[0] | ( byte )value : ( byte )value;
+	for( i = 8; i < shift + bits; i += 8 )
+	{
+		*++out = ( byte )( value >> i );
+	}
+
+	*offset = ofs + bits;
+}
+
+/*
+=================
+Huff_tableReceive
+=================
+*/
+void Huff_tableReceive( const huffTable_t* table, int* ch, byte* fin, int* offset, int maxoffset )
+{
+	int					ofs, shift, window;
+	node_t*				node;
+	const huffLookup_t* entry;
+	const byte*			in;
+
+	ofs = *offset;
+
+	if( ofs + HUFF_LOOKUP_BITS <= maxoffset )
+	{
+		// every byte read here holds at least one bit below maxoffset
+		in	   = fin + ( ofs >> 3 );
+		shift  = ofs & 7;
+		window = in[0] | ( in[1] << 8 );
+		if( shift + HUFF_LOOKUP_BITS > 16 )
+		{
+			window |= in[2] << 16;
+		}
+
+		entry = &table->lookup[( window >> shift ) & ( ( 1 << HUFF_LOOKUP_BITS ) - 1 )];
+		if( entry->bits )
+		{
+			*ch		= entry->symbol;
+			*offset = ofs + entry->bits;
+			return;
+		}
+
+		node = entry->node;
+		ofs += HUFF_LOOKUP_BITS;
+	}
+	else
+	{
+		node = table->huff->tree;
+	}
+
+	while( node && node->symbol == INTERNAL_NODE )
+	{
+		if( ofs >= maxoffset )
+		{
+			*ch		= 0;
+			*offset = maxoffset + 1;
+			return;
+		}
+		node = ( fin[ofs >> 3] >> ( ofs & 7 ) ) & 1 ? node->right : node->left;
+		ofs++;
+	}
+	if( !node )
+	{
+		*ch = 0;
+		return;
+	}
+	*ch		= node->symbol;
+	*offset = ofs;
+}
@@ -23,11 +23,10 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "qcommon.h"
 
 static huffman_t msgHuff;
+static huffTable_t msgHuffTable;
 
 static qboolean	 msgInit = qfalse;
 
-int				 pcount[256];
-
 /*
 ==============================================================================
 
@@ -187,7 +186,7 @@ void MSG_WriteBits( msg_t* msg, int value, int bits )
 		{
 			for( i = 0; i < bits; i += 8 )
 			{
-				Huff_offsetTransmit( &msgHuff.compressor, ( value & 0xff ), msg->data, &msg->bit, msg->maxsize << 3 );
+				Huff_tableTransmit( &msgHuffTable, ( value & 0xff ), msg->data, &msg->bit, msg->maxsize << 3 );
 				value = ( value >> 8 );
 
 				if( msg->bit > msg->maxsize << 3 )
@@ -282,7 +281,7 @@ int MSG_ReadBits( msg_t* msg, int bits )
 			//			fp = fopen("c:\\netchan.bin", "a");
 			for( i = 0; i < bits; i += 8 )
 			{
-				Huff_offsetReceive( msgHuff.decompressor.tree, &get, msg->data, &msg->bit, msg->cursize << 3 );
+				Huff_tableReceive( &msgHuffTable, &get, msg->data, &msg->bit, msg->cursize << 3 );
 				//				fwrite(&get, 1, 1, fp);
 				value = ( unsigned int )value | ( ( unsigned int )get << ( i + nbits ) );
 
@@ -978,26 +977,6 @@ entityState_t communication
 =============================================================================
 */
 
-/*
-=================
-MSG_ReportChangeVectors_f
-
-Prints out a table from the current statistics for copying to code
-=================
-*/
-void MSG_ReportChangeVectors_f()
-{
-	int i;
-
-	for( i = 0; i < 256; i++ )
-	{
-		if( pcount[i] )
-		{
-			Com_Printf( "%d used %d\n", i, pcount[i] );
-		}
-	}
-}
-
 typedef struct
 {
 	char* name;
@@ -1005,6 +984,11 @@ typedef struct
 	int	  bits; // 0 = float
 } netField_t;
 
+static int	MSG_DeltaEntityType( const entityState_t* es );
+static int	MSG_FindDeltaMask( const deltaDictionary_t* dict, int type, uint64_t mask );
+static void MSG_CountChangeVector( int type, uint64_t mask );
+static int	MSG_DeltaMaskFields( uint64_t mask, int numFields );
+
 // using the stringizing operator to save typing...
 #define NETF( x ) #x, ( size_t ) & ( ( entityState_t* )0 )->x
 
@@ -1086,6 +1070,8 @@ void MSG_WriteDeltaEntity( msg_t* msg, struct entityState_s* from, struct entity
 {
 	int			i, lc;
 	int			numFields;
+	int			type, index;
+	uint64_t	changed;
 	netField_t* field;
 	int			trunc;
 	float		fullFloat;
@@ -1120,7 +1106,8 @@ void MSG_WriteDeltaEntity( msg_t* msg, struct entityState_s* from, struct entity
 		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntity: Bad entity number: %i", to->number );
 	}
 
-	lc = 0;
+	lc		= 0;
+	changed = 0;
 	// build the change vector as bytes so it is endien independent
 	for( i = 0, field = entityStateFields; i < numFields; i++, field++ )
 	{
@@ -1129,6 +1116,7 @@ void MSG_WriteDeltaEntity( msg_t* msg, struct entityState_s* from, struct entity
 		if( *fromF != *toF )
 		{
 			lc = i + 1;
+			changed |= ( uint64_t )1 << i;
 		}
 	}
 
@@ -1150,7 +1138,25 @@ void MSG_WriteDeltaEntity( msg_t* msg, struct entityState_s* from, struct entity
 	MSG_WriteBits( msg, 0, 1 ); // not removed
 	MSG_WriteBits( msg, 1, 1 ); // we have a delta
 
-	MSG_WriteByte( msg, lc ); // # of changes
+	// the receiver only knows the old state, so predict from its type
+	type = MSG_DeltaEntityType( from );
+	MSG_CountChangeVector( type, changed );
+
+	index = MSG_FindDeltaMask( msg->deltaDictionary, type, changed );
+	if( index >= 0 )
+	{
+		// the changed fields are implied by the dictionary entry
+		MSG_WriteBits( msg, 1, 1 );
+		MSG_WriteBits( msg, index, DELTA_DICT_BITS );
+	}
+	else
+	{
+		if( msg->deltaDictionary )
+		{
+			MSG_WriteBits( msg, 0, 1 );
+		}
+		MSG_WriteByte( msg, lc ); // # of changes
+	}
 
 	oldsize += numFields;
 
@@ -1161,11 +1167,17 @@ void MSG_WriteDeltaEntity( msg_t* msg, struct entityState_s* from, struct entity
 
 		if( *fromF == *toF )
 		{
-			MSG_WriteBits( msg, 0, 1 ); // no change
+			if( index < 0 )
+			{
+				MSG_WriteBits( msg, 0, 1 ); // no change
+			}
 			continue;
 		}
 
-		MSG_WriteBits( msg, 1, 1 ); // changed
+		if( index < 0 )
+		{
+			MSG_WriteBits( msg, 1, 1 ); // changed
+		}
 
 		if( field->bits == 0 )
 		{
@@ -1227,6 +1239,9 @@ void MSG_ReadDeltaEntity( msg_t* msg, entityState_t* from, entityState_t* to, in
 {
 	int			i, lc;
 	int			numFields;
+	int			type;
+	uint64_t	changed;
+	qboolean	predicted;
 	netField_t* field;
 	int *		fromF, *toF;
 	int			print;
@@ -1268,7 +1283,25 @@ void MSG_ReadDeltaEntity( msg_t* msg, entityState_t* from, entityState_t* to, in
 	}
 
 	numFields = ARRAY_LEN( entityStateFields );
-	lc		  = MSG_ReadByte( msg );
+	predicted = qfalse;
+	changed	  = 0;
+
+	if( msg->deltaDictionary && MSG_ReadBits( msg, 1 ) )
+	{
+		type = MSG_DeltaEntityType( from );
+		i	 = MSG_ReadBits( msg, DELTA_DICT_BITS );
+		if( i >= msg->deltaDictionary->numMasks[type] )
+		{
+			Com_Error( ERR_DROP, "invalid entityState change mask %i for type %i", i, type );
+		}
+		predicted = qtrue;
+		changed	  = msg->deltaDictionary->masks[type][i];
+		lc		  = MSG_DeltaMaskFields( changed, numFields );
+	}
+	else
+	{
+		lc = MSG_ReadByte( msg );
+	}
 
 	if( lc > numFields || lc < 0 )
 	{
@@ -1294,7 +1327,7 @@ void MSG_ReadDeltaEntity( msg_t* msg, entityState_t* from, entityState_t* to, in
 		fromF = ( int* )( ( byte* )from + field->offset );
 		toF	  = ( int* )( ( byte* )to + field->offset );
 
-		if( !MSG_ReadBits( msg, 1 ) )
+		if( predicted ? !( changed & ( ( uint64_t )1 << i ) ) : !MSG_ReadBits( msg, 1 ) )
 		{
 			// no change
 			*toF = *fromF;
@@ -1349,7 +1382,6 @@ void MSG_ReadDeltaEntity( msg_t* msg, entityState_t* from, entityState_t* to, in
 					}
 				}
 			}
-			//			pcount[i]++;
 		}
 	}
 	for( i = lc, field = &entityStateFields[lc]; i < numFields; i++, field++ )
@@ -1453,6 +1485,8 @@ void	   MSG_WriteDeltaPlayerstate( msg_t* msg, struct playerState_s* from, struc
 	int *		  fromF, *toF;
 	float		  fullFloat;
 	int			  trunc, lc;
+	int			  index;
+	uint64_t	  changed;
 
 	if( !from )
 	{
@@ -1462,7 +1496,8 @@ void	   MSG_WriteDeltaPlayerstate( msg_t* msg, struct playerState_s* from, struc
 
 	numFields = ARRAY_LEN( playerStateFields );
 
-	lc = 0;
+	lc		= 0;
+	changed = 0;
 	for( i = 0, field = playerStateFields; i < numFields; i++, field++ )
 	{
 		fromF = ( int* )( ( byte* )from + field->offset );
@@ -1470,10 +1505,30 @@ void	   MSG_WriteDeltaPlayerstate( msg_t* msg, struct playerState_s* from, struc
 		if( *fromF != *toF )
 		{
 			lc = i + 1;
+			changed |= ( uint64_t )1 << i;
 		}
 	}
 
-	MSG_WriteByte( msg, lc ); // # of changes
+	if( changed )
+	{
+		MSG_CountChangeVector( DELTA_DICT_PLAYERSTATE, changed );
+	}
+
+	index = changed ? MSG_FindDeltaMask( msg->deltaDictionary, DELTA_DICT_PLAYERSTATE, changed ) : -1;
+	if( index >= 0 )
+	{
+		// the changed fields are implied by the dictionary entry
+		MSG_WriteBits( msg, 1, 1 );
+		MSG_WriteBits( msg, index, DELTA_DICT_BITS );
+	}
+	else
+	{
+		if( msg->deltaDictionary )
+		{
+			MSG_WriteBits( msg, 0, 1 );
+		}
+		MSG_WriteByte( msg, lc ); // # of changes
+	}
 
 	oldsize += numFields - lc;
 
@@ -1484,12 +1539,17 @@ void	   MSG_WriteDeltaPlayerstate( msg_t* msg, struct playerState_s* from, struc
 
 		if( *fromF == *toF )
 		{
-			MSG_WriteBits( msg, 0, 1 ); // no change
+			if( index < 0 )
+			{
+				MSG_WriteBits( msg, 0, 1 ); // no change
+			}
 			continue;
 		}
 
-		MSG_WriteBits( msg, 1, 1 ); // changed
-									//		pcount[i]++;
+		if( index < 0 )
+		{
+			MSG_WriteBits( msg, 1, 1 ); // changed
+		}
 
 		if( field->bits == 0 )
 		{
@@ -1638,6 +1698,8 @@ void MSG_ReadDeltaPlayerstate( msg_t* msg, playerState_t* from, playerState_t* t
 	int *		  fromF, *toF;
 	int			  trunc;
 	playerState_t dummy;
+	uint64_t	  changed;
+	qboolean	  predicted;
 
 	if( !from )
 	{
@@ -1668,7 +1730,24 @@ void MSG_ReadDeltaPlayerstate( msg_t* msg, playerState_t* from, playerState_t* t
 	}
 
 	numFields = ARRAY_LEN( playerStateFields );
-	lc		  = MSG_ReadByte( msg );
+	predicted = qfalse;
+	changed	  = 0;
+
+	if( msg->deltaDictionary && MSG_ReadBits( msg, 1 ) )
+	{
+		i = MSG_ReadBits( msg, DELTA_DICT_BITS );
+		if( i >= msg->deltaDictionary->numMasks[DELTA_DICT_PLAYERSTATE] )
+		{
+			Com_Error( ERR_DROP, "invalid playerState change mask %i", i );
+		}
+		predicted = qtrue;
+		changed	  = msg->deltaDictionary->masks[DELTA_DICT_PLAYERSTATE][i];
+		lc		  = MSG_DeltaMaskFields( changed, numFields );
+	}
+	else
+	{
+		lc = MSG_ReadByte( msg );
+	}
 
 	if( lc > numFields || lc < 0 )
 	{
@@ -1680,7 +1759,7 @@ void MSG_ReadDeltaPlayerstate( msg_t* msg, playerState_t* from, playerState_t* t
 		fromF = ( int* )( ( byte* )from + field->offset );
 		toF	  = ( int* )( ( byte* )to + field->offset );
 
-		if( !MSG_ReadBits( msg, 1 ) )
+		if( predicted ? !( changed & ( ( uint64_t )1 << i ) ) : !MSG_ReadBits( msg, 1 ) )
 		{
 			// no change
 			*toF = *fromF;
@@ -1805,6 +1884,375 @@ void MSG_ReadDeltaPlayerstate( msg_t* msg, playerState_t* from, playerState_t* t
 	}
 }
 
+/*
+============================================================================
+
+delta change mask dictionary
+
+Most deltas of an entity type change the same few sets of fields, e.g. a
+running player only sends its position and velocity.  When both sides agreed
+on a dictionary at connect time, a delta whose changed field set is in the
+dictionary for the type of the old state sends a DELTA_DICT_BITS index
+instead of the field count byte and one change bit per field.  Any other
+delta costs a single extra bit.
+
+The server counts the change vectors it writes and rebuilds the dictionary
+from them for every map, so it adapts to the game being played.  It can not
+change during a map because deltas may be lost and the clients only learn
+it from the gamestate.  Until enough vectors were seen the seed table below
+is used, "changeVectors" prints the current statistics in the same format.
+
+============================================================================
+*/
+
+#define DELTA_STAT_SLOTS		 64
+#define DELTA_STAT_PROBES		 4
+#define DELTA_DICT_MIN_SAMPLES	 1024 // use the seeds for types with fewer samples
+#define DELTA_DICT_MIN_COUNT	 4
+#define DELTA_STAT_DECAY		 ( 1 << 22 ) // halve the counts of a type after this many samples
+
+#define DF( x )					 ( ( uint64_t )1 << ( x ) )
+
+typedef struct
+{
+	int		 type;
+	uint64_t mask;
+} deltaSeed_t;
+
+typedef struct
+{
+	uint64_t	 mask;
+	volatile int count;
+} deltaStat_t;
+
+// statistics are only approximate when snapshots are written by worker threads
+static deltaStat_t	deltaStats[DELTA_DICT_TYPES][DELTA_STAT_SLOTS];
+static volatile int deltaStatTotal[DELTA_DICT_TYPES];
+
+static const deltaSeed_t deltaSeeds[] = {
+	// ET_PLAYER
+	{ 1, DF( 1 ) | DF( 2 ) | DF( 3 ) | DF( 4 ) | DF( 7 ) },					// pos.trBase[0-1] pos.trDelta[0-1] apos.trBase[1]
+	{ 1, DF( 1 ) | DF( 2 ) | DF( 3 ) | DF( 4 ) },								// pos.trBase[0-1] pos.trDelta[0-1]
+	{ 1, DF( 7 ) },															// apos.trBase[1]
+	{ 1, DF( 7 ) | DF( 10 ) },												// apos.trBase[0-1]
+	{ 1, DF( 1 ) | DF( 2 ) | DF( 3 ) | DF( 4 ) | DF( 5 ) | DF( 7 ) | DF( 8 ) },	// airborne
+	{ 1, DF( 1 ) | DF( 2 ) | DF( 3 ) | DF( 4 ) | DF( 5 ) | DF( 8 ) },			// airborne, no turning
+
+	// playerState_t
+	{ DELTA_DICT_PLAYERSTATE, DF( 0 ) },															   // commandTime
+	{ DELTA_DICT_PLAYERSTATE, DF( 0 ) | DF( 6 ) | DF( 7 ) },										   // turning
+	{ DELTA_DICT_PLAYERSTATE, DF( 0 ) | DF( 1 ) | DF( 2 ) | DF( 3 ) | DF( 4 ) | DF( 5 ) },			   // running
+	{ DELTA_DICT_PLAYERSTATE, DF( 0 ) | DF( 1 ) | DF( 2 ) | DF( 3 ) | DF( 4 ) | DF( 5 ) | DF( 6 ) | DF( 7 ) }, // running and turning
+	{ DELTA_DICT_PLAYERSTATE, DF( 0 ) | DF( 1 ) | DF( 2 ) | DF( 3 ) | DF( 4 ) | DF( 5 ) | DF( 6 ) | DF( 7 ) | DF( 8 ) }, // and firing
+	{ DELTA_DICT_PLAYERSTATE, DF( 0 ) | DF( 1 ) | DF( 2 ) | DF( 4 ) | DF( 5 ) | DF( 6 ) | DF( 7 ) | DF( 9 ) | DF( 10 ) }, // airborne
+};
+
+/*
+=================
+MSG_DeltaEntityType
+
+Dictionary slot for an entity, events share the last one
+=================
+*/
+static int MSG_DeltaEntityType( const entityState_t* es )
+{
+	if( es->eType < 0 || es->eType >= DELTA_DICT_ENTITYTYPES )
+	{
+		return DELTA_DICT_ENTITYTYPES - 1;
+	}
+	return es->eType;
+}
+
+/*
+=================
+MSG_DeltaMaskFields
+
+Number of leading fields covered by a change mask
+=================
+*/
+static int MSG_DeltaMaskFields( uint64_t mask, int numFields )
+{
+	while( numFields > 0 && !( mask & DF( numFields - 1 ) ) )
+	{
+		numFields--;
+	}
+	return numFields;
+}
+
+/*
+=================
+MSG_FindDeltaMask
+
+Returns the dictionary index of mask, or -1
+=================
+*/
+static int MSG_FindDeltaMask( const deltaDictionary_t* dict, int type, uint64_t mask )
+{
+	int i;
+
+	if( !dict )
+	{
+		return -1;
+	}
+
+	for( i = 0; i < dict->numMasks[type]; i++ )
+	{
+		if( dict->masks[type][i] == mask )
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+=================
+MSG_CountChangeVector
+
+Keeps the most frequent change vectors of every type, a new vector
+replaces the least used one of its probe sequence
+=================
+*/
+static void MSG_CountChangeVector( int type, uint64_t mask )
+{
+	deltaStat_t* stats;
+	deltaStat_t* weakest;
+	int			 i, hash;
+
+	stats	= deltaStats[type];
+	hash	= ( int )( ( mask ^ ( mask >> 29 ) ) * 2654435761u ) & ( DELTA_STAT_SLOTS - 1 );
+	weakest = NULL;
+
+	// keep the counts and the weights from overflowing on long maps,
+	// only the thread that hits the limit halves them
+	if( Sys_AtomicIncrement( &deltaStatTotal[type] ) == DELTA_STAT_DECAY )
+	{
+		for( i = 0; i < DELTA_STAT_SLOTS; i++ )
+		{
+			stats[i].count >>= 1;
+		}
+		deltaStatTotal[type] >>= 1;
+	}
+
+	for( i = 0; i < DELTA_STAT_PROBES; i++ )
+	{
+		deltaStat_t* stat = &stats[( hash + i ) & ( DELTA_STAT_SLOTS - 1 )];
+
+		if( stat->mask == mask && stat->count )
+		{
+			Sys_AtomicIncrement( &stat->count );
+			return;
+		}
+		if( !weakest || stat->count < weakest->count )
+		{
+			weakest = stat;
+		}
+	}
+
+	weakest->mask = mask;
+	Sys_AtomicIncrement( &weakest->count );
+}
+
+/*
+=================
+MSG_DeltaMaskWeight
+
+Bits a dictionary hit saves, times how often the mask was seen
+=================
+*/
+static int MSG_DeltaMaskWeight( const deltaStat_t* stat )
+{
+	return stat->count * ( 8 + MSG_DeltaMaskFields( stat->mask, 64 ) - DELTA_DICT_BITS );
+}
+
+/*
+=================
+MSG_BuildDeltaDictionary
+
+Picks the change vectors that saved the most bits so far
+=================
+*/
+void MSG_BuildDeltaDictionary( deltaDictionary_t* dict )
+{
+	int			 type, i, j, num;
+	deltaStat_t* stats;
+	deltaStat_t	 best[DELTA_DICT_SIZE];
+
+	Com_Memset( dict, 0, sizeof( *dict ) );
+
+	for( type = 0; type < DELTA_DICT_TYPES; type++ )
+	{
+		if( deltaStatTotal[type] < DELTA_DICT_MIN_SAMPLES )
+		{
+			for( i = 0; i < ( int )ARRAY_LEN( deltaSeeds ); i++ )
+			{
+				if( deltaSeeds[i].type == type && dict->numMasks[type] < DELTA_DICT_SIZE )
+				{
+					dict->masks[type][dict->numMasks[type]++] = deltaSeeds[i].mask;
+				}
+			}
+			continue;
+		}
+
+		// insertion sort the heaviest vectors into best[]
+		stats = deltaStats[type];
+		num	  = 0;
+		for( i = 0; i < DELTA_STAT_SLOTS; i++ )
+		{
+			if( stats[i].count < DELTA_DICT_MIN_COUNT )
+			{
+				continue;
+			}
+
+			for( j = num; j > 0 && MSG_DeltaMaskWeight( &best[j - 1] ) < MSG_DeltaMaskWeight( &stats[i] ); j-- )
+			{
+				if( j < DELTA_DICT_SIZE )
+				{
+					best[j] = best[j - 1];
+				}
+			}
+			if( j < DELTA_DICT_SIZE )
+			{
+				best[j].mask  = stats[i].mask;
+				best[j].count = stats[i].count;
+				if( num < DELTA_DICT_SIZE )
+				{
+					num++;
+				}
+			}
+		}
+
+		for( i = 0; i < num; i++ )
+		{
+			dict->masks[type][i] = best[i].mask;
+		}
+		dict->numMasks[type] = num;
+
+		// let older maps fade out
+		for( i = 0; i < DELTA_STAT_SLOTS; i++ )
+		{
+			stats[i].count >>= 1;
+		}
+		deltaStatTotal[type] >>= 1;
+	}
+}
+
+/*
+=================
+MSG_WriteDeltaDictionary
+=================
+*/
+void MSG_WriteDeltaDictionary( msg_t* msg, const deltaDictionary_t* dict )
+{
+	int type, i;
+
+	for( type = 0; type < DELTA_DICT_TYPES; type++ )
+	{
+		MSG_WriteByte( msg, dict->numMasks[type] );
+		for( i = 0; i < dict->numMasks[type]; i++ )
+		{
+			MSG_WriteLong( msg, ( int )( dict->masks[type][i] & 0xffffffff ) );
+			MSG_WriteLong( msg, ( int )( dict->masks[type][i] >> 32 ) );
+		}
+	}
+}
+
+/*
+=================
+MSG_ReadDeltaDictionary
+=================
+*/
+void MSG_ReadDeltaDictionary( msg_t* msg, deltaDictionary_t* dict )
+{
+	int		 type, i, numFields;
+	uint64_t valid, lo, hi;
+
+	for( type = 0; type < DELTA_DICT_TYPES; type++ )
+	{
+		dict->numMasks[type] = MSG_ReadByte( msg );
+		if( dict->numMasks[type] > DELTA_DICT_SIZE )
+		{
+			Com_Error( ERR_DROP, "MSG_ReadDeltaDictionary: too many masks for type %i", type );
+		}
+
+		numFields = type == DELTA_DICT_PLAYERSTATE ? ARRAY_LEN( playerStateFields ) : ARRAY_LEN( entityStateFields );
+		valid	  = numFields < 64 ? DF( numFields ) - 1 : ~( uint64_t )0;
+
+		for( i = 0; i < dict->numMasks[type]; i++ )
+		{
+			lo = ( unsigned int )MSG_ReadLong( msg );
+			hi = ( unsigned int )MSG_ReadLong( msg );
+
+			// a mask must name at least one existing field
+			dict->masks[type][i] = ( lo | ( hi << 32 ) ) & valid;
+			if( !dict->masks[type][i] )
+			{
+				Com_Error( ERR_DROP, "MSG_ReadDeltaDictionary: empty mask for type %i", type );
+			}
+		}
+	}
+}
+
+/*
+=================
+MSG_ReportChangeVectors_f
+
+Prints out a table from the current statistics for copying to code
+=================
+*/
+void MSG_ReportChangeVectors_f()
+{
+	int			 type, i, j, numFields;
+	deltaStat_t* stat;
+	netField_t*	 fields;
+
+	if( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ) )
+	{
+		Com_Memset( deltaStats, 0, sizeof( deltaStats ) );
+		Com_Memset( ( void* )deltaStatTotal, 0, sizeof( deltaStatTotal ) );
+		return;
+	}
+
+	for( type = 0; type < DELTA_DICT_TYPES; type++ )
+	{
+		if( !deltaStatTotal[type] )
+		{
+			continue;
+		}
+
+		if( type == DELTA_DICT_PLAYERSTATE )
+		{
+			fields	  = playerStateFields;
+			numFields = ARRAY_LEN( playerStateFields );
+			Com_Printf( "// playerState_t, %i deltas\n", deltaStatTotal[type] );
+		}
+		else
+		{
+			fields	  = entityStateFields;
+			numFields = ARRAY_LEN( entityStateFields );
+			Com_Printf( "// eType %i, %i deltas\n", type, deltaStatTotal[type] );
+		}
+
+		for( i = 0, stat = deltaStats[type]; i < DELTA_STAT_SLOTS; i++, stat++ )
+		{
+			if( stat->count < DELTA_DICT_MIN_COUNT )
+			{
+				continue;
+			}
+
+			Com_Printf( "{ %i, 0x%08x%08xULL }, // %i:", type, ( unsigned int )( stat->mask >> 32 ), ( unsigned int )( stat->mask & 0xffffffff ), stat->count );
+			for( j = 0; j < numFields; j++ )
+			{
+				if( stat->mask & DF( j ) )
+				{
+					Com_Printf( " %s", fields[j].name );
+				}
+			}
+			Com_Printf( "\n" );
+		}
+	}
+}
+
 int msg_hData[256] = {
 	250315, // 0
 	41193,	// 1
@@ -2078,6 +2526,125 @@ void MSG_initHuffman()
 			Huff_addRef( &msgHuff.decompressor, ( byte )i ); // Do update
 		}
 	}
+
+	// the tree is fixed from now on
+	Huff_BuildTable( &msgHuffTable, &msgHuff.compressor );
+}
+
+/*
+=================
+MSG_HuffmanBenchmark_f
+
+Runs the tree walking and the table driven codec over data that follows
+msg_hData and checks that they agree
+=================
+*/
+void MSG_HuffmanBenchmark_f()
+{
+	static byte src[MAX_MSGLEN / 2];
+	static byte treeOut[MAX_MSGLEN];
+	static byte tableOut[MAX_MSGLEN];
+	static byte decoded[MAX_MSGLEN / 2];
+	int			i, j, iterations, total, pick, seed;
+	int			treeBits, tableBits, ofs, ch;
+	int64_t		start, treeEncode, tableEncode, treeDecode, tableDecode;
+	qboolean	match;
+
+	if( !msgInit )
+	{
+		MSG_initHuffman();
+	}
+
+	iterations = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 200;
+	if( iterations < 1 )
+	{
+		iterations = 1;
+	}
+
+	// sample the symbols with the frequencies the tree was built for
+	total = 0;
+	for( i = 0; i < 256; i++ )
+	{
+		total += msg_hData[i];
+	}
+	seed = 0x12345;
+	for( i = 0; i < ( int )sizeof( src ); i++ )
+	{
+		seed = seed * 1103515245 + 12345;
+		pick = ( ( unsigned int )seed >> 8 ) % total;
+		for( j = 0; pick >= msg_hData[j]; j++ )
+		{
+			pick -= msg_hData[j];
+		}
+		src[i] = j;
+	}
+
+	start = Sys_Microseconds();
+	for( i = 0; i < iterations; i++ )
+	{
+		treeBits = 0;
+		for( j = 0; j < ( int )sizeof( src ); j++ )
+		{
+			Huff_offsetTransmit( &msgHuff.compressor, src[j], treeOut, &treeBits, sizeof( treeOut ) << 3 );
+		}
+	}
+	treeEncode = Sys_Microseconds() - start;
+
+	start = Sys_Microseconds();
+	for( i = 0; i < iterations; i++ )
+	{
+		tableBits = 0;
+		for( j = 0; j < ( int )sizeof( src ); j++ )
+		{
+			Huff_tableTransmit( &msgHuffTable, src[j], tableOut, &tableBits, sizeof( tableOut ) << 3 );
+		}
+	}
+	tableEncode = Sys_Microseconds() - start;
+
+	match = ( treeBits == tableBits && !memcmp( treeOut, tableOut, ( treeBits + 7 ) >> 3 ) ) ? qtrue : qfalse;
+
+	start = Sys_Microseconds();
+	for( i = 0; i < iterations; i++ )
+	{
+		ofs = 0;
+		for( j = 0; j < ( int )sizeof( src ); j++ )
+		{
+			Huff_offsetReceive( msgHuff.decompressor.tree, &ch, treeOut, &ofs, treeBits );
+			decoded[j] = ch;
+		}
+	}
+	treeDecode = Sys_Microseconds() - start;
+
+	if( memcmp( decoded, src, sizeof( src ) ) )
+	{
+		match = qfalse;
+	}
+
+	start = Sys_Microseconds();
+	for( i = 0; i < iterations; i++ )
+	{
+		ofs = 0;
+		for( j = 0; j < ( int )sizeof( src ); j++ )
+		{
+			Huff_tableReceive( &msgHuffTable, &ch, treeOut, &ofs, treeBits );
+			decoded[j] = ch;
+		}
+	}
+	tableDecode = Sys_Microseconds() - start;
+
+	if( memcmp( decoded, src, sizeof( src ) ) )
+	{
+		match = qfalse;
+	}
+
+	Com_Printf( "%i x %i bytes, %.2f bits per byte\n", iterations, ( int )sizeof( src ), ( float )treeBits / sizeof( src ) );
+	Com_Printf( "encode: tree %7.1f MB/s, table %7.1f MB/s\n",
+		( float )iterations * sizeof( src ) / MAX( treeEncode, 1 ),
+		( float )iterations * sizeof( src ) / MAX( tableEncode, 1 ) );
+	Com_Printf( "decode: tree %7.1f MB/s, table %7.1f MB/s\n",
+		( float )iterations * sizeof( src ) / MAX( treeDecode, 1 ),
+		( float )iterations * sizeof( src ) / MAX( tableDecode, 1 ) );
+	Com_Printf( "%s\n", match ? "outputs are identical" : "^1outputs differ" );
 }
 
 /*
@@ -20,6 +20,10 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 ===========================================================================
 */
 
+#if defined( __linux__ ) && !defined( _GNU_SOURCE )
+	#define _GNU_SOURCE // recvmmsg / sendmmsg
+#endif
+
 #include <q_shared.h>
 #include "../qcommon/qcommon.h"
 
@@ -109,6 +113,8 @@ static cvar_t*			   net_port6;
 static cvar_t*			   net_mcast6addr;
 static cvar_t*			   net_mcast6iface;
 
+static cvar_t*			   net_batchPackets;
+
 static struct sockaddr	   socksRelayAddr;
 
 static SOCKET			   ip_socket		 = INVALID_SOCKET;
@@ -633,137 +639,353 @@ qboolean NET_IsLocalAddress( netadr_t adr )
 //=============================================================================
 
 /*
-==================
-Sys_GetPacket
+=============================================================================
 
-Never called by the game logic, just the system event queing
-==================
+PACKET BATCHING
+
+Incoming datagrams are drained into a ring of packets, on Linux with one
+recvmmsg call per socket.  Between Sys_BeginPacketBatch and
+Sys_FlushPacketBatch outgoing packets are collected as well and handed to
+sendmmsg together, other platforms send them right away.
+
+=============================================================================
 */
-#ifdef _DEBUG
-int recvfromCount;
+
+#if defined( __linux__ ) && defined( MSG_WAITFORONE )
+	#define USE_MMSG
 #endif
 
-qboolean Sys_GetPacket( netadr_t* net_from, msg_t* net_message )
+#define NET_BATCH_PACKETS	32
+#define NET_BATCH_PACKETLEN 1400 // larger packets are sent on their own
+
+typedef struct
 {
-	int						ret;
+	SOCKET					socket;
+	int						length;
 	struct sockaddr_storage from;
 	socklen_t				fromlen;
-	int						err;
+	byte					data[MAX_MSGLEN];
+} netRecvPacket_t;
+
+typedef struct
+{
+	SOCKET					socket;
+	netadrtype_t			type;
+	int						length;
+	struct sockaddr_storage addr;
+	socklen_t				addrlen;
+	byte					data[NET_BATCH_PACKETLEN];
+} netSendPacket_t;
+
+static netRecvPacket_t recvPackets[NET_BATCH_PACKETS];
+static int			   recvPacketNext;
+static int			   numRecvPackets;
+
+static netSendPacket_t sendPackets[NET_BATCH_PACKETS];
+static int			   numSendPackets;
+static qboolean		   sendBatching;
+
+#ifdef USE_MMSG
+static qboolean mmsgUnsupported; // kernel without recvmmsg / sendmmsg
+#endif
+
+#ifdef _DEBUG
+int recvfromCount;
+#endif
+
+/*
+==================
+NET_ReceivePackets
+
+Appends whatever is waiting on the socket to the receive ring
+==================
+*/
+static void NET_ReceivePackets( SOCKET s )
+{
+	netRecvPacket_t* packet;
+	int				 ret, err;
+#ifdef USE_MMSG
+	struct mmsghdr msgs[NET_BATCH_PACKETS];
+	struct iovec   iov[NET_BATCH_PACKETS];
+	int			   i, count;
+#endif
+
+	if( numRecvPackets == NET_BATCH_PACKETS )
+	{
+		return;
+	}
 
 #ifdef _DEBUG
 	recvfromCount++; // performance check
 #endif
 
-	if( ip_socket != INVALID_SOCKET )
+#ifdef USE_MMSG
+	if( net_batchPackets->integer && !mmsgUnsupported )
 	{
-		fromlen = sizeof( from );
-		ret		= recvfrom( ip_socket, ( void* )net_message->data, net_message->maxsize, 0, ( struct sockaddr* )&from, &fromlen );
+		count = NET_BATCH_PACKETS - numRecvPackets;
 
-		if( ret == SOCKET_ERROR )
+		memset( msgs, 0, count * sizeof( msgs[0] ) );
+		for( i = 0; i < count; i++ )
 		{
-			err = socketError;
+			packet = &recvPackets[numRecvPackets + i];
 
-			if( err != EAGAIN && err != ECONNRESET )
-			{
-				Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
-			}
+			iov[i].iov_base				= packet->data;
+			iov[i].iov_len				= sizeof( packet->data );
+			msgs[i].msg_hdr.msg_iov		= &iov[i];
+			msgs[i].msg_hdr.msg_iovlen	= 1;
+			msgs[i].msg_hdr.msg_name	= &packet->from;
+			msgs[i].msg_hdr.msg_namelen = sizeof( packet->from );
 		}
-		else
-		{
-			memset( ( ( struct sockaddr_in* )&from )->sin_zero, 0, 8 );
 
-			if( usingSocks && memcmp( &from, &socksRelayAddr, fromlen ) == 0 )
-			{
-				if( ret < 10 || net_message->data[0] != 0 || net_message->data[1] != 0 || net_message->data[2] != 0 || net_message->data[3] != 1 )
-				{
-					return qfalse;
-				}
-				net_from->type		   = NA_IP;
-				net_from->ip[0]		   = net_message->data[4];
-				net_from->ip[1]		   = net_message->data[5];
-				net_from->ip[2]		   = net_message->data[6];
-				net_from->ip[3]		   = net_message->data[7];
-				net_from->port		   = *( short* )&net_message->data[8];
-				net_message->readcount = 10;
-			}
-			else
+		ret = recvmmsg( s, msgs, count, MSG_DONTWAIT, NULL );
+		if( ret != SOCKET_ERROR )
+		{
+			for( i = 0; i < ret; i++ )
 			{
-				SockadrToNetadr( ( struct sockaddr* )&from, net_from );
-				net_message->readcount = 0;
+				packet			= &recvPackets[numRecvPackets + i];
+				packet->socket	= s;
+				packet->length	= msgs[i].msg_len;
+				packet->fromlen = msgs[i].msg_hdr.msg_namelen;
 			}
+			numRecvPackets += ret;
+			return;
+		}
 
-			if( ret == net_message->maxsize )
+		if( socketError != ENOSYS )
+		{
+			err = socketError;
+			if( err != EAGAIN && err != ECONNRESET )
 			{
-				Com_Printf( "Oversize packet from %s\n", NET_AdrToString( *net_from ) );
-				return qfalse;
+				Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
 			}
-
-			net_message->cursize = ret;
-			return qtrue;
+			return;
 		}
+
+		Com_DPrintf( "recvmmsg is not available, receiving packets one at a time\n" );
+		mmsgUnsupported = qtrue;
 	}
+#endif
 
-	if( ip6_socket != INVALID_SOCKET )
+	packet			= &recvPackets[numRecvPackets];
+	packet->fromlen = sizeof( packet->from );
+	ret				= recvfrom( s, ( void* )packet->data, sizeof( packet->data ), 0, ( struct sockaddr* )&packet->from, &packet->fromlen );
+
+	if( ret == SOCKET_ERROR )
 	{
-		fromlen = sizeof( from );
-		ret		= recvfrom( ip6_socket, ( void* )net_message->data, net_message->maxsize, 0, ( struct sockaddr* )&from, &fromlen );
+		err = socketError;
 
-		if( ret == SOCKET_ERROR )
+		if( err != EAGAIN && err != ECONNRESET )
 		{
-			err = socketError;
+			Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
+		}
+		return;
+	}
 
-			if( err != EAGAIN && err != ECONNRESET )
+	packet->socket = s;
+	packet->length = ret;
+	numRecvPackets++;
+}
+
+/*
+==================
+NET_ParsePacket
+
+Fills in net_from and net_message from a received packet
+==================
+*/
+static qboolean NET_ParsePacket( netRecvPacket_t* packet, netadr_t* net_from, msg_t* net_message )
+{
+	if( packet->socket == ip_socket )
+	{
+		memset( ( ( struct sockaddr_in* )&packet->from )->sin_zero, 0, 8 );
+
+		if( usingSocks && memcmp( &packet->from, &socksRelayAddr, packet->fromlen ) == 0 )
+		{
+			if( packet->length < 10 || packet->data[0] != 0 || packet->data[1] != 0 || packet->data[2] != 0 || packet->data[3] != 1 )
 			{
-				Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
+				return qfalse;
 			}
+			net_from->type		   = NA_IP;
+			net_from->ip[0]		   = packet->data[4];
+			net_from->ip[1]		   = packet->data[5];
+			net_from->ip[2]		   = packet->data[6];
+			net_from->ip[3]		   = packet->data[7];
+			net_from->port		   = *( short* )&packet->data[8];
+			net_message->readcount = 10;
 		}
 		else
 		{
-			SockadrToNetadr( ( struct sockaddr* )&from, net_from );
+			SockadrToNetadr( ( struct sockaddr* )&packet->from, net_from );
 			net_message->readcount = 0;
+		}
+	}
+	else
+	{
+		SockadrToNetadr( ( struct sockaddr* )&packet->from, net_from );
+		net_message->readcount = 0;
+	}
 
-			if( ret == net_message->maxsize )
-			{
-				Com_Printf( "Oversize packet from %s\n", NET_AdrToString( *net_from ) );
-				return qfalse;
-			}
+	if( packet->length == sizeof( packet->data ) || packet->length >= net_message->maxsize )
+	{
+		Com_Printf( "Oversize packet from %s\n", NET_AdrToString( *net_from ) );
+		return qfalse;
+	}
+
+	Com_Memcpy( net_message->data, packet->data, packet->length );
+	net_message->cursize = packet->length;
+	return qtrue;
+}
+
+/*
+==================
+Sys_GetPacket
 
-			net_message->cursize = ret;
+Never called by the game logic, just the system event queing
+==================
+*/
+qboolean Sys_GetPacket( netadr_t* net_from, msg_t* net_message )
+{
+	if( recvPacketNext == numRecvPackets )
+	{
+		recvPacketNext = numRecvPackets = 0;
+
+		if( ip_socket != INVALID_SOCKET )
+		{
+			NET_ReceivePackets( ip_socket );
+		}
+		if( ip6_socket != INVALID_SOCKET )
+		{
+			NET_ReceivePackets( ip6_socket );
+		}
+		if( multicast6_socket != INVALID_SOCKET && multicast6_socket != ip6_socket )
+		{
+			NET_ReceivePackets( multicast6_socket );
+		}
+	}
+
+	while( recvPacketNext < numRecvPackets )
+	{
+		if( NET_ParsePacket( &recvPackets[recvPacketNext++], net_from, net_message ) )
+		{
 			return qtrue;
 		}
 	}
 
-	if( multicast6_socket != INVALID_SOCKET && multicast6_socket != ip6_socket )
+	return qfalse;
+}
+
+/*
+==================
+NET_SendPacketError
+==================
+*/
+static void NET_SendPacketError( netadrtype_t type )
+{
+	int err = socketError;
+
+	// wouldblock is silent
+	if( err == EAGAIN )
+	{
+		return;
+	}
+
+	// some PPP links do not allow broadcasts and return an error
+	if( ( err == EADDRNOTAVAIL ) && ( ( type == NA_BROADCAST ) ) )
 	{
-		fromlen = sizeof( from );
-		ret		= recvfrom( multicast6_socket, ( void* )net_message->data, net_message->maxsize, 0, ( struct sockaddr* )&from, &fromlen );
+		return;
+	}
 
-		if( ret == SOCKET_ERROR )
+	Com_Printf( "NET_SendPacket: %s\n", NET_ErrorString() );
+}
+
+/*
+==================
+NET_SendBatch
+==================
+*/
+static void NET_SendBatch()
+{
+#ifdef USE_MMSG
+	struct mmsghdr	 msgs[NET_BATCH_PACKETS];
+	struct iovec	 iov[NET_BATCH_PACKETS];
+	netSendPacket_t* packet;
+	int				 i, end, ret;
+
+	memset( msgs, 0, numSendPackets * sizeof( msgs[0] ) );
+	for( i = 0, packet = sendPackets; i < numSendPackets; i++, packet++ )
+	{
+		iov[i].iov_base				= packet->data;
+		iov[i].iov_len				= packet->length;
+		msgs[i].msg_hdr.msg_iov		= &iov[i];
+		msgs[i].msg_hdr.msg_iovlen	= 1;
+		msgs[i].msg_hdr.msg_name	= &packet->addr;
+		msgs[i].msg_hdr.msg_namelen = packet->addrlen;
+	}
+
+	// one call for every run of packets on the same socket
+	for( i = 0; i < numSendPackets; )
+	{
+		for( end = i + 1; end < numSendPackets && sendPackets[end].socket == sendPackets[i].socket; end++ )
 		{
-			err = socketError;
+		}
 
-			if( err != EAGAIN && err != ECONNRESET )
+		ret = sendmmsg( sendPackets[i].socket, &msgs[i], end - i, 0 );
+		if( ret == SOCKET_ERROR && socketError == ENOSYS )
+		{
+			Com_DPrintf( "sendmmsg is not available, sending packets one at a time\n" );
+			mmsgUnsupported = qtrue;
+			for( ; i < numSendPackets; i++ )
 			{
-				Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
+				packet = &sendPackets[i];
+				if( sendto( packet->socket, packet->data, packet->length, 0, ( struct sockaddr* )&packet->addr, packet->addrlen ) == SOCKET_ERROR )
+				{
+					NET_SendPacketError( packet->type );
+				}
 			}
+			break;
+		}
+		if( ret == SOCKET_ERROR )
+		{
+			// drop the packet that failed and go on with the rest
+			NET_SendPacketError( sendPackets[i].type );
+			i++;
 		}
 		else
 		{
-			SockadrToNetadr( ( struct sockaddr* )&from, net_from );
-			net_message->readcount = 0;
-
-			if( ret == net_message->maxsize )
-			{
-				Com_Printf( "Oversize packet from %s\n", NET_AdrToString( *net_from ) );
-				return qfalse;
-			}
-
-			net_message->cursize = ret;
-			return qtrue;
+			i += ret;
 		}
 	}
+#endif
 
-	return qfalse;
+	numSendPackets = 0;
+}
+
+/*
+==================
+Sys_BeginPacketBatch
+
+Packets sent until Sys_FlushPacketBatch may be delayed until then
+==================
+*/
+void Sys_BeginPacketBatch()
+{
+#ifdef USE_MMSG
+	sendBatching = ( net_batchPackets && net_batchPackets->integer && !mmsgUnsupported ) ? qtrue : qfalse;
+#endif
+}
+
+/*
+==================
+Sys_FlushPacketBatch
+==================
+*/
+void Sys_FlushPacketBatch()
+{
+	if( numSendPackets )
+	{
+		NET_SendBatch();
+	}
+	sendBatching = qfalse;
 }
 
 //=============================================================================
@@ -799,6 +1021,33 @@ void		Sys_SendPacket( int length, const void* data, netadr_t to )
 	memset( &addr, 0, sizeof( addr ) );
 	NetadrToSockadr( &to, ( struct sockaddr* )&addr );
 
+	if( sendBatching )
+	{
+		if( !( usingSocks && to.type == NA_IP ) && length <= NET_BATCH_PACKETLEN && ( addr.ss_family == AF_INET || addr.ss_family == AF_INET6 ) )
+		{
+			netSendPacket_t* packet = &sendPackets[numSendPackets++];
+
+			packet->socket	= addr.ss_family == AF_INET ? ip_socket : ip6_socket;
+			packet->type	= to.type;
+			packet->length	= length;
+			packet->addr	= addr;
+			packet->addrlen = addr.ss_family == AF_INET ? sizeof( struct sockaddr_in ) : sizeof( struct sockaddr_in6 );
+			memcpy( packet->data, data, length );
+
+			if( numSendPackets == NET_BATCH_PACKETS )
+			{
+				NET_SendBatch();
+			}
+			return;
+		}
+
+		// keep the order of the queued packets
+		if( numSendPackets )
+		{
+			NET_SendBatch();
+		}
+	}
+
 	if( usingSocks && to.type == NA_IP )
 	{
 		socksBuf[0]				= 0; // reserved
@@ -823,22 +1072,54 @@ void		Sys_SendPacket( int length, const void* data, netadr_t to )
 	}
 	if( ret == SOCKET_ERROR )
 	{
-		int err = socketError;
+		NET_SendPacketError( to.type );
+	}
+}
 
-		// wouldblock is silent
-		if( err == EAGAIN )
-		{
-			return;
-		}
+/*
+==================
+Sys_SendPacketUnbuffered
 
-		// some PPP links do not allow broadcasts and return an error
-		if( ( err == EADDRNOTAVAIL ) && ( ( to.type == NA_BROADCAST ) ) )
-		{
-			return;
-		}
+Sends a plain unicast packet straight to the socket, bypassing the batch
+queue and the socks relay and without reporting errors, so it can be
+called from a thread other than the main one.  Returns qfalse if the
+packet could not be sent this way.
+==================
+*/
+qboolean Sys_SendPacketUnbuffered( int length, const void* data, netadr_t to )
+{
+	struct sockaddr_storage addr;
+	SOCKET					sock;
+	int						addrlen;
+
+	if( to.type == NA_IP && !usingSocks )
+	{
+		sock	= ip_socket;
+		addrlen = sizeof( struct sockaddr_in );
+	}
+	else if( to.type == NA_IP6 )
+	{
+		sock	= ip6_socket;
+		addrlen = sizeof( struct sockaddr_in6 );
+	}
+	else
+	{
+		return qfalse;
+	}
 
-		Com_Printf( "NET_SendPacket: %s\n", NET_ErrorString() );
+	if( sock == INVALID_SOCKET )
+	{
+		return qfalse;
 	}
+
+	memset( &addr, 0, sizeof( addr ) );
+	NetadrToSockadr( &to, ( struct sockaddr* )&addr );
+
+	if( sendto( sock, data, length, 0, ( struct sockaddr* )&addr, addrlen ) == SOCKET_ERROR )
+	{
+		return qfalse;
+	}
+	return qtrue;
 }
 
 //=============================================================================
@@ -1734,6 +2015,9 @@ static qboolean NET_GetCvars()
 	modified += net_socksPassword->modified;
 	net_socksPassword->modified = qfalse;
 
+	// takes effect immediately, no need to reopen the sockets
+	net_batchPackets = Cvar_Get( "net_batchPackets", "1", CVAR_ARCHIVE );
+
 	return modified ? qtrue : qfalse;
 }
 
@@ -1792,6 +2076,10 @@ void NET_Config( qboolean enableNetworking )
 
 	if( stop )
 	{
+		// nothing may refer to the old sockets
+		Sys_FlushPacketBatch();
+		recvPacketNext = numRecvPackets = 0;
+
 		if( ip_socket != INVALID_SOCKET )
 		{
 			closesocket( ip_socket );
@@ -0,0 +1,398 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// profile.c -- frame profiler
+/*
+
+Code is instrumented with PROF_BEGIN( "name" ) / PROF_END() pairs.  While
+com_profile is set every thread that runs instrumented code records the
+finished zones into its own ring buffer, so recording never takes a lock.
+The rings always hold the most recent events, "profiledump" writes them
+out in the Chrome trace event format, to be opened in chrome://tracing or
+ui.perfetto.dev.
+
+Zone names must be string literals, only the pointer is stored.
+
+com_profileSpike can be set to a frame time in msec, a dump is then
+written automatically to profile/spike_<frame>.json whenever the outermost
+zone of the main thread, the work part of Com_Frame, takes longer than
+that, at most once every PROF_SPIKE_INTERVAL msec.
+
+*/
+
+#include "q_shared.h"
+#include "qcommon.h"
+
+#if defined( _MSC_VER )
+	#define PROF_THREAD_LOCAL __declspec( thread )
+#else
+	#define PROF_THREAD_LOCAL __thread
+#endif
+
+#define PROF_MAX_THREADS	( MAX_JOB_THREADS + 8 ) // job workers plus the long running threads
+#define PROF_MAX_DEPTH		32
+#define PROF_THREAD_EVENTS	8192  // ring size for threads other than the main one
+#define PROF_SPIKE_INTERVAL 10000
+#define PROF_DUMP_BUFFER	65536
+
+typedef struct
+{
+	const char* name;
+	int64_t		start; // usec since the profiler was started
+	int			duration;
+	int			depth;
+} profEvent_t;
+
+typedef struct
+{
+	int			 epoch; // open zones from an earlier recording are dropped
+	int			 depth;
+	const char*	 names[PROF_MAX_DEPTH];
+	int64_t		 starts[PROF_MAX_DEPTH];
+
+	int			 numEvents; // total ever recorded, the ring holds the last ones
+	int			 ringSize;	// power of two
+	profEvent_t* ring;
+} profThread_t;
+
+int								prof_active;
+
+static cvar_t*					com_profile;
+static cvar_t*					com_profileEvents;
+static cvar_t*					com_profileSpike;
+
+static profThread_t				profThreads[PROF_MAX_THREADS];
+static int						profNumThreads;
+static int						profEpoch;
+static int64_t					profBaseTime;
+static int						profSpikeChecked; // main thread events already checked for spikes
+static int						profLastSpike;
+
+static PROF_THREAD_LOCAL profThread_t* profThread;
+static PROF_THREAD_LOCAL qboolean	   profNoSlot;
+
+/*
+==================
+Prof_ThreadState
+
+Gives each thread its own slot the first time it records something
+==================
+*/
+static profThread_t* Prof_ThreadState()
+{
+	int slot;
+
+	if( profThread )
+	{
+		return profThread;
+	}
+	if( profNoSlot )
+	{
+		return NULL;
+	}
+
+	slot = Sys_AtomicIncrement( &profNumThreads );
+	if( slot >= PROF_MAX_THREADS )
+	{
+		profNoSlot = qtrue;
+		return NULL;
+	}
+
+	profThread = &profThreads[slot];
+	return profThread;
+}
+
+/*
+==================
+Prof_Begin
+==================
+*/
+void Prof_Begin( const char* name )
+{
+	profThread_t* t = Prof_ThreadState();
+
+	if( !t || !t->ring )
+	{
+		return;
+	}
+
+	if( t->epoch != profEpoch )
+	{
+		t->epoch = profEpoch;
+		t->depth = 0;
+	}
+
+	// too deep zones still have to be matched by their PROF_END
+	if( t->depth < PROF_MAX_DEPTH )
+	{
+		t->names[t->depth]	= name;
+		t->starts[t->depth] = Sys_Microseconds() - profBaseTime;
+	}
+	t->depth++;
+}
+
+/*
+==================
+Prof_End
+==================
+*/
+void Prof_End()
+{
+	profThread_t* t = Prof_ThreadState();
+	profEvent_t*  ev;
+	int64_t		  now;
+
+	if( !t || !t->ring || t->epoch != profEpoch || t->depth <= 0 )
+	{
+		return;
+	}
+
+	t->depth--;
+	if( t->depth >= PROF_MAX_DEPTH )
+	{
+		return;
+	}
+
+	now			 = Sys_Microseconds() - profBaseTime;
+	ev			 = &t->ring[t->numEvents & ( t->ringSize - 1 )];
+	ev->name	 = t->names[t->depth];
+	ev->start	 = t->starts[t->depth];
+	ev->duration = ( int )( now - ev->start );
+	ev->depth	 = t->depth;
+	t->numEvents++;
+}
+
+/*
+==================
+Prof_WriteTrace
+
+Writes all rings as Chrome trace "complete" events
+==================
+*/
+static qboolean Prof_WriteTrace( const char* filename )
+{
+	fileHandle_t  f;
+	char*		  buffer;
+	int			  used, i, j, first, count, written;
+	profThread_t* t;
+	profEvent_t*  ev;
+
+	f = FS_FOpenFileWrite( filename );
+	if( !f )
+	{
+		Com_Printf( "Couldn't write %s\n", filename );
+		return qfalse;
+	}
+
+	buffer = Z_Malloc( PROF_DUMP_BUFFER );
+	used   = Com_sprintf( buffer, PROF_DUMP_BUFFER, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+
+	written = 0;
+	for( i = 0; i < PROF_MAX_THREADS && i < profNumThreads; i++ )
+	{
+		t = &profThreads[i];
+		if( !t->ring || !t->numEvents )
+		{
+			continue;
+		}
+
+		used += Com_sprintf( buffer + used, PROF_DUMP_BUFFER - used, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}}",
+			written ? ",\n" : "", i, i ? va( "thread %i", i ) : "main" );
+		written++;
+
+		count = MIN( t->numEvents, t->ringSize );
+		first = t->numEvents - count;
+		for( j = 0; j < count; j++ )
+		{
+			if( used > PROF_DUMP_BUFFER - 256 )
+			{
+				FS_Write( buffer, used, f );
+				used = 0;
+			}
+
+			ev = &t->ring[( first + j ) & ( t->ringSize - 1 )];
+			used += Com_sprintf( buffer + used, PROF_DUMP_BUFFER - used, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%i,\"ts\":%lld,\"dur\":%i}", ev->name, i,
+				( long long )ev->start, ev->duration );
+			written++;
+		}
+	}
+
+	used += Com_sprintf( buffer + used, PROF_DUMP_BUFFER - used, "\n]}\n" );
+	FS_Write( buffer, used, f );
+	FS_FCloseFile( f );
+	Z_Free( buffer );
+
+	Com_Printf( "Wrote %i profile events to %s\n", written, filename );
+	return qtrue;
+}
+
+/*
+==================
+Prof_Dump
+
+Recording is paused while the rings are written.  A zone of another
+thread that is just being closed may still come out torn, and zones that
+were open during the dump are dropped.
+==================
+*/
+static void Prof_Dump( const char* filename )
+{
+	int active = prof_active;
+
+	prof_active = 0;
+	Sys_MemoryBarrier();
+
+	Prof_WriteTrace( filename );
+
+	// their PROF_END was skipped while paused
+	profEpoch++;
+	Sys_MemoryBarrier();
+	prof_active = active;
+}
+
+/*
+==================
+Prof_Dump_f
+
+profiledump [filename]
+==================
+*/
+static void Prof_Dump_f()
+{
+	char filename[MAX_QPATH];
+
+	if( !profThreads[0].ring )
+	{
+		Com_Printf( "Nothing recorded, set com_profile 1 first\n" );
+		return;
+	}
+
+	if( Cmd_Argc() > 1 )
+	{
+		Q_strncpyz( filename, Cmd_Argv( 1 ), sizeof( filename ) );
+		Com_DefaultExtension( filename, sizeof( filename ), ".json" );
+	}
+	else
+	{
+		Com_sprintf( filename, sizeof( filename ), "profile/frame_%i.json", com_frameNumber );
+	}
+
+	Prof_Dump( filename );
+}
+
+/*
+==================
+Prof_StartRecording
+
+The rings are allocated on the main thread the first time recording is
+switched on and kept until shutdown, so a thread that is still inside a
+zone never writes to freed memory.
+==================
+*/
+static void Prof_StartRecording()
+{
+	int i, size;
+
+	if( !profThreads[0].ring )
+	{
+		// round the main ring down to a power of two
+		for( size = 1024; size * 2 <= com_profileEvents->integer; size *= 2 )
+			;
+
+		for( i = 0; i < PROF_MAX_THREADS; i++ )
+		{
+			profThreads[i].ringSize = i ? PROF_THREAD_EVENTS : size;
+			profThreads[i].ring		= Z_Malloc( profThreads[i].ringSize * sizeof( profEvent_t ) );
+		}
+		profBaseTime = Sys_Microseconds();
+	}
+
+	for( i = 0; i < PROF_MAX_THREADS; i++ )
+	{
+		profThreads[i].numEvents = 0;
+	}
+	profSpikeChecked = 0;
+
+	profEpoch++;
+	Sys_MemoryBarrier();
+	prof_active = 1;
+}
+
+/*
+==================
+Prof_Frame
+
+Called by the main thread at the start of every frame
+==================
+*/
+void Prof_Frame()
+{
+	profThread_t* t = &profThreads[0];
+	profEvent_t*  last;
+
+	if( com_profile->integer && !prof_active )
+	{
+		Prof_StartRecording();
+	}
+	else if( !com_profile->integer && prof_active )
+	{
+		prof_active = 0;
+	}
+
+	if( !prof_active )
+	{
+		return;
+	}
+
+	// a dropped frame leaves its zones open
+	t->depth = 0;
+
+	if( com_profileSpike->integer > 0 && t->numEvents > profSpikeChecked )
+	{
+		profSpikeChecked = t->numEvents;
+
+		last = &t->ring[( t->numEvents - 1 ) & ( t->ringSize - 1 )];
+		if( !last->depth && last->duration > com_profileSpike->integer * 1000 && ( !profLastSpike || Sys_Milliseconds() - profLastSpike > PROF_SPIKE_INTERVAL ) )
+		{
+			Com_Printf( "%s took %i msec in frame %i\n", last->name, last->duration / 1000, com_frameNumber );
+			Prof_Dump( va( "profile/spike_%i.json", com_frameNumber ) );
+			profLastSpike = Sys_Milliseconds();
+		}
+	}
+}
+
+/*
+==================
+Prof_Init
+
+Must be called by the main thread, which takes the first slot
+==================
+*/
+void Prof_Init()
+{
+	com_profile		  = Cvar_Get( "com_profile", "0", 0 );
+	com_profileEvents = Cvar_Get( "com_profileEvents", "131072", CVAR_LATCH );
+	com_profileSpike  = Cvar_Get( "com_profileSpike", "0", 0 );
+
+	Prof_ThreadState();
+
+	Cmd_AddCommand( "profiledump", Prof_Dump_f );
+}
@@ -40,6 +40,24 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 //
 // msg.c
 //
+
+// field change masks that entity and player state deltas can refer to
+// with a short index instead of sending one change bit per field
+#define DELTA_DICT_BITS		   4
+#define DELTA_DICT_SIZE		   ( 1 << DELTA_DICT_BITS )
+#define DELTA_DICT_ENTITYTYPES 16 // entity types above this share the last slot
+#define DELTA_DICT_PLAYERSTATE DELTA_DICT_ENTITYTYPES
+#define DELTA_DICT_TYPES	   ( DELTA_DICT_ENTITYTYPES + 1 )
+
+// bumped whenever the dictionary delta encoding changes
+#define DELTA_ENCODING_VERSION 1
+
+typedef struct deltaDictionary_s
+{
+	int		 numMasks[DELTA_DICT_TYPES];
+	uint64_t masks[DELTA_DICT_TYPES][DELTA_DICT_SIZE];
+} deltaDictionary_t;
+
 typedef struct
 {
 	qboolean allowoverflow; // if false, do a Com_Error
@@ -50,6 +68,10 @@ typedef struct
 	int		 cursize;
 	int		 readcount;
 	int		 bit; // for bitwise reads and writes
+
+	// entity and player state deltas use this dictionary when set,
+	// otherwise one change bit is sent for every field
+	const deltaDictionary_t* deltaDictionary;
 } msg_t;
 
 void MSG_Init( msg_t* buf, byte* data, int length );
@@ -109,7 +131,12 @@ void  MSG_ReadDeltaEntity( msg_t* msg, entityState_t* from, entityState_t* to, i
 void  MSG_WriteDeltaPlayerstate( msg_t* msg, struct playerState_s* from, struct playerState_s* to );
 void  MSG_ReadDeltaPlayerstate( msg_t* msg, struct playerState_s* from, struct playerState_s* to );
 
+void  MSG_BuildDeltaDictionary( deltaDictionary_t* dict );
+void  MSG_WriteDeltaDictionary( msg_t* msg, const deltaDictionary_t* dict );
+void  MSG_ReadDeltaDictionary( msg_t* msg, deltaDictionary_t* dict );
+
 void  MSG_ReportChangeVectors_f();
+void  MSG_HuffmanBenchmark_f();
 
 //============================================================================
 
@@ -299,6 +326,8 @@ enum svc_ops_e
 	// new commands, supported only by ioquake3 protocol but not legacy
 	svc_voipSpeex, // not wrapped in USE_VOIP, so this value is reserved.
 	svc_voipOpus,  //
+
+	svc_deltaDictionary, // [dictionary] only in gamestate messages, to clients that asked for it
 };
 
 //
@@ -698,6 +727,14 @@ void		 FS_ForceFlush( fileHandle_t f );
 void		 FS_FreeFile( void* buffer );
 // frees the memory returned by FS_ReadFile
 
+long		 FS_MapFile( const char* qpath, void** buffer );
+// maps a whole file read-only into memory and returns its length, -1 and a
+// NULL buffer if not present.  Files inside a pk3 are read into the zone.
+// Unlike FS_ReadFile the buffer may be kept for as long as the caller likes.
+
+void		 FS_UnmapFile( void* buffer );
+// releases a buffer returned by FS_MapFile
+
 void		 FS_WriteFile( const char* qpath, const void* buffer, int size );
 // writes a complete file, creating any subdirectories needed
 
@@ -808,7 +845,8 @@ typedef enum
 	CF_3DNOW_EXT = 1 << 4,
 	CF_SSE		 = 1 << 5,
 	CF_SSE2		 = 1 << 6,
-	CF_ALTIVEC	 = 1 << 7
+	CF_ALTIVEC	 = 1 << 7,
+	CF_AVX2		 = 1 << 8
 } cpuFeatures_t;
 
 // centralized and cleaned, that's the max string you can send to a Com_Printf / Com_DPrintf (above gets truncated)
@@ -914,6 +952,7 @@ extern int			time_frontend;
 extern int			time_backend; // renderer backend time
 
 extern int			com_frameTime;
+extern int			com_frameNumber;
 extern int			com_frameMsec; // RB
 
 extern qboolean		com_errorEntered;
@@ -1133,6 +1172,9 @@ void		  Sys_Print( const char* msg );
 // any game related timing information should come from event timestamps
 int			  Sys_Milliseconds();
 
+// high resolution timer for profiling
+int64_t		  Sys_Microseconds();
+
 qboolean	  Sys_RandomBytes( byte* string, int len );
 
 // the system console is shown when a dedicated server is running
@@ -1143,6 +1185,10 @@ cpuFeatures_t Sys_GetProcessorFeatures();
 void		  Sys_SetErrorText( const char* text );
 
 void		  Sys_SendPacket( int length, const void* data, netadr_t to );
+qboolean	  Sys_SendPacketUnbuffered( int length, const void* data, netadr_t to );
+qboolean	  Sys_GetPacket( netadr_t* net_from, msg_t* net_message );
+void		  Sys_BeginPacketBatch();
+void		  Sys_FlushPacketBatch();
 
 qboolean	  Sys_StringToAdr( const char* s, netadr_t* a, netadrtype_t family );
 // Does NOT parse port numbers, only base addresses.
@@ -1153,6 +1199,8 @@ void		  Sys_ShowIP();
 FILE*		  Sys_FOpen( const char* ospath, const char* mode );
 qboolean	  Sys_Mkdir( const char* path );
 FILE*		  Sys_Mkfifo( const char* ospath );
+void*		  Sys_MapFile( const char* ospath, long* length );
+void		  Sys_UnmapFile( void* data, long length );
 char*		  Sys_Cwd();
 void		  Sys_SetDefaultInstallPath( const char* path );
 char*		  Sys_DefaultInstallPath();
@@ -1199,6 +1247,63 @@ dialogResult_t Sys_Dialog( dialogType_t type, const char* message, const char* t
 void		   Sys_RemovePIDFile( const char* gamedir );
 void		   Sys_InitPIDFile( const char* gamedir );
 
+// worker thread pool, see sys_thread.c
+#define MAX_JOB_THREADS 16
+
+typedef void ( *jobFunc_t )( void* data, int index );
+
+extern cvar_t* com_jobThreads;
+
+void		   Sys_InitJobs();
+void		   Sys_ShutdownJobs();
+int			   Sys_NumJobThreads();
+void		   Sys_RunJobs( jobFunc_t func, void* data, int count );
+int			   Sys_AtomicIncrement( volatile int* value );
+
+// long running threads, see sys_thread.c
+typedef void ( *threadFunc_t )( void* arg );
+typedef struct sysThread_s sysThread_t;
+typedef struct sysSignal_s sysSignal_t;
+typedef struct sysMutex_s  sysMutex_t;
+
+void		 Sys_MemoryBarrier();
+sysThread_t* Sys_CreateThread( threadFunc_t func, void* arg );
+void		 Sys_JoinThread( sysThread_t* thread );
+sysSignal_t* Sys_CreateSignal();
+void		 Sys_DestroySignal( sysSignal_t* signal );
+void		 Sys_RaiseSignal( sysSignal_t* signal );
+qboolean	 Sys_WaitSignal( sysSignal_t* signal, int msec );
+sysMutex_t*	 Sys_CreateMutex();
+void		 Sys_DestroyMutex( sysMutex_t* mutex );
+void		 Sys_LockMutex( sysMutex_t* mutex );
+void		 Sys_UnlockMutex( sysMutex_t* mutex );
+
+// frame profiler, see profile.c
+// zones are opened and closed by PROF_BEGIN( "literal" ) / PROF_END() in the same function
+#define PROF_BEGIN( name )      \
+	do                          \
+	{                           \
+		if( prof_active )       \
+		{                       \
+			Prof_Begin( name ); \
+		}                       \
+	} while( 0 )
+#define PROF_END()        \
+	do                    \
+	{                     \
+		if( prof_active ) \
+		{                 \
+			Prof_End();   \
+		}                 \
+	} while( 0 )
+
+extern int prof_active;
+
+void	   Prof_Init();
+void	   Prof_Frame();
+void	   Prof_Begin( const char* name );
+void	   Prof_End();
+
 /* This is based on the Adaptive Huffman algorithm described in Sayood's Data
  * Compression book.  The ranks are not actually stored, but implicitly defined
  * by the location of a node within a doubly-linked list */
@@ -1238,6 +1343,24 @@ typedef struct
 	huff_t decompressor;
 } huffman_t;
 
+// lookup tables for a tree that no longer adapts
+#define HUFF_LOOKUP_BITS 11
+
+typedef struct
+{
+	int		symbol;
+	int		bits; // 0 if the code is longer than HUFF_LOOKUP_BITS
+	node_t* node; // continue the tree walk from here in that case
+} huffLookup_t;
+
+typedef struct
+{
+	huff_t*		 huff;
+	unsigned int code[HMAX];	 // first bit to send in bit 0
+	int			 codeBits[HMAX]; // 0 if the tree has to be walked
+	huffLookup_t lookup[1 << HUFF_LOOKUP_BITS];
+} huffTable_t;
+
 void			 Huff_Compress( msg_t* buf, int offset );
 void			 Huff_Decompress( msg_t* buf, int offset );
 void			 Huff_Init( huffman_t* huff );
@@ -1248,6 +1371,9 @@ void			 Huff_offsetReceive( node_t* node, int* ch, byte* fin, int* offset, int m
 void			 Huff_offsetTransmit( huff_t* huff, int ch, byte* fout, int* offset, int maxoffset );
 void			 Huff_putBit( int bit, byte* fout, int* offset );
 int				 Huff_getBit( byte* fout, int* offset );
+void			 Huff_BuildTable( huffTable_t* table, huff_t* huff );
+void			 Huff_tableTransmit( const huffTable_t* table, int ch, byte* fout, int* offset, int maxoffset );
+void			 Huff_tableReceive( const huffTable_t* table, int* ch, byte* fin, int* offset, int maxoffset );
 
 // don't use if you don't know what you're doing.
 int				 Huff_getBloc();
@@ -118,7 +118,12 @@ static qboolean R_LoadMD5Anim( skelAnimation_t* skelAnim, void* buffer, int buff
 		ri.Printf( PRINT_WARNING, "RE_RegisterAnimation: expected 'numJoints' found '%s' in model '%s'\n", token, name );
 		return qfalse;
 	}
-	token			  = Com_ParseExt( &buf_p, qfalse );
+	token = Com_ParseExt( &buf_p, qfalse );
+	if( atoi( token ) > MAX_BONES )
+	{
+		ri.Printf( PRINT_WARNING, "RE_RegisterAnimation: '%s' has more than %i bones (%i)\n", name, MAX_BONES, atoi( token ) );
+		return qfalse;
+	}
 	anim->numChannels = atoi( token );
 
 	// parse frameRate <number>
@@ -1331,8 +1336,8 @@ int RE_BuildSkeleton( refSkeleton_t* skel, qhandle_t hAnim, int startFrame, int
 		md5Animation_t* anim;
 		md5Channel_t*	channel;
 		md5Frame_t *	newFrame, *oldFrame;
-		vec3_t			newOrigin, oldOrigin, lerpedOrigin;
-		quat_t			newQuat, oldQuat, lerpedQuat;
+		bonePose_t		oldPoses[MAX_BONES], newPoses[MAX_BONES];
+		float *			oldOrigin, *newOrigin, *oldQuat, *newQuat;
 		int				componentsApplied;
 
 		anim = skelAnim->md5;
@@ -1364,11 +1369,19 @@ int RE_BuildSkeleton( refSkeleton_t* skel, qhandle_t hAnim, int startFrame, int
 			skel->bounds[1][i] = oldFrame->bounds[1][i] > newFrame->bounds[1][i] ? oldFrame->bounds[1][i] : newFrame->bounds[1][i];
 		}
 
+		// gather the animated components of both frames, the rotations are
+		// completed and lerped for all bones at once
 		for( i = 0, channel = anim->channels; i < anim->numChannels; i++, channel++ )
 		{
-			// set baseframe values
+			oldOrigin = oldPoses[i].origin;
+			newOrigin = newPoses[i].origin;
+			oldQuat	  = oldPoses[i].rotation;
+			newQuat	  = newPoses[i].rotation;
+
+			// set baseframe values, w is lerped along by the SIMD kernels
 			VectorCopy( channel->baseOrigin, newOrigin );
 			VectorCopy( channel->baseOrigin, oldOrigin );
+			newOrigin[3] = oldOrigin[3] = 0;
 
 			QuatCopy( channel->baseQuat, newQuat );
 			QuatCopy( channel->baseQuat, oldQuat );
@@ -1400,38 +1413,31 @@ int RE_BuildSkeleton( refSkeleton_t* skel, qhandle_t hAnim, int startFrame, int
 			// update quaternion rotation bits
 			if( channel->componentsBits & COMPONENT_BIT_QX )
 			{
-				( ( vec_t* )oldQuat )[0] = oldFrame->components[channel->componentsOffset + componentsApplied];
-				( ( vec_t* )newQuat )[0] = newFrame->components[channel->componentsOffset + componentsApplied];
+				oldQuat[0] = oldFrame->components[channel->componentsOffset + componentsApplied];
+				newQuat[0] = newFrame->components[channel->componentsOffset + componentsApplied];
 				componentsApplied++;
 			}
 
 			if( channel->componentsBits & COMPONENT_BIT_QY )
 			{
-				( ( vec_t* )oldQuat )[1] = oldFrame->components[channel->componentsOffset + componentsApplied];
-				( ( vec_t* )newQuat )[1] = newFrame->components[channel->componentsOffset + componentsApplied];
+				oldQuat[1] = oldFrame->components[channel->componentsOffset + componentsApplied];
+				newQuat[1] = newFrame->components[channel->componentsOffset + componentsApplied];
 				componentsApplied++;
 			}
 
 			if( channel->componentsBits & COMPONENT_BIT_QZ )
 			{
-				( ( vec_t* )oldQuat )[2] = oldFrame->components[channel->componentsOffset + componentsApplied];
-				( ( vec_t* )newQuat )[2] = newFrame->components[channel->componentsOffset + componentsApplied];
+				oldQuat[2] = oldFrame->components[channel->componentsOffset + componentsApplied];
+				newQuat[2] = newFrame->components[channel->componentsOffset + componentsApplied];
 			}
+		}
 
-			QuatCalcW( oldQuat );
-			QuatNormalize( oldQuat );
-
-			QuatCalcW( newQuat );
-			QuatNormalize( newQuat );
-
-	#if 1
-			VectorLerp( oldOrigin, newOrigin, frac, lerpedOrigin );
-			QuatSlerp( oldQuat, newQuat, frac, lerpedQuat );
-	#else
-			VectorCopy( newOrigin, lerpedOrigin );
-			QuatCopy( newQuat, lerpedQuat );
-	#endif
+		skinKernels->calcBoneRotations( oldPoses, anim->numChannels );
+		skinKernels->calcBoneRotations( newPoses, anim->numChannels );
+		skinKernels->lerpBones( oldPoses, newPoses, frac, oldPoses, anim->numChannels );
 
+		for( i = 0, channel = anim->channels; i < anim->numChannels; i++, channel++ )
+		{
 			// copy lerped information to the bone + extra data
 			skel->bones[i].parentIndex = channel->parentIndex;
 
@@ -1441,15 +1447,15 @@ int RE_BuildSkeleton( refSkeleton_t* skel, qhandle_t hAnim, int startFrame, int
 				QuatClear( skel->bones[i].rotation );
 
 				// move bounding box back
-				VectorSubtract( skel->bounds[0], lerpedOrigin, skel->bounds[0] );
-				VectorSubtract( skel->bounds[1], lerpedOrigin, skel->bounds[1] );
+				VectorSubtract( skel->bounds[0], oldPoses[i].origin, skel->bounds[0] );
+				VectorSubtract( skel->bounds[1], oldPoses[i].origin, skel->bounds[1] );
 			}
 			else
 			{
-				VectorCopy( lerpedOrigin, skel->bones[i].origin );
+				VectorCopy( oldPoses[i].origin, skel->bones[i].origin );
 			}
 
-			QuatCopy( lerpedQuat, skel->bones[i].rotation );
+			QuatCopy( oldPoses[i].rotation, skel->bones[i].rotation );
 
 	#if defined( REFBONE_NAMES )
 			Q_strncpyz( skel->bones[i].name, channel->name, sizeof( skel->bones[i].name ) );
@@ -1564,10 +1570,9 @@ RE_BlendSkeleton
 */
 int RE_BlendSkeleton( refSkeleton_t* skel, const refSkeleton_t* blend, float frac )
 {
-	int	   i;
-	vec3_t lerpedOrigin;
-	quat_t lerpedQuat;
-	vec3_t bounds[2];
+	int		   i;
+	bonePose_t poses[MAX_BONES], blendPoses[MAX_BONES];
+	vec3_t	   bounds[2];
 
 	if( skel->numBones != blend->numBones )
 	{
@@ -1578,11 +1583,19 @@ int RE_BlendSkeleton( refSkeleton_t* skel, const refSkeleton_t* blend, float fra
 	// lerp between the 2 bone poses
 	for( i = 0; i < skel->numBones; i++ )
 	{
-		VectorLerp( skel->bones[i].origin, blend->bones[i].origin, frac, lerpedOrigin );
-		QuatSlerp( skel->bones[i].rotation, blend->bones[i].rotation, frac, lerpedQuat );
+		VectorCopy( skel->bones[i].origin, poses[i].origin );
+		QuatCopy( skel->bones[i].rotation, poses[i].rotation );
+		VectorCopy( blend->bones[i].origin, blendPoses[i].origin );
+		QuatCopy( blend->bones[i].rotation, blendPoses[i].rotation );
+		poses[i].origin[3] = blendPoses[i].origin[3] = 0;
+	}
+
+	skinKernels->lerpBones( poses, blendPoses, frac, poses, skel->numBones );
 
-		VectorCopy( lerpedOrigin, skel->bones[i].origin );
-		QuatCopy( lerpedQuat, skel->bones[i].rotation );
+	for( i = 0; i < skel->numBones; i++ )
+	{
+		VectorCopy( poses[i].origin, skel->bones[i].origin );
+		QuatCopy( poses[i].rotation, skel->bones[i].rotation );
 	}
 
 	// calculate a bounding box in the current coordinate system
@@ -0,0 +1,934 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of XreaL source code.
+
+XreaL source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+XreaL source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with XreaL source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// tr_animation_simd.c -- SSE and AVX2 kernels for MD5 CPU skinning and skeleton lerping
+
+#include "tr_local.h"
+
+#if( defined( __x86_64__ ) || defined( _M_X64 ) || id386_sse ) && !defined( C_ONLY )
+	#define SKIN_SIMD 1
+	#include <immintrin.h>
+#else
+	#define SKIN_SIMD 0
+#endif
+
+#if defined( __GNUC__ ) || defined( __clang__ )
+	#define SKIN_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#else
+	#define SKIN_TARGET_AVX2
+#endif
+
+const skinKernels_t* skinKernels;
+
+/*
+===============================================================================
+
+C KERNELS
+
+These work on the md5Vertex_t data exactly like Tess_SurfaceMD5 always
+did, every vector is transformed by every bone of its vertex and the
+results are blended.  They are the reference for the SIMD kernels.
+
+===============================================================================
+*/
+
+/*
+==================
+R_SkinPositions_C
+==================
+*/
+static void R_SkinPositions_C( const md5Surface_t* srf, const matrix_t* boneMatrices, vec4_t* xyz )
+{
+	const md5Vertex_t* v;
+	const md5Weight_t* w;
+	vec3_t			   tmpVert;
+	vec3_t			   tmpPosition;
+	uint32_t		   i, k;
+
+	for( i = 0, v = srf->verts; i < srf->numVerts; i++, v++ )
+	{
+		VectorClear( tmpPosition );
+
+		for( k = 0, w = v->weights[0]; k < v->numWeights; k++, w++ )
+		{
+			MatrixTransformPoint( boneMatrices[w->boneIndex], w->offset, tmpVert );
+			VectorMA( tmpPosition, w->boneWeight, tmpVert, tmpPosition );
+		}
+
+		xyz[i][0] = tmpPosition[0];
+		xyz[i][1] = tmpPosition[1];
+		xyz[i][2] = tmpPosition[2];
+		xyz[i][3] = 1;
+	}
+}
+
+/*
+==================
+R_SkinVertexes_C
+==================
+*/
+static void R_SkinVertexes_C( const md5Surface_t* srf, const matrix_t* boneMatrices, vec4_t* xyz, vec4_t* tangents, vec4_t* binormals, vec4_t* normals )
+{
+	const md5Vertex_t* v;
+	const md5Weight_t* w;
+	vec3_t			   tmpVert;
+	vec3_t			   tmpPosition;
+	vec3_t			   tmpNormal;
+	vec3_t			   tmpTangent;
+	vec3_t			   tmpBinormal;
+	uint32_t		   i, k;
+
+	for( i = 0, v = srf->verts; i < srf->numVerts; i++, v++ )
+	{
+		VectorClear( tmpPosition );
+		VectorClear( tmpTangent );
+		VectorClear( tmpBinormal );
+		VectorClear( tmpNormal );
+
+		for( k = 0, w = v->weights[0]; k < v->numWeights; k++, w++ )
+		{
+			MatrixTransformPoint( boneMatrices[w->boneIndex], v->position, tmpVert );
+			VectorMA( tmpPosition, w->boneWeight, tmpVert, tmpPosition );
+
+			MatrixTransformNormal( boneMatrices[w->boneIndex], v->tangent, tmpVert );
+			VectorMA( tmpTangent, w->boneWeight, tmpVert, tmpTangent );
+
+			MatrixTransformNormal( boneMatrices[w->boneIndex], v->binormal, tmpVert );
+			VectorMA( tmpBinormal, w->boneWeight, tmpVert, tmpBinormal );
+
+			MatrixTransformNormal( boneMatrices[w->boneIndex], v->normal, tmpVert );
+			VectorMA( tmpNormal, w->boneWeight, tmpVert, tmpNormal );
+		}
+
+		xyz[i][0] = tmpPosition[0];
+		xyz[i][1] = tmpPosition[1];
+		xyz[i][2] = tmpPosition[2];
+		xyz[i][3] = 1;
+
+		tangents[i][0] = tmpTangent[0];
+		tangents[i][1] = tmpTangent[1];
+		tangents[i][2] = tmpTangent[2];
+		tangents[i][3] = 1;
+
+		binormals[i][0] = tmpBinormal[0];
+		binormals[i][1] = tmpBinormal[1];
+		binormals[i][2] = tmpBinormal[2];
+		binormals[i][3] = 1;
+
+		normals[i][0] = tmpNormal[0];
+		normals[i][1] = tmpNormal[1];
+		normals[i][2] = tmpNormal[2];
+		normals[i][3] = 1;
+	}
+}
+
+/*
+==================
+R_CalcBoneRotations_C
+==================
+*/
+static void R_CalcBoneRotations_C( bonePose_t* poses, int numBones )
+{
+	int i;
+
+	for( i = 0; i < numBones; i++ )
+	{
+		QuatCalcW( poses[i].rotation );
+		QuatNormalize( poses[i].rotation );
+	}
+}
+
+/*
+==================
+R_LerpBones_C
+
+out may be the same as from
+==================
+*/
+static void R_LerpBones_C( const bonePose_t* from, const bonePose_t* to, float frac, bonePose_t* out, int numBones )
+{
+	int i;
+
+	for( i = 0; i < numBones; i++ )
+	{
+		VectorLerp( from[i].origin, to[i].origin, frac, out[i].origin );
+		QuatSlerp( from[i].rotation, to[i].rotation, frac, out[i].rotation );
+	}
+}
+
+static const skinKernels_t skinKernelsC = { "C", R_SkinPositions_C, R_SkinVertexes_C, R_CalcBoneRotations_C, R_LerpBones_C };
+
+#if SKIN_SIMD
+
+/*
+===============================================================================
+
+SSE
+
+The position and the tangent space of a vertex are all transformed by
+the same bones, so the bone matrices are blended once per vertex and
+each vector is transformed only by the blended matrix.  The results
+differ from the C kernels by rounding only.
+
+Skeletons are lerped four bones at a time with the rotations transposed
+to x x x x, y y y y ... registers.
+
+===============================================================================
+*/
+
+/*
+==================
+R_TransformVector_SSE
+
+Column major like MatrixTransformPoint, v[3] scales the translation
+==================
+*/
+static ID_INLINE __m128 R_TransformVector_SSE( const __m128* cols, __m128 v )
+{
+	__m128 r;
+
+	r = _mm_mul_ps( cols[0], _mm_shuffle_ps( v, v, _MM_SHUFFLE( 0, 0, 0, 0 ) ) );
+	r = _mm_add_ps( r, _mm_mul_ps( cols[1], _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+	r = _mm_add_ps( r, _mm_mul_ps( cols[2], _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+	r = _mm_add_ps( r, _mm_mul_ps( cols[3], _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+
+	return r;
+}
+
+/*
+==================
+R_StoreVector_SSE
+
+Stores x y z with w = 1
+==================
+*/
+static ID_INLINE void R_StoreVector_SSE( float* out, __m128 v, __m128 one )
+{
+	_mm_storeu_ps( out, _mm_movelh_ps( v, _mm_unpackhi_ps( v, one ) ) );
+}
+
+/*
+==================
+R_Select_SSE
+
+mask ? a : b for every lane
+==================
+*/
+static ID_INLINE __m128 R_Select_SSE( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+/*
+==================
+R_SkinPositions_SSE
+
+Same arithmetic in the same order as the C kernel
+==================
+*/
+static void R_SkinPositions_SSE( const md5Surface_t* srf, const matrix_t* boneMatrices, vec4_t* xyz )
+{
+	const uint8_t* bones   = srf->skinBones;
+	const float*   weights = srf->skinWeights;
+	const vec4_t*  offsets = srf->skinOffsets;
+	const float*   m;
+	__m128		   cols[4];
+	__m128		   one, pos;
+	uint32_t	   i, k;
+
+	one = _mm_set1_ps( 1.0f );
+	for( i = 0; i < srf->numVerts; i++, bones += MAX_WEIGHTS, weights += MAX_WEIGHTS, offsets += MAX_WEIGHTS )
+	{
+		pos = _mm_setzero_ps();
+		for( k = 0; k < srf->skinNumWeights[i]; k++ )
+		{
+			m		= boneMatrices[bones[k]];
+			cols[0] = _mm_loadu_ps( m );
+			cols[1] = _mm_loadu_ps( m + 4 );
+			cols[2] = _mm_loadu_ps( m + 8 );
+			cols[3] = _mm_loadu_ps( m + 12 );
+
+			pos = _mm_add_ps( pos, _mm_mul_ps( R_TransformVector_SSE( cols, _mm_loadu_ps( offsets[k] ) ), _mm_set1_ps( weights[k] ) ) );
+		}
+
+		R_StoreVector_SSE( xyz[i], pos, one );
+	}
+}
+
+/*
+==================
+R_SkinVertexes_SSE
+==================
+*/
+static void R_SkinVertexes_SSE( const md5Surface_t* srf, const matrix_t* boneMatrices, vec4_t* xyz, vec4_t* tangents, vec4_t* binormals, vec4_t* normals )
+{
+	const uint8_t* bones   = srf->skinBones;
+	const float*   weights = srf->skinWeights;
+	const vec4_t*  vectors = srf->skinVectors;
+	const float*   m;
+	__m128		   cols[4];
+	__m128		   one, w;
+	uint32_t	   i, k;
+
+	one = _mm_set1_ps( 1.0f );
+	for( i = 0; i < srf->numVerts; i++, bones += MAX_WEIGHTS, weights += MAX_WEIGHTS, vectors += 4 )
+	{
+		cols[0] = cols[1] = cols[2] = cols[3] = _mm_setzero_ps();
+		for( k = 0; k < srf->skinNumWeights[i]; k++ )
+		{
+			m		= boneMatrices[bones[k]];
+			w		= _mm_set1_ps( weights[k] );
+			cols[0] = _mm_add_ps( cols[0], _mm_mul_ps( _mm_loadu_ps( m ), w ) );
+			cols[1] = _mm_add_ps( cols[1], _mm_mul_ps( _mm_loadu_ps( m + 4 ), w ) );
+			cols[2] = _mm_add_ps( cols[2], _mm_mul_ps( _mm_loadu_ps( m + 8 ), w ) );
+			cols[3] = _mm_add_ps( cols[3], _mm_mul_ps( _mm_loadu_ps( m + 12 ), w ) );
+		}
+
+		// the tangent space vectors have w = 0 and skip the translation
+		R_StoreVector_SSE( xyz[i], R_TransformVector_SSE( cols, _mm_loadu_ps( vectors[0] ) ), one );
+		R_StoreVector_SSE( tangents[i], R_TransformVector_SSE( cols, _mm_loadu_ps( vectors[1] ) ), one );
+		R_StoreVector_SSE( binormals[i], R_TransformVector_SSE( cols, _mm_loadu_ps( vectors[2] ) ), one );
+		R_StoreVector_SSE( normals[i], R_TransformVector_SSE( cols, _mm_loadu_ps( vectors[3] ) ), one );
+	}
+}
+
+/*
+==================
+R_CalcBoneRotations_SSE
+
+Same arithmetic in the same order as QuatCalcW and QuatNormalize
+==================
+*/
+static void R_CalcBoneRotations_SSE( bonePose_t* poses, int numBones )
+{
+	__m128 x, y, z, w;
+	__m128 zero, one, term, length, scale;
+	int	   i;
+
+	zero = _mm_setzero_ps();
+	one	 = _mm_set1_ps( 1.0f );
+	for( i = 0; i + 4 <= numBones; i += 4 )
+	{
+		x = _mm_loadu_ps( poses[i + 0].rotation );
+		y = _mm_loadu_ps( poses[i + 1].rotation );
+		z = _mm_loadu_ps( poses[i + 2].rotation );
+		w = _mm_loadu_ps( poses[i + 3].rotation );
+		_MM_TRANSPOSE4_PS( x, y, z, w );
+
+		// w is 0 when x y z are slightly too long
+		term = _mm_sub_ps( one, _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) ) );
+		w	 = _mm_sub_ps( zero, _mm_sqrt_ps( _mm_max_ps( term, zero ) ) );
+
+		// rotations of length 0 are left alone
+		length = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) ), _mm_mul_ps( w, w ) );
+		length = _mm_sqrt_ps( length );
+		scale  = R_Select_SSE( _mm_cmpneq_ps( length, zero ), _mm_div_ps( one, length ), one );
+
+		x = _mm_mul_ps( x, scale );
+		y = _mm_mul_ps( y, scale );
+		z = _mm_mul_ps( z, scale );
+		w = _mm_mul_ps( w, scale );
+
+		_MM_TRANSPOSE4_PS( x, y, z, w );
+		_mm_storeu_ps( poses[i + 0].rotation, x );
+		_mm_storeu_ps( poses[i + 1].rotation, y );
+		_mm_storeu_ps( poses[i + 2].rotation, z );
+		_mm_storeu_ps( poses[i + 3].rotation, w );
+	}
+
+	R_CalcBoneRotations_C( poses + i, numBones - i );
+}
+
+/*
+==================
+R_ATanPositive_SSE
+
+atan2( y, x ) for x, y >= 0, the polynomial is accurate to about 1e-8
+==================
+*/
+static ID_INLINE __m128 R_ATanPositive_SSE( __m128 y, __m128 x )
+{
+	__m128 a, s, r;
+
+	a = _mm_div_ps( _mm_min_ps( x, y ), _mm_max_ps( x, y ) );
+	s = _mm_mul_ps( a, a );
+
+	r = _mm_set1_ps( 0.0028662257f );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( -0.0161657367f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( 0.0429096138f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( -0.0752896400f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( 0.1065626393f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( -0.1420889944f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( 0.1999355085f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( -0.3333314528f ) );
+	r = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( r, s ), a ), a );
+
+	// atan( y / x ) = pi / 2 - atan( x / y )
+	return R_Select_SSE( _mm_cmpgt_ps( y, x ), _mm_sub_ps( _mm_set1_ps( M_PI * 0.5f ), r ), r );
+}
+
+/*
+==================
+R_Sin_SSE
+
+sin( a ) for 0 <= a <= pi / 2, the polynomial is accurate to about 1e-9
+==================
+*/
+static ID_INLINE __m128 R_Sin_SSE( __m128 a )
+{
+	__m128 s, r;
+
+	s = _mm_mul_ps( a, a );
+
+	r = _mm_set1_ps( -2.39e-08f );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( 2.7526e-06f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( -1.98409e-04f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( 8.3333315e-03f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( -1.666666664e-01f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( 1.0f ) );
+
+	return _mm_mul_ps( r, a );
+}
+
+/*
+==================
+R_LerpBoneBlock_SSE
+
+Four bones of R_LerpBones_SSE.  The slerp follows QuatSlerp, "Slerping
+Clock Cycles" by J.M.P. van Waveren, with polynomials in place of atan2
+and sin.
+==================
+*/
+static void R_LerpBoneBlock_SSE( const bonePose_t* from, const bonePose_t* to, float frac, bonePose_t* out )
+{
+	__m128 fx, fy, fz, fw, tx, ty, tz, tw;
+	__m128 zero, one, signBit, f, origin;
+	__m128 cosom, absCosom, sinSqr, sinom, omega, scale0, scale1, nearlySame, same;
+	int	   i;
+
+	zero	= _mm_setzero_ps();
+	one		= _mm_set1_ps( 1.0f );
+	signBit = _mm_set1_ps( -0.0f );
+	f		= _mm_set1_ps( frac );
+
+	// the rotations are loaded before anything is stored, out may be from
+	fx = _mm_loadu_ps( from[0].rotation );
+	fy = _mm_loadu_ps( from[1].rotation );
+	fz = _mm_loadu_ps( from[2].rotation );
+	fw = _mm_loadu_ps( from[3].rotation );
+	_MM_TRANSPOSE4_PS( fx, fy, fz, fw );
+
+	tx = _mm_loadu_ps( to[0].rotation );
+	ty = _mm_loadu_ps( to[1].rotation );
+	tz = _mm_loadu_ps( to[2].rotation );
+	tw = _mm_loadu_ps( to[3].rotation );
+	_MM_TRANSPOSE4_PS( tx, ty, tz, tw );
+
+	for( i = 0; i < 4; i++ )
+	{
+		origin = _mm_loadu_ps( from[i].origin );
+		origin = _mm_add_ps( origin, _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( to[i].origin ), origin ), f ) );
+		_mm_storeu_ps( out[i].origin, origin );
+	}
+
+	// QuatSlerp does not extrapolate
+	if( frac <= 0.0f || frac >= 1.0f )
+	{
+		for( i = 0; i < 4; i++ )
+		{
+			QuatCopy( frac <= 0.0f ? from[i].rotation : to[i].rotation, out[i].rotation );
+		}
+		return;
+	}
+
+	cosom = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( fx, tx ), _mm_mul_ps( fy, ty ) ), _mm_mul_ps( fz, tz ) ), _mm_mul_ps( fw, tw ) );
+	absCosom = _mm_andnot_ps( signBit, cosom );
+
+	// the lanes that are lerped may come out as NaN here
+	sinSqr = _mm_sub_ps( one, _mm_mul_ps( absCosom, absCosom ) );
+	sinom  = _mm_div_ps( one, _mm_sqrt_ps( sinSqr ) );
+	omega  = R_ATanPositive_SSE( _mm_mul_ps( sinSqr, sinom ), absCosom );
+
+	scale0 = _mm_mul_ps( R_Sin_SSE( _mm_mul_ps( _mm_sub_ps( one, f ), omega ) ), sinom );
+	scale1 = _mm_mul_ps( R_Sin_SSE( _mm_mul_ps( f, omega ) ), sinom );
+
+	nearlySame = _mm_cmple_ps( _mm_sub_ps( one, absCosom ), _mm_set1_ps( 1e-6f ) );
+	scale0	   = R_Select_SSE( nearlySame, _mm_sub_ps( one, f ), scale0 );
+	scale1	   = R_Select_SSE( nearlySame, f, scale1 );
+	scale1	   = R_Select_SSE( _mm_cmpge_ps( cosom, zero ), scale1, _mm_xor_ps( scale1, signBit ) );
+
+	// equal rotations are copied
+	same = _mm_and_ps( _mm_and_ps( _mm_cmpeq_ps( fx, tx ), _mm_cmpeq_ps( fy, ty ) ), _mm_and_ps( _mm_cmpeq_ps( fz, tz ), _mm_cmpeq_ps( fw, tw ) ) );
+
+	tx = R_Select_SSE( same, fx, _mm_add_ps( _mm_mul_ps( scale0, fx ), _mm_mul_ps( scale1, tx ) ) );
+	ty = R_Select_SSE( same, fy, _mm_add_ps( _mm_mul_ps( scale0, fy ), _mm_mul_ps( scale1, ty ) ) );
+	tz = R_Select_SSE( same, fz, _mm_add_ps( _mm_mul_ps( scale0, fz ), _mm_mul_ps( scale1, tz ) ) );
+	tw = R_Select_SSE( same, fw, _mm_add_ps( _mm_mul_ps( scale0, fw ), _mm_mul_ps( scale1, tw ) ) );
+
+	_MM_TRANSPOSE4_PS( tx, ty, tz, tw );
+	_mm_storeu_ps( out[0].rotation, tx );
+	_mm_storeu_ps( out[1].rotation, ty );
+	_mm_storeu_ps( out[2].rotation, tz );
+	_mm_storeu_ps( out[3].rotation, tw );
+}
+
+/*
+==================
+R_LerpBones_SSE
+
+out may be the same as from
+==================
+*/
+static void R_LerpBones_SSE( const bonePose_t* from, const bonePose_t* to, float frac, bonePose_t* out, int numBones )
+{
+	bonePose_t fromBlock[4], toBlock[4], outBlock[4];
+	int		   i, j, last;
+
+	for( i = 0; i + 4 <= numBones; i += 4 )
+	{
+		R_LerpBoneBlock_SSE( from + i, to + i, frac, out + i );
+	}
+
+	// the remaining bones go through a padded block
+	if( i < numBones )
+	{
+		last = numBones - 1;
+		for( j = 0; j < 4; j++ )
+		{
+			fromBlock[j] = from[MIN( i + j, last )];
+			toBlock[j]	 = to[MIN( i + j, last )];
+		}
+
+		R_LerpBoneBlock_SSE( fromBlock, toBlock, frac, outBlock );
+
+		for( j = 0; i + j < numBones; j++ )
+		{
+			out[i + j] = outBlock[j];
+		}
+	}
+}
+
+static const skinKernels_t skinKernelsSSE = { "SSE", R_SkinPositions_SSE, R_SkinVertexes_SSE, R_CalcBoneRotations_SSE, R_LerpBones_SSE };
+
+/*
+===============================================================================
+
+AVX2
+
+A bone matrix is loaded as two registers, columns 0 and 1 and columns 2
+and 3.  A vector is spread to x x x x y y y y and z z z z w w w w to be
+multiplied with them, and the two halves are added at the end.  A
+skeleton has too few bones to gain anything from eight wide lerps, the
+bones go through the SSE kernels.
+
+===============================================================================
+*/
+
+/*
+==================
+R_TransformVector_AVX2
+==================
+*/
+SKIN_TARGET_AVX2 static ID_INLINE __m256 R_TransformVector_AVX2( __m256 cols01, __m256 cols23, __m128 v )
+{
+	__m256 v8;
+
+	// the upper half of v8 is undefined, only lanes 0 to 3 are picked
+	v8 = _mm256_castps128_ps256( v );
+
+	return _mm256_add_ps( _mm256_mul_ps( cols01, _mm256_permutevar8x32_ps( v8, _mm256_setr_epi32( 0, 0, 0, 0, 1, 1, 1, 1 ) ) ),
+		_mm256_mul_ps( cols23, _mm256_permutevar8x32_ps( v8, _mm256_setr_epi32( 2, 2, 2, 2, 3, 3, 3, 3 ) ) ) );
+}
+
+/*
+==================
+R_StoreVector_AVX2
+
+Adds the halves and stores x y z with w = 1
+==================
+*/
+SKIN_TARGET_AVX2 static ID_INLINE void R_StoreVector_AVX2( float* out, __m256 v, __m128 one )
+{
+	__m128 r = _mm_add_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) );
+
+	_mm_storeu_ps( out, _mm_movelh_ps( r, _mm_unpackhi_ps( r, one ) ) );
+}
+
+/*
+==================
+R_SkinPositions_AVX2
+==================
+*/
+SKIN_TARGET_AVX2 static void R_SkinPositions_AVX2( const md5Surface_t* srf, const matrix_t* boneMatrices, vec4_t* xyz )
+{
+	const uint8_t* bones   = srf->skinBones;
+	const float*   weights = srf->skinWeights;
+	const vec4_t*  offsets = srf->skinOffsets;
+	const float*   m;
+	__m256		   pos;
+	__m128		   one;
+	uint32_t	   i, k;
+
+	one = _mm_set1_ps( 1.0f );
+	for( i = 0; i < srf->numVerts; i++, bones += MAX_WEIGHTS, weights += MAX_WEIGHTS, offsets += MAX_WEIGHTS )
+	{
+		pos = _mm256_setzero_ps();
+		for( k = 0; k < srf->skinNumWeights[i]; k++ )
+		{
+			m	= boneMatrices[bones[k]];
+			pos = _mm256_add_ps(
+				pos, _mm256_mul_ps( R_TransformVector_AVX2( _mm256_loadu_ps( m ), _mm256_loadu_ps( m + 8 ), _mm_loadu_ps( offsets[k] ) ), _mm256_set1_ps( weights[k] ) ) );
+		}
+
+		R_StoreVector_AVX2( xyz[i], pos, one );
+	}
+
+	_mm256_zeroupper();
+}
+
+/*
+==================
+R_SkinVertexes_AVX2
+==================
+*/
+SKIN_TARGET_AVX2 static void R_SkinVertexes_AVX2(
+	const md5Surface_t* srf, const matrix_t* boneMatrices, vec4_t* xyz, vec4_t* tangents, vec4_t* binormals, vec4_t* normals )
+{
+	const uint8_t* bones   = srf->skinBones;
+	const float*   weights = srf->skinWeights;
+	const vec4_t*  vectors = srf->skinVectors;
+	const float*   m;
+	__m256		   cols01, cols23, w;
+	__m128		   one;
+	uint32_t	   i, k;
+
+	one = _mm_set1_ps( 1.0f );
+	for( i = 0; i < srf->numVerts; i++, bones += MAX_WEIGHTS, weights += MAX_WEIGHTS, vectors += 4 )
+	{
+		cols01 = cols23 = _mm256_setzero_ps();
+		for( k = 0; k < srf->skinNumWeights[i]; k++ )
+		{
+			m	   = boneMatrices[bones[k]];
+			w	   = _mm256_set1_ps( weights[k] );
+			cols01 = _mm256_add_ps( cols01, _mm256_mul_ps( _mm256_loadu_ps( m ), w ) );
+			cols23 = _mm256_add_ps( cols23, _mm256_mul_ps( _mm256_loadu_ps( m + 8 ), w ) );
+		}
+
+		R_StoreVector_AVX2( xyz[i], R_TransformVector_AVX2( cols01, cols23, _mm_loadu_ps( vectors[0] ) ), one );
+		R_StoreVector_AVX2( tangents[i], R_TransformVector_AVX2( cols01, cols23, _mm_loadu_ps( vectors[1] ) ), one );
+		R_StoreVector_AVX2( binormals[i], R_TransformVector_AVX2( cols01, cols23, _mm_loadu_ps( vectors[2] ) ), one );
+		R_StoreVector_AVX2( normals[i], R_TransformVector_AVX2( cols01, cols23, _mm_loadu_ps( vectors[3] ) ), one );
+	}
+
+	_mm256_zeroupper();
+}
+
+static const skinKernels_t skinKernelsAVX2 = { "AVX2", R_SkinPositions_AVX2, R_SkinVertexes_AVX2, R_CalcBoneRotations_SSE, R_LerpBones_SSE };
+
+#endif // SKIN_SIMD
+
+/*
+==================
+R_InitSkinKernels
+
+r_simd 0 runs the C kernels, 1 the SSE ones and 2 or more the best ones
+the CPU supports
+==================
+*/
+void R_InitSkinKernels()
+{
+	skinKernels = &skinKernelsC;
+
+#if SKIN_SIMD
+	if( r_simd->integer >= 2 && ( Sys_GetProcessorFeatures() & CF_AVX2 ) )
+	{
+		skinKernels = &skinKernelsAVX2;
+	}
+	else if( r_simd->integer >= 1 )
+	{
+		skinKernels = &skinKernelsSSE;
+	}
+#endif
+
+	ri.Printf( PRINT_DEVELOPER, "skinning kernels: %s\n", skinKernels->name );
+}
+
+/*
+===============================================================================
+
+SKINNING BENCHMARK
+
+===============================================================================
+*/
+
+typedef struct
+{
+	const md5Model_t* model;
+	int				  numCharacters;
+
+	// numCharacters * numBones each
+	matrix_t*		  shadowPalettes; // bone transforms like for skipTangentSpaces
+	matrix_t*		  lightPalettes;  // bone transforms times the inverse bind pose
+	bonePose_t*		  fromPoses;
+	bonePose_t*		  toPoses;
+	bonePose_t*		  lerpedPoses;
+
+	// maxVerts each, the kernel output and the C reference
+	vec4_t*			  vectors[8];
+} skinBench_t;
+
+/*
+==================
+R_SkinBenchPose
+
+The bind pose of a bone turned a few degrees at random
+==================
+*/
+static void R_SkinBenchPose( const md5Bone_t* bone, int* seed, bonePose_t* pose )
+{
+	quat_t jitter;
+
+	QuatFromAngles( jitter, Q_crandom( seed ) * 15, Q_crandom( seed ) * 15, Q_crandom( seed ) * 15 );
+	QuatMultiply1( bone->rotation, jitter, pose->rotation );
+	QuatNormalize( pose->rotation );
+
+	VectorCopy( bone->origin, pose->origin );
+	pose->origin[3] = 0;
+}
+
+/*
+==================
+R_SkinBenchRun
+
+Lerps the skeletons and skins all surfaces of every character with and
+without tangent spaces, frames times, and returns the usec of each part
+==================
+*/
+static void R_SkinBenchRun( const skinKernels_t* kernels, const skinBench_t* b, int frames, int64_t times[3] )
+{
+	const md5Surface_t* srf;
+	int64_t				start;
+	int					numBones = b->model->numBones;
+	int					i, j, k;
+
+	times[0] = times[1] = times[2] = 0;
+	for( i = 0; i < frames; i++ )
+	{
+		start = Sys_Microseconds();
+		for( j = 0; j < b->numCharacters; j++ )
+		{
+			kernels->lerpBones( b->fromPoses + j * numBones, b->toPoses + j * numBones, ( i % 10 ) * 0.1f + 0.05f, b->lerpedPoses + j * numBones, numBones );
+		}
+		times[0] += Sys_Microseconds() - start;
+
+		start = Sys_Microseconds();
+		for( j = 0; j < b->numCharacters; j++ )
+		{
+			for( k = 0, srf = b->model->surfaces; k < b->model->numSurfaces; k++, srf++ )
+			{
+				kernels->skinVertexes( srf, b->lightPalettes + j * numBones, b->vectors[0], b->vectors[1], b->vectors[2], b->vectors[3] );
+			}
+		}
+		times[1] += Sys_Microseconds() - start;
+
+		start = Sys_Microseconds();
+		for( j = 0; j < b->numCharacters; j++ )
+		{
+			for( k = 0, srf = b->model->surfaces; k < b->model->numSurfaces; k++, srf++ )
+			{
+				kernels->skinPositions( srf, b->shadowPalettes + j * numBones, b->vectors[0] );
+			}
+		}
+		times[2] += Sys_Microseconds() - start;
+	}
+}
+
+/*
+==================
+R_SkinBenchError
+==================
+*/
+static float R_SkinBenchError( const float* a, const float* b, int count, int stride, int components )
+{
+	float error = 0;
+	int	  i, j;
+
+	for( i = 0; i < count; i++, a += stride, b += stride )
+	{
+		for( j = 0; j < components; j++ )
+		{
+			error = MAX( error, fabs( a[j] - b[j] ) );
+		}
+	}
+
+	return error;
+}
+
+/*
+==================
+R_SkinBenchCompare
+
+Largest difference to the C kernels in the lerped bones, the skinned
+vertexes and the skinned shadow positions
+==================
+*/
+static void R_SkinBenchCompare( const skinKernels_t* kernels, const skinBench_t* b, float errors[3] )
+{
+	const md5Surface_t* srf;
+	bonePose_t			reference[MAX_BONES];
+	int					numBones = b->model->numBones;
+	int					i, j, k;
+
+	errors[0] = errors[1] = errors[2] = 0;
+	for( i = 0; i < b->numCharacters; i++ )
+	{
+		skinKernelsC.lerpBones( b->fromPoses + i * numBones, b->toPoses + i * numBones, 0.3f, reference, numBones );
+		kernels->lerpBones( b->fromPoses + i * numBones, b->toPoses + i * numBones, 0.3f, b->lerpedPoses + i * numBones, numBones );
+		errors[0] = MAX( errors[0], R_SkinBenchError( reference[0].origin, b->lerpedPoses[i * numBones].origin, numBones, 8, 3 ) );
+		errors[0] = MAX( errors[0], R_SkinBenchError( reference[0].rotation, b->lerpedPoses[i * numBones].rotation, numBones, 8, 4 ) );
+
+		for( j = 0, srf = b->model->surfaces; j < b->model->numSurfaces; j++, srf++ )
+		{
+			skinKernelsC.skinVertexes( srf, b->lightPalettes + i * numBones, b->vectors[4], b->vectors[5], b->vectors[6], b->vectors[7] );
+			kernels->skinVertexes( srf, b->lightPalettes + i * numBones, b->vectors[0], b->vectors[1], b->vectors[2], b->vectors[3] );
+			for( k = 0; k < 4; k++ )
+			{
+				errors[1] = MAX( errors[1], R_SkinBenchError( b->vectors[k][0], b->vectors[k + 4][0], srf->numVerts, 4, 4 ) );
+			}
+
+			skinKernelsC.skinPositions( srf, b->shadowPalettes + i * numBones, b->vectors[4] );
+			kernels->skinPositions( srf, b->shadowPalettes + i * numBones, b->vectors[0] );
+			errors[2] = MAX( errors[2], R_SkinBenchError( b->vectors[0][0], b->vectors[4][0], srf->numVerts, 4, 4 ) );
+		}
+	}
+}
+
+/*
+==================
+R_SkinBench_f
+
+skinbench <md5 model> [characters] [frames]
+
+Every frame lerps the skeleton and skins all surfaces of each character,
+once with tangent spaces and once positions only like for shadows, with
+the C kernels and every SIMD kernel the CPU can run
+==================
+*/
+void R_SkinBench_f()
+{
+	const skinKernels_t* kernels[3];
+	model_t*			 mod;
+	skinBench_t			 b;
+	int64_t				 times[3];
+	float				 errors[3];
+	int					 numKernels, frames, maxVerts, numVerts, seed;
+	int					 i, j, k;
+
+	if( ri.Cmd_Argc() < 2 )
+	{
+		ri.Printf( PRINT_ALL, "usage: skinbench <md5 model> [characters] [frames]\n" );
+		return;
+	}
+
+	mod = R_GetModelByHandle( RE_RegisterModel( ri.Cmd_Argv( 1 ) ) );
+	if( mod->type != MOD_MD5 || !mod->md5->numBones )
+	{
+		ri.Printf( PRINT_ALL, "skinbench: %s is not an MD5 model\n", ri.Cmd_Argv( 1 ) );
+		return;
+	}
+
+	Com_Memset( &b, 0, sizeof( b ) );
+	b.model			= mod->md5;
+	b.numCharacters = ri.Cmd_Argc() > 2 ? atoi( ri.Cmd_Argv( 2 ) ) : 32;
+	frames			= ri.Cmd_Argc() > 3 ? atoi( ri.Cmd_Argv( 3 ) ) : 100;
+	b.numCharacters = MAX( b.numCharacters, 1 );
+	frames			= MAX( frames, 1 );
+
+	maxVerts = numVerts = 0;
+	for( i = 0; i < b.model->numSurfaces; i++ )
+	{
+		maxVerts = MAX( maxVerts, ( int )b.model->surfaces[i].numVerts );
+		numVerts += b.model->surfaces[i].numVerts;
+	}
+
+	b.shadowPalettes = ri.Malloc( b.numCharacters * b.model->numBones * sizeof( matrix_t ) );
+	b.lightPalettes	 = ri.Malloc( b.numCharacters * b.model->numBones * sizeof( matrix_t ) );
+	b.fromPoses		 = ri.Malloc( b.numCharacters * b.model->numBones * sizeof( bonePose_t ) );
+	b.toPoses		 = ri.Malloc( b.numCharacters * b.model->numBones * sizeof( bonePose_t ) );
+	b.lerpedPoses	 = ri.Malloc( b.numCharacters * b.model->numBones * sizeof( bonePose_t ) );
+	for( i = 0; i < 8; i++ )
+	{
+		b.vectors[i] = ri.Malloc( MAX( maxVerts, 1 ) * sizeof( vec4_t ) );
+	}
+
+	// every character gets its own pose, the palettes are built from the
+	// first one and the skeleton is lerped to the second
+	seed = 1;
+	for( i = 0; i < b.numCharacters; i++ )
+	{
+		for( j = 0; j < b.model->numBones; j++ )
+		{
+			k = i * b.model->numBones + j;
+
+			R_SkinBenchPose( &b.model->bones[j], &seed, &b.fromPoses[k] );
+			R_SkinBenchPose( &b.model->bones[j], &seed, &b.toPoses[k] );
+
+			MatrixSetupTransformFromQuat( b.shadowPalettes[k], b.fromPoses[k].rotation, b.fromPoses[k].origin );
+			MatrixMultiply( b.shadowPalettes[k], b.model->bones[j].inverseTransform, b.lightPalettes[k] );
+		}
+	}
+
+	numKernels			  = 0;
+	kernels[numKernels++] = &skinKernelsC;
+#if SKIN_SIMD
+	kernels[numKernels++] = &skinKernelsSSE;
+	if( Sys_GetProcessorFeatures() & CF_AVX2 )
+	{
+		kernels[numKernels++] = &skinKernelsAVX2;
+	}
+#endif
+
+	ri.Printf( PRINT_ALL, "%i characters of %s with %i bones and %i vertexes, %i frames\n", b.numCharacters, mod->name, b.model->numBones, numVerts, frames );
+
+	for( i = 0; i < numKernels; i++ )
+	{
+		R_SkinBenchRun( kernels[i], &b, frames, times );
+		ri.Printf( PRINT_ALL, "%-6s bones %7.3f, skinning %7.3f, shadow skinning %7.3f msec per frame", kernels[i]->name, times[0] / 1000.0f / frames,
+			times[1] / 1000.0f / frames, times[2] / 1000.0f / frames );
+
+		if( kernels[i] != &skinKernelsC )
+		{
+			R_SkinBenchCompare( kernels[i], &b, errors );
+			ri.Printf( PRINT_ALL, ", largest differences %g %g %g", errors[0], errors[1], errors[2] );
+		}
+		ri.Printf( PRINT_ALL, "\n" );
+	}
+
+	for( i = 0; i < 8; i++ )
+	{
+		ri.Free( b.vectors[i] );
+	}
+	ri.Free( b.lerpedPoses );
+	ri.Free( b.toPoses );
+	ri.Free( b.fromPoses );
+	ri.Free( b.lightPalettes );
+	ri.Free( b.shadowPalettes );
+}
@@ -11812,18 +11812,23 @@ smp extensions, or asynchronously by another thread.
 void RB_ExecuteRenderCommands( const void* data )
 {
 	int t1, t2;
+	int i;
 
 	GLimp_LogComment( "--- RB_ExecuteRenderCommands ---\n" );
 
 	t1 = ri.Milliseconds();
 
-	if( !r_smp->integer || data == backEndData[0]->commands.cmds )
+	backEnd.smpFrame = 0;
+	if( r_smp->integer )
 	{
-		backEnd.smpFrame = 0;
-	}
-	else
-	{
-		backEnd.smpFrame = 1;
+		for( i = 1; i < r_smpFrames->integer; i++ )
+		{
+			if( data == backEndData[i]->commands.cmds )
+			{
+				backEnd.smpFrame = i;
+				break;
+			}
+		}
 	}
 
 	while( 1 )
@@ -11890,17 +11895,15 @@ void RB_RenderThread()
 	while( 1 )
 	{
 		// sleep until we have work to do
-		data = GLimp_RendererSleep();
+		data = R_WaitRenderCommands();
 
 		if( !data )
 		{
 			return; // all done, renderer is shutting down
 		}
 
-		renderThreadActive = qtrue;
-
 		RB_ExecuteRenderCommands( data );
 
-		renderThreadActive = qfalse;
+		R_FinishRenderCommands();
 	}
 }
@@ -9702,6 +9702,477 @@ void R_BuildCubeMaps()
 #endif
 }
 
+/*
+===============================================================================
+
+WORLD SURFACE BVH
+
+A BVH_WIDTH wide bounding volume hierarchy over the bounds of the world
+surfaces.  The BSP walk can only cull whole leafs, which are huge on outdoor
+maps with few portals, the BVH culls groups of nearby surfaces instead.  The
+PVS still applies through the BSP leafs every surface is marked in.  Flares
+are points at their origin, and any other surface without bounds of its own
+gets the bounds of the leafs it is marked in.
+
+A binary tree is built top down with a binned surface area heuristic over
+the surface centers, then collapsed: every node takes over the children of
+its largest children until it has BVH_WIDTH of them.
+
+===============================================================================
+*/
+
+#define BVH_BINS			  16
+#define BVH_MAX_LEAF_SURFACES 8
+#define BVH_TRAVERSAL_COST	  1.0f // relative to testing a surface
+#define BVH_EMPTY_BOUNDS	  1e30f
+
+typedef struct
+{
+	vec3_t bounds[2];
+	int	   children[2]; // -1 for leafs
+	int	   firstSurface;
+	int	   numSurfaces;
+} bvhBuildNode_t;
+
+typedef struct
+{
+	bspSurface_t**	surfaces; // reordered while splitting
+	vec3_t*			centers;  // 2 * center, in the same order
+	vec3_t ( *bounds )[2];	  // of every world surface, by surface number
+
+	int				numNodes;
+	bvhBuildNode_t* nodes;
+
+	bspBVHNode_t*	outNodes;
+	bspBVHLeaf_t*	outLeafs;
+	int				numOutNodes;
+	int				numOutLeafs;
+} bvhBuild_t;
+
+/*
+=================
+R_BVHSurfaceArea
+
+Half the surface area of the bounds
+=================
+*/
+static float R_BVHSurfaceArea( const vec3_t mins, const vec3_t maxs )
+{
+	vec3_t d;
+
+	VectorSubtract( maxs, mins, d );
+	if( d[0] < 0 || d[1] < 0 || d[2] < 0 )
+	{
+		return 0;
+	}
+	return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+}
+
+/*
+=================
+R_BVHBin
+=================
+*/
+static ID_INLINE int R_BVHBin( float center, float mins, float scale )
+{
+	int bin = ( int )( ( center - mins ) * scale );
+
+	return bin < 0 ? 0 : ( bin >= BVH_BINS ? BVH_BINS - 1 : bin );
+}
+
+/*
+=================
+R_BuildBVHNode_r
+
+Returns the index of the new node
+=================
+*/
+static int R_BuildBVHNode_r( bvhBuild_t* build, int firstSurface, int numSurfaces, int depth )
+{
+	int				index, i, j, axis, bin, mid, bestAxis, bestBin;
+	int				binCounts[BVH_BINS], rightCounts[BVH_BINS];
+	vec3_t			binBounds[BVH_BINS][2], rightBounds[BVH_BINS][2], leftMins, leftMaxs;
+	vec3_t			centerMins, centerMaxs;
+	float			scale, area, cost, bestCost;
+	vec3_t*			bounds;
+	bspSurface_t*	tmpSurface;
+	vec3_t			tmpCenter;
+	bvhBuildNode_t* node;
+
+	index = build->numNodes++;
+	node  = &build->nodes[index];
+
+	node->children[0]  = node->children[1] = -1;
+	node->firstSurface = firstSurface;
+	node->numSurfaces  = numSurfaces;
+
+	ClearBounds( node->bounds[0], node->bounds[1] );
+	ClearBounds( centerMins, centerMaxs );
+	for( i = firstSurface; i < firstSurface + numSurfaces; i++ )
+	{
+		bounds = build->bounds[build->surfaces[i] - s_worldData.surfaces];
+		AddPointToBounds( bounds[0], node->bounds[0], node->bounds[1] );
+		AddPointToBounds( bounds[1], node->bounds[0], node->bounds[1] );
+		AddPointToBounds( build->centers[i], centerMins, centerMaxs );
+	}
+
+	if( numSurfaces == 1 || depth >= BVH_MAX_DEPTH )
+	{
+		return index;
+	}
+
+	// find the cheapest split, a leaf costs testing all of its surfaces
+	area	 = R_BVHSurfaceArea( node->bounds[0], node->bounds[1] );
+	bestCost = numSurfaces <= BVH_MAX_LEAF_SURFACES ? numSurfaces : 1e30f;
+	bestAxis = -1;
+	bestBin	 = 0;
+
+	for( axis = 0; axis < 3 && area > 0; axis++ )
+	{
+		if( centerMaxs[axis] - centerMins[axis] <= 0 )
+		{
+			continue;
+		}
+		scale = BVH_BINS / ( centerMaxs[axis] - centerMins[axis] );
+
+		for( bin = 0; bin < BVH_BINS; bin++ )
+		{
+			binCounts[bin] = 0;
+			ClearBounds( binBounds[bin][0], binBounds[bin][1] );
+		}
+
+		for( i = firstSurface; i < firstSurface + numSurfaces; i++ )
+		{
+			bounds = build->bounds[build->surfaces[i] - s_worldData.surfaces];
+			bin	   = R_BVHBin( build->centers[i][axis], centerMins[axis], scale );
+
+			binCounts[bin]++;
+			AddPointToBounds( bounds[0], binBounds[bin][0], binBounds[bin][1] );
+			AddPointToBounds( bounds[1], binBounds[bin][0], binBounds[bin][1] );
+		}
+
+		// bins bin .. BVH_BINS - 1 go to the right child
+		rightCounts[BVH_BINS - 1] = binCounts[BVH_BINS - 1];
+		VectorCopy( binBounds[BVH_BINS - 1][0], rightBounds[BVH_BINS - 1][0] );
+		VectorCopy( binBounds[BVH_BINS - 1][1], rightBounds[BVH_BINS - 1][1] );
+		for( bin = BVH_BINS - 2; bin > 0; bin-- )
+		{
+			rightCounts[bin] = rightCounts[bin + 1] + binCounts[bin];
+			VectorCopy( rightBounds[bin + 1][0], rightBounds[bin][0] );
+			VectorCopy( rightBounds[bin + 1][1], rightBounds[bin][1] );
+			AddPointToBounds( binBounds[bin][0], rightBounds[bin][0], rightBounds[bin][1] );
+			AddPointToBounds( binBounds[bin][1], rightBounds[bin][0], rightBounds[bin][1] );
+		}
+
+		ClearBounds( leftMins, leftMaxs );
+		for( bin = 1, j = 0; bin < BVH_BINS; bin++ )
+		{
+			j += binCounts[bin - 1];
+			AddPointToBounds( binBounds[bin - 1][0], leftMins, leftMaxs );
+			AddPointToBounds( binBounds[bin - 1][1], leftMins, leftMaxs );
+
+			if( !j || !rightCounts[bin] )
+			{
+				continue;
+			}
+
+			cost = BVH_TRAVERSAL_COST +
+				   ( R_BVHSurfaceArea( leftMins, leftMaxs ) * j + R_BVHSurfaceArea( rightBounds[bin][0], rightBounds[bin][1] ) * rightCounts[bin] ) / area;
+			if( cost < bestCost )
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin	 = bin;
+			}
+		}
+	}
+
+	if( bestAxis < 0 && numSurfaces <= BVH_MAX_LEAF_SURFACES )
+	{
+		return index;
+	}
+
+	// partition the surfaces
+	mid = firstSurface;
+	if( bestAxis >= 0 )
+	{
+		scale = BVH_BINS / ( centerMaxs[bestAxis] - centerMins[bestAxis] );
+
+		for( i = firstSurface; i < firstSurface + numSurfaces; i++ )
+		{
+			if( R_BVHBin( build->centers[i][bestAxis], centerMins[bestAxis], scale ) < bestBin )
+			{
+				tmpSurface			 = build->surfaces[i];
+				build->surfaces[i]	 = build->surfaces[mid];
+				build->surfaces[mid] = tmpSurface;
+
+				VectorCopy( build->centers[i], tmpCenter );
+				VectorCopy( build->centers[mid], build->centers[i] );
+				VectorCopy( tmpCenter, build->centers[mid] );
+				mid++;
+			}
+		}
+	}
+
+	// too many surfaces with the same center, just halve them
+	if( mid == firstSurface || mid == firstSurface + numSurfaces )
+	{
+		mid = firstSurface + numSurfaces / 2;
+	}
+
+	i = R_BuildBVHNode_r( build, firstSurface, mid - firstSurface, depth + 1 );
+	j = R_BuildBVHNode_r( build, mid, firstSurface + numSurfaces - mid, depth + 1 );
+
+	build->nodes[index].children[0] = i;
+	build->nodes[index].children[1] = j;
+
+	return index;
+}
+
+/*
+=================
+R_CollapseBVHNode_r
+
+Returns the index of the new BVH_WIDTH wide node
+=================
+*/
+static int R_CollapseBVHNode_r( bvhBuild_t* build, int buildIndex )
+{
+	int				children[BVH_WIDTH];
+	int				numChildren, i, j, best, index, child;
+	float			area, bestArea;
+	bvhBuildNode_t* node;
+	bspBVHNode_t*	out;
+	bspBVHLeaf_t*	leaf;
+
+	// open up the largest inner nodes until the node is full
+	children[0] = buildIndex;
+	numChildren = 1;
+	while( numChildren < BVH_WIDTH )
+	{
+		best	 = -1;
+		bestArea = -1;
+		for( i = 0; i < numChildren; i++ )
+		{
+			node = &build->nodes[children[i]];
+			if( node->children[0] < 0 )
+			{
+				continue;
+			}
+
+			area = R_BVHSurfaceArea( node->bounds[0], node->bounds[1] );
+			if( area > bestArea )
+			{
+				bestArea = area;
+				best	 = i;
+			}
+		}
+
+		if( best < 0 )
+		{
+			break;
+		}
+
+		node					= &build->nodes[children[best]];
+		children[best]			= node->children[0];
+		children[numChildren++] = node->children[1];
+	}
+
+	index = build->numOutNodes++;
+	for( i = 0; i < BVH_WIDTH; i++ )
+	{
+		if( i >= numChildren )
+		{
+			for( j = 0; j < 3; j++ )
+			{
+				build->outNodes[index].bounds[j][i]		= BVH_EMPTY_BOUNDS;
+				build->outNodes[index].bounds[j + 3][i] = -BVH_EMPTY_BOUNDS;
+			}
+			build->outNodes[index].children[i] = BVH_EMPTY_CHILD;
+			continue;
+		}
+
+		node = &build->nodes[children[i]];
+		if( node->children[0] < 0 )
+		{
+			leaf			   = &build->outLeafs[build->numOutLeafs];
+			leaf->firstSurface = node->firstSurface;
+			leaf->numSurfaces  = node->numSurfaces;
+			child			   = BVH_LEAF_CHILD( build->numOutLeafs++ );
+		}
+		else
+		{
+			child = R_CollapseBVHNode_r( build, children[i] );
+		}
+
+		// the recursion may have moved on, so index again
+		out = &build->outNodes[index];
+		for( j = 0; j < 3; j++ )
+		{
+			out->bounds[j][i]	  = node->bounds[0][j];
+			out->bounds[j + 3][i] = node->bounds[1][j];
+		}
+		out->children[i] = child;
+	}
+
+	return index;
+}
+
+/*
+=================
+R_BuildWorldBVH
+=================
+*/
+static void R_BuildWorldBVH()
+{
+	bspBVH_t*		 bvh = &s_worldData.bvh;
+	bvhBuild_t		 build;
+	bspNode_t*		 leaf;
+	bspSurface_t*	 surf;
+	bspBVHSurface_t* bvhSurf;
+	srfGeneric_t*	 gen;
+	vec3_t*			 bounds;
+	int*			 remap;
+	int				 i, j, numSurfaces, numSurfaceLeafs;
+
+	ri.Printf( PRINT_ALL, "...building world BVH\n" );
+
+	Com_Memset( bvh, 0, sizeof( *bvh ) );
+	Com_Memset( &build, 0, sizeof( build ) );
+
+	// collect all the surfaces of the BSP leafs, R_WorldBVHNode replaces the
+	// BSP walk so the BVH must hold everything R_AddLeafSurfaces would add
+	remap = ( int* )ri.Malloc( s_worldData.numSurfaces * sizeof( int ) );
+	Com_Memset( remap, -1, s_worldData.numSurfaces * sizeof( int ) );
+
+	build.surfaces = ( bspSurface_t** )ri.Malloc( s_worldData.numSurfaces * sizeof( bspSurface_t* ) );
+	build.centers  = ( vec3_t* )ri.Malloc( s_worldData.numSurfaces * sizeof( vec3_t ) );
+	build.bounds   = ( vec3_t( * )[2] )ri.Malloc( s_worldData.numSurfaces * sizeof( *build.bounds ) );
+
+	numSurfaces		= 0;
+	numSurfaceLeafs = 0;
+	for( i = s_worldData.numDecisionNodes, leaf = s_worldData.nodes + i; i < s_worldData.numnodes; i++, leaf++ )
+	{
+		for( j = 0; j < leaf->numMarkSurfaces; j++ )
+		{
+			surf   = leaf->markSurfaces[j];
+			bounds = build.bounds[surf - s_worldData.surfaces];
+
+			if( remap[surf - s_worldData.surfaces] < 0 )
+			{
+				remap[surf - s_worldData.surfaces] = numSurfaces;
+				build.surfaces[numSurfaces++]	   = surf;
+
+				switch( *surf->data )
+				{
+					case SF_FACE:
+					case SF_GRID:
+					case SF_TRIANGLES:
+						gen = ( srfGeneric_t* )surf->data;
+						VectorCopy( gen->bounds[0], bounds[0] );
+						VectorCopy( gen->bounds[1], bounds[1] );
+						break;
+
+					case SF_FLARE:
+						VectorCopy( ( ( srfFlare_t* )surf->data )->origin, bounds[0] );
+						VectorCopy( ( ( srfFlare_t* )surf->data )->origin, bounds[1] );
+						break;
+
+					default:
+						ClearBounds( bounds[0], bounds[1] );
+						break;
+				}
+			}
+
+			// surfaces without bounds of their own get the leafs they are in
+			if( *surf->data != SF_FACE && *surf->data != SF_GRID && *surf->data != SF_TRIANGLES && *surf->data != SF_FLARE )
+			{
+				AddPointToBounds( leaf->mins, bounds[0], bounds[1] );
+				AddPointToBounds( leaf->maxs, bounds[0], bounds[1] );
+			}
+			numSurfaceLeafs++;
+		}
+	}
+
+	for( i = 0; i < numSurfaces; i++ )
+	{
+		bounds = build.bounds[build.surfaces[i] - s_worldData.surfaces];
+		VectorAdd( bounds[0], bounds[1], build.centers[i] );
+	}
+
+	if( numSurfaces )
+	{
+		build.nodes = ( bvhBuildNode_t* )ri.Malloc( ( 2 * numSurfaces - 1 ) * sizeof( bvhBuildNode_t ) );
+		R_BuildBVHNode_r( &build, 0, numSurfaces, 0 );
+
+		// there are less wide nodes than inner binary nodes, and less leafs than binary nodes
+		build.outNodes = ( bspBVHNode_t* )ri.Malloc( build.numNodes * sizeof( bspBVHNode_t ) );
+		build.outLeafs = ( bspBVHLeaf_t* )ri.Malloc( build.numNodes * sizeof( bspBVHLeaf_t ) );
+		R_CollapseBVHNode_r( &build, 0 );
+
+		bvh->numNodes = build.numOutNodes;
+		bvh->nodes	  = ( bspBVHNode_t* )ri.Hunk_Alloc( bvh->numNodes * sizeof( bspBVHNode_t ), h_low );
+		Com_Memcpy( bvh->nodes, build.outNodes, bvh->numNodes * sizeof( bspBVHNode_t ) );
+
+		bvh->numLeafs = build.numOutLeafs;
+		bvh->leafs	  = ( bspBVHLeaf_t* )ri.Hunk_Alloc( bvh->numLeafs * sizeof( bspBVHLeaf_t ), h_low );
+		Com_Memcpy( bvh->leafs, build.outLeafs, bvh->numLeafs * sizeof( bspBVHLeaf_t ) );
+
+		ri.Free( build.nodes );
+		ri.Free( build.outNodes );
+		ri.Free( build.outLeafs );
+
+		// surfaces in leaf order, followed by the BSP leafs they are marked in
+		bvh->numSurfaces	 = numSurfaces;
+		bvh->surfaces		 = ( bspBVHSurface_t* )ri.Hunk_Alloc( numSurfaces * sizeof( bspBVHSurface_t ), h_low );
+		bvh->numSurfaceLeafs = numSurfaceLeafs;
+		bvh->surfaceLeafs	 = ( bspNode_t** )ri.Hunk_Alloc( numSurfaceLeafs * sizeof( bspNode_t* ), h_low );
+
+		for( i = 0; i < numSurfaces; i++ )
+		{
+			bvh->surfaces[i].surface						= build.surfaces[i];
+			remap[build.surfaces[i] - s_worldData.surfaces] = i;
+		}
+
+		for( i = s_worldData.numDecisionNodes, leaf = s_worldData.nodes + i; i < s_worldData.numnodes; i++, leaf++ )
+		{
+			for( j = 0; j < leaf->numMarkSurfaces; j++ )
+			{
+				if( remap[leaf->markSurfaces[j] - s_worldData.surfaces] >= 0 )
+				{
+					bvh->surfaces[remap[leaf->markSurfaces[j] - s_worldData.surfaces]].numLeafs++;
+				}
+			}
+		}
+
+		for( i = 0, j = 0; i < numSurfaces; i++ )
+		{
+			bvh->surfaces[i].firstLeaf = j;
+			j += bvh->surfaces[i].numLeafs;
+			bvh->surfaces[i].numLeafs = 0;
+		}
+
+		for( i = s_worldData.numDecisionNodes, leaf = s_worldData.nodes + i; i < s_worldData.numnodes; i++, leaf++ )
+		{
+			for( j = 0; j < leaf->numMarkSurfaces; j++ )
+			{
+				if( remap[leaf->markSurfaces[j] - s_worldData.surfaces] >= 0 )
+				{
+					bvhSurf = &bvh->surfaces[remap[leaf->markSurfaces[j] - s_worldData.surfaces]];
+					bvh->surfaceLeafs[bvhSurf->firstLeaf + bvhSurf->numLeafs++] = leaf;
+				}
+			}
+		}
+	}
+
+	ri.Free( remap );
+	ri.Free( build.surfaces );
+	ri.Free( build.centers );
+	ri.Free( build.bounds );
+
+	ri.Printf( PRINT_DEVELOPER, "%i surfaces in %i BVH nodes and %i leafs\n", bvh->numSurfaces, bvh->numNodes, bvh->numLeafs );
+}
+
 /*
 =================
 RE_LoadWorldMap
@@ -9832,6 +10303,8 @@ void RE_LoadWorldMap( const char* name )
 	//	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadLightGrid( &header->lumps[LUMP_LIGHTGRID] );
 
+	R_BuildWorldBVH();
+
 	// create static VBOS from the world
 	R_CreateWorldVBO();
 	R_CreateClusters();
@@ -9841,6 +10314,10 @@ void RE_LoadWorldMap( const char* name )
 	// to reduce the polygon count
 	R_PrecacheInteractions();
 
+	// surface marks for the threads that gather light interactions
+	s_worldData.numInteractionThreads = Sys_NumJobThreads();
+	s_worldData.interactionMarks	  = ( int* )ri.Hunk_Alloc( s_worldData.numInteractionThreads * s_worldData.numSurfaces * sizeof( int ), h_low );
+
 	s_worldData.dataSize = ( byte* )ri.Hunk_Alloc( 0, h_low ) - startMarker;
 
 	// ri.Printf(PRINT_ALL, "total world data size: %d.%02d MB\n", s_worldData.dataSize / (1024 * 1024),
@@ -25,54 +25,508 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 volatile renderCommandList_t* renderCommandList;
 
-volatile qboolean			  renderThreadActive;
+/*
+=============================================================
+
+RENDER THREAD
+
+With r_smp the back end runs RB_RenderThread on a thread of its own.
+The front end builds every frame in one of r_smpFrames backEndData
+buffers and queues its command list in R_IssueRenderCommands, the back
+end works through the queue in order.  Before a buffer is filled again
+R_WaitRenderFence waits until the back end has finished the last command
+list queued from it, so up to r_smpFrames - 1 frames are in flight while
+the front end builds the next one.
+
+The back end keeps the GL context as long as it has work,
+R_SyncRenderThread drains the queue and takes the context back to the
+main thread until the next command list is queued.
+
+=============================================================
+*/
+
+typedef struct
+{
+	const void* cmds;
+	qboolean	endOfFrame; // publish the back end counters when finished
+} renderQueueEntry_t;
+
+typedef struct
+{
+	sysMutex_t*		   lock;
+	sysSignal_t*	   work; // raised when a command list is queued, on sync and on quit
+	sysSignal_t*	   done; // raised when the back end finished a command list or released the context
+
+	// protected by lock
+	renderQueueEntry_t entries[SMP_FRAMES];
+	int				   queued;			   // command lists queued so far
+	int				   finished;		   // command lists the back end has finished
+	int				   fences[SMP_FRAMES]; // finished has to reach this before a buffer is reused
+	qboolean		   sync;			   // release the context once the queue is empty
+	qboolean		   quit;
+	qboolean		   backEndHasContext;
+	backEndCounters_t  pc; // of the last finished frame
+	int64_t			   backEndUsec;
+
+	// only touched by the back end
+	int64_t			   startTime;
+	qboolean		   endOfFrame;
+
+	// only touched by the front end
+	qboolean		   frontEndHasContext;
+	int64_t			   frontEndWaitUsec;
+} renderQueue_t;
+
+static renderQueue_t renderQueue;
+
+typedef struct
+{
+	int		frames; // 0 if not running
+	int		remaining;
+	int64_t startTime;
+	int64_t backEndUsec;
+	int64_t frontEndWaitUsec;
+} smpBench_t;
+
+static smpBench_t smpBench;
+
+int				  c_blockedOnRender;
+int				  c_blockedOnMain;
+
+/*
+=====================
+R_QueueRenderCommands
+=====================
+*/
+static void R_QueueRenderCommands( const void* cmds, qboolean endOfFrame )
+{
+	renderQueueEntry_t* entry;
+
+	if( renderQueue.frontEndHasContext )
+	{
+		GLimp_SetCurrentContext( qfalse );
+		renderQueue.frontEndHasContext = qfalse;
+	}
+
+	Sys_LockMutex( renderQueue.lock );
+	entry							 = &renderQueue.entries[renderQueue.queued % SMP_FRAMES];
+	entry->cmds						 = cmds;
+	entry->endOfFrame				 = endOfFrame;
+	renderQueue.queued++;
+	renderQueue.fences[tr.smpFrame] = renderQueue.queued;
+	Sys_UnlockMutex( renderQueue.lock );
+
+	Sys_RaiseSignal( renderQueue.work );
+}
+
+/*
+=====================
+R_WaitRenderQueue
+
+Waits on the front end until the back end has finished the given number
+of command lists, and released the context if asked to
+=====================
+*/
+static void R_WaitRenderQueue( int finished, qboolean release )
+{
+	int64_t	 start;
+	qboolean ready;
+
+	start = Sys_Microseconds();
+	while( 1 )
+	{
+		Sys_LockMutex( renderQueue.lock );
+		ready = renderQueue.finished >= finished && ( !release || !renderQueue.backEndHasContext );
+		Sys_UnlockMutex( renderQueue.lock );
+
+		if( ready )
+		{
+			break;
+		}
+		Sys_WaitSignal( renderQueue.done, 100 );
+	}
+	renderQueue.frontEndWaitUsec += Sys_Microseconds() - start;
+}
+
+/*
+=====================
+R_SyncRenderQueue
+
+Waits until the back end is idle and takes the context back
+=====================
+*/
+static void R_SyncRenderQueue()
+{
+	if( renderQueue.frontEndHasContext )
+	{
+		// nothing was queued since the last sync
+		return;
+	}
+
+	Sys_LockMutex( renderQueue.lock );
+	renderQueue.sync = qtrue;
+	Sys_UnlockMutex( renderQueue.lock );
+	Sys_RaiseSignal( renderQueue.work );
+
+	R_WaitRenderQueue( renderQueue.queued, qtrue );
+
+	Sys_LockMutex( renderQueue.lock );
+	renderQueue.sync = qfalse;
+	Sys_UnlockMutex( renderQueue.lock );
+
+	GLimp_SetCurrentContext( qtrue );
+	renderQueue.frontEndHasContext = qtrue;
+}
+
+/*
+=====================
+R_SpawnRenderThread
+=====================
+*/
+qboolean R_SpawnRenderThread()
+{
+	Com_Memset( &renderQueue, 0, sizeof( renderQueue ) );
+
+	renderQueue.lock = Sys_CreateMutex();
+	renderQueue.work = Sys_CreateSignal();
+	renderQueue.done = Sys_CreateSignal();
+	if( !renderQueue.lock || !renderQueue.work || !renderQueue.done )
+	{
+		R_ShutdownRenderThread();
+		return qfalse;
+	}
+
+	renderQueue.frontEndHasContext = qtrue;
+
+	if( !GLimp_SpawnRenderThread( RB_RenderThread ) )
+	{
+		R_ShutdownRenderThread();
+		return qfalse;
+	}
+	return qtrue;
+}
+
+/*
+=====================
+R_ShutdownRenderThread
+=====================
+*/
+void R_ShutdownRenderThread()
+{
+	if( glConfig.smpActive )
+	{
+		R_SyncRenderQueue();
+
+		Sys_LockMutex( renderQueue.lock );
+		renderQueue.quit = qtrue;
+		Sys_UnlockMutex( renderQueue.lock );
+		Sys_RaiseSignal( renderQueue.work );
+
+		GLimp_ShutdownRenderThread();
+		glConfig.smpActive = qfalse;
+	}
+
+	Sys_DestroySignal( renderQueue.done );
+	Sys_DestroySignal( renderQueue.work );
+	Sys_DestroyMutex( renderQueue.lock );
+	Com_Memset( &renderQueue, 0, sizeof( renderQueue ) );
+}
+
+/*
+=====================
+R_WaitRenderFence
+
+Called before the front end starts to fill the buffer again
+=====================
+*/
+void R_WaitRenderFence( int smpFrame )
+{
+	int fence;
+
+	if( !glConfig.smpActive )
+	{
+		return;
+	}
+
+	Sys_LockMutex( renderQueue.lock );
+	fence = renderQueue.fences[smpFrame];
+	if( renderQueue.finished < fence )
+	{
+		c_blockedOnRender++;
+	}
+	else
+	{
+		c_blockedOnMain++;
+	}
+	Sys_UnlockMutex( renderQueue.lock );
+
+	if( r_showSmp->integer )
+	{
+		ri.Printf( PRINT_ALL, renderQueue.finished < fence ? "R" : "." );
+	}
+
+	R_WaitRenderQueue( fence, qfalse );
+}
+
+/*
+=====================
+R_WaitRenderCommands
+
+Called by the back end, returns NULL when the render thread has to quit
+=====================
+*/
+const void* R_WaitRenderCommands()
+{
+	renderQueueEntry_t entry;
+
+	while( 1 )
+	{
+		Sys_LockMutex( renderQueue.lock );
+
+		if( renderQueue.quit )
+		{
+			Sys_UnlockMutex( renderQueue.lock );
+			return NULL;
+		}
+
+		if( renderQueue.finished < renderQueue.queued )
+		{
+			entry = renderQueue.entries[renderQueue.finished % SMP_FRAMES];
+			Sys_UnlockMutex( renderQueue.lock );
+
+			// the front end has released it before queueing
+			if( !renderQueue.backEndHasContext )
+			{
+				GLimp_SetCurrentContext( qtrue );
+
+				Sys_LockMutex( renderQueue.lock );
+				renderQueue.backEndHasContext = qtrue;
+				Sys_UnlockMutex( renderQueue.lock );
+			}
+
+			renderQueue.endOfFrame = entry.endOfFrame;
+			renderQueue.startTime  = Sys_Microseconds();
+			return entry.cmds;
+		}
+
+		if( renderQueue.sync && renderQueue.backEndHasContext )
+		{
+			Sys_UnlockMutex( renderQueue.lock );
+
+			GLimp_SetCurrentContext( qfalse );
+
+			Sys_LockMutex( renderQueue.lock );
+			renderQueue.backEndHasContext = qfalse;
+			Sys_UnlockMutex( renderQueue.lock );
+
+			Sys_RaiseSignal( renderQueue.done );
+			continue;
+		}
+
+		Sys_UnlockMutex( renderQueue.lock );
+
+		Sys_WaitSignal( renderQueue.work, 100 );
+	}
+}
+
+/*
+=====================
+R_FinishRenderCommands
+
+Called by the back end after the command list from R_WaitRenderCommands
+=====================
+*/
+void R_FinishRenderCommands()
+{
+	int64_t end = Sys_Microseconds();
+
+	Sys_LockMutex( renderQueue.lock );
+	renderQueue.backEndUsec += end - renderQueue.startTime;
+	if( renderQueue.endOfFrame )
+	{
+		renderQueue.pc = backEnd.pc;
+		Com_Memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
+	}
+	renderQueue.finished++;
+	Sys_UnlockMutex( renderQueue.lock );
+
+	Sys_RaiseSignal( renderQueue.done );
+}
+
+/*
+=====================
+R_GetBackEndCounters
+
+The render thread publishes its counters once per frame
+=====================
+*/
+static void R_GetBackEndCounters( backEndCounters_t* pc )
+{
+	if( !glConfig.smpActive )
+	{
+		*pc = backEnd.pc;
+		return;
+	}
+
+	Sys_LockMutex( renderQueue.lock );
+	*pc = renderQueue.pc;
+	Sys_UnlockMutex( renderQueue.lock );
+}
+
+/*
+=====================
+R_SmpBenchFrame
+
+Called at the end of every frame
+=====================
+*/
+static void R_SmpBenchFrame()
+{
+	int64_t now, wall, backEndUsec, frontEndWaitUsec, frontEndUsec, overlap;
+
+	if( !smpBench.frames )
+	{
+		return;
+	}
+
+	now = Sys_Microseconds();
+	if( glConfig.smpActive )
+	{
+		Sys_LockMutex( renderQueue.lock );
+		backEndUsec = renderQueue.backEndUsec;
+		Sys_UnlockMutex( renderQueue.lock );
+	}
+	else
+	{
+		backEndUsec = renderQueue.backEndUsec;
+	}
+
+	// the first frame only starts the measurement
+	if( smpBench.remaining == smpBench.frames )
+	{
+		smpBench.startTime		  = now;
+		smpBench.backEndUsec	  = backEndUsec;
+		smpBench.frontEndWaitUsec = renderQueue.frontEndWaitUsec;
+		smpBench.remaining--;
+		return;
+	}
+
+	if( --smpBench.remaining > 0 )
+	{
+		return;
+	}
+
+	wall			 = now - smpBench.startTime;
+	backEndUsec		 = backEndUsec - smpBench.backEndUsec;
+	frontEndWaitUsec = renderQueue.frontEndWaitUsec - smpBench.frontEndWaitUsec;
+
+	// without the render thread the front end also runs the back end
+	frontEndUsec = wall - frontEndWaitUsec;
+	if( !glConfig.smpActive )
+	{
+		frontEndUsec -= backEndUsec;
+	}
+	overlap = frontEndUsec + backEndUsec - wall;
+	if( overlap < 0 )
+	{
+		overlap = 0;
+	}
+
+	ri.Printf( PRINT_ALL,
+		"%i frames with %s: %.2f msec per frame, front end %.2f, back end %.2f, front end waited %.2f\n",
+		smpBench.frames - 1,
+		glConfig.smpActive ? va( "%i frames in flight", r_smpFrames->integer - 1 ) : "no render thread",
+		wall / 1000.0 / ( smpBench.frames - 1 ),
+		frontEndUsec / 1000.0 / ( smpBench.frames - 1 ),
+		backEndUsec / 1000.0 / ( smpBench.frames - 1 ),
+		frontEndWaitUsec / 1000.0 / ( smpBench.frames - 1 ) );
+	ri.Printf( PRINT_ALL, "front end and back end overlapped %.2f msec per frame, %i%% of the back end time\n", overlap / 1000.0 / ( smpBench.frames - 1 ), backEndUsec ? ( int )( overlap * 100 / backEndUsec ) : 0 );
+
+	smpBench.frames = 0;
+}
+
+/*
+=====================
+R_SmpBench_f
+
+smpbench [frames]
+=====================
+*/
+void R_SmpBench_f()
+{
+	int frames = 100;
+
+	if( ri.Cmd_Argc() > 1 )
+	{
+		frames = atoi( ri.Cmd_Argv( 1 ) );
+	}
+	if( frames < 1 )
+	{
+		ri.Printf( PRINT_ALL, "usage: smpbench [frames]\n" );
+		return;
+	}
+
+	// one more frame to start the measurement
+	smpBench.frames	   = frames + 1;
+	smpBench.remaining = smpBench.frames;
+
+	ri.Printf( PRINT_ALL, "measuring the next %i frames\n", frames );
+}
 
 /*
 =====================
 R_PerformanceCounters
 =====================
 */
-void						  R_PerformanceCounters()
+void R_PerformanceCounters()
 {
+	backEndCounters_t pc;
+
 	if( !r_speeds->integer )
 	{
 		// clear the counters even if we aren't printing
 		Com_Memset( &tr.pc, 0, sizeof( tr.pc ) );
-		Com_Memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
+		if( !glConfig.smpActive )
+		{
+			Com_Memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
+		}
 		return;
 	}
 
+	R_GetBackEndCounters( &pc );
+
 	if( r_speeds->integer == RSPEEDS_GENERAL )
 	{
 		ri.Printf( PRINT_ALL,
-			"%i views %i portals %i batches %i surfs %i leafs %i verts %i tris\n",
-			backEnd.pc.c_views,
-			backEnd.pc.c_portals,
-			backEnd.pc.c_batches,
-			backEnd.pc.c_surfaces,
+			"%i views %i portals %i batches %i surfs %i leafs %i bvh leafs %i verts %i tris\n",
+			pc.c_views,
+			pc.c_portals,
+			pc.c_batches,
+			pc.c_surfaces,
 			tr.pc.c_leafs,
-			backEnd.pc.c_vertexes,
-			backEnd.pc.c_indexes / 3 );
+			tr.pc.c_bvhLeafs,
+			pc.c_vertexes,
+			pc.c_indexes / 3 );
 
 		ri.Printf( PRINT_ALL,
 			"%i lights %i bout %i pvsout %i queryout %i interactions\n",
-			tr.pc.c_dlights + tr.pc.c_slights - backEnd.pc.c_occlusionQueriesLightsCulled,
+			tr.pc.c_dlights + tr.pc.c_slights - pc.c_occlusionQueriesLightsCulled,
 			tr.pc.c_box_cull_light_out,
 			tr.pc.c_pvs_cull_light_out,
-			backEnd.pc.c_occlusionQueriesLightsCulled,
-			tr.pc.c_dlightInteractions + tr.pc.c_slightInteractions - backEnd.pc.c_occlusionQueriesInteractionsCulled );
+			pc.c_occlusionQueriesLightsCulled,
+			tr.pc.c_dlightInteractions + tr.pc.c_slightInteractions - pc.c_occlusionQueriesInteractionsCulled );
 
 		ri.Printf( PRINT_ALL,
 			"%i draws %i queries %i CHC++ ms %i vbos %i ibos %i verts %i tris\n",
-			backEnd.pc.c_drawElements,
+			pc.c_drawElements,
 			tr.pc.c_occlusionQueries,
 			tr.pc.c_CHCTime,
-			backEnd.pc.c_vboVertexBuffers,
-			backEnd.pc.c_vboIndexBuffers,
-			backEnd.pc.c_vboVertexes,
-			backEnd.pc.c_vboIndexes / 3 );
+			pc.c_vboVertexBuffers,
+			pc.c_vboIndexBuffers,
+			pc.c_vboVertexes,
+			pc.c_vboIndexes / 3 );
 
-		ri.Printf( PRINT_ALL, "%i multidraws %i primitives %i tris\n", backEnd.pc.c_multiDrawElements, backEnd.pc.c_multiDrawPrimitives, backEnd.pc.c_multiVboIndexes / 3 );
+		ri.Printf( PRINT_ALL, "%i multidraws %i primitives %i tris\n", pc.c_multiDrawElements, pc.c_multiDrawPrimitives, pc.c_multiVboIndexes / 3 );
 	}
 	else if( r_speeds->integer == RSPEEDS_CULLING )
 	{
@@ -116,24 +570,24 @@ void						  R_PerformanceCounters()
 	}
 	else if( r_speeds->integer == RSPEEDS_FOG )
 	{
-		ri.Printf( PRINT_ALL, "fog srf:%i batches:%i\n", backEnd.pc.c_fogSurfaces, backEnd.pc.c_fogBatches );
+		ri.Printf( PRINT_ALL, "fog srf:%i batches:%i\n", pc.c_fogSurfaces, pc.c_fogBatches );
 	}
 	else if( r_speeds->integer == RSPEEDS_FLARES )
 	{
-		ri.Printf( PRINT_ALL, "flare adds:%i tests:%i renders:%i\n", backEnd.pc.c_flareAdds, backEnd.pc.c_flareTests, backEnd.pc.c_flareRenders );
+		ri.Printf( PRINT_ALL, "flare adds:%i tests:%i renders:%i\n", pc.c_flareAdds, pc.c_flareTests, pc.c_flareRenders );
 	}
 	else if( r_speeds->integer == RSPEEDS_OCCLUSION_QUERIES )
 	{
 		ri.Printf( PRINT_ALL,
 			"occlusion queries:%i multi:%i saved:%i culled lights:%i culled entities:%i culled leafs:%i response time:%i fetch time:%i\n",
-			backEnd.pc.c_occlusionQueries,
-			backEnd.pc.c_occlusionQueriesMulti,
-			backEnd.pc.c_occlusionQueriesSaved,
-			backEnd.pc.c_occlusionQueriesLightsCulled,
-			backEnd.pc.c_occlusionQueriesEntitiesCulled,
-			backEnd.pc.c_occlusionQueriesLeafsCulled,
-			backEnd.pc.c_occlusionQueriesResponseTime,
-			backEnd.pc.c_occlusionQueriesFetchTime );
+			pc.c_occlusionQueries,
+			pc.c_occlusionQueriesMulti,
+			pc.c_occlusionQueriesSaved,
+			pc.c_occlusionQueriesLightsCulled,
+			pc.c_occlusionQueriesEntitiesCulled,
+			pc.c_occlusionQueriesLeafsCulled,
+			pc.c_occlusionQueriesResponseTime,
+			pc.c_occlusionQueriesFetchTime );
 	}
 	else if( r_speeds->integer == RSPEEDS_DEPTH_BOUNDS_TESTS )
 	{
@@ -144,11 +598,11 @@ void						  R_PerformanceCounters()
 		if( DS_STANDARD_ENABLED() )
 			ri.Printf( PRINT_ALL,
 				"deferred shading times: g-buffer:%i lighting:%i translucent:%i\n",
-				backEnd.pc.c_deferredGBufferTime,
-				backEnd.pc.c_deferredLightingTime,
-				backEnd.pc.c_forwardTranslucentTime );
+				pc.c_deferredGBufferTime,
+				pc.c_deferredLightingTime,
+				pc.c_forwardTranslucentTime );
 		else
-			ri.Printf( PRINT_ALL, "forward shading times: ambient:%i lighting:%i\n", backEnd.pc.c_forwardAmbientTime, backEnd.pc.c_forwardLightingTime );
+			ri.Printf( PRINT_ALL, "forward shading times: ambient:%i lighting:%i\n", pc.c_forwardAmbientTime, pc.c_forwardLightingTime );
 	}
 	else if( r_speeds->integer == RSPEEDS_CHC )
 	{
@@ -170,7 +624,10 @@ void						  R_PerformanceCounters()
 	}
 
 	Com_Memset( &tr.pc, 0, sizeof( tr.pc ) );
-	Com_Memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
+	if( !glConfig.smpActive )
+	{
+		Com_Memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
+	}
 }
 
 /*
@@ -178,12 +635,10 @@ void						  R_PerformanceCounters()
 R_IssueRenderCommands
 ====================
 */
-int	 c_blockedOnRender;
-int	 c_blockedOnMain;
-
 void R_IssueRenderCommands( qboolean runPerformanceCounters )
 {
 	renderCommandList_t* cmdList;
+	int64_t				 start;
 
 	cmdList = &backEndData[tr.smpFrame]->commands;
 	assert( cmdList ); // bk001205
@@ -193,35 +648,12 @@ void R_IssueRenderCommands( qboolean runPerformanceCounters )
 	// clear it out, in case this is a sync and not a buffer flip
 	cmdList->used = 0;
 
-	if( glConfig.smpActive )
-	{
-		// if the render thread is not idle, wait for it
-		if( renderThreadActive )
-		{
-			c_blockedOnRender++;
-			if( r_showSmp->integer )
-			{
-				ri.Printf( PRINT_ALL, "R" );
-			}
-		}
-		else
-		{
-			c_blockedOnMain++;
-			if( r_showSmp->integer )
-			{
-				ri.Printf( PRINT_ALL, "." );
-			}
-		}
-
-		// sleep until the renderer has completed
-		GLimp_FrontEndSleep();
-	}
-
-	// at this point, the back end thread is idle, so it is ok
-	// to look at its performance counters
+	// the render thread publishes its counters at the end of a frame,
+	// so they may be a few frames old
 	if( runPerformanceCounters )
 	{
 		R_PerformanceCounters();
+		R_SmpBenchFrame();
 	}
 
 	// actually start the commands going
@@ -230,11 +662,13 @@ void R_IssueRenderCommands( qboolean runPerformanceCounters )
 		// let it start on the new batch
 		if( !glConfig.smpActive )
 		{
+			start = Sys_Microseconds();
 			RB_ExecuteRenderCommands( cmdList->cmds );
+			renderQueue.backEndUsec += Sys_Microseconds() - start;
 		}
 		else
 		{
-			GLimp_WakeRenderer( cmdList );
+			R_QueueRenderCommands( cmdList->cmds, runPerformanceCounters );
 		}
 	}
 }
@@ -263,7 +697,7 @@ void R_SyncRenderThread()
 		return;
 	}
 
-	GLimp_SyncRenderThread();
+	R_SyncRenderQueue();
 }
 
 /*
@@ -660,6 +1094,7 @@ Returns the number of msec spent in the back end
 void RE_EndFrame( int* frontEndMsec, int* backEndMsec )
 {
 	swapBuffersCommand_t* cmd;
+	backEndCounters_t	  pc;
 
 	if( !tr.registered )
 	{
@@ -674,8 +1109,8 @@ void RE_EndFrame( int* frontEndMsec, int* backEndMsec )
 
 	R_IssueRenderCommands( qtrue );
 
-	// use the other buffers next frame, because another CPU
-	// may still be rendering into the current ones
+	// use the next buffers, because the render thread
+	// may still be rendering from the current ones
 	R_ToggleSmpFrame();
 
 	if( frontEndMsec )
@@ -685,9 +1120,13 @@ void RE_EndFrame( int* frontEndMsec, int* backEndMsec )
 	tr.frontEndMsec = 0;
 	if( backEndMsec )
 	{
-		*backEndMsec = backEnd.pc.msec;
+		R_GetBackEndCounters( &pc );
+		*backEndMsec = pc.msec;
+	}
+	if( !glConfig.smpActive )
+	{
+		backEnd.pc.msec = 0;
 	}
-	backEnd.pc.msec = 0;
 }
 
 /*
@@ -63,6 +63,7 @@ cvar_t*		r_znear;
 cvar_t*		r_zfar;
 
 cvar_t*		r_smp;
+cvar_t*		r_smpFrames;
 cvar_t*		r_showSmp;
 cvar_t*		r_skipBackEnd;
 cvar_t*		r_skipLightBuffer;
@@ -91,6 +92,9 @@ cvar_t*		r_nocurves;
 cvar_t*		r_noLightScissors;
 cvar_t*		r_noLightVisCull;
 cvar_t*		r_noInteractionSort;
+cvar_t*		r_jobInteractions;
+cvar_t*		r_simd;
+cvar_t*		r_worldBVH;
 cvar_t*		r_dynamicLight;
 cvar_t*		r_staticLight;
 cvar_t*		r_dynamicLightCastShadows;
@@ -398,7 +402,7 @@ static void InitOpenGL()
 		{
 			ri.Printf( PRINT_ALL, "Trying SMP acceleration...\n" );
 
-			if( GLimp_SpawnRenderThread( RB_RenderThread ) )
+			if( R_SpawnRenderThread() )
 			{
 				ri.Printf( PRINT_ALL, "...succeeded.\n" );
 				glConfig.smpActive = qtrue;
@@ -1314,7 +1318,7 @@ void GfxInfo_f()
 
 	if( glConfig.smpActive )
 	{
-		ri.Printf( PRINT_ALL, "Using dual processor acceleration\n" );
+		ri.Printf( PRINT_ALL, "Using a render thread with up to %i frames in flight\n", r_smpFrames->integer - 1 );
 	}
 
 	if( r_finish->integer )
@@ -1403,7 +1407,9 @@ void R_Register()
 	r_forceAmbient = ri.Cvar_Get( "r_forceAmbient", "0.125", CVAR_ARCHIVE | CVAR_LATCH );
 	AssertCvarRange( r_forceAmbient, 0.0f, 0.3f, qfalse );
 
-	r_smp = ri.Cvar_Get( "r_smp", "0", CVAR_ARCHIVE | CVAR_LATCH );
+	r_smp		= ri.Cvar_Get( "r_smp", "0", CVAR_ARCHIVE | CVAR_LATCH );
+	r_smpFrames = ri.Cvar_Get( "r_smpFrames", "2", CVAR_ARCHIVE | CVAR_LATCH );
+	AssertCvarRange( r_smpFrames, 2, SMP_FRAMES, qtrue );
 
 	// temporary latched variables that can only change over a restart
 	r_displayRefresh = ri.Cvar_Get( "r_displayRefresh", "0", CVAR_LATCH );
@@ -1529,6 +1535,9 @@ void R_Register()
 	r_noLightScissors	= ri.Cvar_Get( "r_noLightScissors", "0", CVAR_CHEAT );
 	r_noLightVisCull	= ri.Cvar_Get( "r_noLightVisCull", "0", CVAR_CHEAT );
 	r_noInteractionSort = ri.Cvar_Get( "r_noInteractionSort", "0", CVAR_CHEAT );
+	r_jobInteractions	= ri.Cvar_Get( "r_jobInteractions", "1", CVAR_ARCHIVE );
+	r_simd				= ri.Cvar_Get( "r_simd", "2", CVAR_ARCHIVE | CVAR_LATCH );
+	r_worldBVH			= ri.Cvar_Get( "r_worldBVH", "0", CVAR_ARCHIVE );
 	r_dynamicLight		= ri.Cvar_Get( "r_dynamicLight", "1", CVAR_ARCHIVE );
 	r_staticLight		= ri.Cvar_Get( "r_staticLight", "1", CVAR_CHEAT );
 	r_drawworld			= ri.Cvar_Get( "r_drawworld", "1", CVAR_CHEAT );
@@ -1698,6 +1707,10 @@ void R_Register()
 	ri.Cmd_AddCommand( "gfxinfo", GfxInfo_f );
 	//	ri.Cmd_AddCommand("generatemtr", R_GenerateMaterialFile_f);
 	ri.Cmd_AddCommand( "buildcubemaps", R_BuildCubeMaps );
+	ri.Cmd_AddCommand( "sortbench", R_SortBench_f );
+	ri.Cmd_AddCommand( "smpbench", R_SmpBench_f );
+	ri.Cmd_AddCommand( "skinbench", R_SkinBench_f );
+	ri.Cmd_AddCommand( "worldbench", R_WorldBench_f );
 
 #if !defined( USE_D3D10 )
 	ri.Cmd_AddCommand( "glsl_restart", GLSL_restart_f );
@@ -1761,23 +1774,25 @@ void R_Init()
 
 	R_Register();
 
-	backEndData[0]				= ( backEndData_t* )ri.Hunk_Alloc( sizeof( *backEndData[0] ), h_low );
-	backEndData[0]->polys		= ( srfPoly_t* )ri.Hunk_Alloc( r_maxPolys->integer * sizeof( srfPoly_t ), h_low );
-	backEndData[0]->polyVerts	= ( polyVert_t* )ri.Hunk_Alloc( r_maxPolyVerts->integer * sizeof( polyVert_t ), h_low );
-	backEndData[0]->polybuffers = ( srfPolyBuffer_t* )ri.Hunk_Alloc( r_maxPolys->integer * sizeof( srfPolyBuffer_t ), h_low );
-
-	if( r_smp->integer )
+	// one set of buffers for every frame in flight and the one the front end is building
+	for( i = 0; i < SMP_FRAMES; i++ )
 	{
-		backEndData[1]				= ( backEndData_t* )ri.Hunk_Alloc( sizeof( *backEndData[1] ), h_low );
-		backEndData[1]->polys		= ( srfPoly_t* )ri.Hunk_Alloc( r_maxPolys->integer * sizeof( srfPoly_t ), h_low );
-		backEndData[1]->polyVerts	= ( polyVert_t* )ri.Hunk_Alloc( r_maxPolyVerts->integer * sizeof( polyVert_t ), h_low );
-		backEndData[1]->polybuffers = ( srfPolyBuffer_t* )ri.Hunk_Alloc( r_maxPolys->integer * sizeof( srfPolyBuffer_t ), h_low );
-	}
-	else
-	{
-		backEndData[1] = NULL;
+		if( i && ( !r_smp->integer || i >= r_smpFrames->integer ) )
+		{
+			backEndData[i] = NULL;
+			continue;
+		}
+
+		backEndData[i]				= ( backEndData_t* )ri.Hunk_Alloc( sizeof( *backEndData[i] ), h_low );
+		backEndData[i]->polys		= ( srfPoly_t* )ri.Hunk_Alloc( r_maxPolys->integer * sizeof( srfPoly_t ), h_low );
+		backEndData[i]->polyVerts	= ( polyVert_t* )ri.Hunk_Alloc( r_maxPolyVerts->integer * sizeof( polyVert_t ), h_low );
+		backEndData[i]->polybuffers = ( srfPolyBuffer_t* )ri.Hunk_Alloc( r_maxPolys->integer * sizeof( srfPolyBuffer_t ), h_low );
 	}
 
+	R_InitInteractionJobs();
+
+	R_InitSkinKernels();
+
 	R_ToggleSmpFrame();
 
 #if defined( USE_D3D10 )
@@ -2088,6 +2103,12 @@ void RE_Shutdown( qboolean destroyWindow )
 	ri.Cmd_RemoveCommand( "vbolist" );
 	ri.Cmd_RemoveCommand( "generatemtr" );
 	ri.Cmd_RemoveCommand( "buildcubemaps" );
+	ri.Cmd_RemoveCommand( "sortbench" );
+	ri.Cmd_RemoveCommand( "smpbench" );
+	ri.Cmd_RemoveCommand( "skinbench" );
+	ri.Cmd_RemoveCommand( "worldbench" );
+	R_FreeSortBench();
+	R_FreeWorldBench();
 
 	ri.Cmd_RemoveCommand( "glsl_restart" );
 
@@ -2147,6 +2168,8 @@ void RE_Shutdown( qboolean destroyWindow )
 		GLSL_ShutdownGPUShaders();
 #endif
 
+		R_ShutdownRenderThread();
+
 		GLimp_Shutdown();
 
 #if defined( USE_D3D10 )
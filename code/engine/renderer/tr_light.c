@@ -1108,15 +1108,246 @@ void R_SetupLightProjection( trRefLight_t* light )
 }
 // *INDENT-ON*
 
+/*
+=============================================================
+
+INTERACTION JOBS
+
+R_AddLightInteractions gathers the world interactions of all visible
+lights at once, one job per light.  While a job runs R_AddLightInteraction
+appends to a shared scratch buffer instead of tr.refdef.interactions,
+every thread reserves blocks of it and keeps its own surface marks and
+counters.  R_MergeWorldInteractions copies the interactions back in light
+order afterwards, so the result doesn't depend on the number of threads.
+
+A light whose interactions don't fit into the scratch buffer is gathered
+again on the main thread when it is merged.
+
+=============================================================
+*/
+
+#if defined( _MSC_VER )
+	#define R_THREAD_LOCAL __declspec( thread )
+#else
+	#define R_THREAD_LOCAL __thread
+#endif
+
+#define MAX_INTERACTION_THREADS ( MAX_JOB_THREADS + 1 )
+#define MAX_JOB_INTERACTIONS	( MAX_INTERACTIONS / 4 )
+#define INTERACTION_BLOCK		256
+
+static interaction_t*						iaScratch;
+static volatile int							iaScratchBlocks;
+
+static int									iaBatch;
+static int									iaBaseLightCount;
+static volatile int							iaNumJobs;
+static interactionJob_t						iaJobs[MAX_INTERACTION_THREADS];
+
+static R_THREAD_LOCAL interactionJob_t*		iaJob; // only set while a job runs
+static R_THREAD_LOCAL int					iaJobBatch;
+static R_THREAD_LOCAL int					iaJobSlot;
+
 /*
 =================
-R_AddLightInteraction
+R_InitInteractionJobs
 =================
 */
-qboolean R_AddLightInteraction( trRefLight_t* light, surfaceType_t* surface, shader_t* surfaceShader, byte cubeSideBits, interactionType_t iaType )
+void R_InitInteractionJobs()
+{
+	iaScratch = ( interaction_t* )ri.Hunk_Alloc( MAX_JOB_INTERACTIONS * sizeof( interaction_t ), h_low );
+}
+
+/*
+=================
+R_InteractionJob
+
+Returns NULL outside of R_GatherWorldInteractions
+=================
+*/
+interactionJob_t* R_InteractionJob()
+{
+	return iaJob;
+}
+
+/*
+=================
+R_InteractionCounters
+=================
+*/
+frontEndCounters_t* R_InteractionCounters()
+{
+	return iaJob ? &iaJob->pc : &tr.pc;
+}
+
+/*
+=================
+R_WorldInteractionsJob
+=================
+*/
+static void R_WorldInteractionsJob( void* data, int index )
+{
+	trRefLight_t*	  light = ( ( trRefLight_t** )data )[index];
+	interactionJob_t* job;
+
+	// the first job of a batch on this thread takes the next free slot
+	if( iaJobBatch != iaBatch )
+	{
+		iaJobBatch = iaBatch;
+		iaJobSlot  = Sys_AtomicIncrement( &iaNumJobs );
+
+		job = &iaJobs[iaJobSlot];
+		Com_Memset( job, 0, sizeof( *job ) );
+		job->surfaceMarks = tr.world ? tr.world->interactionMarks + iaJobSlot * tr.world->numSurfaces : NULL;
+		job->blockUsed	  = INTERACTION_BLOCK;
+	}
+
+	job				= &iaJobs[iaJobSlot];
+	job->lightCount = iaBaseLightCount + index + 1;
+	iaJob			= job;
+
+	if( light->isStatic )
+	{
+		R_AddPrecachedWorldInteractions( light );
+	}
+	else
+	{
+		R_AddWorldInteractions( light );
+	}
+
+	iaJob = NULL;
+}
+
+/*
+=================
+R_GatherWorldInteractions
+
+Runs R_AddPrecachedWorldInteractions or R_AddWorldInteractions for all
+lights, tr.currentEntity has to be the world entity
+=================
+*/
+void R_GatherWorldInteractions( trRefLight_t** lights, int numLights )
+{
+	int	 i, j;
+	int* src;
+	int* dst;
+
+	if( numLights <= 0 )
+	{
+		return;
+	}
+
+	iaBatch++;
+	iaNumJobs		= 0;
+	iaScratchBlocks = 0;
+
+	// every light marks the surfaces it has seen with its own count
+	iaBaseLightCount = tr.lightCount;
+	tr.lightCount += numLights;
+
+	for( i = 0; i < numLights; i++ )
+	{
+		lights[i]->jobOverflow = qfalse;
+	}
+
+	if( r_jobInteractions->integer && tr.world && Sys_NumJobThreads() <= tr.world->numInteractionThreads )
+	{
+		Sys_RunJobs( R_WorldInteractionsJob, lights, numLights );
+	}
+	else
+	{
+		for( i = 0; i < numLights; i++ )
+		{
+			R_WorldInteractionsJob( lights, i );
+		}
+	}
+
+	for( i = 0; i < iaNumJobs && i < MAX_INTERACTION_THREADS; i++ )
+	{
+		src = ( int* )&iaJobs[i].pc;
+		dst = ( int* )&tr.pc;
+		for( j = 0; j < ( int )( sizeof( frontEndCounters_t ) / sizeof( int ) ); j++ )
+		{
+			dst[j] += src[j];
+		}
+	}
+}
+
+/*
+=================
+R_MergeWorldInteractions
+
+Moves the interactions R_GatherWorldInteractions found for the light
+to tr.refdef.interactions
+=================
+*/
+void R_MergeWorldInteractions( trRefLight_t* light )
 {
 	int			   iaIndex;
 	interaction_t* ia;
+	interaction_t* next;
+	interaction_t* dst;
+
+	ia						= light->firstInteraction;
+	light->firstInteraction = NULL;
+	light->lastInteraction	= NULL;
+
+	if( light->jobOverflow )
+	{
+		light->numInteractions			 = 0;
+		light->numShadowOnlyInteractions = 0;
+		light->numLightOnlyInteractions	 = 0;
+
+		if( light->isStatic )
+		{
+			R_AddPrecachedWorldInteractions( light );
+		}
+		else
+		{
+			R_AddWorldInteractions( light );
+		}
+		return;
+	}
+
+	for( ; ia; ia = next )
+	{
+		next = ia->next;
+
+		iaIndex = tr.refdef.numInteractions & INTERACTION_MASK;
+		dst		= &tr.refdef.interactions[iaIndex];
+		tr.refdef.numInteractions++;
+
+		*dst	  = *ia;
+		dst->next = NULL;
+
+		light->noSort = iaIndex == 0;
+
+		if( !light->firstInteraction )
+		{
+			light->firstInteraction = dst;
+		}
+
+		if( light->lastInteraction )
+		{
+			light->lastInteraction->next = dst;
+		}
+
+		light->lastInteraction = dst;
+	}
+}
+
+/*
+=================
+R_AddLightInteraction
+=================
+*/
+qboolean R_AddLightInteraction( trRefLight_t* light, surfaceType_t* surface, shader_t* surfaceShader, byte cubeSideBits, interactionType_t iaType )
+{
+	int					iaIndex;
+	int					block;
+	interaction_t*		ia;
+	interactionJob_t*	job;
+	frontEndCounters_t* pc;
 
 	// skip all surfaces that don't matter for lighting only pass
 	if( surfaceShader )
@@ -1127,13 +1358,42 @@ qboolean R_AddLightInteraction( trRefLight_t* light, surfaceType_t* surface, sha
 		}
 	}
 
-	// instead of checking for overflow, we just mask the index
-	// so it wraps around
-	iaIndex = tr.refdef.numInteractions & INTERACTION_MASK;
-	ia		= &tr.refdef.interactions[iaIndex];
-	tr.refdef.numInteractions++;
+	job = iaJob;
+	if( job )
+	{
+		if( light->jobOverflow )
+		{
+			return qfalse;
+		}
 
-	light->noSort = iaIndex == 0;
+		if( job->blockUsed == INTERACTION_BLOCK )
+		{
+			block = Sys_AtomicIncrement( &iaScratchBlocks );
+			if( block >= MAX_JOB_INTERACTIONS / INTERACTION_BLOCK )
+			{
+				// gathered again by R_MergeWorldInteractions
+				light->jobOverflow = qtrue;
+				return qfalse;
+			}
+
+			job->block	   = &iaScratch[block * INTERACTION_BLOCK];
+			job->blockUsed = 0;
+		}
+
+		ia = &job->block[job->blockUsed++];
+		pc = &job->pc;
+	}
+	else
+	{
+		// instead of checking for overflow, we just mask the index
+		// so it wraps around
+		iaIndex = tr.refdef.numInteractions & INTERACTION_MASK;
+		ia		= &tr.refdef.interactions[iaIndex];
+		tr.refdef.numInteractions++;
+
+		light->noSort = iaIndex == 0;
+		pc			  = &tr.pc;
+	}
 
 	// connect to interaction grid
 	if( !light->firstInteraction )
@@ -1197,11 +1457,11 @@ qboolean R_AddLightInteraction( trRefLight_t* light, surfaceType_t* surface, sha
 
 	if( light->isStatic )
 	{
-		tr.pc.c_slightInteractions++;
+		pc->c_slightInteractions++;
 	}
 	else
 	{
-		tr.pc.c_dlightInteractions++;
+		pc->c_dlightInteractions++;
 	}
 
 	return qtrue;
@@ -1656,21 +1916,22 @@ R_CalcLightCubeSideBits
 // *INDENT-OFF*
 byte R_CalcLightCubeSideBits( trRefLight_t* light, vec3_t worldBounds[2] )
 {
-	int		  i;
-	int		  cubeSide;
-	byte	  cubeSideBits;
-	float	  xMin, xMax, yMin, yMax;
-	float	  width, height, depth;
-	float	  zNear, zFar;
-	float	  fovX, fovY;
-	float*	  proj;
-	vec3_t	  angles;
-	matrix_t  tmpMatrix, rotationMatrix, transformMatrix, viewMatrix, projectionMatrix, viewProjectionMatrix;
-	frustum_t frustum;
-	cplane_t* clipPlane;
-	int		  r;
-	qboolean  anyClip;
-	qboolean  culled;
+	int					i;
+	int					cubeSide;
+	byte				cubeSideBits;
+	float				xMin, xMax, yMin, yMax;
+	float				width, height, depth;
+	float				zNear, zFar;
+	float				fovX, fovY;
+	float*				proj;
+	vec3_t				angles;
+	matrix_t			tmpMatrix, rotationMatrix, transformMatrix, viewMatrix, projectionMatrix, viewProjectionMatrix;
+	frustum_t			frustum;
+	cplane_t*			clipPlane;
+	int					r;
+	qboolean			anyClip;
+	qboolean			culled;
+	frontEndCounters_t* pc;
 
 #if 0
 	static int		count = 0;
@@ -1685,6 +1946,9 @@ byte R_CalcLightCubeSideBits( trRefLight_t* light, vec3_t worldBounds[2] )
 	return cubeSideBits;
 #endif
 
+	// counted per thread while the world interactions are gathered as jobs
+	pc = R_InteractionCounters();
+
 	if( light->l.rlType != RL_OMNI || r_shadows->integer < SHADOWING_ESM16 || r_noShadowPyramids->integer )
 		return CUBESIDE_CLIPALL;
 
@@ -1810,12 +2074,12 @@ byte R_CalcLightCubeSideBits( trRefLight_t* light, vec3_t worldBounds[2] )
 			if( !anyClip )
 			{
 				// completely inside frustum
-				tr.pc.c_pyramid_cull_ent_in++;
+				pc->c_pyramid_cull_ent_in++;
 			}
 			else
 			{
 				// partially clipped
-				tr.pc.c_pyramid_cull_ent_clip++;
+				pc->c_pyramid_cull_ent_clip++;
 			}
 
 			cubeSideBits |= ( 1 << cubeSide );
@@ -1823,11 +2087,11 @@ byte R_CalcLightCubeSideBits( trRefLight_t* light, vec3_t worldBounds[2] )
 		else
 		{
 			// completely outside frustum
-			tr.pc.c_pyramid_cull_ent_out++;
+			pc->c_pyramid_cull_ent_out++;
 		}
 	}
 
-	tr.pc.c_pyramidTests++;
+	pc->c_pyramidTests++;
 
 	return cubeSideBits;
 }
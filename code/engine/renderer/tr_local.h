@@ -61,9 +61,9 @@ typedef unsigned short glIndex_t;
 #define BUFFER_OFFSET( i )		   ( ( char* )NULL + ( i ) )
 
 // everything that is needed by the backend needs
-// to be double buffered to allow it to run in
-// parallel on a dual cpu machine
-#define SMP_FRAMES				   2
+// to be buffered once per frame in flight to allow
+// it to run in parallel on another thread, see r_smpFrames
+#define SMP_FRAMES				   4
 
 #define MAX_SHADERS				   ( 1 << 12 )
 #define SHADERS_MASK			   ( MAX_SHADERS - 1 )
@@ -395,6 +395,7 @@ typedef struct trRefLight_s
 	uint16_t				   numShadowOnlyInteractions;
 	uint16_t				   numLightOnlyInteractions;
 	qboolean				   noSort; // don't sort interactions by material
+	qboolean				   jobOverflow; // the world interactions didn't fit into the job scratch buffer
 
 	link_t					   leafs;
 
@@ -2873,6 +2874,48 @@ typedef struct
 // ydnar: optimization
 #define WORLD_MAX_SKY_NODES 32
 
+// bounding volume hierarchy over the world surfaces, built by R_BuildWorldBVH
+#define BVH_WIDTH		  4
+#define BVH_MAX_DEPTH	  48 // of the binary tree that is collapsed into the BVH_WIDTH wide one
+#define BVH_STACK_SIZE	  ( BVH_MAX_DEPTH * ( BVH_WIDTH - 1 ) + 1 )
+#define BVH_EMPTY_CHILD	  -1
+#define BVH_LEAF_CHILD( c ) ( -2 - ( c ) ) // leaf index <-> child reference
+
+typedef struct
+{
+	// minX, minY, minZ, maxX, maxY, maxZ of the children, empty children have inverted bounds
+	float bounds[6][BVH_WIDTH];
+	int	  children[BVH_WIDTH]; // node index, BVH_LEAF_CHILD( leaf index ) or BVH_EMPTY_CHILD
+} bspBVHNode_t;
+
+typedef struct
+{
+	int firstSurface;
+	int numSurfaces;
+} bspBVHLeaf_t;
+
+typedef struct
+{
+	bspSurface_t* surface;
+	int			  firstLeaf; // BSP leafs the surface is marked in, for the PVS test
+	int			  numLeafs;
+} bspBVHSurface_t;
+
+typedef struct
+{
+	int				 numNodes; // node 0 is the root
+	bspBVHNode_t*	 nodes;
+
+	int				 numLeafs;
+	bspBVHLeaf_t*	 leafs;
+
+	int				 numSurfaces;
+	bspBVHSurface_t* surfaces;
+
+	int				 numSurfaceLeafs;
+	bspNode_t**		 surfaceLeafs;
+} bspBVH_t;
+
 typedef struct
 {
 	char				 name[MAX_QPATH];	  // ie: maps/tim_dm2.bsp
@@ -2922,6 +2965,8 @@ typedef struct
 	int					 numMarkSurfaces;
 	bspSurface_t**		 markSurfaces;
 
+	bspBVH_t			 bvh; // the surfaces of the BSP leafs, walked instead of the nodes with r_worldBVH
+
 	int					 numFogs;
 	fog_t*				 fogs;
 
@@ -2945,6 +2990,9 @@ typedef struct
 	int					 numInteractions;
 	interactionCache_t** interactions;
 
+	int					 numInteractionThreads;
+	int*				 interactionMarks; // numSurfaces per thread, see R_GatherWorldInteractions
+
 	int					 numClusters;
 #if defined( USE_BSP_CLUSTERSURFACE_MERGING )
 	bspCluster_t* clusters;
@@ -3089,6 +3137,13 @@ typedef struct
 	uint32_t		   numWeights;
 	md5Weight_t*	   weights;
 
+	// streams for the CPU skinning kernels, MAX_WEIGHTS slots per vertex of which skinNumWeights are used
+	uint8_t*		   skinNumWeights;
+	uint8_t*		   skinBones;	// unused slots use bone 0
+	float*			   skinWeights; // unused slots have weight 0
+	vec4_t*			   skinOffsets; // weight offsets with w = 1
+	vec4_t*			   skinVectors; // position with w = 1, tangent, binormal and normal with w = 0
+
 	struct md5Model_s* model;
 } md5Surface_t;
 
@@ -3338,6 +3393,7 @@ typedef struct
 
 	int c_nodes;
 	int c_leafs;
+	int c_bvhLeafs;
 
 	int c_slights;
 	int c_slightSurfaces;
@@ -3358,6 +3414,18 @@ typedef struct
 	int c_decalProjectors, c_decalTestSurfaces, c_decalClipSurfaces, c_decalSurfaces, c_decalSurfacesCreated;
 } frontEndCounters_t;
 
+// state of a thread that gathers world interactions, see R_GatherWorldInteractions
+typedef struct
+{
+	int					  lightCount;	// replaces tr.lightCount
+	int*				  surfaceMarks; // replaces bspSurface_t::lightCount
+
+	struct interaction_s* block; // current block of the scratch buffer
+	int					  blockUsed;
+
+	frontEndCounters_t	  pc; // added to tr.pc after the batch
+} interactionJob_t;
+
 #define FOG_TABLE_SIZE	256
 #define FUNCTABLE_SIZE	1024
 #define FUNCTABLE_SIZE2 10
@@ -3534,7 +3602,7 @@ typedef struct
 	int			   lightCount; // incremented every time a dlight traverses the world
 	// and every R_MarkFragments call
 
-	int			   smpFrame; // toggles from 0 to 1 every endFrame
+	int			   smpFrame; // cycles through the r_smpFrames buffers every endFrame
 
 	int			   frameSceneNum; // zeroed at RE_BeginFrame
 
@@ -3807,6 +3875,9 @@ extern cvar_t* r_nocurves;
 extern cvar_t* r_noLightScissors;
 extern cvar_t* r_noLightVisCull;
 extern cvar_t* r_noInteractionSort;
+extern cvar_t* r_jobInteractions;
+extern cvar_t* r_simd; // 0 = C kernels, 1 = SSE, 2 = best the CPU supports
+extern cvar_t* r_worldBVH;
 extern cvar_t* r_showcluster;
 
 extern cvar_t* r_mode; // video mode
@@ -3908,6 +3979,7 @@ extern cvar_t* r_subdivisions;
 extern cvar_t* r_stitchCurves;
 
 extern cvar_t* r_smp;
+extern cvar_t* r_smpFrames;
 extern cvar_t* r_showSmp;
 extern cvar_t* r_skipBackEnd;
 extern cvar_t* r_skipLightBuffer;
@@ -4043,6 +4115,9 @@ void			R_AddPolygonBufferSurfaces();
 
 void			R_AddDrawSurf( surfaceType_t* surface, shader_t* shader, int lightmapNum, int fogNum );
 
+void			R_SortBench_f();
+void			R_FreeSortBench();
+
 void			R_LocalNormalToWorld( const vec3_t local, vec3_t world );
 void			R_LocalPointToWorld( const vec3_t local, vec3_t world );
 
@@ -4247,10 +4322,7 @@ void		 GLimp_EndFrame();
 
 qboolean	 GLimp_SpawnRenderThread( void ( *function )() );
 void		 GLimp_ShutdownRenderThread();
-void*		 GLimp_RendererSleep();
-void		 GLimp_FrontEndSleep();
-void		 GLimp_SyncRenderThread();
-void		 GLimp_WakeRenderer( void* data );
+void		 GLimp_SetCurrentContext( qboolean enable );
 
 void		 GLimp_LogComment( const char* comment );
 
@@ -4388,6 +4460,9 @@ void	 R_AddWorldInteractions( trRefLight_t* light );
 void	 R_AddPrecachedWorldInteractions( trRefLight_t* light );
 void	 R_ShutdownVBOs();
 
+void	 R_WorldBench_f();
+void	 R_FreeWorldBench();
+
 /*
 ============================================================
 
@@ -4426,6 +4501,12 @@ qboolean R_AddLightInteraction( trRefLight_t* light, surfaceType_t* surface, sha
 
 void	 R_SortInteractions( trRefLight_t* light );
 
+void				R_InitInteractionJobs();
+interactionJob_t*	R_InteractionJob();
+frontEndCounters_t* R_InteractionCounters();
+void				R_GatherWorldInteractions( trRefLight_t** lights, int numLights );
+void				R_MergeWorldInteractions( trRefLight_t* light );
+
 void	 R_SetupLightScissor( trRefLight_t* light );
 void	 R_SetupLightDepthBounds( trRefLight_t* light );
 void	 R_SetupLightLOD( trRefLight_t* light );
@@ -4622,6 +4703,36 @@ void			 R_AnimationList_f();
 void			 R_AddMD5Surfaces( trRefEntity_t* ent );
 void			 R_AddMD5Interactions( trRefEntity_t* ent, trRefLight_t* light );
 
+typedef struct
+{
+	vec4_t origin;
+	quat_t rotation;
+} bonePose_t;
+
+// CPU skinning and skeleton lerping, see tr_animation_simd.c
+typedef struct
+{
+	const char* name;
+
+	// transforms the weight offsets by their bone matrices, positions only
+	void ( *skinPositions )( const md5Surface_t* srf, const matrix_t* boneMatrices, vec4_t* xyz );
+
+	// blends the bone matrices of every vertex and transforms the bind pose
+	// position and tangent space by them
+	void ( *skinVertexes )( const md5Surface_t* srf, const matrix_t* boneMatrices, vec4_t* xyz, vec4_t* tangents, vec4_t* binormals, vec4_t* normals );
+
+	// QuatCalcW and QuatNormalize for every rotation
+	void ( *calcBoneRotations )( bonePose_t* poses, int numBones );
+
+	// VectorLerp and QuatSlerp for every bone
+	void ( *lerpBones )( const bonePose_t* from, const bonePose_t* to, float frac, bonePose_t* out, int numBones );
+} skinKernels_t;
+
+extern const skinKernels_t* skinKernels;
+
+void						R_InitSkinKernels();
+void						R_SkinBench_f();
+
 #if defined( USE_REFENTITY_ANIMATIONSYSTEM )
 int RE_CheckSkeleton( refSkeleton_t* skel, qhandle_t hModel, qhandle_t hAnim );
 int RE_BuildSkeleton( refSkeleton_t* skel, qhandle_t anim, int startFrame, int endFrame, float frac, qboolean clearOrigin );
@@ -4857,16 +4968,20 @@ typedef struct
 	renderCommandList_t commands;
 } backEndData_t;
 
-extern backEndData_t*				 backEndData[SMP_FRAMES]; // the second one may not be allocated
+extern backEndData_t*				 backEndData[SMP_FRAMES]; // only the first r_smpFrames are allocated with r_smp
 
 extern volatile renderCommandList_t* renderCommandList;
 
-extern volatile qboolean			 renderThreadActive;
-
 void*								 R_GetCommandBuffer( int bytes );
 void								 RB_ExecuteRenderCommands( const void* data );
 
 void								 R_SyncRenderThread();
+qboolean							 R_SpawnRenderThread();
+void								 R_ShutdownRenderThread();
+const void*							 R_WaitRenderCommands();
+void								 R_FinishRenderCommands();
+void								 R_WaitRenderFence( int smpFrame );
+void								 R_SmpBench_f();
 
 void								 R_AddDrawViewCmd();
 
@@ -2427,6 +2427,328 @@ static int DrawSurfCompare( const void* a, const void* b )
 	return 0;
 }
 
+#define DRAWSURF_KEY_SHIFT	16 // the index bits are not sorted
+#define DRAWSURF_KEY_BITS	44
+#define DRAWSURF_RADIX_BITS 11
+#define DRAWSURF_RADIX_SIZE ( 1 << DRAWSURF_RADIX_BITS )
+#define DRAWSURF_RADIX_PASSES ( ( DRAWSURF_KEY_BITS + DRAWSURF_RADIX_BITS - 1 ) / DRAWSURF_RADIX_BITS )
+
+/*
+=================
+R_DrawSurfSortKey
+
+Packs the fields DrawSurfCompare looks at into one 64 bit key, from the top:
+12 bits shader, 12 bits lightmap, 10 bits entity with the world entity
+first, 10 bits fog, and the index of the surface in the low 16 bits.
+Returns qfalse if a field does not fit.
+=================
+*/
+static qboolean R_DrawSurfSortKey( const drawSurf_t* drawSurf, int index, const trRefEntity_t* entities, int numEntities, uint64_t* key )
+{
+	int lightmap, entity, fog;
+
+	lightmap = drawSurf->lightmapNum + 2048;
+	fog		 = drawSurf->fogNum + 512;
+
+	if( drawSurf->entity == &tr.worldEntity )
+	{
+		entity = 0;
+	}
+	else
+	{
+		if( !drawSurf->entity )
+		{
+			return qfalse;
+		}
+		entity = drawSurf->entity - entities;
+		if( entity < 0 || entity >= numEntities )
+		{
+			return qfalse;
+		}
+		entity++;
+	}
+
+	if( drawSurf->shaderNum >= MAX_SHADERS || lightmap < 0 || lightmap >= 4096 || entity >= 1024 || fog < 0 || fog >= 1024 )
+	{
+		return qfalse;
+	}
+
+	*key = ( ( uint64_t )drawSurf->shaderNum << 48 ) | ( ( uint64_t )lightmap << 36 ) | ( ( uint64_t )entity << 26 ) | ( ( uint64_t )fog << 16 ) | ( uint64_t )index;
+	return qtrue;
+}
+
+static uint64_t	  drawSurfKeys[2][MAX_DRAWSURFS];
+static int		  drawSurfHistograms[DRAWSURF_RADIX_PASSES][DRAWSURF_RADIX_SIZE];
+static drawSurf_t drawSurfScratch[MAX_DRAWSURFS];
+
+/*
+=================
+R_RadixSortDrawSurfs
+
+Sorts the surfaces into the same order as DrawSurfCompare with a least
+significant digit radix sort.  The sort is stable and the keys start out in
+index order, so only the bits above the index have to be sorted.  Passes in
+which all keys have the same digit are skipped, fog and lightmap usually are.
+Returns qfalse without changing anything if a surface does not fit into a
+key, the entities must then be sorted with qsort.
+=================
+*/
+static qboolean R_RadixSortDrawSurfs( drawSurf_t* drawSurfs, int numDrawSurfs, const trRefEntity_t* entities, int numEntities )
+{
+	uint64_t *src, *dst, *tmp;
+	int		  i, pass, shift, sum, count;
+	int*	  histogram;
+
+	if( numDrawSurfs > MAX_DRAWSURFS )
+	{
+		return qfalse;
+	}
+
+	Com_Memset( drawSurfHistograms, 0, sizeof( drawSurfHistograms ) );
+
+	src = drawSurfKeys[0];
+	dst = drawSurfKeys[1];
+	for( i = 0; i < numDrawSurfs; i++ )
+	{
+		if( !R_DrawSurfSortKey( &drawSurfs[i], i, entities, numEntities, &src[i] ) )
+		{
+			return qfalse;
+		}
+
+		for( pass = 0; pass < DRAWSURF_RADIX_PASSES; pass++ )
+		{
+			drawSurfHistograms[pass][( src[i] >> ( DRAWSURF_KEY_SHIFT + pass * DRAWSURF_RADIX_BITS ) ) & ( DRAWSURF_RADIX_SIZE - 1 )]++;
+		}
+	}
+
+	for( pass = 0; pass < DRAWSURF_RADIX_PASSES; pass++ )
+	{
+		shift	  = DRAWSURF_KEY_SHIFT + pass * DRAWSURF_RADIX_BITS;
+		histogram = drawSurfHistograms[pass];
+
+		if( histogram[( src[0] >> shift ) & ( DRAWSURF_RADIX_SIZE - 1 )] == numDrawSurfs )
+		{
+			continue;
+		}
+
+		// turn the counts into start offsets
+		sum = 0;
+		for( i = 0; i < DRAWSURF_RADIX_SIZE; i++ )
+		{
+			count		 = histogram[i];
+			histogram[i] = sum;
+			sum += count;
+		}
+
+		for( i = 0; i < numDrawSurfs; i++ )
+		{
+			dst[histogram[( src[i] >> shift ) & ( DRAWSURF_RADIX_SIZE - 1 )]++] = src[i];
+		}
+
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	Com_Memcpy( drawSurfScratch, drawSurfs, numDrawSurfs * sizeof( drawSurf_t ) );
+	for( i = 0; i < numDrawSurfs; i++ )
+	{
+		drawSurfs[i] = drawSurfScratch[src[i] & 0xffff];
+	}
+
+	return qtrue;
+}
+
+/*
+===============================================================================
+
+DRAW SURFACE SORT BENCHMARK
+
+"sortbench record [views]" captures the unsorted draw surface lists of the
+next views, including mirror and portal views.  "sortbench [passes]" then
+sorts copies of them with qsort and with the radix sort, checks that both
+give the same order and prints the time per view.
+
+===============================================================================
+*/
+
+#define MAX_SORTBENCH_SURFS ( MAX_DRAWSURFS * 4 )
+#define MAX_SORTBENCH_VIEWS 1024
+
+typedef struct
+{
+	int					 firstDrawSurf;
+	int					 numDrawSurfs;
+	const trRefEntity_t* entities; // only compared against, never read
+	int					 numEntities;
+} sortBenchView_t;
+
+typedef struct
+{
+	qboolean		recording;
+	int				maxViews;
+	int				numViews;
+	int				numDrawSurfs;
+	sortBenchView_t views[MAX_SORTBENCH_VIEWS];
+	drawSurf_t		drawSurfs[MAX_SORTBENCH_SURFS];
+} sortBenchRecord_t;
+
+static sortBenchRecord_t* sortBenchRecord;
+
+/*
+=================
+R_FreeSortBench
+=================
+*/
+void R_FreeSortBench()
+{
+	if( sortBenchRecord )
+	{
+		ri.Free( sortBenchRecord );
+		sortBenchRecord = NULL;
+	}
+}
+
+/*
+=================
+R_RecordSortBenchView
+=================
+*/
+static void R_RecordSortBenchView()
+{
+	sortBenchRecord_t* rec = sortBenchRecord;
+	sortBenchView_t*   view;
+
+	if( !rec || !rec->recording )
+	{
+		return;
+	}
+
+	if( rec->numViews == rec->maxViews || rec->numViews == MAX_SORTBENCH_VIEWS || rec->numDrawSurfs + tr.viewParms.numDrawSurfs > MAX_SORTBENCH_SURFS )
+	{
+		rec->recording = qfalse;
+		ri.Printf( PRINT_ALL, "sortbench: recorded %i views with %i draw surfaces\n", rec->numViews, rec->numDrawSurfs );
+		return;
+	}
+
+	view				= &rec->views[rec->numViews++];
+	view->firstDrawSurf = rec->numDrawSurfs;
+	view->numDrawSurfs	= tr.viewParms.numDrawSurfs;
+	view->entities		= tr.refdef.entities;
+	view->numEntities	= tr.refdef.numEntities;
+
+	Com_Memcpy( &rec->drawSurfs[rec->numDrawSurfs], tr.viewParms.drawSurfs, tr.viewParms.numDrawSurfs * sizeof( drawSurf_t ) );
+	rec->numDrawSurfs += tr.viewParms.numDrawSurfs;
+}
+
+/*
+=================
+R_SortBench_f
+=================
+*/
+void R_SortBench_f()
+{
+	sortBenchRecord_t* rec;
+	sortBenchView_t*   view;
+	drawSurf_t*		   qsortSurfs;
+	drawSurf_t*		   radixSurfs;
+	int				   i, j, k, passes, views, mismatches, fallbacks;
+	int64_t			   start, qsortTime, radixTime;
+
+	if( !Q_stricmp( ri.Cmd_Argv( 1 ), "record" ) )
+	{
+		views = ri.Cmd_Argc() > 2 ? atoi( ri.Cmd_Argv( 2 ) ) : 100;
+		if( views < 1 )
+		{
+			views = 1;
+		}
+
+		if( !sortBenchRecord )
+		{
+			sortBenchRecord = ri.Malloc( sizeof( *sortBenchRecord ) );
+		}
+		rec = sortBenchRecord;
+
+		rec->recording	  = qtrue;
+		rec->maxViews	  = views;
+		rec->numViews	  = 0;
+		rec->numDrawSurfs = 0;
+
+		ri.Printf( PRINT_ALL, "sortbench: recording %i views\n", views );
+		return;
+	}
+
+	rec = sortBenchRecord;
+	if( !rec || rec->recording || !rec->numViews )
+	{
+		ri.Printf( PRINT_ALL, "usage: sortbench record <views>, then sortbench [passes]\n" );
+		return;
+	}
+
+	passes = ri.Cmd_Argc() > 1 ? atoi( ri.Cmd_Argv( 1 ) ) : 20;
+	if( passes < 1 )
+	{
+		passes = 1;
+	}
+
+	qsortSurfs = ri.Malloc( MAX_DRAWSURFS * sizeof( drawSurf_t ) );
+	radixSurfs = ri.Malloc( MAX_DRAWSURFS * sizeof( drawSurf_t ) );
+
+	qsortTime = radixTime = 0;
+	mismatches = fallbacks = 0;
+	for( i = 0; i < passes; i++ )
+	{
+		for( j = 0, view = rec->views; j < rec->numViews; j++, view++ )
+		{
+			Com_Memcpy( qsortSurfs, &rec->drawSurfs[view->firstDrawSurf], view->numDrawSurfs * sizeof( drawSurf_t ) );
+			start = Sys_Microseconds();
+			qsort( qsortSurfs, view->numDrawSurfs, sizeof( drawSurf_t ), DrawSurfCompare );
+			qsortTime += Sys_Microseconds() - start;
+
+			Com_Memcpy( radixSurfs, &rec->drawSurfs[view->firstDrawSurf], view->numDrawSurfs * sizeof( drawSurf_t ) );
+			start = Sys_Microseconds();
+			if( !R_RadixSortDrawSurfs( radixSurfs, view->numDrawSurfs, view->entities, view->numEntities ) )
+			{
+				qsort( radixSurfs, view->numDrawSurfs, sizeof( drawSurf_t ), DrawSurfCompare );
+				fallbacks++;
+			}
+			radixTime += Sys_Microseconds() - start;
+
+			// qsort is not stable, so only the sorted fields can be compared
+			if( !i )
+			{
+				for( k = 0; k < view->numDrawSurfs; k++ )
+				{
+					if( DrawSurfCompare( &qsortSurfs[k], &radixSurfs[k] ) )
+					{
+						mismatches++;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	ri.Free( qsortSurfs );
+	ri.Free( radixSurfs );
+
+	ri.Printf( PRINT_ALL, "%i views, %i draw surfaces, %i passes\n", rec->numViews, rec->numDrawSurfs, passes );
+	ri.Printf( PRINT_ALL, "qsort: %8.4f msec per view\n", qsortTime / ( 1000.0 * passes * rec->numViews ) );
+	ri.Printf( PRINT_ALL, "radix: %8.4f msec per view\n", radixTime / ( 1000.0 * passes * rec->numViews ) );
+	if( fallbacks )
+	{
+		ri.Printf( PRINT_ALL, "%i views did not fit into sort keys and fell back to qsort\n", fallbacks / passes );
+	}
+	if( mismatches )
+	{
+		ri.Printf( PRINT_WARNING, "WARNING: %i views were sorted differently\n", mismatches );
+	}
+	else
+	{
+		ri.Printf( PRINT_ALL, "all views were sorted the same\n" );
+	}
+}
+
 /*
 =================
 R_SortDrawSurfs
@@ -2468,9 +2790,13 @@ static void R_SortDrawSurfs()
 		ia->next = NULL;
 	}
 
+	R_RecordSortBenchView();
+
 	// sort the drawsurfs by sort type, then orientation, then shader
-	//  qsortFast(drawSurfs, numDrawSurfs, sizeof(drawSurf_t));
-	qsort( tr.viewParms.drawSurfs, tr.viewParms.numDrawSurfs, sizeof( drawSurf_t ), DrawSurfCompare );
+	if( !R_RadixSortDrawSurfs( tr.viewParms.drawSurfs, tr.viewParms.numDrawSurfs, tr.refdef.entities, tr.refdef.numEntities ) )
+	{
+		qsort( tr.viewParms.drawSurfs, tr.viewParms.numDrawSurfs, sizeof( drawSurf_t ), DrawSurfCompare );
+	}
 
 	// check for any pass through drawing, which
 	// may cause another view to be rendered first
@@ -2770,15 +3096,25 @@ void R_AddPolygonInteractions( trRefLight_t* light )
 /*
 =============
 R_AddLightInteractions
+
+The world interactions of the visible lights are gathered as jobs, see
+R_GatherWorldInteractions.  Entity interactions go through
+tr.currentEntity and tr.currentModel and are added on the main thread.
 =============
 */
 void R_AddLightInteractions()
 {
-	int			  i, j;
-	trRefLight_t* light;
-	bspNode_t**	  leafs;
-	bspNode_t*	  leaf;
-	link_t *	  l, *sentinel;
+	int					 i, j;
+	trRefLight_t*		 light;
+	bspNode_t**			 leafs;
+	bspNode_t*			 leaf;
+	link_t *			 l, *sentinel;
+	qboolean			 deferred;
+	int					 numVisibleLights;
+	static trRefLight_t* visibleLights[MAX_REF_LIGHTS];
+
+	deferred		 = r_deferredShading->integer && r_shadows->integer < SHADOWING_ESM16;
+	numVisibleLights = 0;
 
 	for( i = 0; i < tr.refdef.numLights; i++ )
 	{
@@ -2962,7 +3298,20 @@ void R_AddLightInteractions()
 		light->numLightOnlyInteractions	 = 0;
 		light->noSort					 = qfalse;
 
-		if( r_deferredShading->integer && r_shadows->integer < SHADOWING_ESM16 )
+		visibleLights[numVisibleLights++] = light;
+	}
+
+	if( !deferred )
+	{
+		tr.currentEntity = &tr.worldEntity;
+		R_GatherWorldInteractions( visibleLights, numVisibleLights );
+	}
+
+	for( i = 0; i < numVisibleLights; i++ )
+	{
+		light = tr.currentLight = visibleLights[i];
+
+		if( deferred )
 		{
 			// add one fake interaction for this light
 			// because the renderer backend only loops through interactions
@@ -2970,14 +3319,10 @@ void R_AddLightInteractions()
 		}
 		else
 		{
-			if( light->isStatic )
-			{
-				R_AddPrecachedWorldInteractions( light );
-			}
-			else
-			{
-				R_AddWorldInteractions( light );
-			}
+			R_MergeWorldInteractions( light );
+
+			// restore tr.or for this light
+			R_RotateLightForViewParms( light, &tr.viewParms, &tr.orientation );
 
 			R_AddEntityInteractions( light );
 
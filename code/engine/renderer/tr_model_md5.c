@@ -25,6 +25,52 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "tr_local.h"
 #include "tr_model_skel.h"
 
+/*
+=================
+R_SetupMD5SkinStreams
+
+Copies the weights and the bind pose of every vertex into the separate
+streams the CPU skinning kernels read, with MAX_WEIGHTS slots per vertex
+so the slots of a vertex are found without an index, the kernels only
+read the first skinNumWeights of them
+=================
+*/
+static void R_SetupMD5SkinStreams( md5Surface_t* surf )
+{
+	md5Vertex_t* v;
+	md5Weight_t* w;
+	uint32_t	 j, k, slot;
+
+	// the hunk is cleared, unused slots stay bone 0 and weight 0
+	surf->skinNumWeights = ri.Hunk_Alloc( surf->numVerts * sizeof( *surf->skinNumWeights ), h_low );
+	surf->skinBones		 = ri.Hunk_Alloc( surf->numVerts * MAX_WEIGHTS * sizeof( *surf->skinBones ), h_low );
+	surf->skinWeights	 = ri.Hunk_Alloc( surf->numVerts * MAX_WEIGHTS * sizeof( *surf->skinWeights ), h_low );
+	surf->skinOffsets	 = ri.Hunk_Alloc( surf->numVerts * MAX_WEIGHTS * sizeof( *surf->skinOffsets ), h_low );
+	surf->skinVectors	 = ri.Hunk_Alloc( surf->numVerts * 4 * sizeof( *surf->skinVectors ), h_low );
+
+	for( j = 0, v = surf->verts; j < surf->numVerts; j++, v++ )
+	{
+		surf->skinNumWeights[j] = v->numWeights;
+
+		for( k = 0; k < v->numWeights; k++ )
+		{
+			w	 = v->weights[k];
+			slot = j * MAX_WEIGHTS + k;
+
+			surf->skinBones[slot]	= w->boneIndex;
+			surf->skinWeights[slot] = w->boneWeight;
+			VectorCopy( w->offset, surf->skinOffsets[slot] );
+			surf->skinOffsets[slot][3] = 1;
+		}
+
+		VectorCopy( v->position, surf->skinVectors[j * 4 + 0] );
+		VectorCopy( v->tangent, surf->skinVectors[j * 4 + 1] );
+		VectorCopy( v->binormal, surf->skinVectors[j * 4 + 2] );
+		VectorCopy( v->normal, surf->skinVectors[j * 4 + 3] );
+		surf->skinVectors[j * 4 + 0][3] = 1;
+	}
+}
+
 /*
 =================
 R_LoadMD5
@@ -624,6 +670,8 @@ qboolean R_LoadMD5( model_t* mod, void* buffer, int bufferSize, const char* modN
 			VectorNormalize( surf->verts[j].normal );
 		}
 #endif
+
+		R_SetupMD5SkinStreams( surf );
 	}
 
 	// split the surfaces into VBO surfaces by the maximum number of GPU vertex skinning bones
@@ -55,9 +55,10 @@ void	   R_ToggleSmpFrame()
 {
 	if( r_smp->integer )
 	{
-		// use the other buffers next frame, because another CPU
-		// may still be rendering into the current ones
-		tr.smpFrame ^= 1;
+		// use the next buffers, because the render thread
+		// may still be rendering from the current ones
+		tr.smpFrame = ( tr.smpFrame + 1 ) % r_smpFrames->integer;
+		R_WaitRenderFence( tr.smpFrame );
 	}
 	else
 	{
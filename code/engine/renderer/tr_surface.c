@@ -1868,176 +1868,118 @@ static void Tess_SurfaceMDV( mdvSurface_t* srf )
 
 /*
 ==============
-Tess_SurfaceMD5
+Tess_MD5BonePalette
+
+The bone matrices only change with the entity, so they are built once
+per view and entity for all surfaces of the model and all lights
 ==============
 */
-static void Tess_SurfaceMD5( md5Surface_t* srf )
+typedef struct
 {
-	int				i, j, k;
-	int				numIndexes = 0;
-	int				numVertexes;
-	md5Model_t*		model;
-	md5Vertex_t*	v;
-	md5Bone_t*		bone;
-	srfTriangle_t*	tri;
-	vec3_t			lightOrigin;
-	float *			xyzw, *xyzw2;
-	static matrix_t boneMatrices[MAX_BONES];
-
-	GLimp_LogComment( "--- Tess_SurfaceMD5 ---\n" );
-
-	Tess_CheckOverflow( srf->numVerts, srf->numTriangles * 3 );
-
-	model = srf->model;
+	const trRefEntity_t* entity;
+	const md5Model_t*	 model;
+	int					 frameCount;
+	int					 viewCount;
+	matrix_t			 boneMatrices[MAX_BONES];
+} md5BonePalette_t;
+
+static const matrix_t* Tess_MD5BonePalette( const md5Model_t* model, qboolean skipTangentSpaces )
+{
+	static md5BonePalette_t palettes[2]; // with and without the inverse bind pose
+	md5BonePalette_t*		palette = &palettes[skipTangentSpaces ? 1 : 0];
+	int						i;
 
-	numIndexes = srf->numTriangles * 3;
-	for( i = 0, tri = srf->triangles; i < srf->numTriangles; i++, tri++ )
+	if( palette->entity == backEnd.currentEntity && palette->model == model && palette->frameCount == backEnd.viewParms.frameCount &&
+		palette->viewCount == backEnd.viewParms.viewCount )
 	{
-		tess.indexes[tess.numIndexes + i * 3 + 0] = tess.numVertexes + tri->indexes[0];
-		tess.indexes[tess.numIndexes + i * 3 + 1] = tess.numVertexes + tri->indexes[1];
-		tess.indexes[tess.numIndexes + i * 3 + 2] = tess.numVertexes + tri->indexes[2];
+		return ( const matrix_t* )palette->boneMatrices;
 	}
 
-	if( tess.skipTangentSpaces )
-	{
-		vec3_t		 tmpVert;
-		vec3_t		 tmpPosition;
-		md5Weight_t* w;
+	palette->entity		= backEnd.currentEntity;
+	palette->model		= model;
+	palette->frameCount = backEnd.viewParms.frameCount;
+	palette->viewCount	= backEnd.viewParms.viewCount;
 
-		// convert bones back to matrices
-		for( i = 0; i < model->numBones; i++ )
-		{
-			matrix_t m, m2;
+	// convert bones back to matrices
+	for( i = 0; i < model->numBones; i++ )
+	{
+		matrix_t m, m2;
 
 #if defined( USE_REFENTITY_ANIMATIONSYSTEM )
-			if( backEnd.currentEntity->e.skeleton.type == SK_ABSOLUTE )
-			{
-				MatrixSetupScale( m, backEnd.currentEntity->e.skeleton.scale[0], backEnd.currentEntity->e.skeleton.scale[1], backEnd.currentEntity->e.skeleton.scale[2] );
-
-				MatrixSetupTransformFromQuat( m2, backEnd.currentEntity->e.skeleton.bones[i].rotation, backEnd.currentEntity->e.skeleton.bones[i].origin );
-				MatrixMultiply( m2, m, boneMatrices[i] );
-			}
-			else
-#endif
-			{
-				MatrixSetupTransformFromQuat( boneMatrices[i], model->bones[i].rotation, model->bones[i].origin );
-			}
-		}
-
-		// deform the vertices by the lerped bones
-		numVertexes = srf->numVerts;
-		for( j = 0, v = srf->verts; j < numVertexes; j++, v++ )
+		if( backEnd.currentEntity->e.skeleton.type == SK_ABSOLUTE )
 		{
-			VectorClear( tmpPosition );
+			MatrixSetupScale( m, backEnd.currentEntity->e.skeleton.scale[0], backEnd.currentEntity->e.skeleton.scale[1], backEnd.currentEntity->e.skeleton.scale[2] );
 
-			for( k = 0, w = v->weights[0]; k < v->numWeights; k++, w++ )
-			{
-				bone = &model->bones[w->boneIndex];
+			MatrixSetupTransformFromQuat( m2, backEnd.currentEntity->e.skeleton.bones[i].rotation, backEnd.currentEntity->e.skeleton.bones[i].origin );
+			MatrixMultiply( m2, m, palette->boneMatrices[i] );
 
-				MatrixTransformPoint( boneMatrices[w->boneIndex], w->offset, tmpVert );
-				VectorMA( tmpPosition, w->boneWeight, tmpVert, tmpPosition );
+			if( !skipTangentSpaces )
+			{
+				MatrixMultiply2( palette->boneMatrices[i], model->bones[i].inverseTransform );
 			}
-
-			tess.xyz[tess.numVertexes + j][0] = tmpPosition[0];
-			tess.xyz[tess.numVertexes + j][1] = tmpPosition[1];
-			tess.xyz[tess.numVertexes + j][2] = tmpPosition[2];
-			tess.xyz[tess.numVertexes + j][3] = 1;
-
-			tess.texCoords[tess.numVertexes + j][0] = v->texCoords[0];
-			tess.texCoords[tess.numVertexes + j][1] = v->texCoords[1];
-			tess.texCoords[tess.numVertexes + j][2] = 0;
-			tess.texCoords[tess.numVertexes + j][3] = 1;
 		}
-	}
-	else
-	{
-		vec3_t		 tmpVert;
-		vec3_t		 tmpPosition;
-		vec3_t		 tmpNormal;
-		vec3_t		 tmpTangent;
-		vec3_t		 tmpBinormal;
-		md5Weight_t* w;
-
-		// convert bones back to matrices
-		for( i = 0; i < model->numBones; i++ )
+		else
+#endif
 		{
-			matrix_t m, m2; //, m3;
-
-#if defined( USE_REFENTITY_ANIMATIONSYSTEM )
-			if( backEnd.currentEntity->e.skeleton.type == SK_ABSOLUTE )
+			if( skipTangentSpaces )
 			{
-				MatrixSetupScale( m, backEnd.currentEntity->e.skeleton.scale[0], backEnd.currentEntity->e.skeleton.scale[1], backEnd.currentEntity->e.skeleton.scale[2] );
-
-				MatrixSetupTransformFromQuat( m2, backEnd.currentEntity->e.skeleton.bones[i].rotation, backEnd.currentEntity->e.skeleton.bones[i].origin );
-				MatrixMultiply( m2, m, boneMatrices[i] );
-
-				MatrixMultiply2( boneMatrices[i], model->bones[i].inverseTransform );
+				MatrixSetupTransformFromQuat( palette->boneMatrices[i], model->bones[i].rotation, model->bones[i].origin );
 			}
 			else
-#endif
 			{
-				MatrixIdentity( boneMatrices[i] );
+				MatrixIdentity( palette->boneMatrices[i] );
 			}
 		}
+	}
 
-		// deform the vertices by the lerped bones
-		numVertexes = srf->numVerts;
-		for( j = 0, v = srf->verts; j < numVertexes; j++, v++ )
-		{
-			VectorClear( tmpPosition );
-			VectorClear( tmpTangent );
-			VectorClear( tmpBinormal );
-			VectorClear( tmpNormal );
+	return ( const matrix_t* )palette->boneMatrices;
+}
 
-			for( k = 0, w = v->weights[0]; k < v->numWeights; k++, w++ )
-			{
-				// MatrixTransformPoint(boneMatrices[w->boneIndex], w->offset, tmpVert);
-				MatrixTransformPoint( boneMatrices[w->boneIndex], v->position, tmpVert );
-				VectorMA( tmpPosition, w->boneWeight, tmpVert, tmpPosition );
+/*
+==============
+Tess_SurfaceMD5
+==============
+*/
+static void Tess_SurfaceMD5( md5Surface_t* srf )
+{
+	int				i;
+	int				numIndexes = 0;
+	int				numVertexes;
+	md5Vertex_t*	v;
+	srfTriangle_t*	tri;
+	const matrix_t* boneMatrices;
+
+	GLimp_LogComment( "--- Tess_SurfaceMD5 ---\n" );
 
-				MatrixTransformNormal( boneMatrices[w->boneIndex], v->tangent, tmpVert );
-				VectorMA( tmpTangent, w->boneWeight, tmpVert, tmpTangent );
+	Tess_CheckOverflow( srf->numVerts, srf->numTriangles * 3 );
 
-				MatrixTransformNormal( boneMatrices[w->boneIndex], v->binormal, tmpVert );
-				VectorMA( tmpBinormal, w->boneWeight, tmpVert, tmpBinormal );
+	numIndexes = srf->numTriangles * 3;
+	for( i = 0, tri = srf->triangles; i < srf->numTriangles; i++, tri++ )
+	{
+		tess.indexes[tess.numIndexes + i * 3 + 0] = tess.numVertexes + tri->indexes[0];
+		tess.indexes[tess.numIndexes + i * 3 + 1] = tess.numVertexes + tri->indexes[1];
+		tess.indexes[tess.numIndexes + i * 3 + 2] = tess.numVertexes + tri->indexes[2];
+	}
 
-				MatrixTransformNormal( boneMatrices[w->boneIndex], v->normal, tmpVert );
-				VectorMA( tmpNormal, w->boneWeight, tmpVert, tmpNormal );
-			}
+	boneMatrices = Tess_MD5BonePalette( srf->model, tess.skipTangentSpaces );
 
-			// VectorNormalize(tmpTangent);
-			// VectorNormalize(tmpBinormal);
-			// VectorNormalize(tmpNormal);
-
-			// VectorCopy(v->tangent, tmpTangent);
-			// VectorCopy(v->binormal, tmpBinormal);
-			// VectorCopy(v->normal, tmpNormal);
-
-			tess.xyz[tess.numVertexes + j][0] = tmpPosition[0];
-			tess.xyz[tess.numVertexes + j][1] = tmpPosition[1];
-			tess.xyz[tess.numVertexes + j][2] = tmpPosition[2];
-			tess.xyz[tess.numVertexes + j][3] = 1;
-
-			tess.texCoords[tess.numVertexes + j][0] = v->texCoords[0];
-			tess.texCoords[tess.numVertexes + j][1] = v->texCoords[1];
-			tess.texCoords[tess.numVertexes + j][2] = 0;
-			tess.texCoords[tess.numVertexes + j][3] = 1;
-
-			tess.tangents[tess.numVertexes + j][0] = tmpTangent[0];
-			tess.tangents[tess.numVertexes + j][1] = tmpTangent[1];
-			tess.tangents[tess.numVertexes + j][2] = tmpTangent[2];
-			tess.tangents[tess.numVertexes + j][3] = 1;
-
-			tess.binormals[tess.numVertexes + j][0] = tmpBinormal[0];
-			tess.binormals[tess.numVertexes + j][1] = tmpBinormal[1];
-			tess.binormals[tess.numVertexes + j][2] = tmpBinormal[2];
-			tess.binormals[tess.numVertexes + j][3] = 1;
-
-			tess.normals[tess.numVertexes + j][0] = tmpNormal[0];
-			tess.normals[tess.numVertexes + j][1] = tmpNormal[1];
-			tess.normals[tess.numVertexes + j][2] = tmpNormal[2];
-			tess.normals[tess.numVertexes + j][3] = 1;
-		}
+	// deform the vertices by the lerped bones
+	if( tess.skipTangentSpaces )
+	{
+		skinKernels->skinPositions( srf, boneMatrices, tess.xyz + tess.numVertexes );
+	}
+	else
+	{
+		skinKernels->skinVertexes( srf, boneMatrices, tess.xyz + tess.numVertexes, tess.tangents + tess.numVertexes, tess.binormals + tess.numVertexes, tess.normals + tess.numVertexes );
+	}
+
+	numVertexes = srf->numVerts;
+	for( i = 0, v = srf->verts; i < numVertexes; i++, v++ )
+	{
+		tess.texCoords[tess.numVertexes + i][0] = v->texCoords[0];
+		tess.texCoords[tess.numVertexes + i][1] = v->texCoords[1];
+		tess.texCoords[tess.numVertexes + i][2] = 0;
+		tess.texCoords[tess.numVertexes + i][3] = 1;
 	}
 
 	tess.numIndexes += numIndexes;
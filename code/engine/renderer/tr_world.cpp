@@ -25,6 +25,13 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "tr_local.h"
 #include "gl_shader.h"
 
+#if( defined( __x86_64__ ) || defined( _M_X64 ) || id386_sse ) && !defined( C_ONLY )
+	#define BVH_SIMD 1
+	#include <immintrin.h>
+#else
+	#define BVH_SIMD 0
+#endif
+
 /*
 =================
 R_CullTriSurf
@@ -250,11 +257,13 @@ static qboolean R_LightSurfaceGeneric( srfGeneric_t* face, trRefLight_t* light,
 R_AddInteractionSurface
 ======================
 */
-static void R_AddInteractionSurface( bspSurface_t* surf, trRefLight_t* light )
+static void R_AddInteractionSurface( bspSurface_t* surf, trRefLight_t* light, interactionJob_t* job )
 {
-	qboolean		  intersects;
-	interactionType_t iaType	   = IA_DEFAULT;
-	byte			  cubeSideBits = CUBESIDE_CLIPALL;
+	qboolean			intersects;
+	interactionType_t	iaType		 = IA_DEFAULT;
+	byte				cubeSideBits = CUBESIDE_CLIPALL;
+	int*				lightCount;
+	frontEndCounters_t* pc;
 
 	// Tr3B - this surface is maybe not in this view but it may still cast a shadow
 	// into this view
@@ -270,12 +279,28 @@ static void R_AddInteractionSurface( bspSurface_t* surf, trRefLight_t* light )
 		}
 	}
 
-	if( surf->lightCount == tr.lightCount )
+	// jobs keep their own marks, see R_GatherWorldInteractions
+	if( job )
 	{
-		// already checked this surface
-		return;
+		lightCount = &job->surfaceMarks[surf - tr.world->surfaces];
+		if( *lightCount == job->lightCount )
+		{
+			// already checked this surface
+			return;
+		}
+		*lightCount = job->lightCount;
+		pc			= &job->pc;
+	}
+	else
+	{
+		if( surf->lightCount == tr.lightCount )
+		{
+			// already checked this surface
+			return;
+		}
+		surf->lightCount = tr.lightCount;
+		pc				 = &tr.pc;
 	}
-	surf->lightCount = tr.lightCount;
 
 	//  skip all surfaces that don't matter for lighting only pass
 	if( surf->shader->isSky || ( !surf->shader->interactLight && surf->shader->noShadows ) )
@@ -301,18 +326,18 @@ static void R_AddInteractionSurface( bspSurface_t* surf, trRefLight_t* light )
 
 		if( light->isStatic )
 		{
-			tr.pc.c_slightSurfaces++;
+			pc->c_slightSurfaces++;
 		}
 		else
 		{
-			tr.pc.c_dlightSurfaces++;
+			pc->c_dlightSurfaces++;
 		}
 	}
 	else
 	{
 		if( !light->isStatic )
 		{
-			tr.pc.c_dlightSurfacesCulled++;
+			pc->c_dlightSurfacesCulled++;
 		}
 	}
 }
@@ -637,7 +662,7 @@ static void R_RecursiveWorldNode( bspNode_t* node, int planeBits, int decalBits
 R_RecursiveInteractionNode
 ================
 */
-static void R_RecursiveInteractionNode( bspNode_t* node, trRefLight_t* light, int planeBits )
+static void R_RecursiveInteractionNode( bspNode_t* node, trRefLight_t* light, int planeBits, interactionJob_t* job )
 {
 	int i;
 	int r;
@@ -648,12 +673,15 @@ static void R_RecursiveInteractionNode( bspNode_t* node, trRefLight_t* light, in
 		return;
 	}
 
-	// light already hit node
-	if( node->lightCount == tr.lightCount )
+	// light already hit node, a job walks the tree only once per light
+	if( !job )
 	{
-		return;
+		if( node->lightCount == tr.lightCount )
+		{
+			return;
+		}
+		node->lightCount = tr.lightCount;
 	}
-	node->lightCount = tr.lightCount;
 
 	// if the bounding volume is outside the frustum, nothing
 	// inside can be visible OPTIMIZE: don't do this all the way to leafs?
@@ -695,7 +723,7 @@ static void R_RecursiveInteractionNode( bspNode_t* node, trRefLight_t* light, in
 			// the surface may have already been added if it
 			// spans multiple leafs
 			surf = *mark;
-			R_AddInteractionSurface( surf, light );
+			R_AddInteractionSurface( surf, light, job );
 			mark++;
 		}
 		return;
@@ -708,22 +736,607 @@ static void R_RecursiveInteractionNode( bspNode_t* node, trRefLight_t* light, in
 	switch( r )
 	{
 		case 1:
-			R_RecursiveInteractionNode( node->children[0], light, planeBits );
+			R_RecursiveInteractionNode( node->children[0], light, planeBits, job );
 			break;
 
 		case 2:
-			R_RecursiveInteractionNode( node->children[1], light, planeBits );
+			R_RecursiveInteractionNode( node->children[1], light, planeBits, job );
 			break;
 
 		case 3:
 		default:
 			// recurse down the children, front side first
-			R_RecursiveInteractionNode( node->children[0], light, planeBits );
-			R_RecursiveInteractionNode( node->children[1], light, planeBits );
+			R_RecursiveInteractionNode( node->children[0], light, planeBits, job );
+			R_RecursiveInteractionNode( node->children[1], light, planeBits, job );
 			break;
 	}
 }
 
+/*
+=============================================================
+
+	WORLD BVH
+
+=============================================================
+*/
+
+typedef struct
+{
+	int node;
+	int planeBits;
+	int auxBits; // decal bits for views, light frustum plane bits for lights
+} bvhStackEntry_t;
+
+typedef struct
+{
+	int			   maxViews;
+	int			   passes;
+	char		   worldName[MAX_QPATH]; // tr.world is always the same static world_t
+	int			   worldSurfaces;
+
+	int			   stamp;
+	int*		   marks;		 // tr.world->numSurfaces
+	bspSurface_t** surfaces[2];	 // collected by the BSP walk and the BVH walk
+	int			   numSurfaces[2];
+
+	int			   numViews;
+	int64_t		   times[3]; // BSP, BVH C, BVH SSE
+	int64_t		   totalSurfaces[2];
+	int			   onlyBSP, onlyBVH;
+} worldBench_t;
+
+static worldBench_t* worldBench;
+
+/*
+================
+R_CullBVHChildren
+
+Tests the children of a BVH node against the planes in planeBits.  Returns a bit
+for every child that is not completely behind one of the planes, the planes a
+child is completely in front of are removed from its childPlaneBits.
+================
+*/
+static int R_CullBVHChildren( const bspBVHNode_t* node, const cplane_t* planes, int planeBits, int childPlaneBits[BVH_WIDTH], qboolean simd )
+{
+	const cplane_t* plane;
+	int				i, j, k, culled, inside;
+	float			dFar, dNear;
+
+	for( j = 0; j < BVH_WIDTH; j++ )
+	{
+		childPlaneBits[j] = planeBits;
+	}
+
+	culled = 0;
+#if BVH_SIMD
+	if( simd )
+	{
+		__m128 mins[3], maxs[3], outMask, n[3], dist, dFar4, dNear4;
+
+		for( k = 0; k < 3; k++ )
+		{
+			mins[k] = _mm_loadu_ps( node->bounds[k] );
+			maxs[k] = _mm_loadu_ps( node->bounds[k + 3] );
+		}
+
+		outMask = _mm_setzero_ps();
+		for( i = 0, plane = planes; planeBits >> i; i++, plane++ )
+		{
+			if( !( planeBits & ( 1 << i ) ) )
+			{
+				continue;
+			}
+
+			n[0] = _mm_set1_ps( plane->normal[0] );
+			n[1] = _mm_set1_ps( plane->normal[1] );
+			n[2] = _mm_set1_ps( plane->normal[2] );
+			dist = _mm_set1_ps( plane->dist );
+
+			// the corners farthest in front of and behind the plane, like BoxOnPlaneSide
+			dFar4  = _mm_mul_ps( n[0], ( plane->signbits & 1 ) ? mins[0] : maxs[0] );
+			dNear4 = _mm_mul_ps( n[0], ( plane->signbits & 1 ) ? maxs[0] : mins[0] );
+			dFar4  = _mm_add_ps( dFar4, _mm_mul_ps( n[1], ( plane->signbits & 2 ) ? mins[1] : maxs[1] ) );
+			dNear4 = _mm_add_ps( dNear4, _mm_mul_ps( n[1], ( plane->signbits & 2 ) ? maxs[1] : mins[1] ) );
+			dFar4  = _mm_add_ps( dFar4, _mm_mul_ps( n[2], ( plane->signbits & 4 ) ? mins[2] : maxs[2] ) );
+			dNear4 = _mm_add_ps( dNear4, _mm_mul_ps( n[2], ( plane->signbits & 4 ) ? maxs[2] : mins[2] ) );
+
+			outMask = _mm_or_ps( outMask, _mm_cmplt_ps( dFar4, dist ) );
+			inside	= _mm_movemask_ps( _mm_cmpge_ps( dNear4, dist ) );
+			for( j = 0; j < BVH_WIDTH; j++ )
+			{
+				if( inside & ( 1 << j ) )
+				{
+					childPlaneBits[j] &= ~( 1 << i );
+				}
+			}
+		}
+		culled = _mm_movemask_ps( outMask );
+	}
+	else
+#endif
+	{
+		for( i = 0, plane = planes; planeBits >> i; i++, plane++ )
+		{
+			if( !( planeBits & ( 1 << i ) ) )
+			{
+				continue;
+			}
+
+			for( j = 0; j < BVH_WIDTH; j++ )
+			{
+				dFar = dNear = 0;
+				for( k = 0; k < 3; k++ )
+				{
+					if( plane->signbits & ( 1 << k ) )
+					{
+						dFar += plane->normal[k] * node->bounds[k][j];
+						dNear += plane->normal[k] * node->bounds[k + 3][j];
+					}
+					else
+					{
+						dFar += plane->normal[k] * node->bounds[k + 3][j];
+						dNear += plane->normal[k] * node->bounds[k][j];
+					}
+				}
+
+				if( dFar < plane->dist )
+				{
+					culled |= 1 << j;
+				}
+				else if( dNear >= plane->dist )
+				{
+					childPlaneBits[j] &= ~( 1 << i );
+				}
+			}
+		}
+	}
+
+	for( j = 0; j < BVH_WIDTH; j++ )
+	{
+		if( node->children[j] == BVH_EMPTY_CHILD )
+		{
+			culled |= 1 << j;
+		}
+	}
+
+	return ~culled & ( ( 1 << BVH_WIDTH ) - 1 );
+}
+
+/*
+================
+R_OverlapBVHChildren
+
+Returns a bit for every child of a BVH node that intersects the bounds
+================
+*/
+static int R_OverlapBVHChildren( const bspBVHNode_t* node, const vec3_t bounds[2], qboolean simd )
+{
+	int j, k, overlap;
+
+#if BVH_SIMD
+	if( simd )
+	{
+		__m128 mask = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+
+		for( k = 0; k < 3; k++ )
+		{
+			mask = _mm_and_ps( mask, _mm_cmple_ps( _mm_loadu_ps( node->bounds[k] ), _mm_set1_ps( bounds[1][k] ) ) );
+			mask = _mm_and_ps( mask, _mm_cmpge_ps( _mm_loadu_ps( node->bounds[k + 3] ), _mm_set1_ps( bounds[0][k] ) ) );
+		}
+		return _mm_movemask_ps( mask );
+	}
+#endif
+
+	// the bounds of empty children are inverted and never overlap
+	overlap = 0;
+	for( j = 0; j < BVH_WIDTH; j++ )
+	{
+		for( k = 0; k < 3; k++ )
+		{
+			if( node->bounds[k][j] > bounds[1][k] || node->bounds[k + 3][j] < bounds[0][k] )
+			{
+				break;
+			}
+		}
+
+		if( k == 3 )
+		{
+			overlap |= 1 << j;
+		}
+	}
+	return overlap;
+}
+
+/*
+================
+R_BVHSurfaceInPVS
+
+A surface is potentially visible if any of the BSP leafs it is marked in
+is, the visible leafs are added to the z buffer bounds
+================
+*/
+static qboolean R_BVHSurfaceInPVS( const bspBVHSurface_t* surf, qboolean addVisBounds )
+{
+	bspNode_t** leaf;
+	qboolean	visible;
+	int			i;
+
+	visible = qfalse;
+	for( i = 0, leaf = tr.world->bvh.surfaceLeafs + surf->firstLeaf; i < surf->numLeafs; i++, leaf++ )
+	{
+		if( ( *leaf )->visCounts[tr.visIndex] != tr.visCounts[tr.visIndex] )
+		{
+			continue;
+		}
+
+		if( !addVisBounds )
+		{
+			return qtrue;
+		}
+
+		AddPointToBounds( ( *leaf )->mins, tr.viewParms.visBounds[0], tr.viewParms.visBounds[1] );
+		AddPointToBounds( ( *leaf )->maxs, tr.viewParms.visBounds[0], tr.viewParms.visBounds[1] );
+		visible = qtrue;
+	}
+	return visible;
+}
+
+/*
+================
+R_WorldBVHNode
+
+Walks the world BVH instead of the BSP nodes, the BSP leafs are only used
+for the PVS test of the surfaces.  The worldbench collects the surfaces
+instead of adding them.
+================
+*/
+static void R_WorldBVHNode( int decalBits, worldBench_t* bench, qboolean simd )
+{
+	const bspBVH_t*		  bvh = &tr.world->bvh;
+	const bspBVHNode_t*	  node;
+	const bspBVHLeaf_t*	  leaf;
+	const bspBVHSurface_t* surf;
+	bvhStackEntry_t		  stack[BVH_STACK_SIZE];
+	int					  numStack, visible, childPlaneBits[BVH_WIDTH], childDecalBits;
+	int					  i, j, child;
+	vec3_t				  mins, maxs;
+
+	stack[0].node	   = 0;
+	stack[0].planeBits = r_nocull->integer ? 0 : FRUSTUM_CLIPALL;
+	stack[0].auxBits   = decalBits;
+	numStack		   = 1;
+
+	while( numStack )
+	{
+		numStack--;
+		node	  = &bvh->nodes[stack[numStack].node];
+		visible	  = R_CullBVHChildren( node, tr.viewParms.frustums[0], stack[numStack].planeBits, childPlaneBits, simd );
+		decalBits = stack[numStack].auxBits;
+
+		for( j = 0; j < BVH_WIDTH; j++ )
+		{
+			if( !( visible & ( 1 << j ) ) )
+			{
+				continue;
+			}
+			child = node->children[j];
+
+			// ydnar: cull decals
+			childDecalBits = decalBits;
+			if( decalBits )
+			{
+				VectorSet( mins, node->bounds[0][j], node->bounds[1][j], node->bounds[2][j] );
+				VectorSet( maxs, node->bounds[3][j], node->bounds[4][j], node->bounds[5][j] );
+
+				for( i = 0; i < tr.refdef.numDecalProjectors; i++ )
+				{
+					if( decalBits & ( 1 << i ) )
+					{
+						if( tr.refdef.decalProjectors[i].shader == NULL || !R_TestDecalBoundingBox( &tr.refdef.decalProjectors[i], mins, maxs ) )
+						{
+							childDecalBits &= ~( 1 << i );
+						}
+					}
+				}
+			}
+
+			if( child >= 0 )
+			{
+				stack[numStack].node	  = child;
+				stack[numStack].planeBits = childPlaneBits[j];
+				stack[numStack].auxBits	  = childDecalBits;
+				numStack++;
+				continue;
+			}
+
+			leaf = &bvh->leafs[BVH_LEAF_CHILD( child )];
+			if( !bench )
+			{
+				tr.pc.c_bvhLeafs++;
+			}
+
+			for( i = 0, surf = bvh->surfaces + leaf->firstSurface; i < leaf->numSurfaces; i++, surf++ )
+			{
+				if( !R_BVHSurfaceInPVS( surf, ( qboolean )( bench == NULL ) ) )
+				{
+					continue;
+				}
+
+				if( bench )
+				{
+					bench->surfaces[1][bench->numSurfaces[1]++] = surf->surface;
+					continue;
+				}
+
+				R_AddWorldSurface( surf->surface, childDecalBits );
+			}
+		}
+	}
+}
+
+/*
+================
+R_WorldBVHInteractionNode
+
+Same as R_RecursiveInteractionNode, but walks the world BVH
+================
+*/
+static void R_WorldBVHInteractionNode( trRefLight_t* light, interactionJob_t* job, qboolean simd )
+{
+	const bspBVH_t*		  bvh = &tr.world->bvh;
+	const bspBVHNode_t*	  node;
+	const bspBVHLeaf_t*	  leaf;
+	const bspBVHSurface_t* surf;
+	bvhStackEntry_t		  stack[BVH_STACK_SIZE];
+	int					  numStack, visible, childPlaneBits[BVH_WIDTH], childLightBits[BVH_WIDTH];
+	int					  i, j, child;
+
+	stack[0].node = 0;
+
+	// Tr3B - even surfaces that belong to nodes that are outside of the view frustum
+	// can cast shadows into the view frustum
+	stack[0].planeBits = ( !r_nocull->integer && r_shadows->integer <= SHADOWING_BLOB ) ? FRUSTUM_CLIPALL : 0;
+
+	// the light frustum is tested for every surface as well, this only skips them early
+	stack[0].auxBits = ( !r_nocull->integer && !r_noLightFrustums->integer ) ? 63 : 0;
+	numStack		 = 1;
+
+	while( numStack )
+	{
+		numStack--;
+		node	= &bvh->nodes[stack[numStack].node];
+		visible = R_OverlapBVHChildren( node, light->worldBounds, simd );
+		visible &= R_CullBVHChildren( node, tr.viewParms.frustums[0], stack[numStack].planeBits, childPlaneBits, simd );
+		visible &= R_CullBVHChildren( node, light->frustum, stack[numStack].auxBits, childLightBits, simd );
+
+		for( j = 0; j < BVH_WIDTH; j++ )
+		{
+			if( !( visible & ( 1 << j ) ) )
+			{
+				continue;
+			}
+			child = node->children[j];
+
+			if( child >= 0 )
+			{
+				stack[numStack].node	  = child;
+				stack[numStack].planeBits = childPlaneBits[j];
+				stack[numStack].auxBits	  = childLightBits[j];
+				numStack++;
+				continue;
+			}
+
+			leaf = &bvh->leafs[BVH_LEAF_CHILD( child )];
+			for( i = 0, surf = bvh->surfaces + leaf->firstSurface; i < leaf->numSurfaces; i++, surf++ )
+			{
+				if( R_BVHSurfaceInPVS( surf, qfalse ) )
+				{
+					R_AddInteractionSurface( surf->surface, light, job );
+				}
+			}
+		}
+	}
+}
+
+/*
+===============================================================================
+
+WORLD BVH BENCHMARK
+
+"worldbench [views] [passes]" compares the BSP walk and the world BVH walk on
+the next views of the world.  Both only collect the surfaces that pass the
+PVS and frustum tests, every view is walked passes times with each of them
+while it is being rendered, so they see exactly the same PVS.
+
+===============================================================================
+*/
+
+/*
+================
+R_FreeWorldBench
+================
+*/
+void R_FreeWorldBench()
+{
+	if( worldBench )
+	{
+		ri.Free( worldBench->marks );
+		ri.Free( worldBench->surfaces[0] );
+		ri.Free( worldBench->surfaces[1] );
+		ri.Free( worldBench );
+		worldBench = NULL;
+	}
+}
+
+/*
+================
+R_WorldBenchNode_r
+
+R_RecursiveWorldNode without adding anything
+================
+*/
+static void R_WorldBenchNode_r( bspNode_t* node, int planeBits, worldBench_t* bench )
+{
+	bspSurface_t* surf;
+	int			  i, r;
+
+	do
+	{
+		if( node->visCounts[tr.visIndex] != tr.visCounts[tr.visIndex] )
+		{
+			return;
+		}
+
+		if( node->contents != -1 && !node->numMarkSurfaces )
+		{
+			return;
+		}
+
+		if( !r_nocull->integer )
+		{
+			for( i = 0; i < FRUSTUM_PLANES; i++ )
+			{
+				if( planeBits & ( 1 << i ) )
+				{
+					r = BoxOnPlaneSide( node->mins, node->maxs, &tr.viewParms.frustums[0][i] );
+					if( r == 2 )
+					{
+						return;
+					}
+					if( r == 1 )
+					{
+						planeBits &= ~( 1 << i );
+					}
+				}
+			}
+		}
+
+		if( node->contents != -1 )
+		{
+			break;
+		}
+
+		R_WorldBenchNode_r( node->children[0], planeBits, bench );
+		node = node->children[1];
+	} while( 1 );
+
+	for( i = 0; i < node->numMarkSurfaces; i++ )
+	{
+		surf = node->markSurfaces[i];
+		if( bench->marks[surf - tr.world->surfaces] != bench->stamp )
+		{
+			bench->marks[surf - tr.world->surfaces]		= bench->stamp;
+			bench->surfaces[0][bench->numSurfaces[0]++] = surf;
+		}
+	}
+}
+
+/*
+================
+R_WorldBenchView
+
+Called for every world view while the benchmark is running
+================
+*/
+static void R_WorldBenchView()
+{
+	worldBench_t* bench = worldBench;
+	int64_t		  start;
+	int			  i, j, onlyBVH;
+
+	if( !tr.world || tr.world->numSurfaces != bench->worldSurfaces || Q_stricmp( tr.world->name, bench->worldName ) )
+	{
+		ri.Printf( PRINT_ALL, "worldbench: the map changed, aborted\n" );
+		R_FreeWorldBench();
+		return;
+	}
+
+	for( i = 0; i < bench->passes; i++ )
+	{
+		start = Sys_Microseconds();
+		bench->stamp++;
+		bench->numSurfaces[0] = 0;
+		R_WorldBenchNode_r( tr.world->nodes, FRUSTUM_CLIPALL, bench );
+		bench->times[0] += Sys_Microseconds() - start;
+
+		for( j = 0; j < 2; j++ )
+		{
+			start				  = Sys_Microseconds();
+			bench->numSurfaces[1] = 0;
+			R_WorldBVHNode( 0, bench, ( qboolean )j );
+			bench->times[1 + j] += Sys_Microseconds() - start;
+		}
+	}
+
+	// the BSP walk culls whole leafs, the BVH the bounds of every surface
+	bench->totalSurfaces[0] += bench->numSurfaces[0];
+	bench->totalSurfaces[1] += bench->numSurfaces[1];
+	for( i = 0, onlyBVH = 0; i < bench->numSurfaces[1]; i++ )
+	{
+		if( bench->marks[bench->surfaces[1][i] - tr.world->surfaces] != bench->stamp )
+		{
+			onlyBVH++;
+		}
+	}
+	bench->onlyBVH += onlyBVH;
+	bench->onlyBSP += bench->numSurfaces[0] - ( bench->numSurfaces[1] - onlyBVH );
+
+	if( ++bench->numViews < bench->maxViews )
+	{
+		return;
+	}
+
+	ri.Printf( PRINT_ALL, "worldbench: %i views, %i passes, %i BVH nodes for %i surfaces\n", bench->numViews, bench->passes, tr.world->bvh.numNodes,
+		tr.world->bvh.numSurfaces );
+	ri.Printf( PRINT_ALL, "BSP walk:     %8.2f usec/view, %8.1f surfaces/view\n", ( double )bench->times[0] / ( bench->numViews * bench->passes ),
+		( double )bench->totalSurfaces[0] / bench->numViews );
+	ri.Printf( PRINT_ALL, "BVH walk C:   %8.2f usec/view, %8.1f surfaces/view\n", ( double )bench->times[1] / ( bench->numViews * bench->passes ),
+		( double )bench->totalSurfaces[1] / bench->numViews );
+#if BVH_SIMD
+	ri.Printf( PRINT_ALL, "BVH walk SSE: %8.2f usec/view\n", ( double )bench->times[2] / ( bench->numViews * bench->passes ) );
+#endif
+	ri.Printf( PRINT_ALL, "%i surfaces were only found by the BSP walk, %i only by the BVH walk\n", bench->onlyBSP, bench->onlyBVH );
+
+	R_FreeWorldBench();
+}
+
+/*
+================
+R_WorldBench_f
+
+worldbench [views] [passes]
+================
+*/
+void R_WorldBench_f()
+{
+	worldBench_t* bench;
+
+	if( !tr.world || !tr.world->bvh.numNodes )
+	{
+		ri.Printf( PRINT_ALL, "worldbench: no world loaded\n" );
+		return;
+	}
+
+	R_FreeWorldBench();
+
+	bench = worldBench = ( worldBench_t* )ri.Malloc( sizeof( *bench ) );
+	Com_Memset( bench, 0, sizeof( *bench ) );
+
+	bench->maxViews = ri.Cmd_Argc() > 1 ? atoi( ri.Cmd_Argv( 1 ) ) : 100;
+	bench->passes	= ri.Cmd_Argc() > 2 ? atoi( ri.Cmd_Argv( 2 ) ) : 10;
+	bench->maxViews = MAX( bench->maxViews, 1 );
+	bench->passes	= MAX( bench->passes, 1 );
+	bench->worldSurfaces = tr.world->numSurfaces;
+	Q_strncpyz( bench->worldName, tr.world->name, sizeof( bench->worldName ) );
+
+	bench->marks	   = ( int* )ri.Malloc( tr.world->numSurfaces * sizeof( int ) );
+	bench->surfaces[0] = ( bspSurface_t** )ri.Malloc( tr.world->numSurfaces * sizeof( bspSurface_t* ) );
+	bench->surfaces[1] = ( bspSurface_t** )ri.Malloc( tr.world->numSurfaces * sizeof( bspSurface_t* ) );
+	Com_Memset( bench->marks, 0, tr.world->numSurfaces * sizeof( int ) );
+
+	ri.Printf( PRINT_ALL, "worldbench: walking the next %i views %i times\n", bench->maxViews, bench->passes );
+}
+
 /*
 ===============
 R_PointInLeaf
@@ -2384,7 +2997,19 @@ void R_AddWorldSurfaces()
 			ClearLink( &tr.occlusionQueryList );
 
 			// update visbounds and add surfaces that weren't cached with VBOs
-			R_RecursiveWorldNode( tr.world->nodes, FRUSTUM_CLIPALL, tr.refdef.decalBits );
+			if( r_worldBVH->integer && tr.world->bvh.numNodes )
+			{
+				R_WorldBVHNode( tr.refdef.decalBits, NULL, ( qboolean )( r_simd->integer != 0 ) );
+			}
+			else
+			{
+				R_RecursiveWorldNode( tr.world->nodes, FRUSTUM_CLIPALL, tr.refdef.decalBits );
+			}
+
+			if( worldBench )
+			{
+				R_WorldBenchView();
+			}
 		}
 
 		// ydnar: add decal surfaces
@@ -2431,6 +3056,8 @@ R_AddWorldInteractions
 */
 void R_AddWorldInteractions( trRefLight_t* light )
 {
+	interactionJob_t* job;
+
 	if( !r_drawworld->integer )
 	{
 		return;
@@ -2441,11 +3068,22 @@ void R_AddWorldInteractions( trRefLight_t* light )
 		return;
 	}
 
-	tr.currentEntity = &tr.worldEntity;
-
 	// perform frustum culling and add all the potentially visible surfaces
-	tr.lightCount++;
-	R_RecursiveInteractionNode( tr.world->nodes, light, FRUSTUM_CLIPALL );
+	job = R_InteractionJob();
+	if( !job )
+	{
+		tr.currentEntity = &tr.worldEntity;
+		tr.lightCount++;
+	}
+
+	if( r_worldBVH->integer && tr.world->bvh.numNodes )
+	{
+		R_WorldBVHInteractionNode( light, job, ( qboolean )( r_simd->integer != 0 ) );
+	}
+	else
+	{
+		R_RecursiveInteractionNode( tr.world->nodes, light, FRUSTUM_CLIPALL, job );
+	}
 }
 
 /*
@@ -2473,7 +3111,11 @@ void R_AddPrecachedWorldInteractions( trRefLight_t* light )
 		return;
 	}
 
-	tr.currentEntity = &tr.worldEntity;
+	// jobs expect it to be set already
+	if( !R_InteractionJob() )
+	{
+		tr.currentEntity = &tr.worldEntity;
+	}
 
 	if( ( r_vboShadows->integer || r_vboLighting->integer ) ) // && light->l.rlType != RL_DIRECTIONAL)
 	{
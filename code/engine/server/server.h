@@ -59,7 +59,6 @@ typedef struct svEntity_s
 	int					  clusternums[MAX_ENT_CLUSTERS];
 	int					  lastCluster; // if all the clusters don't fit in clusternums
 	int					  areanum, areanum2;
-	int					  snapshotCounter; // used to prevent double adding from portal views
 } svEntity_t;
 
 typedef enum
@@ -79,7 +78,6 @@ typedef struct
 	// https://zerowing.idsoftware.com/bugzilla/show_bug.cgi?id=475
 	// the serverId associated with the current checksumFeed (always <= serverId)
 	int				 checksumFeedServerId;
-	int				 snapshotCounter; // incremented for each snapshot built
 	int				 timeResidual;	  // <= 1000 / sv_frame->value
 	int				 nextFrameTime;	  // when time > nextFrameTime, process world
 	char*			 configstrings[MAX_CONFIGSTRINGS];
@@ -99,6 +97,8 @@ typedef struct
 
 	int				 restartTime;
 	int				 time;
+
+	deltaDictionary_t deltaDictionary; // change masks offered to clients for this map
 } server_t;
 
 typedef struct
@@ -202,6 +202,8 @@ typedef struct client_s
 	int		 oldServerTime;
 	qboolean csUpdated[MAX_CONFIGSTRINGS];
 
+	qboolean useDeltaDictionary; // client asked for DELTA_ENCODING_VERSION deltas
+
 #ifdef LEGACY_PROTOCOL
 	qboolean compat;
 #endif
@@ -298,6 +300,11 @@ extern cvar_t*		  sv_gametype;
 extern cvar_t*		  sv_pure;
 extern cvar_t*		  sv_floodProtect;
 extern cvar_t*		  sv_lanForceRate;
+extern cvar_t*		  sv_parallelSnapshots;
+extern cvar_t*		  sv_visCache;
+extern cvar_t*		  sv_deltaDictionary;
+extern cvar_t*		  sv_queryThread;
+extern cvar_t*		  sv_broadphase;
 #ifndef STANDALONE
 extern cvar_t* sv_strictAuth;
 #endif
@@ -340,6 +347,10 @@ extern leakyBucket_t outboundLeakyBucket;
 qboolean			 SVC_RateLimit( leakyBucket_t* bucket, int burst, int period );
 qboolean			 SVC_RateLimitAddress( netadr_t from, int burst, int period );
 
+qboolean			 SV_IgnoreQueries();
+int					 SV_StatusPlayers( char* status, int size );
+void				 SV_InfoString( char* infostring );
+
 void				 SV_FinalMessage( char* message );
 void QDECL			 SV_SendServerCommand( client_t* cl, const char* fmt, ... ) __attribute__( ( format( printf, 2, 3 ) ) );
 
@@ -402,6 +413,7 @@ void			SV_WriteFrameToClient( client_t* client, msg_t* msg );
 void			SV_SendMessageToClient( msg_t* msg, client_t* client );
 void			SV_SendClientMessages();
 void			SV_SendClientSnapshot( client_t* client );
+void			SV_VisCacheInfo_f();
 
 //
 // sv_game.c
@@ -435,6 +447,10 @@ void			BotImport_DebugPolygonDelete( int id );
 
 void			SV_BotInitBotLib();
 
+void			SV_AASPointBench_f();
+void			SV_FreeAASBenchRecord();
+void			SV_BotMoveBench_f();
+
 //============================================================
 //
 // high level object sorting to reduce interaction tests
@@ -457,6 +473,12 @@ void			SV_LinkEntity( sharedEntity_t* ent );
 clipHandle_t	SV_ClipHandleForEntity( const sharedEntity_t* ent );
 
 void			SV_SectorList_f();
+void			SV_BroadphaseBench_f();
+
+void			SV_RecordBroadphaseFrame();
+// called at the start of each server frame while broadphasebench is recording
+
+void			SV_FreeBroadphaseRecord();
 
 int				SV_AreaEntities( const vec3_t mins, const vec3_t maxs, int* entityList, int maxcount );
 // fills in a table of entity numbers with entities that have bounding boxes
@@ -466,6 +488,9 @@ int				SV_AreaEntities( const vec3_t mins, const vec3_t maxs, int* entityList, i
 // returns the number of pointers filled in
 // The world entity is never returned in this list.
 
+void			SV_TraceBatch( trace_t* results, const traceRequest_t* requests, int count );
+// runs independent traces together, the world part of them on the worker threads
+
 int				SV_PointContents( const vec3_t p, int passEntityNum );
 // returns the CONTENTS_* value from the world and all entities at the given point.
 
@@ -483,6 +508,19 @@ void			SV_Trace( trace_t* results, const vec3_t start, vec3_t mins, vec3_t maxs,
 void			SV_ClipToEntity( trace_t* trace, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int entityNum, int contentmask, traceType_t type );
 // clip to a specific entity
 
+//
+// sv_query.c
+//
+typedef enum
+{
+	QUERY_STATUS,
+	QUERY_INFO
+} queryType_t;
+
+qboolean SV_QueueQuery( queryType_t type, netadr_t from, const char* challenge );
+void	 SV_QueryFrame();
+void	 SV_ShutdownQueryThread();
+
 //
 // sv_net_chan.c
 //
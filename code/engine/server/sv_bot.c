@@ -368,6 +368,106 @@ static void* BotImport_HunkAlloc( int size )
 	return Hunk_Alloc( size, h_high );
 }
 
+/*
+==================
+BotImport_CreateThread
+==================
+*/
+static void* BotImport_CreateThread( void ( *func )( void* arg ), void* arg )
+{
+	return Sys_CreateThread( func, arg );
+}
+
+/*
+==================
+BotImport_JoinThread
+==================
+*/
+static void BotImport_JoinThread( void* thread )
+{
+	Sys_JoinThread( ( sysThread_t* )thread );
+}
+
+/*
+==================
+BotImport_CreateSignal
+==================
+*/
+static void* BotImport_CreateSignal()
+{
+	return Sys_CreateSignal();
+}
+
+/*
+==================
+BotImport_DestroySignal
+==================
+*/
+static void BotImport_DestroySignal( void* signal )
+{
+	Sys_DestroySignal( ( sysSignal_t* )signal );
+}
+
+/*
+==================
+BotImport_RaiseSignal
+==================
+*/
+static void BotImport_RaiseSignal( void* signal )
+{
+	Sys_RaiseSignal( ( sysSignal_t* )signal );
+}
+
+/*
+==================
+BotImport_WaitSignal
+==================
+*/
+static int BotImport_WaitSignal( void* signal, int msec )
+{
+	return Sys_WaitSignal( ( sysSignal_t* )signal, msec );
+}
+
+/*
+==================
+BotImport_CreateMutex
+==================
+*/
+static void* BotImport_CreateMutex()
+{
+	return Sys_CreateMutex();
+}
+
+/*
+==================
+BotImport_DestroyMutex
+==================
+*/
+static void BotImport_DestroyMutex( void* mutex )
+{
+	Sys_DestroyMutex( ( sysMutex_t* )mutex );
+}
+
+/*
+==================
+BotImport_LockMutex
+==================
+*/
+static void BotImport_LockMutex( void* mutex )
+{
+	Sys_LockMutex( ( sysMutex_t* )mutex );
+}
+
+/*
+==================
+BotImport_UnlockMutex
+==================
+*/
+static void BotImport_UnlockMutex( void* mutex )
+{
+	Sys_UnlockMutex( ( sysMutex_t* )mutex );
+}
+
 /*
 ==================
 BotImport_DebugPolygonCreate
@@ -495,6 +595,336 @@ static void BotImport_DebugLineShow( int line, vec3_t start, vec3_t end, int col
 }
 #endif
 
+/*
+===============================================================================
+
+AAS POINT BENCHMARK
+
+"aaspointbench record <frames>" captures the origin of every bot at each
+bot frame.  "aaspointbench [passes]" then looks the recorded origins up one
+at a time with AAS_PointAreaNum and all at once with AAS_PointAreaNums,
+checks that both give the same areas, and times AAS_BBoxAreas for a player
+box at each origin.
+
+===============================================================================
+*/
+
+#ifdef BOTLIB
+#define MAX_AASBENCH_POINTS 65536
+
+typedef struct
+{
+	qboolean recording;
+	int		 maxFrames;
+	int		 numFrames;
+	int		 numPoints;
+	vec3_t	 points[MAX_AASBENCH_POINTS];
+} aasBenchRecord_t;
+
+static aasBenchRecord_t* sv_aasBenchRecord;
+#endif
+
+/*
+===============
+SV_FreeAASBenchRecord
+===============
+*/
+void SV_FreeAASBenchRecord()
+{
+#ifdef BOTLIB
+	if( sv_aasBenchRecord )
+	{
+		Z_Free( sv_aasBenchRecord );
+		sv_aasBenchRecord = NULL;
+	}
+#endif
+}
+
+#ifdef BOTLIB
+/*
+===============
+SV_RecordAASBenchFrame
+
+Called at the start of each bot frame
+===============
+*/
+static void SV_RecordAASBenchFrame()
+{
+	aasBenchRecord_t* rec = sv_aasBenchRecord;
+	client_t*		  cl;
+	int				  i;
+
+	if( !rec || !rec->recording )
+	{
+		return;
+	}
+
+	if( rec->numFrames == rec->maxFrames || rec->numPoints == MAX_AASBENCH_POINTS )
+	{
+		rec->recording = qfalse;
+		Com_Printf( "aaspointbench: recorded %i frames with %i bot origins\n", rec->numFrames, rec->numPoints );
+		return;
+	}
+
+	rec->numFrames++;
+	for( i = 0, cl = svs.clients; i < sv_maxclients->integer && rec->numPoints < MAX_AASBENCH_POINTS; i++, cl++ )
+	{
+		if( cl->state != CS_ACTIVE || cl->netchan.remoteAddress.type != NA_BOT || !cl->gentity )
+		{
+			continue;
+		}
+
+		VectorCopy( cl->gentity->r.currentOrigin, rec->points[rec->numPoints] );
+		rec->numPoints++;
+	}
+}
+#endif
+
+/*
+===============
+SV_AASPointBench_f
+===============
+*/
+void SV_AASPointBench_f()
+{
+#ifdef BOTLIB
+	static const vec3_t playerMins = { -15, -15, -24 };
+	static const vec3_t playerMaxs = { 15, 15, 32 };
+	aasBenchRecord_t*	rec;
+	int*				singleAreas;
+	int*				batchAreas;
+	int					boxAreas[32];
+	vec3_t				absmins, absmaxs;
+	int64_t				singleTime, batchTime, boxTime, start;
+	int					i, j, passes, frames, mismatches, numBoxAreas;
+
+	// make sure server is running
+	if( !com_sv_running->integer )
+	{
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	if( !botlib_export || !botlib_export->aas.AAS_Initialized() )
+	{
+		Com_Printf( "AAS not loaded.\n" );
+		return;
+	}
+
+	if( !Q_stricmp( Cmd_Argv( 1 ), "record" ) )
+	{
+		frames = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 200;
+		if( frames < 1 )
+		{
+			frames = 1;
+		}
+
+		if( !sv_aasBenchRecord )
+		{
+			sv_aasBenchRecord = Z_Malloc( sizeof( *sv_aasBenchRecord ) );
+		}
+		rec = sv_aasBenchRecord;
+
+		rec->recording = qtrue;
+		rec->maxFrames = frames;
+		rec->numFrames = 0;
+		rec->numPoints = 0;
+
+		Com_Printf( "aaspointbench: recording %i frames\n", frames );
+		return;
+	}
+
+	rec = sv_aasBenchRecord;
+	if( !rec || rec->recording || !rec->numPoints )
+	{
+		Com_Printf( "usage: aaspointbench record <frames>, then aaspointbench [passes]\n" );
+		return;
+	}
+
+	passes = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 10;
+	if( passes < 1 )
+	{
+		passes = 1;
+	}
+
+	singleAreas = Z_Malloc( rec->numPoints * sizeof( int ) );
+	batchAreas	= Z_Malloc( rec->numPoints * sizeof( int ) );
+
+	singleTime = batchTime = boxTime = 0;
+	numBoxAreas						 = 0;
+	for( i = 0; i < passes; i++ )
+	{
+		start = Sys_Microseconds();
+		for( j = 0; j < rec->numPoints; j++ )
+		{
+			singleAreas[j] = botlib_export->aas.AAS_PointAreaNum( rec->points[j] );
+		}
+		singleTime += Sys_Microseconds() - start;
+
+		start = Sys_Microseconds();
+		botlib_export->aas.AAS_PointAreaNums( rec->points, batchAreas, rec->numPoints );
+		batchTime += Sys_Microseconds() - start;
+
+		start = Sys_Microseconds();
+		for( j = 0; j < rec->numPoints; j++ )
+		{
+			VectorAdd( rec->points[j], playerMins, absmins );
+			VectorAdd( rec->points[j], playerMaxs, absmaxs );
+			numBoxAreas += botlib_export->aas.AAS_BBoxAreas( absmins, absmaxs, boxAreas, ARRAY_LEN( boxAreas ) );
+		}
+		boxTime += Sys_Microseconds() - start;
+	}
+
+	mismatches = 0;
+	for( i = 0; i < rec->numPoints; i++ )
+	{
+		if( singleAreas[i] != batchAreas[i] )
+		{
+			mismatches++;
+		}
+	}
+
+	Z_Free( singleAreas );
+	Z_Free( batchAreas );
+
+	Com_Printf( "%i frames, %i points per pass, %i passes, %.2f areas per box\n", rec->numFrames, rec->numPoints, passes, numBoxAreas / ( float )( rec->numPoints * passes ) );
+	Com_Printf( "AAS_PointAreaNum:  %8.3f msec %8.2f M lookups/sec\n", singleTime / ( passes * 1000.0 ), rec->numPoints * passes / ( singleTime > 0 ? ( double )singleTime : 1.0 ) );
+	Com_Printf( "AAS_PointAreaNums: %8.3f msec %8.2f M lookups/sec\n", batchTime / ( passes * 1000.0 ), rec->numPoints * passes / ( batchTime > 0 ? ( double )batchTime : 1.0 ) );
+	Com_Printf( "AAS_BBoxAreas:     %8.3f msec %8.2f M lookups/sec\n", boxTime / ( passes * 1000.0 ), rec->numPoints * passes / ( boxTime > 0 ? ( double )boxTime : 1.0 ) );
+	if( mismatches )
+	{
+		Com_Printf( S_COLOR_YELLOW "WARNING: %i of %i points got a different area\n", mismatches, rec->numPoints );
+	}
+	else
+	{
+		Com_Printf( "all points got the same area\n" );
+	}
+#else
+	Com_Printf( "Built without BOTLIB.\n" );
+#endif
+}
+
+/*
+===============================================================================
+
+BOT MOVEMENT BENCHMARK
+
+"botmovebench [frames]" lets the bots play the given number of frames with
+the botlib movement prediction cache switched off, then the same number of
+frames with it switched on, and compares the time spent in the bot AI
+frames.  Meant for a dedicated server running only bots, the two halves
+play different parts of the match so the longer the better.
+
+===============================================================================
+*/
+
+#ifdef BOTLIB
+typedef struct
+{
+	int		phase; // 0 idle, 1 uncached, 2 cached
+	int		frames;
+	int		frame;
+	int64_t time[2];
+	int		calls[2];
+	int		hits[2];
+	char	predictcache[16]; // value to restore when done
+} botMoveBench_t;
+
+static botMoveBench_t sv_botMoveBench;
+
+/*
+===============
+SV_BotMoveBenchFrame
+
+Called after each bot frame while the benchmark runs
+===============
+*/
+static void SV_BotMoveBenchFrame( int64_t usec )
+{
+	botMoveBench_t* bench = &sv_botMoveBench;
+	int				i;
+
+	i = bench->phase - 1;
+	bench->time[i] += usec;
+	if( ++bench->frame < bench->frames )
+	{
+		return;
+	}
+
+	botlib_export->aas.AAS_PredictionCacheStats( &bench->calls[i], &bench->hits[i], qtrue );
+
+	if( bench->phase == 1 )
+	{
+		botlib_export->BotLibVarSet( "predictcache", "1" );
+		bench->phase = 2;
+		bench->frame = 0;
+		return;
+	}
+	bench->phase = 0;
+	botlib_export->BotLibVarSet( "predictcache", bench->predictcache );
+
+	Com_Printf( "%i bot frames each\n", bench->frames );
+	for( i = 0; i < 2; i++ )
+	{
+		Com_Printf( "%s: %8.3f msec per frame, %7.1f predictions per frame, %5.1f%% cached\n", i ? "cache on " : "cache off", bench->time[i] / ( bench->frames * 1000.0 ),
+			bench->calls[i] / ( float )bench->frames, bench->calls[i] ? bench->hits[i] * 100.0f / bench->calls[i] : 0.0f );
+	}
+	if( bench->time[1] > 0 )
+	{
+		Com_Printf( "speedup %.2fx\n", bench->time[0] / ( double )bench->time[1] );
+	}
+}
+#endif
+
+/*
+===============
+SV_BotMoveBench_f
+===============
+*/
+void SV_BotMoveBench_f()
+{
+#ifdef BOTLIB
+	botMoveBench_t* bench = &sv_botMoveBench;
+	int				calls, hits;
+
+	// make sure server is running
+	if( !com_sv_running->integer )
+	{
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	if( !bot_enable || !botlib_export || !botlib_export->aas.AAS_Initialized() )
+	{
+		Com_Printf( "AAS not loaded.\n" );
+		return;
+	}
+
+	if( bench->phase )
+	{
+		Com_Printf( "botmovebench: already running\n" );
+		return;
+	}
+
+	Com_Memset( bench, 0, sizeof( *bench ) );
+	bench->frames = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 1000;
+	if( bench->frames < 1 )
+	{
+		bench->frames = 1;
+	}
+
+	// the libvar is read at the start of the next bot frame
+	botlib_export->BotLibVarGet( "predictcache", bench->predictcache, sizeof( bench->predictcache ) );
+	botlib_export->BotLibVarSet( "predictcache", "0" );
+	botlib_export->aas.AAS_PredictionCacheStats( &calls, &hits, qtrue );
+	bench->phase = 1;
+
+	Com_Printf( "botmovebench: running %i bot frames without and %i with the prediction cache\n", bench->frames, bench->frames );
+#else
+	Com_Printf( "Built without BOTLIB.\n" );
+#endif
+}
+
 /*
 ==================
 SV_BotFrame
@@ -503,6 +933,8 @@ SV_BotFrame
 void SV_BotFrame( int time )
 {
 #ifdef BOTLIB
+	int64_t start;
+
 	if( !bot_enable )
 	{
 		return;
@@ -512,7 +944,18 @@ void SV_BotFrame( int time )
 	{
 		return;
 	}
+	SV_RecordAASBenchFrame();
+
+	start = sv_botMoveBench.phase ? Sys_Microseconds() : 0;
+
+	PROF_BEGIN( "BotAIStartFrame" );
 	VM_Call( gvm, BOTAI_START_FRAME, time );
+	PROF_END();
+
+	if( sv_botMoveBench.phase )
+	{
+		SV_BotMoveBenchFrame( Sys_Microseconds() - start );
+	}
 #endif
 }
 
@@ -644,6 +1087,22 @@ void SV_BotInitBotLib()
 	botlib_import.FS_Write		= FS_Write;
 	botlib_import.FS_FCloseFile = FS_FCloseFile;
 	botlib_import.FS_Seek		= FS_Seek;
+	botlib_import.FS_MapFile	= FS_MapFile;
+	botlib_import.FS_UnmapFile	= FS_UnmapFile;
+
+	// job threads
+	botlib_import.RunJobs		= Sys_RunJobs;
+	botlib_import.CreateThread	= BotImport_CreateThread;
+	botlib_import.JoinThread	= BotImport_JoinThread;
+	botlib_import.CreateSignal	= BotImport_CreateSignal;
+	botlib_import.DestroySignal = BotImport_DestroySignal;
+	botlib_import.RaiseSignal	= BotImport_RaiseSignal;
+	botlib_import.WaitSignal	= BotImport_WaitSignal;
+	botlib_import.CreateMutex	= BotImport_CreateMutex;
+	botlib_import.DestroyMutex	= BotImport_DestroyMutex;
+	botlib_import.LockMutex		= BotImport_LockMutex;
+	botlib_import.UnlockMutex	= BotImport_UnlockMutex;
+	botlib_import.MemoryBarrier = Sys_MemoryBarrier;
 
 	// debug lines
 	botlib_import.DebugLineCreate = BotImport_DebugLineCreate;
@@ -1722,6 +1722,10 @@ void SV_AddOperatorCommands()
 	Cmd_AddCommand( "dumpuser", SV_DumpUser_f );
 	Cmd_AddCommand( "map_restart", SV_MapRestart_f );
 	Cmd_AddCommand( "sectorlist", SV_SectorList_f );
+	Cmd_AddCommand( "broadphasebench", SV_BroadphaseBench_f );
+	Cmd_AddCommand( "aaspointbench", SV_AASPointBench_f );
+	Cmd_AddCommand( "botmovebench", SV_BotMoveBench_f );
+	Cmd_AddCommand( "viscacheinfo", SV_VisCacheInfo_f );
 	Cmd_AddCommand( "map", SV_Map_f );
 	Cmd_SetCommandCompletionFunc( "map", SV_CompleteMapName );
 #ifndef PRE_RELEASE_DEMO
@@ -1773,6 +1777,9 @@ void SV_RemoveOperatorCommands()
 	Cmd_RemoveCommand( "dumpuser" );
 	Cmd_RemoveCommand( "map_restart" );
 	Cmd_RemoveCommand( "sectorlist" );
+	Cmd_RemoveCommand( "broadphasebench" );
+	Cmd_RemoveCommand( "aaspointbench" );
+	Cmd_RemoveCommand( "botmovebench" );
 	Cmd_RemoveCommand( "say" );
 #endif
 }
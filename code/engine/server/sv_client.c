@@ -611,6 +611,19 @@ gotnewcl:
 #else
 	Netchan_Setup( NS_SERVER, &newcl->netchan, from, qport, challenge, qfalse );
 #endif
+
+	// older clients don't send the key and keep one change bit per field
+	newcl->useDeltaDictionary = qfalse;
+	if( sv_deltaDictionary->integer && atoi( Info_ValueForKey( userinfo, "deltaEncoding" ) ) == DELTA_ENCODING_VERSION )
+	{
+		newcl->useDeltaDictionary = qtrue;
+	}
+#ifdef LEGACY_PROTOCOL
+	if( compat )
+	{
+		newcl->useDeltaDictionary = qfalse;
+	}
+#endif
 	// init the netchan queue
 	newcl->netchan_end_queue = &newcl->netchan_start_queue;
 
@@ -817,6 +830,14 @@ static void SV_SendClientGameState( client_t* client )
 	MSG_WriteByte( &msg, svc_gamestate );
 	MSG_WriteLong( &msg, client->reliableSequence );
 
+	// everything after this, including the baselines, uses the dictionary
+	if( client->useDeltaDictionary )
+	{
+		MSG_WriteByte( &msg, svc_deltaDictionary );
+		MSG_WriteDeltaDictionary( &msg, &sv.deltaDictionary );
+		msg.deltaDictionary = &sv.deltaDictionary;
+	}
+
 	// write the configstrings
 	for( start = 0; start < MAX_CONFIGSTRINGS; start++ )
 	{
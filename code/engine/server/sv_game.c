@@ -305,6 +305,40 @@ void SV_GetUsercmd( int clientNum, usercmd_t* cmd )
 	*cmd = svs.clients[clientNum].lastUsercmd;
 }
 
+/*
+===============
+SV_GameTraceBatch
+
+The batch comes straight from the game module, check it before any
+thread touches it
+===============
+*/
+static void SV_GameTraceBatch( trace_t* results, const traceRequest_t* requests, int count )
+{
+	int i;
+
+	if( count < 0 || count > MAX_TRACE_BATCH )
+	{
+		Com_Error( ERR_DROP, "SV_GameTraceBatch: bad count:%i", count );
+	}
+	if( !count )
+	{
+		return;
+	}
+	if( !results || !requests )
+	{
+		Com_Error( ERR_DROP, "SV_GameTraceBatch: NULL" );
+	}
+	for( i = 0; i < count; i++ )
+	{
+		if( requests[i].type != TT_AABB && requests[i].type != TT_CAPSULE )
+		{
+			Com_Error( ERR_DROP, "SV_GameTraceBatch: bad trace type %i in request %i", requests[i].type, i );
+		}
+	}
+	SV_TraceBatch( results, requests, count );
+}
+
 //==============================================
 
 static int FloatAsInt( float f )
@@ -399,6 +433,9 @@ intptr_t SV_GameSystemCalls( intptr_t* args )
 		case G_TRACECAPSULE:
 			SV_Trace( VMA( 1 ), VMA( 2 ), VMA( 3 ), VMA( 4 ), VMA( 5 ), args[6], args[7], TT_CAPSULE );
 			return 0;
+		case G_TRACE_BATCH:
+			SV_GameTraceBatch( VMA( 1 ), VMA( 2 ), args[3] );
+			return 0;
 		case G_POINT_CONTENTS:
 			return SV_PointContents( VMA( 1 ), args[2] );
 		case G_SET_BRUSH_MODEL:
@@ -749,6 +786,9 @@ intptr_t SV_GameSystemCalls( intptr_t* args )
 			return botlib_export->ai.BotChooseLTGItem( args[1], VMA( 2 ), VMA( 3 ), args[4] );
 		case BOTLIB_AI_CHOOSE_NBG_ITEM:
 			return botlib_export->ai.BotChooseNBGItem( args[1], VMA( 2 ), VMA( 3 ), args[4], VMA( 5 ), VMF( 6 ) );
+		case BOTLIB_AI_PREPARE_GOALS:
+			botlib_export->ai.BotPrepareGoals( VMA( 1 ), args[2] );
+			return 0;
 		case BOTLIB_AI_TOUCHING_GOAL:
 			return botlib_export->ai.BotTouchingGoal( VMA( 1 ), VMA( 2 ) );
 		case BOTLIB_AI_ITEM_GOAL_IN_VIS_BUT_NOT_VISIBLE:
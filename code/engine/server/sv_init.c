@@ -531,6 +531,9 @@ void SV_SpawnServer( char* server, qboolean killBots )
 	// make sure we are not paused
 	Cvar_Set( "cl_paused", "0" );
 
+	// the change masks seen so far become this map's delta dictionary
+	MSG_BuildDeltaDictionary( &sv.deltaDictionary );
+
 	// get a new checksum feed and restart the file system
 	sv.checksumFeed = ( ( ( unsigned int )rand() << 16 ) ^ ( unsigned int )rand() ) ^ Com_Milliseconds();
 	FS_Restart( sv.checksumFeed );
@@ -766,6 +769,11 @@ void SV_Init()
 	sv_killserver	  = Cvar_Get( "sv_killserver", "0", 0 );
 	sv_mapChecksum	  = Cvar_Get( "sv_mapChecksum", "", CVAR_ROM );
 	sv_lanForceRate	  = Cvar_Get( "sv_lanForceRate", "1", CVAR_ARCHIVE );
+	sv_parallelSnapshots = Cvar_Get( "sv_parallelSnapshots", "0", CVAR_ARCHIVE );
+	sv_visCache			 = Cvar_Get( "sv_visCache", "1", CVAR_ARCHIVE );
+	sv_deltaDictionary	 = Cvar_Get( "sv_deltaDictionary", "1", CVAR_ARCHIVE );
+	sv_queryThread		 = Cvar_Get( "sv_queryThread", "0", CVAR_ARCHIVE );
+	sv_broadphase		 = Cvar_Get( "sv_broadphase", "0", CVAR_ARCHIVE );
 #ifndef STANDALONE
 	sv_strictAuth = Cvar_Get( "sv_strictAuth", "1", CVAR_ARCHIVE );
 #endif
@@ -843,10 +851,13 @@ void SV_Shutdown( char* finalmsg )
 
 	SV_RemoveOperatorCommands();
 	SV_MasterShutdown();
+	SV_ShutdownQueryThread();
 	SV_ShutdownGameProgs();
 
 	// free current level
 	SV_ClearServer();
+	SV_FreeBroadphaseRecord();
+	SV_FreeAASBenchRecord();
 
 	// free server static data
 	if( svs.clients )
@@ -58,6 +58,11 @@ cvar_t*		   sv_gametype;
 cvar_t*		   sv_pure;
 cvar_t*		   sv_floodProtect;
 cvar_t*		   sv_lanForceRate; // dedicated 1 (LAN) server forces local client rates to 99999 (bug #491)
+cvar_t*		   sv_parallelSnapshots; // build and delta compress client snapshots on the worker threads
+cvar_t*		   sv_visCache;			 // share the PVS entity lists of clients in the same cluster
+cvar_t*		   sv_deltaDictionary;	 // offer dictionary delta compression to clients that support it
+cvar_t*		   sv_queryThread;		 // answer getstatus and getinfo on a separate thread
+cvar_t*		   sv_broadphase;		 // 0 = sector tree, 1 = loose grid for entity area queries
 #ifndef STANDALONE
 cvar_t* sv_strictAuth;
 #endif
@@ -588,56 +593,36 @@ qboolean SVC_RateLimitAddress( netadr_t from, int burst, int period )
 
 /*
 ================
-SVC_Status
+SV_IgnoreQueries
 
-Responds with all the info that qplug or qspy can see about the server
-and all connected players.  Used for getting detailed information after
-the simple info query.
+Status and info queries are not answered in single player
 ================
 */
-static void SVC_Status( netadr_t from )
+qboolean SV_IgnoreQueries()
+{
+	if( Cvar_VariableValue( "g_gametype" ) == GT_SINGLE_PLAYER || Cvar_VariableValue( "ui_singlePlayerActive" ) )
+	{
+		return qtrue;
+	}
+	return qfalse;
+}
+
+/*
+================
+SV_StatusPlayers
+
+Writes one line of score, ping and name for each connected client,
+returns the length of the list
+================
+*/
+int SV_StatusPlayers( char* status, int size )
 {
 	char		   player[1024];
-	char		   status[MAX_MSGLEN];
 	int			   i;
 	client_t*	   cl;
 	playerState_t* ps;
 	int			   statusLength;
 	int			   playerLength;
-	char		   infostring[MAX_INFO_STRING];
-
-	// ignore if we are in single player
-	if( Cvar_VariableValue( "g_gametype" ) == GT_SINGLE_PLAYER || Cvar_VariableValue( "ui_singlePlayerActive" ) )
-	{
-		return;
-	}
-
-	// Prevent using getstatus as an amplifier
-	if( SVC_RateLimitAddress( from, 10, 1000 ) )
-	{
-		Com_DPrintf( "SVC_Status: rate limit from %s exceeded, dropping request\n", NET_AdrToString( from ) );
-		return;
-	}
-
-	// Allow getstatus to be DoSed relatively easily, but prevent
-	// excess outbound bandwidth usage when being flooded inbound
-	if( SVC_RateLimit( &outboundLeakyBucket, 10, 100 ) )
-	{
-		Com_DPrintf( "SVC_Status: rate limit exceeded, dropping request\n" );
-		return;
-	}
-
-	// A maximum challenge length of 128 should be more than plenty.
-	if( strlen( Cmd_Argv( 1 ) ) > 128 )
-	{
-		return;
-	}
-
-	strcpy( infostring, Cvar_InfoString( CVAR_SERVERINFO ) );
-
-	// echo back the parameter to status. so master servers can use it as a challenge
-	// to prevent timed spoofed reply packets that add ghost servers
-	Info_SetValueForKey( infostring, "challenge", Cmd_Argv( 1 ) );
 
 	status[0]	 = 0;
 	statusLength = 0;
@@ -650,7 +635,7 @@ static void SVC_Status( netadr_t from )
 			ps = SV_GameClientNum( i );
 			Com_sprintf( player, sizeof( player ), "%i %i \"%s\"\n", ps->persistant[PERS_SCORE], cl->ping, cl->name );
 			playerLength = strlen( player );
-			if( statusLength + playerLength >= sizeof( status ) )
+			if( statusLength + playerLength >= size )
 			{
 				break; // can't hold any more
 			}
@@ -659,54 +644,20 @@ static void SVC_Status( netadr_t from )
 		}
 	}
 
-	NET_OutOfBandPrint( NS_SERVER, from, "statusResponse\n%s\n%s", infostring, status );
+	return statusLength;
 }
 
 /*
 ================
-SVC_Info
+SV_InfoString
 
-Responds with a short info message that should be enough to determine
-if a user is interested in a server to do a full status
+Adds the keys of an infoResponse to infostring
 ================
 */
-void SVC_Info( netadr_t from )
+void SV_InfoString( char* infostring )
 {
 	int	  i, count, humans;
 	char* gamedir;
-	char  infostring[MAX_INFO_STRING];
-
-	// ignore if we are in single player
-	if( Cvar_VariableValue( "g_gametype" ) == GT_SINGLE_PLAYER || Cvar_VariableValue( "ui_singlePlayerActive" ) )
-	{
-		return;
-	}
-
-	// Prevent using getinfo as an amplifier
-	if( SVC_RateLimitAddress( from, 10, 1000 ) )
-	{
-		Com_DPrintf( "SVC_Info: rate limit from %s exceeded, dropping request\n", NET_AdrToString( from ) );
-		return;
-	}
-
-	// Allow getinfo to be DoSed relatively easily, but prevent
-	// excess outbound bandwidth usage when being flooded inbound
-	if( SVC_RateLimit( &outboundLeakyBucket, 10, 100 ) )
-	{
-		Com_DPrintf( "SVC_Info: rate limit exceeded, dropping request\n" );
-		return;
-	}
-
-	/*
-	 * Check whether Cmd_Argv(1) has a sane length. This was not done in the original Quake3 version which led
-	 * to the Infostring bug discovered by Luigi Auriemma. See http://aluigi.altervista.org/ for the advisory.
-	 */
-
-	// A maximum challenge length of 128 should be more than plenty.
-	if( strlen( Cmd_Argv( 1 ) ) > 128 )
-	{
-		return;
-	}
 
 	// don't count privateclients
 	count = humans = 0;
@@ -722,12 +673,6 @@ void SVC_Info( netadr_t from )
 		}
 	}
 
-	infostring[0] = 0;
-
-	// echo back the parameter to status. so servers can use it as a challenge
-	// to prevent timed spoofed reply packets that add ghost servers
-	Info_SetValueForKey( infostring, "challenge", Cmd_Argv( 1 ) );
-
 	Info_SetValueForKey( infostring, "gamename", com_gamename->string );
 
 #ifdef LEGACY_PROTOCOL
@@ -768,6 +713,111 @@ void SVC_Info( netadr_t from )
 	{
 		Info_SetValueForKey( infostring, "game", gamedir );
 	}
+}
+
+/*
+================
+SVC_Status
+
+Responds with all the info that qplug or qspy can see about the server
+and all connected players.  Used for getting detailed information after
+the simple info query.
+================
+*/
+static void SVC_Status( netadr_t from )
+{
+	char status[MAX_MSGLEN];
+	char infostring[MAX_INFO_STRING];
+
+	// ignore if we are in single player
+	if( SV_IgnoreQueries() )
+	{
+		return;
+	}
+
+	// Prevent using getstatus as an amplifier
+	if( SVC_RateLimitAddress( from, 10, 1000 ) )
+	{
+		Com_DPrintf( "SVC_Status: rate limit from %s exceeded, dropping request\n", NET_AdrToString( from ) );
+		return;
+	}
+
+	// Allow getstatus to be DoSed relatively easily, but prevent
+	// excess outbound bandwidth usage when being flooded inbound
+	if( SVC_RateLimit( &outboundLeakyBucket, 10, 100 ) )
+	{
+		Com_DPrintf( "SVC_Status: rate limit exceeded, dropping request\n" );
+		return;
+	}
+
+	// A maximum challenge length of 128 should be more than plenty.
+	if( strlen( Cmd_Argv( 1 ) ) > 128 )
+	{
+		return;
+	}
+
+	strcpy( infostring, Cvar_InfoString( CVAR_SERVERINFO ) );
+
+	// echo back the parameter to status. so master servers can use it as a challenge
+	// to prevent timed spoofed reply packets that add ghost servers
+	Info_SetValueForKey( infostring, "challenge", Cmd_Argv( 1 ) );
+
+	SV_StatusPlayers( status, sizeof( status ) );
+
+	NET_OutOfBandPrint( NS_SERVER, from, "statusResponse\n%s\n%s", infostring, status );
+}
+
+/*
+================
+SVC_Info
+
+Responds with a short info message that should be enough to determine
+if a user is interested in a server to do a full status
+================
+*/
+void SVC_Info( netadr_t from )
+{
+	char infostring[MAX_INFO_STRING];
+
+	// ignore if we are in single player
+	if( SV_IgnoreQueries() )
+	{
+		return;
+	}
+
+	// Prevent using getinfo as an amplifier
+	if( SVC_RateLimitAddress( from, 10, 1000 ) )
+	{
+		Com_DPrintf( "SVC_Info: rate limit from %s exceeded, dropping request\n", NET_AdrToString( from ) );
+		return;
+	}
+
+	// Allow getinfo to be DoSed relatively easily, but prevent
+	// excess outbound bandwidth usage when being flooded inbound
+	if( SVC_RateLimit( &outboundLeakyBucket, 10, 100 ) )
+	{
+		Com_DPrintf( "SVC_Info: rate limit exceeded, dropping request\n" );
+		return;
+	}
+
+	/*
+	 * Check whether Cmd_Argv(1) has a sane length. This was not done in the original Quake3 version which led
+	 * to the Infostring bug discovered by Luigi Auriemma. See http://aluigi.altervista.org/ for the advisory.
+	 */
+
+	// A maximum challenge length of 128 should be more than plenty.
+	if( strlen( Cmd_Argv( 1 ) ) > 128 )
+	{
+		return;
+	}
+
+	infostring[0] = 0;
+
+	// echo back the parameter to status. so servers can use it as a challenge
+	// to prevent timed spoofed reply packets that add ghost servers
+	Info_SetValueForKey( infostring, "challenge", Cmd_Argv( 1 ) );
+
+	SV_InfoString( infostring );
 
 	NET_OutOfBandPrint( NS_SERVER, from, "infoResponse\n%s", infostring );
 }
@@ -903,11 +953,17 @@ static void SV_ConnectionlessPacket( netadr_t from, msg_t* msg )
 
 	if( !Q_stricmp( c, "getstatus" ) )
 	{
-		SVC_Status( from );
+		if( !SV_QueueQuery( QUERY_STATUS, from, Cmd_Argv( 1 ) ) )
+		{
+			SVC_Status( from );
+		}
 	}
 	else if( !Q_stricmp( c, "getinfo" ) )
 	{
-		SVC_Info( from );
+		if( !SV_QueueQuery( QUERY_INFO, from, Cmd_Argv( 1 ) ) )
+		{
+			SVC_Info( from );
+		}
 	}
 	else if( !Q_stricmp( c, "getchallenge" ) )
 	{
@@ -1313,6 +1369,8 @@ void SV_Frame( int msec )
 		SV_BotFrame( sv.time );
 	}
 
+	SV_RecordBroadphaseFrame();
+
 	// run the game simulation in chunks
 	while( sv.timeResidual >= frameMsec )
 	{
@@ -1321,7 +1379,9 @@ void SV_Frame( int msec )
 		sv.time += frameMsec;
 
 		// let everything in the world think and move
+		PROF_BEGIN( "GAME_RUN_FRAME" );
 		VM_Call( gvm, GAME_RUN_FRAME, sv.time );
+		PROF_END();
 	}
 
 	if( com_speeds->integer )
@@ -1333,7 +1393,12 @@ void SV_Frame( int msec )
 	SV_CheckTimeouts();
 
 	// send messages back to the clients
+	PROF_BEGIN( "SV_SendClientMessages" );
 	SV_SendClientMessages();
+	PROF_END();
+
+	// hand the current status to the query responder
+	SV_QueryFrame();
 
 	// send a heartbeat to the master if needed
 	SV_MasterHeartbeat( HEARTBEAT_FOR_MASTER );
@@ -0,0 +1,504 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// sv_query.c -- answers getstatus and getinfo off the main thread
+
+#include "server.h"
+
+/*
+=============================================================================
+
+QUERY RESPONDER
+
+Server browsers and master servers poll every server with getstatus and
+getinfo.  With sv_queryThread set these are answered by a separate thread.
+
+Once a frame the main thread writes everything the replies need into the
+older of two snapshots and then publishes it.  The responder copies the
+published snapshot out and checks its sequence number afterwards, so
+neither side ever waits for the other.  Queries are handed over through a
+single producer, single consumer ring.
+
+The responder has its own rate limit buckets, and must not print, allocate
+or look at svs / sv.
+
+=============================================================================
+*/
+
+#define MAX_QUERY_REQUESTS	256 // must be a power of two
+#define MAX_QUERY_CHALLENGE 128
+#define MAX_QUERY_BUCKETS	4096 // must be a power of two
+#define QUERY_BUCKET_PROBES 8
+
+typedef struct
+{
+	queryType_t type;
+	netadr_t	from;
+	char		challenge[MAX_QUERY_CHALLENGE + 1];
+} queryRequest_t;
+
+typedef struct
+{
+	volatile int sequence; // odd while the main thread is writing it
+	qboolean	 ignore;
+	int			 serverInfoLength;
+	char		 serverInfo[MAX_INFO_STRING];
+	int			 infoLength;
+	char		 info[MAX_INFO_STRING];
+	int			 playersLength;
+	char		 players[MAX_MSGLEN];
+} querySnapshot_t;
+
+static sysThread_t*	   queryThread;
+static sysSignal_t*	   querySignal;
+static volatile int	   queryQuit;
+static qboolean		   queryUseSocks;
+
+static queryRequest_t  queryRequests[MAX_QUERY_REQUESTS];
+static volatile int	   queryHead; // written by the main thread
+static volatile int	   queryTail; // written by the responder
+
+static querySnapshot_t querySnapshots[2];
+static volatile int	   queryPublished = -1;
+
+// only touched by the responder
+static querySnapshot_t queryCurrent;
+static leakyBucket_t   queryBuckets[MAX_QUERY_BUCKETS];
+static leakyBucket_t   queryOutboundBucket;
+static char			   queryResponse[MAX_MSGLEN];
+
+/*
+================
+SV_QueryBucketForAddress
+
+Like SVC_BucketForAddress, but with a small open addressed table that
+belongs to the responder
+================
+*/
+static leakyBucket_t* SV_QueryBucketForAddress( netadr_t address, int burst, int period )
+{
+	leakyBucket_t* bucket;
+	leakyBucket_t* reuse = NULL;
+	byte*		   ip;
+	int			   size;
+	unsigned	   hash;
+	int			   i, now, interval;
+
+	if( address.type == NA_IP )
+	{
+		ip	 = address.ip;
+		size = 4;
+	}
+	else
+	{
+		ip	 = address.ip6;
+		size = 16;
+	}
+
+	hash = 2166136261u;
+	for( i = 0; i < size; i++ )
+	{
+		hash = ( hash ^ ip[i] ) * 16777619u;
+	}
+
+	now = Sys_Milliseconds();
+
+	for( i = 0; i < QUERY_BUCKET_PROBES; i++ )
+	{
+		bucket = &queryBuckets[( hash + i ) & ( MAX_QUERY_BUCKETS - 1 )];
+
+		if( bucket->type == address.type && !memcmp( bucket->ipv._6, ip, size ) )
+		{
+			return bucket;
+		}
+
+		// Reclaim expired buckets
+		interval = now - bucket->lastTime;
+		if( !reuse && ( bucket->type == NA_BAD || interval > ( burst * period ) || interval < 0 ) )
+		{
+			reuse = bucket;
+		}
+	}
+
+	if( !reuse )
+	{
+		// Couldn't allocate a bucket for this address
+		return NULL;
+	}
+
+	Com_Memset( reuse, 0, sizeof( *reuse ) );
+	reuse->type = address.type;
+	Com_Memcpy( reuse->ipv._6, ip, size );
+	reuse->lastTime = now;
+	reuse->hash		= hash;
+
+	return reuse;
+}
+
+/*
+================
+SV_ReadQuerySnapshot
+
+Copies the last published snapshot into queryCurrent
+================
+*/
+static qboolean SV_ReadQuerySnapshot()
+{
+	querySnapshot_t* snap;
+	int				 published, sequence, tries;
+
+	for( tries = 0; tries < 4; tries++ )
+	{
+		published = queryPublished;
+		if( published < 0 )
+		{
+			return qfalse;
+		}
+		snap = &querySnapshots[published];
+
+		sequence = snap->sequence;
+		Sys_MemoryBarrier();
+		if( sequence & 1 )
+		{
+			continue;
+		}
+
+		queryCurrent.ignore			  = snap->ignore;
+		queryCurrent.serverInfoLength = Com_Clamp( 0, MAX_INFO_STRING - 1, snap->serverInfoLength );
+		queryCurrent.infoLength		  = Com_Clamp( 0, MAX_INFO_STRING - 1, snap->infoLength );
+		queryCurrent.playersLength	  = Com_Clamp( 0, MAX_MSGLEN - 1, snap->playersLength );
+		Com_Memcpy( queryCurrent.serverInfo, snap->serverInfo, queryCurrent.serverInfoLength );
+		Com_Memcpy( queryCurrent.info, snap->info, queryCurrent.infoLength );
+		Com_Memcpy( queryCurrent.players, snap->players, queryCurrent.playersLength );
+
+		Sys_MemoryBarrier();
+		if( snap->sequence == sequence )
+		{
+			queryCurrent.serverInfo[queryCurrent.serverInfoLength] = 0;
+			queryCurrent.info[queryCurrent.infoLength]			   = 0;
+			queryCurrent.players[queryCurrent.playersLength]	   = 0;
+			return qtrue;
+		}
+	}
+
+	return qfalse;
+}
+
+/*
+================
+SV_QueryAppend
+
+Appends as much of text as fits, like the Q_vsnprintf in NET_OutOfBandPrint
+================
+*/
+static void SV_QueryAppend( int* length, const char* text, int textLength )
+{
+	if( textLength > MAX_MSGLEN - 1 - *length )
+	{
+		textLength = MAX_MSGLEN - 1 - *length;
+	}
+	Com_Memcpy( queryResponse + *length, text, textLength );
+	*length += textLength;
+}
+
+/*
+================
+SV_QueryChallengeFits
+
+Mirrors the checks Info_SetValueForKey makes, which prints and leaves the
+key out when they fail
+================
+*/
+static qboolean SV_QueryChallengeFits( const char* challenge, int challengeLength, int infoLength )
+{
+	if( !challengeLength || strpbrk( challenge, "\\;\"" ) )
+	{
+		return qfalse;
+	}
+	if( infoLength + challengeLength + ( int )strlen( "\\challenge\\" ) >= MAX_INFO_STRING )
+	{
+		return qfalse;
+	}
+	return qtrue;
+}
+
+/*
+================
+SV_AnswerQuery
+
+Builds the same statusResponse / infoResponse as SVC_Status and SVC_Info
+================
+*/
+static void SV_AnswerQuery( const queryRequest_t* request )
+{
+	int		 length, challengeLength;
+	qboolean challenge;
+
+	if( !SV_ReadQuerySnapshot() || queryCurrent.ignore )
+	{
+		return;
+	}
+
+	// Prevent using getstatus / getinfo as an amplifier
+	if( SVC_RateLimit( SV_QueryBucketForAddress( request->from, 10, 1000 ), 10, 1000 ) )
+	{
+		return;
+	}
+
+	// Allow queries to be DoSed relatively easily, but prevent
+	// excess outbound bandwidth usage when being flooded inbound
+	if( SVC_RateLimit( &queryOutboundBucket, 10, 100 ) )
+	{
+		return;
+	}
+
+	challengeLength = strlen( request->challenge );
+
+	length = 0;
+	SV_QueryAppend( &length, "\xff\xff\xff\xff", 4 );
+
+	if( request->type == QUERY_STATUS )
+	{
+		challenge = SV_QueryChallengeFits( request->challenge, challengeLength, queryCurrent.serverInfoLength );
+
+		// the challenge goes in front of the server info
+		SV_QueryAppend( &length, "statusResponse\n", 15 );
+		if( challenge )
+		{
+			SV_QueryAppend( &length, "\\challenge\\", 11 );
+			SV_QueryAppend( &length, request->challenge, challengeLength );
+		}
+		SV_QueryAppend( &length, queryCurrent.serverInfo, queryCurrent.serverInfoLength );
+		SV_QueryAppend( &length, "\n", 1 );
+		SV_QueryAppend( &length, queryCurrent.players, queryCurrent.playersLength );
+	}
+	else
+	{
+		challenge = SV_QueryChallengeFits( request->challenge, challengeLength, queryCurrent.infoLength );
+
+		// SVC_Info sets the challenge first, so it ends up behind the other keys
+		SV_QueryAppend( &length, "infoResponse\n", 13 );
+		SV_QueryAppend( &length, queryCurrent.info, queryCurrent.infoLength );
+		if( challenge )
+		{
+			SV_QueryAppend( &length, "\\challenge\\", 11 );
+			SV_QueryAppend( &length, request->challenge, challengeLength );
+		}
+	}
+
+	Sys_SendPacketUnbuffered( length, queryResponse, request->from );
+}
+
+/*
+================
+SV_QueryThread
+================
+*/
+static void SV_QueryThread( void* arg UNUSED_VAR )
+{
+	queryRequest_t request;
+
+	while( !queryQuit )
+	{
+		Sys_WaitSignal( querySignal, 100 );
+
+		while( queryTail != queryHead )
+		{
+			Sys_MemoryBarrier();
+			request = queryRequests[queryTail & ( MAX_QUERY_REQUESTS - 1 )];
+			Sys_MemoryBarrier();
+			queryTail++;
+
+			SV_AnswerQuery( &request );
+		}
+	}
+}
+
+/*
+================
+SV_QueueQuery
+
+Hands a getstatus or getinfo to the responder.  Returns qfalse if the
+caller should answer it itself.
+================
+*/
+qboolean SV_QueueQuery( queryType_t type, netadr_t from, const char* challenge )
+{
+	queryRequest_t* request;
+
+	if( !queryThread || queryPublished < 0 )
+	{
+		return qfalse;
+	}
+
+	// the responder can only send plain unicast packets
+	if( from.type != NA_IP6 && ( from.type != NA_IP || queryUseSocks ) )
+	{
+		return qfalse;
+	}
+
+	// A maximum challenge length of 128 should be more than plenty.
+	if( strlen( challenge ) > MAX_QUERY_CHALLENGE )
+	{
+		return qtrue;
+	}
+
+	// drop it if the responder is this far behind
+	if( queryHead - queryTail >= MAX_QUERY_REQUESTS )
+	{
+		return qtrue;
+	}
+
+	request		  = &queryRequests[queryHead & ( MAX_QUERY_REQUESTS - 1 )];
+	request->type = type;
+	request->from = from;
+	Q_strncpyz( request->challenge, challenge, sizeof( request->challenge ) );
+
+	Sys_MemoryBarrier();
+	queryHead++;
+
+	Sys_RaiseSignal( querySignal );
+	return qtrue;
+}
+
+/*
+================
+SV_PublishQuerySnapshot
+================
+*/
+static void SV_PublishQuerySnapshot()
+{
+	querySnapshot_t* snap;
+	int				 index;
+
+	index = queryPublished == 0 ? 1 : 0;
+	snap  = &querySnapshots[index];
+
+	snap->sequence++;
+	Sys_MemoryBarrier();
+
+	snap->ignore = SV_IgnoreQueries();
+
+	Q_strncpyz( snap->serverInfo, Cvar_InfoString( CVAR_SERVERINFO ), sizeof( snap->serverInfo ) );
+	Info_RemoveKey( snap->serverInfo, "challenge" );
+	snap->serverInfoLength = strlen( snap->serverInfo );
+
+	snap->info[0] = 0;
+	SV_InfoString( snap->info );
+	snap->infoLength = strlen( snap->info );
+
+	snap->playersLength = SV_StatusPlayers( snap->players, sizeof( snap->players ) );
+
+	Sys_MemoryBarrier();
+	snap->sequence++;
+	Sys_MemoryBarrier();
+
+	queryPublished = index;
+}
+
+/*
+================
+SV_StartQueryThread
+================
+*/
+static void SV_StartQueryThread()
+{
+	querySignal = Sys_CreateSignal();
+	if( !querySignal )
+	{
+		Com_Printf( "Couldn't create the query responder signal\n" );
+		Cvar_Set( "sv_queryThread", "0" );
+		return;
+	}
+
+	queryQuit	   = 0;
+	queryHead	   = 0;
+	queryTail	   = 0;
+	queryPublished = -1;
+	Com_Memset( queryBuckets, 0, sizeof( queryBuckets ) );
+	Com_Memset( &queryOutboundBucket, 0, sizeof( queryOutboundBucket ) );
+
+	queryThread = Sys_CreateThread( SV_QueryThread, NULL );
+	if( !queryThread )
+	{
+		Com_Printf( "Couldn't start the query responder thread\n" );
+		Sys_DestroySignal( querySignal );
+		querySignal = NULL;
+		Cvar_Set( "sv_queryThread", "0" );
+		return;
+	}
+
+	Com_DPrintf( "Started the query responder thread\n" );
+}
+
+/*
+================
+SV_ShutdownQueryThread
+================
+*/
+void SV_ShutdownQueryThread()
+{
+	if( !queryThread )
+	{
+		return;
+	}
+
+	queryQuit = 1;
+	Sys_RaiseSignal( querySignal );
+	Sys_JoinThread( queryThread );
+	Sys_DestroySignal( querySignal );
+
+	queryThread	   = NULL;
+	querySignal	   = NULL;
+	queryPublished = -1;
+
+	Com_DPrintf( "Stopped the query responder thread\n" );
+}
+
+/*
+================
+SV_QueryFrame
+
+Starts or stops the responder to follow sv_queryThread and publishes the
+state of this frame to it
+================
+*/
+void SV_QueryFrame()
+{
+	if( !sv_queryThread->integer )
+	{
+		SV_ShutdownQueryThread();
+		return;
+	}
+
+	if( !queryThread )
+	{
+		SV_StartQueryThread();
+		if( !queryThread )
+		{
+			return;
+		}
+	}
+
+	queryUseSocks = Cvar_VariableIntegerValue( "net_socksEnabled" ) ? qtrue : qfalse;
+
+	SV_PublishQuerySnapshot();
+}
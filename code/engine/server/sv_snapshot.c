@@ -49,9 +49,13 @@ A normal server packet will look like:
 SV_EmitPacketEntities
 
 Writes a delta update of an entityState_t list to the message.
+
+If newEntityNums is set the new states are read straight from the game
+entities instead of svs.snapshotEntities, which is how the parallel path
+encodes a frame before its states have been copied into the ring buffer.
 =============
 */
-static void SV_EmitPacketEntities( clientSnapshot_t* from, clientSnapshot_t* to, msg_t* msg )
+static void SV_EmitPacketEntities( clientSnapshot_t* from, clientSnapshot_t* to, msg_t* msg, const int* newEntityNums )
 {
 	entityState_t *oldent, *newent;
 	int			   oldindex, newindex;
@@ -80,7 +84,14 @@ static void SV_EmitPacketEntities( clientSnapshot_t* from, clientSnapshot_t* to,
 		}
 		else
 		{
-			newent = &svs.snapshotEntities[( to->first_entity + newindex ) % svs.numSnapshotEntities];
+			if( newEntityNums )
+			{
+				newent = &SV_GentityNum( newEntityNums[newindex] )->s;
+			}
+			else
+			{
+				newent = &svs.snapshotEntities[( to->first_entity + newindex ) % svs.numSnapshotEntities];
+			}
 			newnum = newent->number;
 		}
 
@@ -127,48 +138,64 @@ static void SV_EmitPacketEntities( clientSnapshot_t* from, clientSnapshot_t* to,
 
 /*
 ==================
-SV_WriteSnapshotToClient
+SV_SnapshotDeltaFrame
+
+Picks the frame the new snapshot is delta compressed against.
+nextSnapshotEntities is the ring position after the new frame was allocated.
 ==================
 */
-static void SV_WriteSnapshotToClient( client_t* client, msg_t* msg )
+static clientSnapshot_t* SV_SnapshotDeltaFrame( client_t* client, int nextSnapshotEntities, int* lastframe )
 {
-	clientSnapshot_t *frame, *oldframe;
-	int				  lastframe;
-	int				  i;
-	int				  snapFlags;
-
-	// this is the snapshot we are creating
-	frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
+	clientSnapshot_t* oldframe;
 
 	// try to use a previous frame as the source for delta compressing the snapshot
 	if( client->deltaMessage <= 0 || client->state != CS_ACTIVE )
 	{
 		// client is asking for a retransmit
-		oldframe  = NULL;
-		lastframe = 0;
+		oldframe   = NULL;
+		*lastframe = 0;
 	}
 	else if( client->netchan.outgoingSequence - client->deltaMessage >= ( PACKET_BACKUP - 3 ) )
 	{
 		// client hasn't gotten a good message through in a long time
 		Com_DPrintf( "%s: Delta request from out of date packet.\n", client->name );
-		oldframe  = NULL;
-		lastframe = 0;
+		oldframe   = NULL;
+		*lastframe = 0;
 	}
 	else
 	{
 		// we have a valid snapshot to delta from
-		oldframe  = &client->frames[client->deltaMessage & PACKET_MASK];
-		lastframe = client->netchan.outgoingSequence - client->deltaMessage;
+		oldframe   = &client->frames[client->deltaMessage & PACKET_MASK];
+		*lastframe = client->netchan.outgoingSequence - client->deltaMessage;
 
 		// the snapshot's entities may still have rolled off the buffer, though
-		if( oldframe->first_entity <= svs.nextSnapshotEntities - svs.numSnapshotEntities )
+		if( oldframe->first_entity <= nextSnapshotEntities - svs.numSnapshotEntities )
 		{
 			Com_DPrintf( "%s: Delta request from out of date entities.\n", client->name );
-			oldframe  = NULL;
-			lastframe = 0;
+			oldframe   = NULL;
+			*lastframe = 0;
 		}
 	}
 
+	return oldframe;
+}
+
+/*
+==================
+SV_WriteSnapshotFrame
+
+Doesn't print or allocate, so it can run on a worker thread
+==================
+*/
+static void SV_WriteSnapshotFrame( client_t* client, msg_t* msg, clientSnapshot_t* oldframe, int lastframe, const int* newEntityNums )
+{
+	clientSnapshot_t* frame;
+	int				  i;
+	int				  snapFlags;
+
+	// this is the snapshot we are creating
+	frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
+
 	MSG_WriteByte( msg, svc_snapshot );
 
 	// NOTE, MRE: now sent at the start of every message from server to client
@@ -222,7 +249,7 @@ static void SV_WriteSnapshotToClient( client_t* client, msg_t* msg )
 	}
 
 	// delta encode the entities
-	SV_EmitPacketEntities( oldframe, frame, msg );
+	SV_EmitPacketEntities( oldframe, frame, msg, newEntityNums );
 
 	// padding for rate debugging
 	if( sv_padPackets->integer )
@@ -234,6 +261,21 @@ static void SV_WriteSnapshotToClient( client_t* client, msg_t* msg )
 	}
 }
 
+/*
+==================
+SV_WriteSnapshotToClient
+==================
+*/
+static void SV_WriteSnapshotToClient( client_t* client, msg_t* msg )
+{
+	clientSnapshot_t* oldframe;
+	int				  lastframe;
+
+	oldframe = SV_SnapshotDeltaFrame( client, svs.nextSnapshotEntities, &lastframe );
+
+	SV_WriteSnapshotFrame( client, msg, oldframe, lastframe, NULL );
+}
+
 /*
 ==================
 SV_UpdateServerCommandsToClient
@@ -265,8 +307,9 @@ Build a client snapshot structure
 
 typedef struct
 {
-	int numSnapshotEntities;
-	int snapshotEntities[MAX_SNAPSHOT_ENTITIES];
+	int	 numSnapshotEntities;
+	int	 snapshotEntities[MAX_SNAPSHOT_ENTITIES];
+	byte addedEntities[MAX_GENTITIES / 8]; // prevents double adding from portal views
 } snapshotEntityNumbers_t;
 
 /*
@@ -299,14 +342,16 @@ static int QDECL SV_QsortEntityNumbers( const void* a, const void* b )
 SV_AddEntToSnapshot
 ===============
 */
-static void SV_AddEntToSnapshot( svEntity_t* svEnt, sharedEntity_t* gEnt, snapshotEntityNumbers_t* eNums )
+static void SV_AddEntToSnapshot( sharedEntity_t* gEnt, snapshotEntityNumbers_t* eNums )
 {
+	int num = gEnt->s.number;
+
 	// if we have already added this entity to this snapshot, don't add again
-	if( svEnt->snapshotCounter == sv.snapshotCounter )
+	if( eNums->addedEntities[num >> 3] & ( 1 << ( num & 7 ) ) )
 	{
 		return;
 	}
-	svEnt->snapshotCounter = sv.snapshotCounter;
+	eNums->addedEntities[num >> 3] |= 1 << ( num & 7 );
 
 	// if we are full, silently discard entities
 	if( eNums->numSnapshotEntities == MAX_SNAPSHOT_ENTITIES )
@@ -318,38 +363,75 @@ static void SV_AddEntToSnapshot( svEntity_t* svEnt, sharedEntity_t* gEnt, snapsh
 	eNums->numSnapshotEntities++;
 }
 
+/*
+=============================================================================
+
+Per frame visibility cache
+
+Clients standing in the same cluster and area see the same entities through
+the PVS and the area portals, so the linked / cluster / area tests are done
+once per frame for every (cluster, area) pair and the resulting entity list
+is shared.  The area stands in for the areabits here, they are derived from
+it.  Only the per client filters and portal views are done for every client.
+
+=============================================================================
+*/
+
+#define MAX_VISCACHE_ENTRIES  256
+#define VISCACHE_HASH_SIZE	  512
+#define MAX_VISCACHE_ENTITIES ( 64 * MAX_GENTITIES )
+
+typedef struct
+{
+	int cluster;
+	int area;
+	int firstEntity; // into visCache.entityNums
+	int numEntities;
+	int hashNext;
+} visCacheEntry_t;
+
+typedef struct
+{
+	qboolean		active; // only inside SV_SendClientMessages, the entities don't move there
+	qboolean		locked; // no new entries while worker threads read the cache
+
+	int				numEntries;
+	visCacheEntry_t entries[MAX_VISCACHE_ENTRIES];
+	int				hashTable[VISCACHE_HASH_SIZE];
+
+	int				numEntityNums;
+	int				entityNums[MAX_VISCACHE_ENTITIES];
+
+	// statistics for viscacheinfo
+	int				frames;
+	volatile int	lookups;
+	volatile int	hits;
+	volatile int	uncached; // cache full or locked
+	int64_t			buildTime; // microseconds spent building entries
+	int				builds;
+} visCache_t;
+
+static visCache_t visCache;
+
 /*
 ===============
-SV_AddEntitiesVisibleFromPoint
+SV_BuildVisibleEntityList
+
+Lists all entities that pass the PVS and area tests from the given cluster
+and area, in increasing entity number order
 ===============
 */
-static void SV_AddEntitiesVisibleFromPoint( vec3_t origin, clientSnapshot_t* frame, snapshotEntityNumbers_t* eNums, qboolean portal )
+static int SV_BuildVisibleEntityList( int clientcluster, int clientarea, int* entityNums )
 {
 	int				e, i;
 	sharedEntity_t* ent;
 	svEntity_t*		svEnt;
 	int				l;
-	int				clientarea, clientcluster;
-	int				leafnum;
-	byte*			clientpvs;
 	byte*			bitvector;
+	int				numEntityNums;
 
-	// during an error shutdown message we may need to transmit
-	// the shutdown message after the server has shutdown, so
-	// specfically check for it
-	if( !sv.state )
-	{
-		return;
-	}
-
-	leafnum		  = CM_PointLeafnum( origin );
-	clientarea	  = CM_LeafArea( leafnum );
-	clientcluster = CM_LeafCluster( leafnum );
-
-	// calculate the visible areas
-	frame->areabytes = CM_WriteAreaBits( frame->areabits, clientarea );
-
-	clientpvs = CM_ClusterPVS( clientcluster );
+	bitvector	  = CM_ClusterPVS( clientcluster );
+	numEntityNums = 0;
 
 	for( e = 0; e < sv.numEntities; e++ )
 	{
@@ -373,50 +455,15 @@ static void SV_AddEntitiesVisibleFromPoint( vec3_t origin, clientSnapshot_t* fra
 			continue;
 		}
 
-		// entities can be flagged to be sent to only one client
-		if( ent->r.svFlags & SVF_SINGLECLIENT )
-		{
-			if( ent->r.singleClient != frame->ps.clientNum )
-			{
-				continue;
-			}
-		}
-		// entities can be flagged to be sent to everyone but one client
-		if( ent->r.svFlags & SVF_NOTSINGLECLIENT )
-		{
-			if( ent->r.singleClient == frame->ps.clientNum )
-			{
-				continue;
-			}
-		}
-		// entities can be flagged to be sent to a given mask of clients
-		if( ent->r.svFlags & SVF_CLIENTMASK )
-		{
-			if( frame->ps.clientNum >= 32 )
-			{
-				Com_Error( ERR_DROP, "SVF_CLIENTMASK: clientNum >= 32" );
-			}
-			if( ~ent->r.singleClient & ( 1 << frame->ps.clientNum ) )
-			{
-				continue;
-			}
-		}
-
-		svEnt = SV_SvEntityForGentity( ent );
-
-		// don't double add an entity through portals
-		if( svEnt->snapshotCounter == sv.snapshotCounter )
-		{
-			continue;
-		}
-
 		// broadcast entities are always sent
 		if( ent->r.svFlags & SVF_BROADCAST )
 		{
-			SV_AddEntToSnapshot( svEnt, ent, eNums );
+			entityNums[numEntityNums++] = e;
 			continue;
 		}
 
+		svEnt = SV_SvEntityForGentity( ent );
+
 		// ignore if not touching a PV leaf
 		// check area
 		if( !CM_AreasConnected( clientarea, svEnt->areanum ) )
@@ -429,8 +476,6 @@ static void SV_AddEntitiesVisibleFromPoint( vec3_t origin, clientSnapshot_t* fra
 			}
 		}
 
-		bitvector = clientpvs;
-
 		// check individual leafs
 		if( !svEnt->numClusters )
 		{
@@ -470,8 +515,212 @@ static void SV_AddEntitiesVisibleFromPoint( vec3_t origin, clientSnapshot_t* fra
 			}
 		}
 
+		entityNums[numEntityNums++] = e;
+	}
+
+	return numEntityNums;
+}
+
+/*
+===============
+SV_VisibleEntityList
+
+Returns the cached entity list for the cluster and area, builds it into
+scratch if it can't be cached
+===============
+*/
+static const int* SV_VisibleEntityList( int clientcluster, int clientarea, int* scratch, int* numEntityNums )
+{
+	visCacheEntry_t* entry;
+	int				 hash;
+	int				 index;
+	int64_t			 startTime;
+
+	if( !visCache.active || !sv_visCache->integer )
+	{
+		*numEntityNums = SV_BuildVisibleEntityList( clientcluster, clientarea, scratch );
+		return scratch;
+	}
+
+	Sys_AtomicIncrement( &visCache.lookups );
+
+	hash = ( ( clientcluster * 31 ) ^ clientarea ) & ( VISCACHE_HASH_SIZE - 1 );
+	for( index = visCache.hashTable[hash]; index != -1; index = entry->hashNext )
+	{
+		entry = &visCache.entries[index];
+		if( entry->cluster == clientcluster && entry->area == clientarea )
+		{
+			Sys_AtomicIncrement( &visCache.hits );
+			*numEntityNums = entry->numEntities;
+			return &visCache.entityNums[entry->firstEntity];
+		}
+	}
+
+	if( visCache.locked || visCache.numEntries == MAX_VISCACHE_ENTRIES || visCache.numEntityNums + sv.numEntities > MAX_VISCACHE_ENTITIES )
+	{
+		Sys_AtomicIncrement( &visCache.uncached );
+		*numEntityNums = SV_BuildVisibleEntityList( clientcluster, clientarea, scratch );
+		return scratch;
+	}
+
+	startTime = Sys_Microseconds();
+
+	entry			   = &visCache.entries[visCache.numEntries];
+	entry->cluster	   = clientcluster;
+	entry->area		   = clientarea;
+	entry->firstEntity = visCache.numEntityNums;
+	entry->numEntities = SV_BuildVisibleEntityList( clientcluster, clientarea, &visCache.entityNums[visCache.numEntityNums] );
+	entry->hashNext	   = visCache.hashTable[hash];
+
+	visCache.hashTable[hash] = visCache.numEntries++;
+	visCache.numEntityNums += entry->numEntities;
+
+	visCache.buildTime += Sys_Microseconds() - startTime;
+	visCache.builds++;
+
+	*numEntityNums = entry->numEntities;
+	return &visCache.entityNums[entry->firstEntity];
+}
+
+/*
+===============
+SV_BeginVisCache
+===============
+*/
+static void SV_BeginVisCache()
+{
+	visCache.active		   = qtrue;
+	visCache.locked		   = qfalse;
+	visCache.numEntries	   = 0;
+	visCache.numEntityNums = 0;
+	Com_Memset( visCache.hashTable, -1, sizeof( visCache.hashTable ) );
+	visCache.frames++;
+}
+
+/*
+===============
+SV_EndVisCache
+===============
+*/
+static void SV_EndVisCache()
+{
+	visCache.active = qfalse;
+}
+
+/*
+===============
+SV_VisCacheInfo_f
+===============
+*/
+void SV_VisCacheInfo_f()
+{
+	int64_t averageBuild;
+
+	if( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ) )
+	{
+		visCache.frames	   = 0;
+		visCache.lookups   = 0;
+		visCache.hits	   = 0;
+		visCache.uncached  = 0;
+		visCache.buildTime = 0;
+		visCache.builds	   = 0;
+		return;
+	}
+
+	if( !sv_visCache->integer )
+	{
+		Com_Printf( "sv_visCache is disabled\n" );
+	}
+
+	averageBuild = visCache.builds ? visCache.buildTime / visCache.builds : 0;
+
+	Com_Printf( "%i frames, %i lookups, %i hits (%.1f%%), %i uncached\n", visCache.frames, visCache.lookups, visCache.hits,
+		visCache.lookups ? 100.0f * visCache.hits / visCache.lookups : 0.0f, visCache.uncached );
+	Com_Printf( "%i lists built in %i usec, average %i usec\n", visCache.builds, ( int )visCache.buildTime, ( int )averageBuild );
+	Com_Printf( "estimated time saved: %i usec\n", ( int )( averageBuild * visCache.hits ) );
+	Com_Printf( "last frame: %i entries, %i entity numbers\n", visCache.numEntries, visCache.numEntityNums );
+}
+
+/*
+===============
+SV_AddEntitiesVisibleFromPoint
+===============
+*/
+static void SV_AddEntitiesVisibleFromPoint( vec3_t origin, clientSnapshot_t* frame, snapshotEntityNumbers_t* eNums, qboolean portal )
+{
+	int				e, i;
+	sharedEntity_t* ent;
+	int				clientarea, clientcluster;
+	int				leafnum;
+	const int*		visibleEntities;
+	int				numVisibleEntities;
+	int				scratch[MAX_GENTITIES];
+
+	// during an error shutdown message we may need to transmit
+	// the shutdown message after the server has shutdown, so
+	// specfically check for it
+	if( !sv.state )
+	{
+		return;
+	}
+
+	leafnum		  = CM_PointLeafnum( origin );
+	clientarea	  = CM_LeafArea( leafnum );
+	clientcluster = CM_LeafCluster( leafnum );
+
+	// calculate the visible areas
+	frame->areabytes = CM_WriteAreaBits( frame->areabits, clientarea );
+
+	visibleEntities = SV_VisibleEntityList( clientcluster, clientarea, scratch, &numVisibleEntities );
+
+	for( i = 0; i < numVisibleEntities; i++ )
+	{
+		e	= visibleEntities[i];
+		ent = SV_GentityNum( e );
+
+		// entities can be flagged to be sent to only one client
+		if( ent->r.svFlags & SVF_SINGLECLIENT )
+		{
+			if( ent->r.singleClient != frame->ps.clientNum )
+			{
+				continue;
+			}
+		}
+		// entities can be flagged to be sent to everyone but one client
+		if( ent->r.svFlags & SVF_NOTSINGLECLIENT )
+		{
+			if( ent->r.singleClient == frame->ps.clientNum )
+			{
+				continue;
+			}
+		}
+		// entities can be flagged to be sent to a given mask of clients
+		if( ent->r.svFlags & SVF_CLIENTMASK )
+		{
+			if( frame->ps.clientNum >= 32 )
+			{
+				Com_Error( ERR_DROP, "SVF_CLIENTMASK: clientNum >= 32" );
+			}
+			if( ~ent->r.singleClient & ( 1 << frame->ps.clientNum ) )
+			{
+				continue;
+			}
+		}
+
+		// don't double add an entity through portals
+		if( eNums->addedEntities[e >> 3] & ( 1 << ( e & 7 ) ) )
+		{
+			continue;
+		}
+
 		// add it
-		SV_AddEntToSnapshot( svEnt, ent, eNums );
+		SV_AddEntToSnapshot( ent, eNums );
+
+		// broadcast entities are always sent, even without touching a PV leaf
+		if( ent->r.svFlags & SVF_BROADCAST )
+		{
+			continue;
+		}
 
 		// if it's a portal entity, add everything visible from its camera position
 		if( ent->r.svFlags & SVF_PORTAL )
@@ -492,7 +741,7 @@ static void SV_AddEntitiesVisibleFromPoint( vec3_t origin, clientSnapshot_t* fra
 
 /*
 =============
-SV_BuildClientSnapshot
+SV_BuildClientEntityNumbers
 
 Decides which entities are going to be visible to the client, and
 copies off the playerstate and areabits.
@@ -501,29 +750,25 @@ This properly handles multiple recursive portals, but the render
 currently doesn't.
 
 For viewing through other player's eyes, clent can be something other than client->gentity
+
+Returns qfalse if the client has no entity to build a snapshot for.
 =============
 */
-static void SV_BuildClientSnapshot( client_t* client )
+static qboolean SV_BuildClientEntityNumbers( client_t* client, snapshotEntityNumbers_t* entityNumbers )
 {
-	vec3_t					org;
-	clientSnapshot_t*		frame;
-	snapshotEntityNumbers_t entityNumbers;
-	int						i;
-	sharedEntity_t*			ent;
-	entityState_t*			state;
-	svEntity_t*				svEnt;
-	sharedEntity_t*			clent;
-	int						clientNum;
-	playerState_t*			ps;
-
-	// bump the counter used to prevent double adding
-	sv.snapshotCounter++;
+	vec3_t			  org;
+	clientSnapshot_t* frame;
+	int				  i;
+	sharedEntity_t*	  clent;
+	int				  clientNum;
+	playerState_t*	  ps;
 
 	// this is the frame we are creating
 	frame = &client->frames[client->netchan.outgoingSequence & PACKET_MASK];
 
 	// clear everything in this snapshot
-	entityNumbers.numSnapshotEntities = 0;
+	entityNumbers->numSnapshotEntities = 0;
+	Com_Memset( entityNumbers->addedEntities, 0, sizeof( entityNumbers->addedEntities ) );
 	Com_Memset( frame->areabits, 0, sizeof( frame->areabits ) );
 
 	// https://zerowing.idsoftware.com/bugzilla/show_bug.cgi?id=62
@@ -532,7 +777,7 @@ static void SV_BuildClientSnapshot( client_t* client )
 	clent = client->gentity;
 	if( !clent || client->state == CS_ZOMBIE )
 	{
-		return;
+		return qfalse;
 	}
 
 	// grab the current playerState_t
@@ -546,9 +791,7 @@ static void SV_BuildClientSnapshot( client_t* client )
 	{
 		Com_Error( ERR_DROP, "SV_SvEntityForGentity: bad gEnt" );
 	}
-	svEnt = &sv.svEntities[clientNum];
-
-	svEnt->snapshotCounter = sv.snapshotCounter;
+	entityNumbers->addedEntities[clientNum >> 3] |= 1 << ( clientNum & 7 );
 
 	// find the client's viewpoint
 	VectorCopy( ps->origin, org );
@@ -556,13 +799,13 @@ static void SV_BuildClientSnapshot( client_t* client )
 
 	// add all the entities directly visible to the eye, which
 	// may include portal entities that merge other viewpoints
-	SV_AddEntitiesVisibleFromPoint( org, frame, &entityNumbers, qfalse );
+	SV_AddEntitiesVisibleFromPoint( org, frame, entityNumbers, qfalse );
 
 	// if there were portals visible, there may be out of order entities
 	// in the list which will need to be resorted for the delta compression
 	// to work correctly.  This also catches the error condition
 	// of an entity being included twice.
-	qsort( entityNumbers.snapshotEntities, entityNumbers.numSnapshotEntities, sizeof( entityNumbers.snapshotEntities[0] ), SV_QsortEntityNumbers );
+	qsort( entityNumbers->snapshotEntities, entityNumbers->numSnapshotEntities, sizeof( entityNumbers->snapshotEntities[0] ), SV_QsortEntityNumbers );
 
 	// now that all viewpoint's areabits have been OR'd together, invert
 	// all of them to make it a mask vector, which is what the renderer wants
@@ -571,12 +814,27 @@ static void SV_BuildClientSnapshot( client_t* client )
 		( ( int* )frame->areabits )[i] = ( ( int* )frame->areabits )[i] ^ -1;
 	}
 
-	// copy the entity states out
+	return qtrue;
+}
+
+/*
+=============
+SV_CopySnapshotEntities
+
+Copies the entity states of a built snapshot into svs.snapshotEntities
+=============
+*/
+static void SV_CopySnapshotEntities( clientSnapshot_t* frame, snapshotEntityNumbers_t* entityNumbers )
+{
+	int				i;
+	sharedEntity_t* ent;
+	entityState_t*	state;
+
 	frame->num_entities = 0;
 	frame->first_entity = svs.nextSnapshotEntities;
-	for( i = 0; i < entityNumbers.numSnapshotEntities; i++ )
+	for( i = 0; i < entityNumbers->numSnapshotEntities; i++ )
 	{
-		ent	   = SV_GentityNum( entityNumbers.snapshotEntities[i] );
+		ent	   = SV_GentityNum( entityNumbers->snapshotEntities[i] );
 		state  = &svs.snapshotEntities[svs.nextSnapshotEntities % svs.numSnapshotEntities];
 		*state = ent->s;
 		svs.nextSnapshotEntities++;
@@ -589,6 +847,21 @@ static void SV_BuildClientSnapshot( client_t* client )
 	}
 }
 
+/*
+=============
+SV_BuildClientSnapshot
+=============
+*/
+static void SV_BuildClientSnapshot( client_t* client )
+{
+	snapshotEntityNumbers_t entityNumbers;
+
+	if( SV_BuildClientEntityNumbers( client, &entityNumbers ) )
+	{
+		SV_CopySnapshotEntities( &client->frames[client->netchan.outgoingSequence & PACKET_MASK], &entityNumbers );
+	}
+}
+
 #ifdef USE_VOIP
 /*
 ==================
@@ -656,6 +929,49 @@ void SV_SendMessageToClient( msg_t* msg, client_t* client )
 	SV_Netchan_Transmit( client, msg );
 }
 
+/*
+=======================
+SV_StartClientMessage
+=======================
+*/
+static void SV_StartClientMessage( client_t* client, msg_t* msg, byte* msgBuf, int msgBufSize )
+{
+	MSG_Init( msg, msgBuf, msgBufSize );
+	msg->allowoverflow = qtrue;
+	if( client->useDeltaDictionary )
+	{
+		msg->deltaDictionary = &sv.deltaDictionary;
+	}
+
+	// NOTE, MRE: all server->client messages now acknowledge
+	// let the client know which reliable clientCommands we have received
+	MSG_WriteLong( msg, client->lastClientCommand );
+
+	// (re)send any reliable server commands
+	SV_UpdateServerCommandsToClient( client, msg );
+}
+
+/*
+=======================
+SV_FinishClientMessage
+=======================
+*/
+static void SV_FinishClientMessage( client_t* client, msg_t* msg )
+{
+#ifdef USE_VOIP
+	SV_WriteVoipToClient( client, msg );
+#endif
+
+	// check for overflow
+	if( msg->overflowed )
+	{
+		Com_Printf( "WARNING: msg overflowed for %s\n", client->name );
+		MSG_Clear( msg );
+	}
+
+	SV_SendMessageToClient( msg, client );
+}
+
 /*
 =======================
 SV_SendClientSnapshot
@@ -679,32 +995,241 @@ void SV_SendClientSnapshot( client_t* client )
 		return;
 	}
 
-	MSG_Init( &msg, msg_buf, sizeof( msg_buf ) );
-	msg.allowoverflow = qtrue;
-
-	// NOTE, MRE: all server->client messages now acknowledge
-	// let the client know which reliable clientCommands we have received
-	MSG_WriteLong( &msg, client->lastClientCommand );
-
-	// (re)send any reliable server commands
-	SV_UpdateServerCommandsToClient( client, &msg );
+	SV_StartClientMessage( client, &msg, msg_buf, sizeof( msg_buf ) );
 
 	// send over all the relevant entityState_t
 	// and the playerState_t
 	SV_WriteSnapshotToClient( client, &msg );
 
-#ifdef USE_VOIP
-	SV_WriteVoipToClient( client, &msg );
-#endif
+	SV_FinishClientMessage( client, &msg );
+}
 
-	// check for overflow
-	if( msg.overflowed )
+/*
+=============================================================================
+
+Parallel snapshot building
+
+The visibility tests and the delta compression of every client are done on
+the worker threads, everything that touches shared server state runs on the
+main thread in client order so the result is identical to the serial path:
+
+1. build the entity lists of all clients                 (workers)
+2. reserve the ring buffer space and pick delta frames   (main)
+3. delta encode the snapshots into per client buffers    (workers)
+4. copy the entity states into svs.snapshotEntities      (main)
+5. hand the messages to the netchan                      (main)
+
+Step 3 reads the new entity states straight from the game entities, so it
+can run before step 4 overwrites ring entries of older frames.
+
+=============================================================================
+*/
+
+typedef struct
+{
+	client_t*				client;
+	qboolean				built;	// SV_BuildClientEntityNumbers succeeded
+	qboolean				serial;	// built on the main thread, it may hit the SVF_CLIENTMASK error
+	qboolean				sendMsg; // bots don't get a message
+	clientSnapshot_t*		oldframe;
+	int						lastframe;
+	snapshotEntityNumbers_t entityNumbers;
+	msg_t					msg;
+	byte					msgBuf[MAX_MSGLEN];
+} snapshotJob_t;
+
+static snapshotJob_t snapshotJobs[MAX_CLIENTS];
+
+/*
+=======================
+SV_BuildSnapshotJob
+=======================
+*/
+static void SV_BuildSnapshotJob( void* data, int index )
+{
+	snapshotJob_t* job = ( snapshotJob_t* )data + index;
+
+	if( job->serial )
 	{
-		Com_Printf( "WARNING: msg overflowed for %s\n", client->name );
-		MSG_Clear( &msg );
+		return;
 	}
 
-	SV_SendMessageToClient( &msg, client );
+	job->built = SV_BuildClientEntityNumbers( job->client, &job->entityNumbers );
+}
+
+/*
+=======================
+SV_WriteSnapshotJob
+=======================
+*/
+static void SV_WriteSnapshotJob( void* data, int index )
+{
+	snapshotJob_t* job = ( snapshotJob_t* )data + index;
+
+	if( !job->sendMsg )
+	{
+		return;
+	}
+
+	SV_StartClientMessage( job->client, &job->msg, job->msgBuf, sizeof( job->msgBuf ) );
+	SV_WriteSnapshotFrame( job->client, &job->msg, job->oldframe, job->lastframe, job->entityNumbers.snapshotEntities );
+}
+
+/*
+=======================
+SV_PrepareSnapshotJobs
+
+Fixes up everything the workers would otherwise have to report with
+Com_DPrintf / Com_Error while building the entity lists, and fills the
+visibility cache before the workers lock it.  Clients that could run into
+the SVF_CLIENTMASK error are left to the main thread, so it is raised for
+exactly the entities the serial path raises it for.
+=======================
+*/
+static void SV_PrepareSnapshotJobs( snapshotJob_t* jobs, int numJobs )
+{
+	int				e, i;
+	sharedEntity_t* ent;
+	qboolean		clientMask;
+	playerState_t*	ps;
+	static int		scratch[MAX_GENTITIES];
+
+	clientMask = qfalse;
+	for( e = 0; e < sv.numEntities; e++ )
+	{
+		ent = SV_GentityNum( e );
+		if( !ent->r.linked )
+		{
+			continue;
+		}
+
+		if( ent->s.number != e )
+		{
+			Com_DPrintf( "FIXING ENT->S.NUMBER!!!\n" );
+			ent->s.number = e;
+		}
+
+		if( ent->r.svFlags & SVF_CLIENTMASK )
+		{
+			clientMask = qtrue;
+		}
+	}
+
+	for( i = 0; i < numJobs; i++ )
+	{
+		jobs[i].serial = qfalse;
+
+		if( !jobs[i].client->gentity || jobs[i].client->state == CS_ZOMBIE )
+		{
+			continue;
+		}
+
+		ps = SV_GameClientNum( jobs[i].client - svs.clients );
+		if( ps->clientNum < 0 || ps->clientNum >= MAX_GENTITIES )
+		{
+			Com_Error( ERR_DROP, "SV_SvEntityForGentity: bad gEnt" );
+		}
+		if( clientMask && ps->clientNum >= 32 )
+		{
+			jobs[i].serial = qtrue;
+		}
+
+		// fill the visibility cache for the direct views, portal views
+		// that are not cached yet are built by the workers themselves
+		if( sv.state && visCache.active && sv_visCache->integer )
+		{
+			vec3_t org;
+			int	   leafnum;
+			int	   numEntityNums;
+
+			VectorCopy( ps->origin, org );
+			org[2] += ps->viewheight;
+
+			leafnum = CM_PointLeafnum( org );
+			SV_VisibleEntityList( CM_LeafCluster( leafnum ), CM_LeafArea( leafnum ), scratch, &numEntityNums );
+		}
+	}
+}
+
+/*
+=======================
+SV_SendClientSnapshots
+
+Parallel version of calling SV_SendClientSnapshot for every client
+=======================
+*/
+static void SV_SendClientSnapshots( client_t** clients, int numClients )
+{
+	int				  i;
+	int				  nextSnapshotEntities;
+	snapshotJob_t*	  job;
+	clientSnapshot_t* frame;
+
+	for( i = 0; i < numClients; i++ )
+	{
+		snapshotJobs[i].client = clients[i];
+	}
+
+	SV_PrepareSnapshotJobs( snapshotJobs, numClients );
+
+	// the workers only read the visibility cache
+	visCache.locked = qtrue;
+	Sys_RunJobs( SV_BuildSnapshotJob, snapshotJobs, numClients );
+	visCache.locked = qfalse;
+
+	for( i = 0, job = snapshotJobs; i < numClients; i++, job++ )
+	{
+		if( job->serial )
+		{
+			job->built = SV_BuildClientEntityNumbers( job->client, &job->entityNumbers );
+		}
+	}
+
+	// reserve the ring buffer space exactly like the serial path would
+	nextSnapshotEntities = svs.nextSnapshotEntities;
+	for( i = 0, job = snapshotJobs; i < numClients; i++, job++ )
+	{
+		frame = &job->client->frames[job->client->netchan.outgoingSequence & PACKET_MASK];
+
+		if( job->built )
+		{
+			frame->first_entity = nextSnapshotEntities;
+			frame->num_entities = job->entityNumbers.numSnapshotEntities;
+			nextSnapshotEntities += frame->num_entities;
+
+			// this should never hit, map should always be restarted first in SV_Frame
+			if( nextSnapshotEntities >= 0x7FFFFFFE )
+			{
+				Com_Error( ERR_FATAL, "svs.nextSnapshotEntities wrapped" );
+			}
+		}
+
+		// bots need to have their snapshots build, but
+		// the query them directly without needing to be sent
+		if( job->client->gentity && job->client->gentity->r.svFlags & SVF_BOT )
+		{
+			job->sendMsg = qfalse;
+			continue;
+		}
+
+		job->sendMsg  = qtrue;
+		job->oldframe = SV_SnapshotDeltaFrame( job->client, nextSnapshotEntities, &job->lastframe );
+	}
+
+	Sys_RunJobs( SV_WriteSnapshotJob, snapshotJobs, numClients );
+
+	for( i = 0, job = snapshotJobs; i < numClients; i++, job++ )
+	{
+		if( job->built )
+		{
+			SV_CopySnapshotEntities( &job->client->frames[job->client->netchan.outgoingSequence & PACKET_MASK], &job->entityNumbers );
+		}
+
+		if( job->sendMsg )
+		{
+			SV_FinishClientMessage( job->client, &job->msg );
+		}
+	}
 }
 
 /*
@@ -716,6 +1241,10 @@ void SV_SendClientMessages()
 {
 	int		  i;
 	client_t* c;
+	client_t* snapshotClients[MAX_CLIENTS];
+	int		  numSnapshotClients;
+
+	numSnapshotClients = 0;
 
 	// send a message to each connected client
 	for( i = 0; i < sv_maxclients->integer; i++ )
@@ -754,9 +1283,31 @@ void SV_SendClientMessages()
 			}
 		}
 
-		// generate and send a new message
-		SV_SendClientSnapshot( c );
-		c->lastSnapshotTime = svs.time;
-		c->rateDelayed		= qfalse;
+		snapshotClients[numSnapshotClients++] = c;
+	}
+
+	// generate and send the new messages
+	Sys_BeginPacketBatch();
+	SV_BeginVisCache();
+
+	if( sv_parallelSnapshots->integer && Sys_NumJobThreads() > 1 && numSnapshotClients > 1 )
+	{
+		SV_SendClientSnapshots( snapshotClients, numSnapshotClients );
+	}
+	else
+	{
+		for( i = 0; i < numSnapshotClients; i++ )
+		{
+			SV_SendClientSnapshot( snapshotClients[i] );
+		}
+	}
+
+	SV_EndVisCache();
+	Sys_FlushPacketBatch();
+
+	for( i = 0; i < numSnapshotClients; i++ )
+	{
+		snapshotClients[i]->lastSnapshotTime = svs.time;
+		snapshotClients[i]->rateDelayed		 = qfalse;
 	}
 }
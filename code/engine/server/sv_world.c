@@ -59,6 +59,12 @@ the world is carved up with an evenly spaced, axially aligned bsp tree.  Entitie
 are kept in chains either at the final leafs, or at the first node that splits
 them, which prevents having to deal with multiple fragments of a single entity.
 
+With sv_broadphase 1 a loose grid is used instead, see below.  The choice is
+made in SV_ClearWorld, so changes take effect on the next map.  The grid
+returns the entities of SV_AreaEntities in a different order than the sector
+walk, and game code can depend on that order (touch and trigger order, first
+hit picks), so it is opt-in.
+
 ===============================================================================
 */
 
@@ -76,17 +82,323 @@ typedef struct worldSector_s
 worldSector_t sv_worldSectors[AREA_NODES];
 int			  sv_numworldSectors;
 
+/*
+===============================================================================
+
+LOOSE GRID
+
+The x/y extent of the map is split into square cells.  Each entity lives in
+the one cell that holds the center of its box, and every cell is treated as
+half a cell larger on all sides, so anything no wider than a cell is fully
+inside the loosened bounds of its own cell.  Wider entities go on a separate
+list that every query checks.  Entities off the map are clamped to the
+border cells, which keeps the cell ranges of queries conservative.
+
+Cell membership and the bounds used for the overlap tests are kept in
+arrays indexed by entity number, so a query never touches the much larger
+sharedEntity_t of an entity that does not overlap.
+
+===============================================================================
+*/
+
+#define GRID_MAX_CELLS	   128 // per axis
+#define GRID_MIN_CELL_SIZE 128
+#define GRID_OVERSIZED	   ( GRID_MAX_CELLS * GRID_MAX_CELLS )
+
+typedef struct
+{
+	float minX[MAX_GENTITIES];
+	float minY[MAX_GENTITIES];
+	float minZ[MAX_GENTITIES];
+	float maxX[MAX_GENTITIES];
+	float maxY[MAX_GENTITIES];
+	float maxZ[MAX_GENTITIES];
+} entityBounds_t;
+
+typedef struct
+{
+	vec2_t		   origin;
+	float		   cellSize;
+	float		   invCellSize;
+	int			   size[2];
+
+	int			   heads[GRID_OVERSIZED + 1]; // the last list holds the oversized entities
+	int			   cell[MAX_GENTITIES];		  // -1 when not linked
+	int			   next[MAX_GENTITIES];
+	int			   prev[MAX_GENTITIES];
+	entityBounds_t bounds;
+} entityGrid_t;
+
+static entityGrid_t sv_grid;
+static int			sv_broadphaseMode;
+
+typedef struct
+{
+	const float* mins;
+	const float* maxs;
+	int*		 list;
+	int			 count, maxcount;
+} areaParms_t;
+
+// recorded by broadphasebench
+#define MAX_BENCH_FRAMES  64
+#define MAX_BENCH_QUERIES 65536
+
+typedef struct
+{
+	int	   num;
+	vec3_t absmin, absmax;
+} benchEntity_t;
+
+typedef struct
+{
+	vec3_t mins, maxs;
+} benchQuery_t;
+
+typedef struct
+{
+	int firstEntity, numEntities;
+	int firstQuery, numQueries;
+} benchFrame_t;
+
+typedef struct
+{
+	qboolean	  recording;
+	int			  maxFrames;
+	int			  numFrames;
+	benchFrame_t  frames[MAX_BENCH_FRAMES];
+	int			  numEntities;
+	benchEntity_t entities[MAX_BENCH_FRAMES * MAX_GENTITIES];
+	int			  numQueries;
+	benchQuery_t  queries[MAX_BENCH_QUERIES];
+} broadphaseRecord_t;
+
+static broadphaseRecord_t* sv_broadphaseRecord;
+
+/*
+===============
+SV_GridCellCoord
+===============
+*/
+static int SV_GridCellCoord( float v, int axis )
+{
+	int c;
+
+	c = ( int )floor( ( v - sv_grid.origin[axis] ) * sv_grid.invCellSize );
+	if( c < 0 )
+	{
+		return 0;
+	}
+	if( c >= sv_grid.size[axis] )
+	{
+		return sv_grid.size[axis] - 1;
+	}
+	return c;
+}
+
+/*
+===============
+SV_ClearGrid
+===============
+*/
+static void SV_ClearGrid( const vec3_t mins, const vec3_t maxs )
+{
+	float extent;
+	int	  i;
+
+	extent = MAX( maxs[0] - mins[0], maxs[1] - mins[1] );
+
+	sv_grid.cellSize = MAX( GRID_MIN_CELL_SIZE, ceil( extent / GRID_MAX_CELLS ) );
+	sv_grid.invCellSize = 1.0f / sv_grid.cellSize;
+	for( i = 0; i < 2; i++ )
+	{
+		sv_grid.origin[i] = mins[i];
+		sv_grid.size[i]	  = Com_Clamp( 1, GRID_MAX_CELLS, ( int )ceil( ( maxs[i] - mins[i] ) * sv_grid.invCellSize ) );
+	}
+
+	for( i = 0; i <= GRID_OVERSIZED; i++ )
+	{
+		sv_grid.heads[i] = -1;
+	}
+	for( i = 0; i < MAX_GENTITIES; i++ )
+	{
+		sv_grid.cell[i] = -1;
+	}
+}
+
+/*
+===============
+SV_GridUnlink
+===============
+*/
+static void SV_GridUnlink( int num )
+{
+	int cell;
+
+	cell = sv_grid.cell[num];
+	if( cell == -1 )
+	{
+		return;
+	}
+	sv_grid.cell[num] = -1;
+
+	if( sv_grid.prev[num] != -1 )
+	{
+		sv_grid.next[sv_grid.prev[num]] = sv_grid.next[num];
+	}
+	else
+	{
+		sv_grid.heads[cell] = sv_grid.next[num];
+	}
+	if( sv_grid.next[num] != -1 )
+	{
+		sv_grid.prev[sv_grid.next[num]] = sv_grid.prev[num];
+	}
+}
+
+/*
+===============
+SV_GridLink
+===============
+*/
+static void SV_GridLink( int num, const vec3_t absmin, const vec3_t absmax )
+{
+	int cell;
+
+	if( sv_grid.cell[num] != -1 )
+	{
+		SV_GridUnlink( num );
+	}
+
+	if( absmax[0] - absmin[0] > sv_grid.cellSize || absmax[1] - absmin[1] > sv_grid.cellSize )
+	{
+		cell = GRID_OVERSIZED;
+	}
+	else
+	{
+		cell = SV_GridCellCoord( 0.5f * ( absmin[0] + absmax[0] ), 0 ) + SV_GridCellCoord( 0.5f * ( absmin[1] + absmax[1] ), 1 ) * GRID_MAX_CELLS;
+	}
+
+	sv_grid.bounds.minX[num] = absmin[0];
+	sv_grid.bounds.minY[num] = absmin[1];
+	sv_grid.bounds.minZ[num] = absmin[2];
+	sv_grid.bounds.maxX[num] = absmax[0];
+	sv_grid.bounds.maxY[num] = absmax[1];
+	sv_grid.bounds.maxZ[num] = absmax[2];
+
+	sv_grid.cell[num] = cell;
+	sv_grid.prev[num] = -1;
+	sv_grid.next[num] = sv_grid.heads[cell];
+	if( sv_grid.heads[cell] != -1 )
+	{
+		sv_grid.prev[sv_grid.heads[cell]] = num;
+	}
+	sv_grid.heads[cell] = num;
+}
+
+/*
+===============
+SV_GridAreaEntities_r
+
+Collects the entities of one cell list, returns qfalse when the list is full
+===============
+*/
+static qboolean SV_GridAreaEntities_r( int num, areaParms_t* ap )
+{
+	const entityBounds_t* b = &sv_grid.bounds;
+
+	for( ; num != -1; num = sv_grid.next[num] )
+	{
+		if( b->minX[num] > ap->maxs[0] || b->minY[num] > ap->maxs[1] || b->minZ[num] > ap->maxs[2] || b->maxX[num] < ap->mins[0] || b->maxY[num] < ap->mins[1] || b->maxZ[num] < ap->mins[2] )
+		{
+			continue;
+		}
+
+		if( ap->count == ap->maxcount )
+		{
+			Com_Printf( "SV_AreaEntities: MAXCOUNT\n" );
+			return qfalse;
+		}
+
+		ap->list[ap->count] = num;
+		ap->count++;
+	}
+
+	return qtrue;
+}
+
+/*
+===============
+SV_GridAreaEntities
+===============
+*/
+static void SV_GridAreaEntities( areaParms_t* ap )
+{
+	int	  x, y, x0, y0, x1, y1;
+	float loose;
+
+	if( !SV_GridAreaEntities_r( sv_grid.heads[GRID_OVERSIZED], ap ) )
+	{
+		return;
+	}
+
+	loose = 0.5f * sv_grid.cellSize;
+	x0	  = SV_GridCellCoord( ap->mins[0] - loose, 0 );
+	x1	  = SV_GridCellCoord( ap->maxs[0] + loose, 0 );
+	y0	  = SV_GridCellCoord( ap->mins[1] - loose, 1 );
+	y1	  = SV_GridCellCoord( ap->maxs[1] + loose, 1 );
+
+	for( y = y0; y <= y1; y++ )
+	{
+		for( x = x0; x <= x1; x++ )
+		{
+			if( !SV_GridAreaEntities_r( sv_grid.heads[x + y * GRID_MAX_CELLS], ap ) )
+			{
+				return;
+			}
+		}
+	}
+}
+
+//===========================================================================
+
 /*
 ===============
 SV_SectorList_f
 ===============
 */
-void		  SV_SectorList_f()
+void SV_SectorList_f()
 {
-	int			   i, c;
+	int			   i, c, num, cells, used, most, oversized;
 	worldSector_t* sec;
 	svEntity_t*	   ent;
 
+	if( sv_broadphaseMode )
+	{
+		used = most = oversized = 0;
+		for( i = 0; i <= GRID_OVERSIZED; i++ )
+		{
+			c = 0;
+			for( num = sv_grid.heads[i]; num != -1; num = sv_grid.next[num] )
+			{
+				c++;
+			}
+			if( i == GRID_OVERSIZED )
+			{
+				oversized = c;
+			}
+			else if( c )
+			{
+				used++;
+				most = MAX( most, c );
+			}
+		}
+		cells = sv_grid.size[0] * sv_grid.size[1];
+		Com_Printf( "grid %ix%i cells of %i units, %i of %i used, %i entities in the fullest\n", sv_grid.size[0], sv_grid.size[1], ( int )sv_grid.cellSize, used, cells, most );
+		Com_Printf( "%i oversized entities\n", oversized );
+		return;
+	}
+
 	for( i = 0; i < AREA_NODES; i++ )
 	{
 		sec = &sv_worldSectors[i];
@@ -147,6 +459,19 @@ static worldSector_t* SV_CreateworldSector( int depth, vec3_t mins, vec3_t maxs
 	return anode;
 }
 
+/*
+===============
+SV_ClearSectors
+===============
+*/
+static void SV_ClearSectors( vec3_t mins, vec3_t maxs )
+{
+	Com_Memset( sv_worldSectors, 0, sizeof( sv_worldSectors ) );
+	sv_numworldSectors = 0;
+
+	SV_CreateworldSector( 0, mins, maxs );
+}
+
 /*
 ===============
 SV_ClearWorld
@@ -158,31 +483,28 @@ void SV_ClearWorld()
 	clipHandle_t h;
 	vec3_t		 mins, maxs;
 
-	Com_Memset( sv_worldSectors, 0, sizeof( sv_worldSectors ) );
-	sv_numworldSectors = 0;
+	SV_FreeBroadphaseRecord();
+
+	sv_broadphaseMode = sv_broadphase->integer ? 1 : 0;
 
 	// get world map bounds
 	h = CM_InlineModel( 0 );
 	CM_ModelBounds( h, mins, maxs );
-	SV_CreateworldSector( 0, mins, maxs );
+
+	SV_ClearSectors( mins, maxs );
+	SV_ClearGrid( mins, maxs );
 }
 
 /*
 ===============
-SV_UnlinkEntity
-
+SV_SectorUnlink
 ===============
 */
-void SV_UnlinkEntity( sharedEntity_t* gEnt )
+static void SV_SectorUnlink( svEntity_t* ent )
 {
-	svEntity_t*	   ent;
 	svEntity_t*	   scan;
 	worldSector_t* ws;
 
-	ent = SV_SvEntityForGentity( gEnt );
-
-	gEnt->r.linked = qfalse;
-
 	ws = ent->worldSector;
 	if( !ws )
 	{
@@ -208,6 +530,83 @@ void SV_UnlinkEntity( sharedEntity_t* gEnt )
 	Com_Printf( "WARNING: SV_UnlinkEntity: not found in worldSector\n" );
 }
 
+/*
+===============
+SV_SectorLink
+===============
+*/
+static void SV_SectorLink( svEntity_t* ent, const vec3_t absmin, const vec3_t absmax )
+{
+	worldSector_t* node;
+
+	// find the first world sector node that the ent's box crosses
+	node = sv_worldSectors;
+	while( 1 )
+	{
+		if( node->axis == -1 )
+		{
+			break;
+		}
+		if( absmin[node->axis] > node->dist )
+		{
+			node = node->children[0];
+		}
+		else if( absmax[node->axis] < node->dist )
+		{
+			node = node->children[1];
+		}
+		else
+		{
+			break; // crosses the node
+		}
+	}
+
+	// link it in
+	ent->worldSector			 = node;
+	ent->nextEntityInWorldSector = node->entities;
+	node->entities				 = ent;
+}
+
+/*
+===============
+SV_EntityLinked
+
+Whether the entity is in the active broadphase
+===============
+*/
+static qboolean SV_EntityLinked( svEntity_t* ent )
+{
+	if( sv_broadphaseMode )
+	{
+		return sv_grid.cell[ent - sv.svEntities] != -1 ? qtrue : qfalse;
+	}
+	return ent->worldSector ? qtrue : qfalse;
+}
+
+/*
+===============
+SV_UnlinkEntity
+
+===============
+*/
+void SV_UnlinkEntity( sharedEntity_t* gEnt )
+{
+	svEntity_t* ent;
+
+	ent = SV_SvEntityForGentity( gEnt );
+
+	gEnt->r.linked = qfalse;
+
+	if( sv_broadphaseMode )
+	{
+		SV_GridUnlink( ent - sv.svEntities );
+	}
+	else
+	{
+		SV_SectorUnlink( ent );
+	}
+}
+
 /*
 ===============
 SV_LinkEntity
@@ -217,7 +616,6 @@ SV_LinkEntity
 #define MAX_TOTAL_ENT_LEAFS 128
 void SV_LinkEntity( sharedEntity_t* gEnt )
 {
-	worldSector_t* node;
 	int			   leafs[MAX_TOTAL_ENT_LEAFS];
 	int			   cluster;
 	int			   num_leafs;
@@ -229,7 +627,7 @@ void SV_LinkEntity( sharedEntity_t* gEnt )
 
 	ent = SV_SvEntityForGentity( gEnt );
 
-	if( ent->worldSector )
+	if( SV_EntityLinked( ent ) )
 	{
 		SV_UnlinkEntity( gEnt ); // unlink from old position
 	}
@@ -376,32 +774,15 @@ void SV_LinkEntity( sharedEntity_t* gEnt )
 
 	gEnt->r.linkcount++;
 
-	// find the first world sector node that the ent's box crosses
-	node = sv_worldSectors;
-	while( 1 )
+	// link it in
+	if( sv_broadphaseMode )
 	{
-		if( node->axis == -1 )
-		{
-			break;
-		}
-		if( gEnt->r.absmin[node->axis] > node->dist )
-		{
-			node = node->children[0];
-		}
-		else if( gEnt->r.absmax[node->axis] < node->dist )
-		{
-			node = node->children[1];
-		}
-		else
-		{
-			break; // crosses the node
-		}
+		SV_GridLink( ent - sv.svEntities, gEnt->r.absmin, gEnt->r.absmax );
+	}
+	else
+	{
+		SV_SectorLink( ent, gEnt->r.absmin, gEnt->r.absmax );
 	}
-
-	// link it in
-	ent->worldSector			 = node;
-	ent->nextEntityInWorldSector = node->entities;
-	node->entities				 = ent;
 
 	gEnt->r.linked = qtrue;
 }
@@ -416,14 +797,6 @@ bounds.  This does NOT mean that they actually touch in the case of bmodels.
 ============================================================================
 */
 
-typedef struct
-{
-	const float* mins;
-	const float* maxs;
-	int*		 list;
-	int			 count, maxcount;
-} areaParms_t;
-
 /*
 ====================
 SV_AreaEntities_r
@@ -473,6 +846,27 @@ static void SV_AreaEntities_r( worldSector_t* node, areaParms_t* ap )
 	}
 }
 
+/*
+===============
+SV_RecordBroadphaseQuery
+===============
+*/
+static void SV_RecordBroadphaseQuery( const vec3_t mins, const vec3_t maxs )
+{
+	broadphaseRecord_t* rec = sv_broadphaseRecord;
+	benchQuery_t*		query;
+
+	if( !rec->numFrames || rec->numQueries == MAX_BENCH_QUERIES )
+	{
+		return;
+	}
+
+	query = &rec->queries[rec->numQueries++];
+	VectorCopy( mins, query->mins );
+	VectorCopy( maxs, query->maxs );
+	rec->frames[rec->numFrames - 1].numQueries++;
+}
+
 /*
 ================
 SV_AreaEntities
@@ -482,17 +876,333 @@ int SV_AreaEntities( const vec3_t mins, const vec3_t maxs, int* entityList, int
 {
 	areaParms_t ap;
 
+	if( sv_broadphaseRecord && sv_broadphaseRecord->recording )
+	{
+		SV_RecordBroadphaseQuery( mins, maxs );
+	}
+
 	ap.mins		= mins;
 	ap.maxs		= maxs;
 	ap.list		= entityList;
 	ap.count	= 0;
 	ap.maxcount = maxcount;
 
-	SV_AreaEntities_r( sv_worldSectors, &ap );
+	if( sv_broadphaseMode )
+	{
+		SV_GridAreaEntities( &ap );
+	}
+	else
+	{
+		SV_AreaEntities_r( sv_worldSectors, &ap );
+	}
 
 	return ap.count;
 }
 
+/*
+===============================================================================
+
+BROADPHASE BENCHMARK
+
+"broadphasebench record <frames>" captures the bounds of every linked entity
+at the start of each server frame and the area queries made during it.
+"broadphasebench [passes]" then replays the recording against both the
+sector tree and the grid, checks that they return the same entities and
+prints the time each spent linking and querying.
+
+===============================================================================
+*/
+
+/*
+===============
+SV_FreeBroadphaseRecord
+===============
+*/
+void SV_FreeBroadphaseRecord()
+{
+	if( sv_broadphaseRecord )
+	{
+		Z_Free( sv_broadphaseRecord );
+		sv_broadphaseRecord = NULL;
+	}
+}
+
+/*
+===============
+SV_RecordBroadphaseFrame
+
+Called at the start of each server frame
+===============
+*/
+void SV_RecordBroadphaseFrame()
+{
+	broadphaseRecord_t* rec = sv_broadphaseRecord;
+	benchFrame_t*		frame;
+	benchEntity_t*		be;
+	sharedEntity_t*		gEnt;
+	int					i;
+
+	if( !rec || !rec->recording )
+	{
+		return;
+	}
+
+	if( rec->numFrames == rec->maxFrames )
+	{
+		rec->recording = qfalse;
+		Com_Printf( "broadphasebench: recorded %i frames with %i entities and %i queries\n", rec->numFrames, rec->numEntities, rec->numQueries );
+		return;
+	}
+
+	frame			   = &rec->frames[rec->numFrames++];
+	frame->firstEntity = rec->numEntities;
+	frame->firstQuery  = rec->numQueries;
+	frame->numQueries  = 0;
+
+	for( i = 0; i < sv.numEntities; i++ )
+	{
+		gEnt = SV_GentityNum( i );
+		if( !gEnt->r.linked )
+		{
+			continue;
+		}
+
+		be		= &rec->entities[rec->numEntities++];
+		be->num = i;
+		VectorCopy( gEnt->r.absmin, be->absmin );
+		VectorCopy( gEnt->r.absmax, be->absmax );
+	}
+
+	frame->numEntities = rec->numEntities - frame->firstEntity;
+}
+
+/*
+===============
+SV_BroadphaseReplay
+
+Runs one recorded frame against the sector tree or the grid.  Every
+entity of the frame is linked, all queries are made and the entities are
+unlinked again, which is not timed.
+===============
+*/
+static void SV_BroadphaseReplay( const benchFrame_t* frame, int mode, int64_t* linkTime, int64_t* queryTime, int* results )
+{
+	static int				list[MAX_GENTITIES];
+	broadphaseRecord_t*		rec = sv_broadphaseRecord;
+	const benchEntity_t*	be;
+	const benchQuery_t*		query;
+	sharedEntity_t*			gEnt;
+	areaParms_t				ap;
+	int64_t					start;
+	int						i, j;
+	unsigned				sum;
+
+	start = Sys_Microseconds();
+	for( i = 0, be = &rec->entities[frame->firstEntity]; i < frame->numEntities; i++, be++ )
+	{
+		if( mode )
+		{
+			SV_GridLink( be->num, be->absmin, be->absmax );
+		}
+		else
+		{
+			// the tree tests against the bounds in the game entity
+			gEnt = SV_GentityNum( be->num );
+			VectorCopy( be->absmin, gEnt->r.absmin );
+			VectorCopy( be->absmax, gEnt->r.absmax );
+			SV_SectorLink( &sv.svEntities[be->num], be->absmin, be->absmax );
+		}
+	}
+	*linkTime += Sys_Microseconds() - start;
+
+	start = Sys_Microseconds();
+	for( i = 0, query = &rec->queries[frame->firstQuery]; i < frame->numQueries; i++, query++ )
+	{
+		ap.mins		= query->mins;
+		ap.maxs		= query->maxs;
+		ap.list		= list;
+		ap.count	= 0;
+		ap.maxcount = MAX_GENTITIES;
+
+		if( mode )
+		{
+			SV_GridAreaEntities( &ap );
+		}
+		else
+		{
+			SV_AreaEntities_r( sv_worldSectors, &ap );
+		}
+
+		if( results )
+		{
+			// order independent, the two return their entities in a different order
+			sum = 0;
+			for( j = 0; j < ap.count; j++ )
+			{
+				sum += list[j] * 2654435761u;
+			}
+			results[i] = ( int )( sum ^ ap.count );
+		}
+	}
+	*queryTime += Sys_Microseconds() - start;
+
+	for( i = 0, be = &rec->entities[frame->firstEntity]; i < frame->numEntities; i++, be++ )
+	{
+		if( mode )
+		{
+			SV_GridUnlink( be->num );
+		}
+		else
+		{
+			SV_SectorUnlink( &sv.svEntities[be->num] );
+		}
+	}
+}
+
+/*
+===============
+SV_BroadphaseBench_f
+===============
+*/
+void SV_BroadphaseBench_f()
+{
+	static vec3_t		savedMins[MAX_GENTITIES], savedMaxs[MAX_GENTITIES];
+	static qboolean		savedLinked[MAX_GENTITIES];
+	broadphaseRecord_t* rec;
+	benchFrame_t*		frame;
+	sharedEntity_t*		gEnt;
+	int*				treeResults;
+	int*				gridResults;
+	int64_t				treeLink, treeQuery, gridLink, gridQuery;
+	int					i, j, passes, frames, mismatches;
+
+	// make sure server is running
+	if( !com_sv_running->integer )
+	{
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	if( !Q_stricmp( Cmd_Argv( 1 ), "record" ) )
+	{
+		frames = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 32;
+		frames = Com_Clamp( 1, MAX_BENCH_FRAMES, frames );
+
+		if( !sv_broadphaseRecord )
+		{
+			sv_broadphaseRecord = Z_Malloc( sizeof( *sv_broadphaseRecord ) );
+		}
+		rec = sv_broadphaseRecord;
+
+		rec->recording	 = qtrue;
+		rec->maxFrames	 = frames;
+		rec->numFrames	 = 0;
+		rec->numEntities = 0;
+		rec->numQueries	 = 0;
+
+		Com_Printf( "broadphasebench: recording %i frames\n", frames );
+		return;
+	}
+
+	rec = sv_broadphaseRecord;
+	if( !rec || rec->recording || !rec->numFrames )
+	{
+		Com_Printf( "usage: broadphasebench record <frames>, then broadphasebench [passes]\n" );
+		return;
+	}
+
+	passes = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 10;
+	if( passes < 1 )
+	{
+		passes = 1;
+	}
+
+	// take the live entities out, they are put back afterwards
+	for( i = 0; i < MAX_GENTITIES; i++ )
+	{
+		if( sv_broadphaseMode )
+		{
+			savedLinked[i] = sv_grid.cell[i] != -1 ? qtrue : qfalse;
+			SV_GridUnlink( i );
+		}
+		else
+		{
+			savedLinked[i] = sv.svEntities[i].worldSector ? qtrue : qfalse;
+			SV_SectorUnlink( &sv.svEntities[i] );
+		}
+
+		if( i < sv.numEntities )
+		{
+			gEnt = SV_GentityNum( i );
+			VectorCopy( gEnt->r.absmin, savedMins[i] );
+			VectorCopy( gEnt->r.absmax, savedMaxs[i] );
+		}
+	}
+
+	treeResults = Z_Malloc( rec->numQueries * sizeof( int ) );
+	gridResults = Z_Malloc( rec->numQueries * sizeof( int ) );
+
+	treeLink = treeQuery = gridLink = gridQuery = 0;
+	for( i = 0; i < passes; i++ )
+	{
+		for( j = 0, frame = rec->frames; j < rec->numFrames; j++, frame++ )
+		{
+			SV_BroadphaseReplay( frame, 0, &treeLink, &treeQuery, i ? NULL : treeResults + frame->firstQuery );
+			SV_BroadphaseReplay( frame, 1, &gridLink, &gridQuery, i ? NULL : gridResults + frame->firstQuery );
+		}
+	}
+
+	mismatches = 0;
+	for( i = 0; i < rec->numQueries; i++ )
+	{
+		if( treeResults[i] != gridResults[i] )
+		{
+			mismatches++;
+		}
+	}
+
+	Z_Free( treeResults );
+	Z_Free( gridResults );
+
+	// put the live entities back
+	for( i = 0; i < MAX_GENTITIES; i++ )
+	{
+		if( i < sv.numEntities )
+		{
+			gEnt = SV_GentityNum( i );
+			VectorCopy( savedMins[i], gEnt->r.absmin );
+			VectorCopy( savedMaxs[i], gEnt->r.absmax );
+		}
+
+		if( !savedLinked[i] )
+		{
+			continue;
+		}
+
+		gEnt = SV_GentityNum( i );
+		if( sv_broadphaseMode )
+		{
+			SV_GridLink( i, gEnt->r.absmin, gEnt->r.absmax );
+		}
+		else
+		{
+			SV_SectorLink( &sv.svEntities[i], gEnt->r.absmin, gEnt->r.absmax );
+		}
+	}
+
+	Com_Printf( "%i frames, %i entity links and %i queries per pass, %i passes\n", rec->numFrames, rec->numEntities, rec->numQueries, passes );
+	Com_Printf( "sector tree: %8.3f msec link %8.3f msec query\n", treeLink / ( passes * 1000.0 ), treeQuery / ( passes * 1000.0 ) );
+	Com_Printf( "loose grid:  %8.3f msec link %8.3f msec query\n", gridLink / ( passes * 1000.0 ), gridQuery / ( passes * 1000.0 ) );
+	if( mismatches )
+	{
+		Com_Printf( S_COLOR_YELLOW "WARNING: %i of %i queries returned different entities\n", mismatches, rec->numQueries );
+	}
+	else
+	{
+		Com_Printf( "all queries returned the same entities\n" );
+	}
+}
+
 //===========================================================================
 
 typedef struct
@@ -654,45 +1364,21 @@ static void SV_ClipMoveToEntities( moveclip_t* clip )
 
 /*
 ==================
-SV_Trace
+SV_ClipTraceToEntities
 
-Moves the given mins/maxs volume through the world from start to end.
-passEntityNum and entities owned by passEntityNum are explicitly not checked.
+Clips a trace that has already been run against the world to the solid
+entities.  passEntityNum and entities owned by passEntityNum are explicitly
+not checked.
 ==================
 */
-void SV_Trace( trace_t* results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, traceType_t type )
+static void SV_ClipTraceToEntities( trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, traceType_t type )
 {
 	moveclip_t clip;
 	int		   i;
 
-	if( !mins )
-	{
-		mins = vec3_origin;
-	}
-	if( !maxs )
-	{
-		maxs = vec3_origin;
-	}
-
 	Com_Memset( &clip, 0, sizeof( moveclip_t ) );
 
-	// clip to world
-	CM_BoxTrace( &clip.trace, start, end, mins, maxs, 0, contentmask, type );
-	clip.trace.entityNum = clip.trace.fraction != 1.0 ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
-	if( clip.trace.fraction == 0 )
-	{
-		*results = clip.trace;
-		return; // blocked immediately by the world
-	}
-
-	// Tr3B: HACK extension that would work with the ETPub trap_Trace(Capsule)NoEnts code
-	if( passEntityNum == -2 )
-	{
-		// skip tracing against entities
-		*results = clip.trace;
-		return;
-	}
-
+	clip.trace		 = *results;
 	clip.contentmask = contentmask;
 	clip.start		 = start;
 	//  VectorCopy( clip.trace.endpos, clip.end );
@@ -726,6 +1412,74 @@ void SV_Trace( trace_t* results, const vec3_t start, vec3_t mins, vec3_t maxs, c
 	*results = clip.trace;
 }
 
+/*
+==================
+SV_Trace
+
+Moves the given mins/maxs volume through the world from start to end.
+passEntityNum and entities owned by passEntityNum are explicitly not checked.
+==================
+*/
+void SV_Trace( trace_t* results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, traceType_t type )
+{
+	PROF_BEGIN( "SV_Trace" );
+
+	if( !mins )
+	{
+		mins = vec3_origin;
+	}
+	if( !maxs )
+	{
+		maxs = vec3_origin;
+	}
+
+	// clip to world
+	CM_BoxTrace( results, start, end, mins, maxs, 0, contentmask, type );
+	results->entityNum = results->fraction != 1.0 ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+
+	// nothing more to do if blocked immediately by the world
+	// Tr3B: HACK extension that would work with the ETPub trap_Trace(Capsule)NoEnts code,
+	// passEntityNum -2 skips tracing against entities
+	if( results->fraction != 0 && passEntityNum != -2 )
+	{
+		SV_ClipTraceToEntities( results, start, mins, maxs, end, passEntityNum, contentmask, type );
+	}
+
+	PROF_END();
+}
+
+/*
+==================
+SV_TraceBatch
+
+Runs count independent SV_Traces.  The world part of all of them is done
+first and spread over the worker threads, the entity clipping then runs
+here in request order.
+==================
+*/
+void SV_TraceBatch( trace_t* results, const traceRequest_t* requests, int count )
+{
+	const traceRequest_t* r;
+	int					  i;
+
+	PROF_BEGIN( "SV_TraceBatch" );
+
+	CM_BoxTraceBatch( results, requests, count );
+
+	for( i = 0, r = requests; i < count; i++, r++ )
+	{
+		results[i].entityNum = results[i].fraction != 1.0 ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+		if( results[i].fraction == 0 || r->passEntityNum == -2 )
+		{
+			continue;
+		}
+
+		SV_ClipTraceToEntities( &results[i], r->start, r->mins, r->maxs, r->end, r->passEntityNum, r->contentmask, r->type );
+	}
+
+	PROF_END();
+}
+
 /*
 =============
 SV_PointContents
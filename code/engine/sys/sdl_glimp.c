@@ -1157,12 +1157,12 @@ void GLimp_EndFrame()
 
 SMP acceleration
 
+The render command queue and the context handoff between the threads
+live in tr_cmds.c, this only owns the thread and the context switches.
+
 ===========================================================
 */
 
-static SDL_mutex* smpMutex				= NULL;
-static SDL_cond*  renderCommandsEvent	= NULL;
-static SDL_cond*  renderCompletedEvent	= NULL;
 static void ( *renderThreadFunction )() = NULL;
 static SDL_Thread* renderThread			= NULL;
 
@@ -1171,7 +1171,7 @@ static SDL_Thread* renderThread			= NULL;
 GLimp_SetCurrentContext
 ===============
 */
-static void		   GLimp_SetCurrentContext( qboolean enable )
+void GLimp_SetCurrentContext( qboolean enable )
 {
 	if( enable )
 	{
@@ -1200,6 +1200,8 @@ static int GLimp_RenderThreadWrapper( void* arg )
 /*
 ===============
 GLimp_SpawnRenderThread
+
+The front end has to release the context before the render thread can take it
 ===============
 */
 qboolean GLimp_SpawnRenderThread( void ( *function )() )
@@ -1210,30 +1212,6 @@ qboolean GLimp_SpawnRenderThread( void ( *function )() )
 		GLimp_ShutdownRenderThread();
 	}
 
-	smpMutex = SDL_CreateMutex();
-	if( smpMutex == NULL )
-	{
-		ri.Printf( PRINT_WARNING, "smpMutex creation failed: %s\n", SDL_GetError() );
-		GLimp_ShutdownRenderThread();
-		return qfalse;
-	}
-
-	renderCommandsEvent = SDL_CreateCond();
-	if( renderCommandsEvent == NULL )
-	{
-		ri.Printf( PRINT_WARNING, "renderCommandsEvent creation failed: %s\n", SDL_GetError() );
-		GLimp_ShutdownRenderThread();
-		return qfalse;
-	}
-
-	renderCompletedEvent = SDL_CreateCond();
-	if( renderCompletedEvent == NULL )
-	{
-		ri.Printf( PRINT_WARNING, "renderCompletedEvent creation failed: %s\n", SDL_GetError() );
-		GLimp_ShutdownRenderThread();
-		return qfalse;
-	}
-
 	renderThreadFunction = function;
 	renderThread		 = SDL_CreateThread( GLimp_RenderThreadWrapper, "render thread", NULL );
 	if( renderThread == NULL )
@@ -1249,131 +1227,26 @@ qboolean GLimp_SpawnRenderThread( void ( *function )() )
 /*
 ===============
 GLimp_ShutdownRenderThread
+
+The thread function must already have been told to return
 ===============
 */
 void GLimp_ShutdownRenderThread()
 {
 	if( renderThread != NULL )
 	{
-		GLimp_WakeRenderer( NULL );
 		SDL_WaitThread( renderThread, NULL );
 		renderThread	   = NULL;
 		glConfig.smpActive = qfalse;
 	}
 
-	if( smpMutex != NULL )
-	{
-		SDL_DestroyMutex( smpMutex );
-		smpMutex = NULL;
-	}
-
-	if( renderCommandsEvent != NULL )
-	{
-		SDL_DestroyCond( renderCommandsEvent );
-		renderCommandsEvent = NULL;
-	}
-
-	if( renderCompletedEvent != NULL )
-	{
-		SDL_DestroyCond( renderCompletedEvent );
-		renderCompletedEvent = NULL;
-	}
-
 	renderThreadFunction = NULL;
 }
 
-static volatile void*	 smpData = NULL;
-static volatile qboolean smpDataReady;
-
-/*
-===============
-GLimp_RendererSleep
-===============
-*/
-void*					 GLimp_RendererSleep()
-{
-	void* data = NULL;
-
-	GLimp_SetCurrentContext( qfalse );
-
-	SDL_LockMutex( smpMutex );
-	{
-		smpData		 = NULL;
-		smpDataReady = qfalse;
-
-		// after this, the front end can exit GLimp_FrontEndSleep
-		SDL_CondSignal( renderCompletedEvent );
-
-		while( !smpDataReady )
-		{
-			SDL_CondWait( renderCommandsEvent, smpMutex );
-		}
-
-		data = ( void* )smpData;
-	}
-	SDL_UnlockMutex( smpMutex );
-
-	GLimp_SetCurrentContext( qtrue );
-
-	return data;
-}
-
-/*
-===============
-GLimp_SyncRenderThread
-===============
-*/
-void GLimp_SyncRenderThread()
-{
-	GLimp_FrontEndSleep();
-
-	GLimp_SetCurrentContext( qtrue );
-}
-
-/*
-===============
-GLimp_FrontEndSleep
-===============
-*/
-void GLimp_FrontEndSleep()
-{
-	SDL_LockMutex( smpMutex );
-	{
-		while( smpData )
-		{
-			SDL_CondWait( renderCompletedEvent, smpMutex );
-		}
-	}
-	SDL_UnlockMutex( smpMutex );
-
-	GLimp_SetCurrentContext( qtrue );
-}
-
-/*
-===============
-GLimp_WakeRenderer
-===============
-*/
-void GLimp_WakeRenderer( void* data )
-{
-	GLimp_SetCurrentContext( qfalse );
-
-	SDL_LockMutex( smpMutex );
-	{
-		assert( smpData == NULL );
-		smpData		 = data;
-		smpDataReady = qtrue;
-
-		// after this, the renderer can continue through GLimp_RendererSleep
-		SDL_CondSignal( renderCommandsEvent );
-	}
-	SDL_UnlockMutex( smpMutex );
-}
-
 #else
 
 // No SMP - stubs
-static void GLimp_SetCurrentContext( qboolean enable )
+void GLimp_SetCurrentContext( qboolean enable )
 {
 }
 
@@ -1392,21 +1265,4 @@ void GLimp_ShutdownRenderThread()
 {
 }
 
-void* GLimp_RendererSleep()
-{
-	return NULL;
-}
-
-void GLimp_SyncRenderThread()
-{
-}
-
-void GLimp_FrontEndSleep()
-{
-}
-
-void GLimp_WakeRenderer( void* data )
-{
-}
-
 #endif
\ No newline at end of file
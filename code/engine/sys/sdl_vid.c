@@ -53,7 +53,7 @@ static void GLimp_GetCurrentContext()
 {
 }
 
-static void GLimp_SetCurrentContext( qboolean enable )
+void GLimp_SetCurrentContext( qboolean enable )
 {
 }
 
@@ -72,19 +72,6 @@ void GLimp_ShutdownRenderThread()
 {
 }
 
-void* GLimp_RendererSleep()
-{
-	return NULL;
-}
-
-void GLimp_FrontEndSleep()
-{
-}
-
-void GLimp_WakeRenderer( void* data )
-{
-}
-
 typedef enum
 {
 	RSERR_OK,
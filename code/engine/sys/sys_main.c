@@ -341,6 +341,10 @@ cpuFeatures_t Sys_GetProcessorFeatures()
 	{
 		features |= CF_SSE2;
 	}
+	if( SDL_HasAVX2() )
+	{
+		features |= CF_AVX2;
+	}
 #endif
 
 	return features;
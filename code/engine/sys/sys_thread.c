@@ -0,0 +1,682 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+/*
+=============================================================================
+
+WORKER THREADS
+
+A small pool of worker threads that run "parallel for" batches.  The calling
+thread always takes part in the batch and Sys_RunJobs does not return before
+every index has been processed, so callers can treat it like a plain loop.
+
+Jobs must not call Com_Printf, Com_Error or touch the zone/hunk allocators.
+
+=============================================================================
+*/
+
+#include <q_shared.h>
+#include "../qcommon/qcommon.h"
+#include "sys_local.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <unistd.h>
+	#include <time.h>
+#endif
+
+#ifdef _WIN32
+typedef HANDLE			  sysThreadHandle_t;
+typedef CRITICAL_SECTION  sysLock_t;
+typedef CONDITION_VARIABLE sysCond_t;
+#else
+typedef pthread_t		  sysThreadHandle_t;
+typedef pthread_mutex_t	  sysLock_t;
+typedef pthread_cond_t	  sysCond_t;
+#endif
+
+typedef struct
+{
+	int				  numThreads;
+	sysThreadHandle_t threads[MAX_JOB_THREADS];
+
+	sysLock_t		  lock;
+	sysCond_t		  wake; // signaled when a new batch is posted
+	sysCond_t		  done; // signaled when the last worker leaves a batch
+
+	int				  batch; // incremented for every posted batch
+	qboolean		  quit;
+	int				  busyWorkers;
+
+	// current batch
+	jobFunc_t		  func;
+	void*			  data;
+	int				  count;
+	volatile int	  next;
+} jobPool_t;
+
+static jobPool_t jobs;
+static qboolean	 jobsRunning;
+
+cvar_t*			 com_jobThreads;
+
+/*
+=================
+Sys_AtomicIncrement
+
+Returns the value before the increment
+=================
+*/
+int Sys_AtomicIncrement( volatile int* value )
+{
+#ifdef _WIN32
+	return InterlockedIncrement( ( volatile LONG* )value ) - 1;
+#else
+	return __sync_fetch_and_add( value, 1 );
+#endif
+}
+
+static void Sys_InitLock( sysLock_t* lock, sysCond_t* wake, sysCond_t* done )
+{
+#ifdef _WIN32
+	InitializeCriticalSection( lock );
+	InitializeConditionVariable( wake );
+	InitializeConditionVariable( done );
+#else
+	pthread_mutex_init( lock, NULL );
+	pthread_cond_init( wake, NULL );
+	pthread_cond_init( done, NULL );
+#endif
+}
+
+static void Sys_Lock( sysLock_t* lock )
+{
+#ifdef _WIN32
+	EnterCriticalSection( lock );
+#else
+	pthread_mutex_lock( lock );
+#endif
+}
+
+static void Sys_Unlock( sysLock_t* lock )
+{
+#ifdef _WIN32
+	LeaveCriticalSection( lock );
+#else
+	pthread_mutex_unlock( lock );
+#endif
+}
+
+static void Sys_CondWait( sysCond_t* cond, sysLock_t* lock )
+{
+#ifdef _WIN32
+	SleepConditionVariableCS( cond, lock, INFINITE );
+#else
+	pthread_cond_wait( cond, lock );
+#endif
+}
+
+static void Sys_CondBroadcast( sysCond_t* cond )
+{
+#ifdef _WIN32
+	WakeAllConditionVariable( cond );
+#else
+	pthread_cond_broadcast( cond );
+#endif
+}
+
+/*
+=================
+Sys_ProcessJobs
+
+Pulls indices out of the current batch until it is exhausted, the
+share of every thread shows up in its own profiler ring
+=================
+*/
+static void Sys_ProcessJobs( jobFunc_t func, void* data, int count )
+{
+	int index;
+
+	PROF_BEGIN( "Sys_ProcessJobs" );
+	while( ( index = Sys_AtomicIncrement( &jobs.next ) ) < count )
+	{
+		func( data, index );
+	}
+	PROF_END();
+}
+
+/*
+=================
+Sys_JobThread
+=================
+*/
+#ifdef _WIN32
+static DWORD WINAPI Sys_JobThread( LPVOID arg UNUSED_VAR )
+#else
+static void* Sys_JobThread( void* arg UNUSED_VAR )
+#endif
+{
+	int		  lastBatch = 0;
+	jobFunc_t func;
+	void*	  data;
+	int		  count;
+
+	while( 1 )
+	{
+		Sys_Lock( &jobs.lock );
+		while( !jobs.quit && jobs.batch == lastBatch )
+		{
+			Sys_CondWait( &jobs.wake, &jobs.lock );
+		}
+		if( jobs.quit )
+		{
+			Sys_Unlock( &jobs.lock );
+			break;
+		}
+		lastBatch = jobs.batch;
+		if( jobs.next >= jobs.count )
+		{
+			// the caller already drained this batch and may have returned
+			Sys_Unlock( &jobs.lock );
+			continue;
+		}
+		func	  = jobs.func;
+		data	  = jobs.data;
+		count	  = jobs.count;
+		jobs.busyWorkers++;
+		Sys_Unlock( &jobs.lock );
+
+		Sys_ProcessJobs( func, data, count );
+
+		Sys_Lock( &jobs.lock );
+		if( --jobs.busyWorkers == 0 )
+		{
+			Sys_CondBroadcast( &jobs.done );
+		}
+		Sys_Unlock( &jobs.lock );
+	}
+
+	return 0;
+}
+
+/*
+=================
+Sys_NumCPUs
+=================
+*/
+static int Sys_NumCPUs()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+
+	GetSystemInfo( &info );
+	return info.dwNumberOfProcessors;
+#else
+	return sysconf( _SC_NPROCESSORS_ONLN );
+#endif
+}
+
+/*
+=================
+Sys_InitJobs
+=================
+*/
+void Sys_InitJobs()
+{
+	int i, numThreads;
+
+	com_jobThreads = Cvar_Get( "com_jobThreads", "-1", CVAR_ARCHIVE | CVAR_LATCH );
+
+	numThreads = com_jobThreads->integer;
+	if( numThreads < 0 )
+	{
+		// leave one core for the main thread
+		numThreads = Sys_NumCPUs() - 1;
+	}
+	numThreads = Com_Clamp( 0, MAX_JOB_THREADS, numThreads );
+
+	Com_Memset( &jobs, 0, sizeof( jobs ) );
+	Sys_InitLock( &jobs.lock, &jobs.wake, &jobs.done );
+
+	for( i = 0; i < numThreads; i++ )
+	{
+#ifdef _WIN32
+		jobs.threads[i] = CreateThread( NULL, 0, Sys_JobThread, NULL, 0, NULL );
+		if( !jobs.threads[i] )
+		{
+			break;
+		}
+#else
+		if( pthread_create( &jobs.threads[i], NULL, Sys_JobThread, NULL ) )
+		{
+			break;
+		}
+#endif
+	}
+	jobs.numThreads = i;
+
+	Com_Printf( "Started %i worker threads\n", jobs.numThreads );
+}
+
+/*
+=================
+Sys_ShutdownJobs
+=================
+*/
+void Sys_ShutdownJobs()
+{
+	int i;
+
+	if( !jobs.numThreads )
+	{
+		return;
+	}
+
+	Sys_Lock( &jobs.lock );
+	jobs.quit = qtrue;
+	Sys_CondBroadcast( &jobs.wake );
+	Sys_Unlock( &jobs.lock );
+
+	for( i = 0; i < jobs.numThreads; i++ )
+	{
+#ifdef _WIN32
+		WaitForSingleObject( jobs.threads[i], INFINITE );
+		CloseHandle( jobs.threads[i] );
+#else
+		pthread_join( jobs.threads[i], NULL );
+#endif
+	}
+	jobs.numThreads = 0;
+}
+
+/*
+=================
+Sys_NumJobThreads
+
+Number of threads that take part in a batch, including the caller
+=================
+*/
+int Sys_NumJobThreads()
+{
+	return jobs.numThreads + 1;
+}
+
+/*
+=================
+Sys_RunJobs
+
+Calls func( data, i ) for every i in [0, count) spread over the worker
+threads and returns when all of them are finished.  Only the main thread
+may post batches, nested batches run serially on the calling thread.
+=================
+*/
+void Sys_RunJobs( jobFunc_t func, void* data, int count )
+{
+	int i;
+
+	if( count <= 0 )
+	{
+		return;
+	}
+
+	if( !jobs.numThreads || count == 1 || jobsRunning )
+	{
+		for( i = 0; i < count; i++ )
+		{
+			func( data, i );
+		}
+		return;
+	}
+
+	jobsRunning = qtrue;
+
+	Sys_Lock( &jobs.lock );
+	jobs.func  = func;
+	jobs.data  = data;
+	jobs.count = count;
+	jobs.next  = 0;
+	jobs.batch++;
+	Sys_CondBroadcast( &jobs.wake );
+	Sys_Unlock( &jobs.lock );
+
+	Sys_ProcessJobs( func, data, count );
+
+	// wait for the workers that picked up this batch
+	Sys_Lock( &jobs.lock );
+	while( jobs.busyWorkers )
+	{
+		Sys_CondWait( &jobs.done, &jobs.lock );
+	}
+	Sys_Unlock( &jobs.lock );
+
+	jobsRunning = qfalse;
+}
+
+/*
+=============================================================================
+
+LONG RUNNING THREADS
+
+For work that runs beside the frame instead of inside a batch.  The same
+restrictions as for jobs apply.
+
+=============================================================================
+*/
+
+#define MAX_SYS_THREADS 8
+#define MAX_SYS_SIGNALS 8
+#define MAX_SYS_MUTEXES 8
+
+struct sysThread_s
+{
+	qboolean		  used;
+	sysThreadHandle_t handle;
+	threadFunc_t	  func;
+	void*			  arg;
+};
+
+struct sysSignal_s
+{
+	qboolean  used;
+	sysLock_t lock;
+	sysCond_t cond;
+	sysCond_t unused;
+	qboolean  raised;
+};
+
+struct sysMutex_s
+{
+	qboolean  used;
+	sysLock_t lock;
+};
+
+static sysThread_t sysThreads[MAX_SYS_THREADS];
+static sysSignal_t sysSignals[MAX_SYS_SIGNALS];
+static sysMutex_t  sysMutexes[MAX_SYS_MUTEXES];
+
+/*
+=================
+Sys_MemoryBarrier
+
+Orders the memory accesses before and after it, for lock free handoffs
+=================
+*/
+void Sys_MemoryBarrier()
+{
+#ifdef _WIN32
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+#ifdef _WIN32
+static DWORD WINAPI Sys_ThreadMain( LPVOID arg )
+#else
+static void* Sys_ThreadMain( void* arg )
+#endif
+{
+	sysThread_t* thread = ( sysThread_t* )arg;
+
+	thread->func( thread->arg );
+	return 0;
+}
+
+/*
+=================
+Sys_CreateThread
+
+Returns NULL if the thread could not be started
+=================
+*/
+sysThread_t* Sys_CreateThread( threadFunc_t func, void* arg )
+{
+	int			 i;
+	sysThread_t* thread;
+
+	for( i = 0, thread = sysThreads; i < MAX_SYS_THREADS; i++, thread++ )
+	{
+		if( !thread->used )
+		{
+			break;
+		}
+	}
+	if( i == MAX_SYS_THREADS )
+	{
+		return NULL;
+	}
+
+	thread->func = func;
+	thread->arg	 = arg;
+
+#ifdef _WIN32
+	thread->handle = CreateThread( NULL, 0, Sys_ThreadMain, thread, 0, NULL );
+	if( !thread->handle )
+	{
+		return NULL;
+	}
+#else
+	if( pthread_create( &thread->handle, NULL, Sys_ThreadMain, thread ) )
+	{
+		return NULL;
+	}
+#endif
+
+	thread->used = qtrue;
+	return thread;
+}
+
+/*
+=================
+Sys_JoinThread
+
+Waits for the thread function to return
+=================
+*/
+void Sys_JoinThread( sysThread_t* thread )
+{
+	if( !thread || !thread->used )
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	WaitForSingleObject( thread->handle, INFINITE );
+	CloseHandle( thread->handle );
+#else
+	pthread_join( thread->handle, NULL );
+#endif
+	thread->used = qfalse;
+}
+
+/*
+=================
+Sys_CreateSignal
+
+An auto reset event, a raise wakes one waiting thread
+=================
+*/
+sysSignal_t* Sys_CreateSignal()
+{
+	int			 i;
+	sysSignal_t* signal;
+
+	for( i = 0, signal = sysSignals; i < MAX_SYS_SIGNALS; i++, signal++ )
+	{
+		if( !signal->used )
+		{
+			Sys_InitLock( &signal->lock, &signal->cond, &signal->unused );
+			signal->raised = qfalse;
+			signal->used   = qtrue;
+			return signal;
+		}
+	}
+	return NULL;
+}
+
+/*
+=================
+Sys_DestroySignal
+=================
+*/
+void Sys_DestroySignal( sysSignal_t* signal )
+{
+	if( !signal )
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	DeleteCriticalSection( &signal->lock );
+#else
+	pthread_mutex_destroy( &signal->lock );
+	pthread_cond_destroy( &signal->cond );
+	pthread_cond_destroy( &signal->unused );
+#endif
+	signal->used = qfalse;
+}
+
+/*
+=================
+Sys_RaiseSignal
+=================
+*/
+void Sys_RaiseSignal( sysSignal_t* signal )
+{
+	Sys_Lock( &signal->lock );
+	signal->raised = qtrue;
+	Sys_CondBroadcast( &signal->cond );
+	Sys_Unlock( &signal->lock );
+}
+
+/*
+=================
+Sys_WaitSignal
+
+Returns qfalse if msec passed without the signal being raised
+=================
+*/
+qboolean Sys_WaitSignal( sysSignal_t* signal, int msec )
+{
+	qboolean raised;
+#ifndef _WIN32
+	struct timespec deadline;
+
+	clock_gettime( CLOCK_REALTIME, &deadline );
+	deadline.tv_sec += msec / 1000;
+	deadline.tv_nsec += ( msec % 1000 ) * 1000000;
+	if( deadline.tv_nsec >= 1000000000 )
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000;
+	}
+#endif
+
+	Sys_Lock( &signal->lock );
+	while( !signal->raised )
+	{
+#ifdef _WIN32
+		if( !SleepConditionVariableCS( &signal->cond, &signal->lock, msec ) )
+		{
+			break;
+		}
+#else
+		if( pthread_cond_timedwait( &signal->cond, &signal->lock, &deadline ) )
+		{
+			break;
+		}
+#endif
+	}
+	raised		   = signal->raised;
+	signal->raised = qfalse;
+	Sys_Unlock( &signal->lock );
+
+	return raised;
+}
+
+/*
+=================
+Sys_CreateMutex
+=================
+*/
+sysMutex_t* Sys_CreateMutex()
+{
+	int			i;
+	sysMutex_t* mutex;
+
+	for( i = 0, mutex = sysMutexes; i < MAX_SYS_MUTEXES; i++, mutex++ )
+	{
+		if( !mutex->used )
+		{
+#ifdef _WIN32
+			InitializeCriticalSection( &mutex->lock );
+#else
+			pthread_mutex_init( &mutex->lock, NULL );
+#endif
+			mutex->used = qtrue;
+			return mutex;
+		}
+	}
+	return NULL;
+}
+
+/*
+=================
+Sys_DestroyMutex
+=================
+*/
+void Sys_DestroyMutex( sysMutex_t* mutex )
+{
+	if( !mutex )
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	DeleteCriticalSection( &mutex->lock );
+#else
+	pthread_mutex_destroy( &mutex->lock );
+#endif
+	mutex->used = qfalse;
+}
+
+/*
+=================
+Sys_LockMutex
+=================
+*/
+void Sys_LockMutex( sysMutex_t* mutex )
+{
+	Sys_Lock( &mutex->lock );
+}
+
+/*
+=================
+Sys_UnlockMutex
+=================
+*/
+void Sys_UnlockMutex( sysMutex_t* mutex )
+{
+	Sys_Unlock( &mutex->lock );
+}
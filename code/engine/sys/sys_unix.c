@@ -159,6 +159,25 @@ int			  Sys_Milliseconds()
 	return curtime;
 }
 
+/*
+================
+Sys_Microseconds
+================
+*/
+int64_t Sys_Microseconds()
+{
+	static time_t	base;
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	if( !base )
+	{
+		base = ts.tv_sec;
+	}
+
+	return ( int64_t )( ts.tv_sec - base ) * 1000000 + ts.tv_nsec / 1000;
+}
+
 /*
 ==================
 Sys_RandomBytes
@@ -264,6 +283,51 @@ FILE* Sys_FOpen( const char* ospath, const char* mode )
 	return fopen( ospath, mode );
 }
 
+/*
+==================
+Sys_MapFile
+==================
+*/
+void* Sys_MapFile( const char* ospath, long* length )
+{
+	struct stat buf;
+	void*		data;
+	int			fd;
+
+	fd = open( ospath, O_RDONLY );
+	if( fd == -1 )
+	{
+		return NULL;
+	}
+
+	if( fstat( fd, &buf ) || !S_ISREG( buf.st_mode ) || buf.st_size <= 0 )
+	{
+		close( fd );
+		return NULL;
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	data = mmap( NULL, buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if( data == MAP_FAILED )
+	{
+		return NULL;
+	}
+
+	*length = buf.st_size;
+	return data;
+}
+
+/*
+==================
+Sys_UnmapFile
+==================
+*/
+void Sys_UnmapFile( void* data, long length )
+{
+	munmap( data, length );
+}
+
 /*
 ==================
 Sys_Mkdir
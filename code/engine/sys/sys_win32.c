@@ -261,6 +261,27 @@ int Sys_Milliseconds()
 	return sys_curtime;
 }
 
+/*
+================
+Sys_Microseconds
+================
+*/
+int64_t Sys_Microseconds()
+{
+	static LARGE_INTEGER frequency;
+	static LARGE_INTEGER base;
+	LARGE_INTEGER		 counter;
+
+	if( !frequency.QuadPart )
+	{
+		QueryPerformanceFrequency( &frequency );
+		QueryPerformanceCounter( &base );
+	}
+	QueryPerformanceCounter( &counter );
+
+	return ( counter.QuadPart - base.QuadPart ) * 1000000 / frequency.QuadPart;
+}
+
 /*
 ================
 Sys_RandomBytes
@@ -429,6 +450,66 @@ FILE* Sys_FOpen( const char* ospath, const char* mode )
 	return fopen( ospath, mode );
 }
 
+/*
+==============
+Sys_MapFile
+==============
+*/
+void* Sys_MapFile( const char* ospath, long* length )
+{
+	HANDLE		  file, mapping;
+	LARGE_INTEGER size;
+	void*		  data;
+	size_t		  len;
+
+	// same restriction as Sys_FOpen
+	len = strlen( ospath );
+	if( len == 0 || ospath[len - 1] == ' ' || ospath[len - 1] == '.' )
+	{
+		return NULL;
+	}
+
+	file = CreateFileA( ospath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+	{
+		return NULL;
+	}
+
+	if( !GetFileSizeEx( file, &size ) || size.QuadPart <= 0 || size.QuadPart > 0x7fffffff )
+	{
+		CloseHandle( file );
+		return NULL;
+	}
+
+	// the view keeps the file and the mapping object alive
+	mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	CloseHandle( file );
+	if( !mapping )
+	{
+		return NULL;
+	}
+
+	data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	CloseHandle( mapping );
+	if( !data )
+	{
+		return NULL;
+	}
+
+	*length = ( long )size.QuadPart;
+	return data;
+}
+
+/*
+==============
+Sys_UnmapFile
+==============
+*/
+void Sys_UnmapFile( void* data, long length )
+{
+	UnmapViewOfFile( data );
+}
+
 /*
 ==============
 Sys_Mkdir
@@ -1744,6 +1744,39 @@ int BotAILoadMap( int restart )
 void ProximityMine_Trigger( gentity_t* trigger, gentity_t* other, trace_t* trace );
 #endif
 
+/*
+==================
+BotPrepareThinkers
+
+Hands the bots that are about to think to the botlib, which calculates the
+travel times towards all items for their goal choice on the job threads.
+Only the bots that will choose a long term goal or look for a nearby goal
+this think are prepared, most thinks choose neither. The bot state of the
+last think is a good guess for what they will ask.
+==================
+*/
+static void BotPrepareThinkers( int* clients, int numclients )
+{
+	int				  i, numprepare;
+	bot_state_t*	  bs;
+	bot_goalprepare_t prepare[MAX_CLIENTS];
+
+	numprepare = 0;
+	for( i = 0; i < numclients; i++ )
+	{
+		bs = botstates[clients[i]];
+		if( bs->ltg_time >= FloatTime() && bs->check_time >= FloatTime() )
+		{
+			continue;
+		}
+		prepare[numprepare].goalstate	= bs->gs;
+		prepare[numprepare].travelflags = bs->tfl;
+		VectorCopy( g_entities[clients[i]].client->ps.origin, prepare[numprepare].origin );
+		numprepare++;
+	}
+	trap_BotPrepareGoals( prepare, numprepare );
+}
+
 /*
 ==================
 BotAIStartFrame
@@ -1751,7 +1784,7 @@ BotAIStartFrame
 */
 int BotAIStartFrame( int time )
 {
-	int				  i;
+	int				  i, numthinking, thinking[MAX_CLIENTS];
 	gentity_t*		  ent;
 	bot_entitystate_t state;
 	int				  elapsed_time, thinktime;
@@ -1938,7 +1971,8 @@ int BotAIStartFrame( int time )
 
 	floattime = trap_AAS_Time();
 
-	// execute scheduled bot AI
+	// find the bots that think this frame
+	numthinking = 0;
 	for( i = 0; i < MAX_CLIENTS; i++ )
 	{
 		if( !botstates[i] || !botstates[i]->inuse )
@@ -1959,11 +1993,20 @@ int BotAIStartFrame( int time )
 
 			if( g_entities[i].client->pers.connected == CON_CONNECTED )
 			{
-				BotAI( i, ( float )thinktime / 1000 );
+				thinking[numthinking++] = i;
 			}
 		}
 	}
 
+	// let the botlib do the routing for their goals all at once
+	BotPrepareThinkers( thinking, numthinking );
+
+	// execute scheduled bot AI
+	for( i = 0; i < numthinking; i++ )
+	{
+		BotAI( thinking[i], ( float )thinktime / 1000 );
+	}
+
 	// execute bot user commands every frame
 	for( i = 0; i < MAX_CLIENTS; i++ )
 	{
@@ -918,6 +918,7 @@ int	  trap_BotGetTopGoal( int goalstate, void /* struct bot_goal_s */* goal );
 int	  trap_BotGetSecondGoal( int goalstate, void /* struct bot_goal_s */* goal );
 int	  trap_BotChooseLTGItem( int goalstate, vec3_t origin, int* inventory, int travelflags );
 int	  trap_BotChooseNBGItem( int goalstate, vec3_t origin, int* inventory, int travelflags, void /* struct bot_goal_s */* ltg, float maxtime );
+void  trap_BotPrepareGoals( void /* struct bot_goalprepare_s */* prepare, int numprepare );
 int	  trap_BotTouchingGoal( vec3_t origin, void /* struct bot_goal_s */* goal );
 int	  trap_BotItemGoalInVisButNotVisible( int viewer, vec3_t eye, vec3_t viewangles, void /* struct bot_goal_s */* goal );
 int	  trap_BotGetNextCampSpotGoal( int num, void /* struct bot_goal_s */* goal );
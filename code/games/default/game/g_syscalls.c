@@ -784,6 +784,11 @@ int trap_BotChooseNBGItem( int goalstate, vec3_t origin, int* inventory, int tra
 	return syscall( BOTLIB_AI_CHOOSE_NBG_ITEM, goalstate, origin, inventory, travelflags, ltg, PASSFLOAT( maxtime ) );
 }
 
+void trap_BotPrepareGoals( void /* struct bot_goalprepare_s */* prepare, int numprepare )
+{
+	syscall( BOTLIB_AI_PREPARE_GOALS, prepare, numprepare );
+}
+
 int trap_BotTouchingGoal( vec3_t origin, void /* struct bot_goal_s */* goal )
 {
 	return syscall( BOTLIB_AI_TOUCHING_GOAL, origin, goal );
@@ -37,6 +37,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 	// maximum nodes
 	#define MAX_NODES	 1000
 
+	// maximum links between the nodes
+	#define MAX_NODE_LINKS ( MAX_NODES * 16 )
+
 	// link types
 	#define INVALID		 -1
 
@@ -125,6 +128,7 @@ void		  ACEMV_Wander( gentity_t* self );
 
 // acebot_nodes.c protos
 int			  ACEND_FindCost( int from, int to );
+int			  ACEND_NextNode( int from, int to );
 int			  ACEND_FindCloseReachableNode( gentity_t* self, float range, int type );
 int			  ACEND_FindClosestReachableNode( gentity_t* self, float range, int type );
 void		  ACEND_SetGoal( gentity_t* self, int goal_node );
@@ -133,6 +137,7 @@ void		  ACEND_GrapFired( gentity_t* self );
 qboolean	  ACEND_CheckForLadder( gentity_t* self );
 void		  ACEND_PathMap( gentity_t* self );
 void		  ACEND_InitNodes();
+void		  ACEND_MoveNode( int node, const vec3_t origin );
 void		  ACEND_ShowNode( int node );
 void		  ACEND_DrawPath( int currentNode, int goalNode );
 void		  ACEND_ShowPath( gentity_t* self, int goalNode );
@@ -140,7 +145,6 @@ int			  ACEND_AddNode( gentity_t* self, int type );
 const char*	  ACEND_NodeTypeToString( int type );
 void		  ACEND_UpdateNodeEdge( int from, int to );
 void		  ACEND_RemoveNodeEdge( gentity_t* self, int from, int to );
-void		  ACEND_ResolveAllPaths();
 void		  ACEND_SaveNodes();
 void		  ACEND_LoadNodes();
 
@@ -33,41 +33,416 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 int		  numNodes;
 
 // array for node data
-node_t	  nodes[MAX_NODES];
-short int path_table[MAX_NODES][MAX_NODES];
+node_t nodes[MAX_NODES];
+
+// the links between the nodes, the dense path table of the node files is only
+// used on disk, routes are searched on demand and cached per start or goal node
+typedef struct
+{
+	short from;
+	short to;
+} nodeLink_t;
+
+static nodeLink_t nodeLinks[MAX_NODE_LINKS];
+static int		  numNodeLinks;
+
+// compressed adjacency lists built from nodeLinks whenever they changed
+static qboolean	  graphDirty;
+static int		  graphGeneration;
+static int		  firstOutLink[MAX_NODES + 1];
+static short	  outLinks[MAX_NODE_LINKS];
+static int		  firstInLink[MAX_NODES + 1];
+static short	  inLinks[MAX_NODE_LINKS];
+
+// a breadth first search from or to the root node, as all links cost the same
+// this holds the shortest routes and answers every query about that node
+	#define MAX_ROUTE_TREES 32
+
+typedef struct
+{
+	int		 root;
+	qboolean reverse; // routes to the root instead of from it
+	int		 generation;
+	int		 lastUsed;
+	short	 next[MAX_NODES]; // next node on the route, first node after root for forward trees
+	short	 cost[MAX_NODES]; // number of links, INVALID if unreachable
+} routeTree_t;
+
+static routeTree_t routeTrees[MAX_ROUTE_TREES];
+static int		   routeTreeUse;
+static short	   routeQueue[MAX_NODES];
+
+// spatial hash for finding nodes near a point, the cells are NODE_DENSITY wide
+	#define NODE_HASH_SIZE 1024
+
+typedef struct
+{
+	int	  node;
+	float dist;
+} nodeDist_t;
+
+static int		  nodeHashChains[NODE_HASH_SIZE];
+static int		  nodeHashNext[MAX_NODES];
+static int		  nodeCells[MAX_NODES][3];
+static nodeDist_t nodeCandidates[MAX_NODES];
+
+/*
+==================
+ACEND_BuildGraph
+
+Sorts the links into per node lists, which invalidates all cached routes
+==================
+*/
+static void ACEND_BuildGraph()
+{
+	int i;
+
+	if( !graphDirty )
+	{
+		return;
+	}
+
+	memset( firstOutLink, 0, sizeof( firstOutLink ) );
+	memset( firstInLink, 0, sizeof( firstInLink ) );
+
+	for( i = 0; i < numNodeLinks; i++ )
+	{
+		firstOutLink[nodeLinks[i].from + 1]++;
+		firstInLink[nodeLinks[i].to + 1]++;
+	}
+
+	for( i = 0; i < numNodes; i++ )
+	{
+		firstOutLink[i + 1] += firstOutLink[i];
+		firstInLink[i + 1] += firstInLink[i];
+	}
+
+	// fill from the back so the lists keep the order the links were added in
+	for( i = numNodeLinks - 1; i >= 0; i-- )
+	{
+		outLinks[--firstOutLink[nodeLinks[i].from + 1]] = nodeLinks[i].to;
+		inLinks[--firstInLink[nodeLinks[i].to + 1]]		= nodeLinks[i].from;
+	}
+
+	// every start ended up in the slot of the following node
+	for( i = 0; i < numNodes; i++ )
+	{
+		firstOutLink[i] = firstOutLink[i + 1];
+		firstInLink[i]	= firstInLink[i + 1];
+	}
+	firstOutLink[numNodes] = numNodeLinks;
+	firstInLink[numNodes]  = numNodeLinks;
+
+	graphGeneration++;
+	graphDirty = qfalse;
+}
+
+/*
+==================
+ACEND_HasNodeEdge
+==================
+*/
+static qboolean ACEND_HasNodeEdge( int from, int to )
+{
+	int i;
+
+	ACEND_BuildGraph();
+
+	for( i = firstOutLink[from]; i < firstOutLink[from + 1]; i++ )
+	{
+		if( outLinks[i] == to )
+		{
+			return qtrue;
+		}
+	}
+
+	return qfalse;
+}
+
+/*
+==================
+ACEND_CachedRouteTree
+==================
+*/
+static routeTree_t* ACEND_CachedRouteTree( int root, qboolean reverse )
+{
+	int			 i;
+	routeTree_t* tree;
+
+	ACEND_BuildGraph();
+
+	for( i = 0, tree = routeTrees; i < MAX_ROUTE_TREES; i++, tree++ )
+	{
+		if( tree->generation == graphGeneration && tree->root == root && tree->reverse == reverse )
+		{
+			tree->lastUsed = ++routeTreeUse;
+			return tree;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+==================
+ACEND_RouteTree
+
+Returns the cached search from or to the root, replacing the least recently
+used one if it has to be searched first
+==================
+*/
+static routeTree_t* ACEND_RouteTree( int root, qboolean reverse )
+{
+	int			 i, node, link, head, tail;
+	routeTree_t* tree;
+	int*		 first;
+	short*		 links;
+
+	tree = ACEND_CachedRouteTree( root, reverse );
+	if( tree )
+	{
+		return tree;
+	}
+
+	tree = NULL;
+	for( i = 0; i < MAX_ROUTE_TREES; i++ )
+	{
+		if( routeTrees[i].generation != graphGeneration )
+		{
+			tree = &routeTrees[i];
+			break;
+		}
+		if( !tree || routeTrees[i].lastUsed < tree->lastUsed )
+		{
+			tree = &routeTrees[i];
+		}
+	}
+
+	tree->root		 = root;
+	tree->reverse	 = reverse;
+	tree->generation = graphGeneration;
+	tree->lastUsed	 = ++routeTreeUse;
+
+	memset( tree->next, INVALID, sizeof( short ) * numNodes );
+	memset( tree->cost, INVALID, sizeof( short ) * numNodes );
+
+	first = reverse ? firstInLink : firstOutLink;
+	links = reverse ? inLinks : outLinks;
+
+	tree->cost[root] = 0;
+	routeQueue[0]	 = root;
+	head			 = 0;
+	tail			 = 1;
+
+	while( head < tail )
+	{
+		node = routeQueue[head++];
+
+		for( link = first[node]; link < first[node + 1]; link++ )
+		{
+			i = links[link];
+			if( tree->cost[i] != INVALID )
+			{
+				continue;
+			}
+
+			tree->cost[i] = tree->cost[node] + 1;
+			if( reverse )
+			{
+				tree->next[i] = node;
+			}
+			else
+			{
+				tree->next[i] = ( node == root ) ? i : tree->next[node];
+			}
+			routeQueue[tail++] = i;
+		}
+	}
+
+	return tree;
+}
 
 // Determin cost of moving from one node to another
-int		  ACEND_FindCost( int from, int to )
+int ACEND_FindCost( int from, int to )
 {
-	int curnode;
-	int cost = 1; // Shortest possible is 1
+	routeTree_t* tree;
 
-	if( from == INVALID || to == INVALID )
+	if( from < 0 || to < 0 || from >= numNodes || to >= numNodes || from == to )
 	{
 		return INVALID;
 	}
 
-	// If we can not get there then return invalid
-	if( path_table[from][to] == INVALID )
+	// goals are usually asked for from the same start node
+	tree = ACEND_CachedRouteTree( to, qtrue );
+	if( tree )
+	{
+		return tree->cost[from];
+	}
+
+	tree = ACEND_RouteTree( from, qfalse );
+	return tree->cost[to];
+}
+
+// Returns the node after from on the shortest route to the goal
+int ACEND_NextNode( int from, int to )
+{
+	routeTree_t* tree;
+
+	if( from < 0 || to < 0 || from >= numNodes || to >= numNodes || from == to )
 	{
 		return INVALID;
 	}
 
-	// Otherwise check the path and return the cost
-	curnode = path_table[from][to];
+	tree = ACEND_CachedRouteTree( from, qfalse );
+	if( tree )
+	{
+		return tree->next[to];
+	}
+
+	// all bots following a path to the same goal share this one
+	tree = ACEND_RouteTree( to, qtrue );
+	return tree->next[from];
+}
+
+/*
+==================
+ACEND_HashCell
+==================
+*/
+static int ACEND_HashCell( int x, int y, int z )
+{
+	return ( ( unsigned )x * 73856093u ^ ( unsigned )y * 19349663u ^ ( unsigned )z * 83492791u ) & ( NODE_HASH_SIZE - 1 );
+}
 
-	// Find a path (linear time, very fast)
-	while( curnode != to )
+/*
+==================
+ACEND_HashNode
+==================
+*/
+static void ACEND_HashNode( int node )
+{
+	int i, hash;
+
+	for( i = 0; i < 3; i++ )
 	{
-		curnode = path_table[curnode][to];
-		if( curnode == INVALID ) // something has corrupted the path abort
+		nodeCells[node][i] = ( int )floor( nodes[node].origin[i] / NODE_DENSITY );
+	}
+
+	hash				 = ACEND_HashCell( nodeCells[node][0], nodeCells[node][1], nodeCells[node][2] );
+	nodeHashNext[node]	 = nodeHashChains[hash];
+	nodeHashChains[hash] = node;
+}
+
+/*
+==================
+ACEND_UnhashNode
+==================
+*/
+static void ACEND_UnhashNode( int node )
+{
+	int* link;
+
+	link = &nodeHashChains[ACEND_HashCell( nodeCells[node][0], nodeCells[node][1], nodeCells[node][2] )];
+	while( *link != INVALID )
+	{
+		if( *link == node )
 		{
-			return INVALID;
+			*link = nodeHashNext[node];
+			return;
 		}
-		cost++;
+		link = &nodeHashNext[*link];
 	}
+}
 
-	return cost;
+/*
+==================
+ACEND_NodesInRange
+
+Collects the nodes of the given type closer than range to the origin,
+unsorted
+==================
+*/
+static int ACEND_NodesInRange( const vec3_t origin, float range, int type )
+{
+	int	   i, x, y, z, node, count;
+	int	   mins[3], maxs[3];
+	float  dist;
+	vec3_t v;
+
+	for( i = 0; i < 3; i++ )
+	{
+		mins[i] = ( int )floor( ( origin[i] - range ) / NODE_DENSITY );
+		maxs[i] = ( int )floor( ( origin[i] + range ) / NODE_DENSITY );
+	}
+
+	count = 0;
+
+	// a huge range touches more cells than there are nodes
+	if( ( float )( maxs[0] - mins[0] + 1 ) * ( maxs[1] - mins[1] + 1 ) * ( maxs[2] - mins[2] + 1 ) > numNodes )
+	{
+		for( node = 0; node < numNodes; node++ )
+		{
+			if( type == NODE_ALL || type == nodes[node].type )
+			{
+				VectorSubtract( nodes[node].origin, origin, v );
+				dist = VectorLength( v );
+				if( dist < range )
+				{
+					nodeCandidates[count].node	 = node;
+					nodeCandidates[count].dist	 = dist;
+					count++;
+				}
+			}
+		}
+		return count;
+	}
+
+	for( x = mins[0]; x <= maxs[0]; x++ )
+	{
+		for( y = mins[1]; y <= maxs[1]; y++ )
+		{
+			for( z = mins[2]; z <= maxs[2]; z++ )
+			{
+				for( node = nodeHashChains[ACEND_HashCell( x, y, z )]; node != INVALID; node = nodeHashNext[node] )
+				{
+					// other cells can share the chain
+					if( nodeCells[node][0] != x || nodeCells[node][1] != y || nodeCells[node][2] != z )
+					{
+						continue;
+					}
+
+					if( type == NODE_ALL || type == nodes[node].type )
+					{
+						VectorSubtract( nodes[node].origin, origin, v );
+						dist = VectorLength( v );
+						if( dist < range )
+						{
+							nodeCandidates[count].node = node;
+							nodeCandidates[count].dist = dist;
+							count++;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return count;
+}
+
+static int ACEND_CompareNodeDist( const void* a, const void* b )
+{
+	float d = ( ( const nodeDist_t* )a )->dist - ( ( const nodeDist_t* )b )->dist;
+
+	if( d < 0 )
+	{
+		return -1;
+	}
+	if( d > 0 )
+	{
+		return 1;
+	}
+	return ( ( const nodeDist_t* )a )->node - ( ( const nodeDist_t* )b )->node;
 }
 
 // Find a close node to the player within dist.
@@ -76,31 +451,19 @@ int		  ACEND_FindCost( int from, int to )
 // accurate.
 int ACEND_FindCloseReachableNode( gentity_t* self, float range, int type )
 {
-	vec3_t	v;
-	int		i;
+	int		i, count;
 	trace_t tr;
-	float	dist;
 
-	//  range *= range;
+	count = ACEND_NodesInRange( self->client->ps.origin, range, type );
 
-	for( i = 0; i < numNodes; i++ )
+	for( i = 0; i < count; i++ )
 	{
-		if( type == NODE_ALL || type == nodes[i].type ) // check node type
-		{
-			VectorSubtract( nodes[i].origin, self->client->ps.origin, v ); // subtract first
+		// make sure it is visible
+		trap_Trace( &tr, self->client->ps.origin, self->r.mins, self->r.maxs, nodes[nodeCandidates[i].node].origin, self->s.number, MASK_PLAYERSOLID );
 
-			dist = VectorLength( v );
-
-			if( dist < range ) // square range instead of sqrt
-			{
-				// make sure it is visible
-				trap_Trace( &tr, self->client->ps.origin, self->r.mins, self->r.maxs, nodes[i].origin, self->s.number, MASK_PLAYERSOLID );
-
-				if( tr.fraction == 1.0 )
-				{
-					return i;
-				}
-			}
+		if( tr.fraction == 1.0 )
+		{
+			return nodeCandidates[i].node;
 		}
 	}
 
@@ -110,13 +473,8 @@ int ACEND_FindCloseReachableNode( gentity_t* self, float range, int type )
 // Find the closest node to the player within a certain range
 int ACEND_FindClosestReachableNode( gentity_t* self, float range, int type )
 {
-	int		i;
-	float	closest = 99999;
-	float	dist;
-	int		node = INVALID;
-	vec3_t	v;
+	int		i, count;
 	trace_t tr;
-	// float           rng;
 	vec3_t	maxs, mins;
 
 	VectorCopy( self->r.mins, mins );
@@ -124,31 +482,22 @@ int ACEND_FindClosestReachableNode( gentity_t* self, float range, int type )
 
 	mins[2] += STEPSIZE;
 
-	//  rng = (float)(range * range);   // square range for distance comparison (eliminate sqrt)
+	// trace the candidates nearest first, the first visible one is the closest
+	count = ACEND_NodesInRange( self->client->ps.origin, range, type );
+	qsort( nodeCandidates, count, sizeof( nodeDist_t ), ACEND_CompareNodeDist );
 
-	for( i = 0; i < numNodes; i++ )
+	for( i = 0; i < count; i++ )
 	{
-		if( type == NODE_ALL || type == nodes[i].type ) // check node type
-		{
-			VectorSubtract( nodes[i].origin, self->client->ps.origin, v ); // subtract first
-
-			dist = VectorLength( v );
-
-			if( dist < closest && dist < range )
-			{
-				// make sure it is visible
-				trap_Trace( &tr, self->client->ps.origin, mins, maxs, nodes[i].origin, self->s.number, MASK_PLAYERSOLID );
+		// make sure it is visible
+		trap_Trace( &tr, self->client->ps.origin, mins, maxs, nodes[nodeCandidates[i].node].origin, self->s.number, MASK_PLAYERSOLID );
 
-				if( tr.fraction == 1.0 )
-				{
-					node	= i;
-					closest = dist;
-				}
-			}
+		if( tr.fraction == 1.0 )
+		{
+			return nodeCandidates[i].node;
 		}
 	}
 
-	return node;
+	return INVALID;
 }
 
 void ACEND_SetGoal( gentity_t* self, int goalNode )
@@ -217,7 +566,7 @@ qboolean ACEND_FollowPath( gentity_t* self )
 		else
 		{
 			self->bs.currentNode = self->bs.nextNode;
-			self->bs.nextNode	 = path_table[self->bs.currentNode][self->bs.goalNode];
+			self->bs.nextNode	 = ACEND_NextNode( self->bs.currentNode, self->bs.goalNode );
 		}
 	}
 
@@ -443,7 +792,24 @@ void ACEND_InitNodes()
 	// init node array (set all to INVALID)
 	numNodes = 0;
 	memset( nodes, 0, sizeof( node_t ) * MAX_NODES );
-	memset( path_table, INVALID, sizeof( short int ) * MAX_NODES * MAX_NODES );
+
+	numNodeLinks = 0;
+	graphDirty	 = qtrue;
+	memset( routeTrees, 0, sizeof( routeTrees ) );
+	memset( nodeHashChains, INVALID, sizeof( nodeHashChains ) );
+}
+
+// move a node and keep it findable (utility function)
+void ACEND_MoveNode( int node, const vec3_t origin )
+{
+	if( node < 0 || node >= numNodes )
+	{
+		return;
+	}
+
+	ACEND_UnhashNode( node );
+	VectorCopy( origin, nodes[node].origin );
+	ACEND_HashNode( node );
 }
 
 // show the node for debugging (utility function)
@@ -485,10 +851,10 @@ void ACEND_DrawPath( int currentNode, int goalNode )
 		return;
 	}
 
-	nextNode = path_table[currentNode][goalNode];
+	nextNode = ACEND_NextNode( currentNode, goalNode );
 
 	// Now set up and display the path
-	while( currentNode != goalNode && currentNode != -1 )
+	while( currentNode != goalNode && currentNode != -1 && nextNode != -1 )
 	{
 		gentity_t* ent;
 
@@ -509,7 +875,7 @@ void ACEND_DrawPath( int currentNode, int goalNode )
 		trap_LinkEntity( ent );
 
 		currentNode = nextNode;
-		nextNode	= path_table[currentNode][goalNode];
+		nextNode	= ACEND_NextNode( currentNode, goalNode );
 	}
 }
 
@@ -657,7 +1023,10 @@ int ACEND_AddNode( gentity_t* self, int type )
 	// add a link
 	// ACEND_UpdateNodeEdge(numNodes, numNodes - 1);
 
+	ACEND_HashNode( numNodes );
+
 	numNodes++;
+	graphDirty = qtrue;
 	return numNodes - 1; // return the node added
 }
 
@@ -704,32 +1073,27 @@ const char* ACEND_NodeTypeToString( int type )
 // add / update node connections (paths)
 void ACEND_UpdateNodeEdge( int from, int to )
 {
-	int i;
-
-	if( from == -1 || to == -1 || from == to )
+	if( from < 0 || to < 0 || from >= numNodes || to >= numNodes || from == to )
 	{
 		return; // safety
 	}
 
-	// Add the link
-	path_table[from][to] = to;
+	if( ACEND_HasNodeEdge( from, to ) )
+	{
+		return;
+	}
 
-	// Now for the self-referencing part, linear time for each link added
-	for( i = 0; i < numNodes; i++ )
+	if( numNodeLinks >= MAX_NODE_LINKS )
 	{
-		if( path_table[i][from] != INVALID )
-		{
-			if( i == to )
-			{
-				path_table[i][to] = INVALID; // make sure we terminate
-			}
-			else
-			{
-				path_table[i][to] = path_table[i][from];
-			}
-		}
+		return;
 	}
 
+	// Add the link, the routes are searched again when needed
+	nodeLinks[numNodeLinks].from = from;
+	nodeLinks[numNodeLinks].to	 = to;
+	numNodeLinks++;
+	graphDirty = qtrue;
+
 	if( ace_showLinks.integer )
 	{
 		trap_SendServerCommand( -1, va( "print \"Link %d -> %d\n\"", from, to ) );
@@ -746,57 +1110,15 @@ void ACEND_RemoveNodeEdge( gentity_t* self, int from, int to )
 		trap_SendServerCommand( -1, va( "print \"%s: removing link %d -> %d\n\"", self->client->pers.netname, from, to ) );
 	}
 
-	path_table[from][to] = INVALID; // set to invalid
-
-	// Make sure this gets updated in our path array
-	for( i = 0; i < numNodes; i++ )
+	for( i = 0; i < numNodeLinks; i++ )
 	{
-		if( path_table[from][i] == to )
+		if( nodeLinks[i].from == from && nodeLinks[i].to == to )
 		{
-			path_table[from][i] = INVALID;
-		}
-	}
-}
-
-// This function will resolve all paths that are incomplete
-// usually called before saving to disk
-void ACEND_ResolveAllPaths()
-{
-	int i, from, to;
-	int num = 0;
-
-	G_Printf( "Resolving all paths..." );
-
-	for( from = 0; from < numNodes; from++ )
-	{
-		for( to = 0; to < numNodes; to++ )
-		{
-			// update unresolved paths
-			// Not equal to itself, not equal to -1 and equal to the last link
-			if( from != to && path_table[from][to] == to )
-			{
-				num++;
-
-				// Now for the self-referencing part linear time for each link added
-				for( i = 0; i < numNodes; i++ )
-				{
-					if( path_table[i][from] != -1 )
-					{
-						if( i == to )
-						{
-							path_table[i][to] = -1; // make sure we terminate
-						}
-						else
-						{
-							path_table[i][to] = path_table[i][from];
-						}
-					}
-				}
-			}
+			nodeLinks[i] = nodeLinks[--numNodeLinks];
+			graphDirty	 = qtrue;
+			return;
 		}
 	}
-
-	G_Printf( "done (%d updated)\n", num );
 }
 
 // Save to disk file
@@ -812,8 +1134,8 @@ void ACEND_SaveNodes()
 	int			 i, j;
 	int			 version = 1;
 	char		 mapname[MAX_QPATH];
-
-	ACEND_ResolveAllPaths();
+	static short row[MAX_NODES];
+	routeTree_t* tree;
 
 	trap_Cvar_VariableStringBuffer( "mapname", mapname, sizeof( mapname ) );
 	Com_sprintf( filename, sizeof( filename ), "nav/%s.nod", mapname );
@@ -833,11 +1155,18 @@ void ACEND_SaveNodes()
 	trap_FS_Write( &numNodes, sizeof( int ), file );
 	trap_FS_Write( nodes, sizeof( node_t ) * numNodes, file );
 
+	// write the fully resolved next node table older versions expect
 	for( i = 0; i < numNodes; i++ )
+	{
+		tree = ACEND_RouteTree( i, qfalse );
 		for( j = 0; j < numNodes; j++ )
 		{
-			trap_FS_Write( &path_table[i][j], sizeof( short int ), file ); // write count
+			row[j] = tree->next[j];
 		}
+		row[i] = INVALID;
+
+		trap_FS_Write( row, sizeof( short ) * numNodes, file );
+	}
 
 	trap_FS_FCloseFile( file );
 
@@ -854,6 +1183,7 @@ void ACEND_LoadNodes()
 	char		 filename[MAX_QPATH];
 	int			 version;
 	char		 mapname[MAX_QPATH];
+	static short row[MAX_NODES];
 
 	trap_Cvar_VariableStringBuffer( "mapname", mapname, sizeof( mapname ) );
 	Com_sprintf( filename, sizeof( filename ), "nav/%s.nod", mapname );
@@ -876,13 +1206,36 @@ void ACEND_LoadNodes()
 		G_Printf( "ACE: Loading node table '%s'...\n", filename );
 
 		trap_FS_Read( &numNodes, sizeof( int ), file ); // read count
+		if( numNodes < 0 || numNodes > MAX_NODES )
+		{
+			G_Printf( "ACE: '%s' has too many nodes %i\n", filename, numNodes );
+			numNodes = 0;
+			trap_FS_FCloseFile( file );
+			return;
+		}
 		trap_FS_Read( &nodes, sizeof( node_t ) * numNodes, file );
 
 		for( i = 0; i < numNodes; i++ )
+		{
+			ACEND_HashNode( i );
+		}
+
+		// only the direct links are kept from the next node table
+		for( i = 0; i < numNodes; i++ )
+		{
+			trap_FS_Read( row, sizeof( short ) * numNodes, file );
+
 			for( j = 0; j < numNodes; j++ )
 			{
-				trap_FS_Read( &path_table[i][j], sizeof( short int ), file ); // write count
+				if( row[j] == j && i != j && numNodeLinks < MAX_NODE_LINKS )
+				{
+					nodeLinks[numNodeLinks].from = i;
+					nodeLinks[numNodeLinks].to	 = j;
+					numNodeLinks++;
+				}
 			}
+		}
+		graphDirty = qtrue;
 
 		if( ace_showNodes.integer )
 		{
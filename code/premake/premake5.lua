@@ -205,6 +205,7 @@ project "RBQuake3"
 		"../engine/qcommon/md4.c",
 		"../engine/qcommon/md5.c",
 		"../engine/qcommon/msg.c",
+		"../engine/qcommon/profile.c",
 		"../engine/qcommon/vm.c",
 		"../engine/qcommon/net_*.c",
 		"../engine/qcommon/unzip.c",
@@ -485,6 +486,7 @@ project "RBQuake3"
 		{
 			"../engine/sys/sys_main.c",
 			"../engine/sys/sys_win32.c",
+			"../engine/sys/sys_thread.c",
 			"../engine/sys/con_log.c",
 			"../engine/sys/con_win32.c",
 			"../engine/sys/sdl_gamma.c",
@@ -599,6 +601,7 @@ project "RBQuake3"
 		{
 			"../engine/sys/sys_main.c",
 			"../engine/sys/sys_unix.c",
+			"../engine/sys/sys_thread.c",
 			"../engine/sys/con_log.c",
 			"../engine/sys/con_passive.c",
 			"../engine/sys/sdl_gamma.c",
@@ -606,13 +609,14 @@ project "RBQuake3"
 			"../engine/sys/sdl_input.c",
 			"../engine/sys/sdl_snd.c",
 		}
-		--buildoptions
-		--{
-		--	"-pthread"
-		--}
+		buildoptions
+		{
+			"-pthread"
+		}
 		links
 		{
 			"GL",
+			"pthread",
 		}
 		defines
 		{
@@ -49,6 +49,14 @@ typedef struct bot_goal_s
 	int	   iteminfo;   // item information
 } bot_goal_t;
 
+// a bot that is about to think, see BotPrepareGoals
+typedef struct bot_goalprepare_s
+{
+	int	   goalstate;	// goal state of the bot
+	vec3_t origin;		// origin the bot will choose goals from
+	int	   travelflags; // travel flags the bot will choose goals with
+} bot_goalprepare_t;
+
 // reset the whole goal state, but keep the item weights
 void  BotResetGoalState( int goalstate );
 // reset avoid goals
@@ -78,6 +86,12 @@ int	  BotChooseLTGItem( int goalstate, vec3_t origin, int* inventory, int travel
 // also the travel time from the nearby goal towards the long term goal may not
 // be larger than the travel time towards the long term goal from the current bot position
 int	  BotChooseNBGItem( int goalstate, vec3_t origin, int* inventory, int travelflags, bot_goal_t* ltg, float maxtime );
+// calculate the travel times towards the level items for all the given bots at
+// once on the job threads, BotChooseLTGItem and BotChooseNBGItem use them when
+// called later in the same frame with the same origin and travel flags
+void  BotPrepareGoals( bot_goalprepare_t* prepare, int numprepare );
+// forget all travel times prepared by BotPrepareGoals
+void  BotClearPreparedGoals();
 // returns true if the bot touches the goal
 int	  BotTouchingGoal( vec3_t origin, bot_goal_t* goal );
 // returns true if the goal should be visible but isn't
@@ -29,7 +29,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  *
  *****************************************************************************/
 
-#define BOTLIB_API_VERSION 2
+#define BOTLIB_API_VERSION 8
 
 struct aas_clientmove_s;
 struct aas_entityinfo_s;
@@ -39,6 +39,7 @@ struct aas_predictroute_s;
 struct bot_consolemessage_s;
 struct bot_match_s;
 struct bot_goal_s;
+struct bot_goalprepare_s;
 struct bot_moveresult_s;
 struct bot_initmove_s;
 struct weaponinfo_s;
@@ -196,6 +197,23 @@ typedef struct botlib_import_s
 	int ( *FS_Write )( const void* buffer, int len, fileHandle_t f );
 	void ( *FS_FCloseFile )( fileHandle_t f );
 	int ( *FS_Seek )( fileHandle_t f, long offset, int origin );
+	long ( *FS_MapFile )( const char* qpath, void** buffer );
+	void ( *FS_UnmapFile )( void* buffer );
+	// runs func( data, i ) for every i in [0, count) on the job threads
+	void ( *RunJobs )( void ( *func )( void* data, int index ), void* data, int count );
+	// long running threads and the auto reset signals that wake them up
+	void* ( *CreateThread )( void ( *func )( void* arg ), void* arg );
+	void ( *JoinThread )( void* thread );
+	void* ( *CreateSignal )();
+	void ( *DestroySignal )( void* signal );
+	void ( *RaiseSignal )( void* signal );
+	int ( *WaitSignal )( void* signal, int msec );
+	// locks for the parts of a job that are not thread safe
+	void* ( *CreateMutex )();
+	void ( *DestroyMutex )( void* mutex );
+	void ( *LockMutex )( void* mutex );
+	void ( *UnlockMutex )( void* mutex );
+	void ( *MemoryBarrier )();
 	// debug visualisation stuff
 	int ( *DebugLineCreate )();
 	void ( *DebugLineDelete )( int line );
@@ -221,6 +239,7 @@ typedef struct aas_export_s
 	// be_aas_sample.c
 	//--------------------------------------------
 	int ( *AAS_PointAreaNum )( vec3_t point );
+	int ( *AAS_PointAreaNums )( vec3_t* points, int* areanums, int numpoints );
 	int ( *AAS_PointReachabilityAreaIndex )( vec3_t point );
 	int ( *AAS_TraceAreas )( vec3_t start, vec3_t end, int* areas, vec3_t* points, int maxareas );
 	int ( *AAS_BBoxAreas )( vec3_t absmins, vec3_t absmaxs, int* areas, int maxareas );
@@ -266,6 +285,7 @@ typedef struct aas_export_s
 		int														 stopevent,
 		int														 stopareanum,
 		int														 visualize );
+	void ( *AAS_PredictionCacheStats )( int* calls, int* hits, int reset );
 } aas_export_t;
 
 typedef struct ea_export_s
@@ -351,6 +371,7 @@ typedef struct ai_export_s
 	int ( *BotGetSecondGoal )( int goalstate, struct bot_goal_s* goal );
 	int ( *BotChooseLTGItem )( int goalstate, vec3_t origin, int* inventory, int travelflags );
 	int ( *BotChooseNBGItem )( int goalstate, vec3_t origin, int* inventory, int travelflags, struct bot_goal_s* ltg, float maxtime );
+	void ( *BotPrepareGoals )( struct bot_goalprepare_s* prepare, int numprepare );
 	int ( *BotTouchingGoal )( vec3_t origin, struct bot_goal_s* goal );
 	int ( *BotItemGoalInVisButNotVisible )( int viewer, vec3_t eye, vec3_t viewangles, struct bot_goal_s* goal );
 	int ( *BotGetLevelItemGoal )( int index, char* classname, struct bot_goal_s* goal );
@@ -223,6 +223,9 @@ typedef enum
 	// 1.32
 	G_FS_SEEK,
 
+	G_TRACE_BATCH, // ( trace_t *results, const traceRequest_t *requests, int count );
+				   // runs independent traces together, results are in request order
+
 	BOTLIB_SETUP = 200, // ();
 	BOTLIB_SHUTDOWN,	// ();
 	BOTLIB_LIBVAR_SET,
@@ -384,7 +387,10 @@ typedef enum
 
 	//=========== Bullet physics functionality =============
 
-	BULLET_ADD_WORLD_BRUSHES_TO_DYNAMICS_WORLD // (plDynamicsWorldHandle * dynamicsWorldHandle)
+	BULLET_ADD_WORLD_BRUSHES_TO_DYNAMICS_WORLD, // (plDynamicsWorldHandle * dynamicsWorldHandle)
+
+	// new imports go at the end so existing game modules keep their numbers
+	BOTLIB_AI_PREPARE_GOALS // ( bot_goalprepare_t *prepare, int numprepare );
 } gameImport_t;
 
 //
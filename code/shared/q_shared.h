@@ -1783,6 +1783,20 @@ typedef struct
 	float    lateralFraction; // fraction of collision tangetially to the trace direction
 } trace_t;
 
+// one trace of a batch, see G_TRACE_BATCH
+#define MAX_TRACE_BATCH 4096 // most traces in one batch
+
+typedef struct
+{
+	vec3_t      start;
+	vec3_t      end;
+	vec3_t      mins;
+	vec3_t      maxs;
+	int         passEntityNum; // -2 skips the entities
+	int         contentmask;
+	traceType_t type;          // TT_AABB or TT_CAPSULE
+} traceRequest_t;
+
 // trace->entityNum can also be 0 to (MAX_GENTITIES-1)
 // or ENTITYNUM_NONE, ENTITYNUM_WORLD
 